@@ -0,0 +1,199 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/AnKi.h>
+
+using namespace anki;
+
+ANKI_REGISTER_CONFIG_OPTION(bench_frameCount, 500u, 1u, MAX_U32, "Number of frames to measure")
+ANKI_REGISTER_CONFIG_OPTION(bench_warmupFrameCount, 20u, 0u, MAX_U32, "Number of frames to skip before measuring")
+ANKI_REGISTER_CONFIG_OPTION(bench_gridSize, 16, 1, 128, "The scene is a grid of gridSize x gridSize models and lights")
+
+/// Renders a synthetic scene for a number of frames and reports the CPU time of the various stages. It's meant to be
+/// used with the null graphics backend (ANKI_GR_BACKEND=NULL) so it can run without a GPU.
+class BenchApp : public App
+{
+public:
+	Error init(int argc, char** argv);
+
+	Error userMainLoop(Bool& quit) override;
+
+	void printResults() const;
+
+private:
+	/// Accumulated per stage timings.
+	class Timings
+	{
+	public:
+		Second m_frame = 0.0;
+		Second m_sceneUpdate = 0.0;
+		Second m_visibilityTests = 0.0;
+		Second m_physics = 0.0;
+		Second m_render = 0.0;
+		Second m_lightBin = 0.0;
+	};
+
+	U32 m_frameCount = 0;
+	U32 m_warmupFrameCount = 0;
+	U32 m_frame = 0;
+	Second m_frameStartTime = 0.0;
+	Timings m_timings;
+
+	Error createScene(U32 gridSize);
+};
+
+Error BenchApp::init(int argc, char** argv)
+{
+	ConfigSet config = DefaultConfigSet::get();
+	config.set("rsrc_dataPaths", ".:samples/simple_scene");
+	config.set("core_displayStats", 1); // That enables the renderer stats
+	config.set("gr_debugContext", 0);
+	ANKI_CHECK(config.setFromCommandLineArguments(argc, argv));
+	ANKI_CHECK(App::init(config, allocAligned, nullptr));
+
+	// Run as fast as possible
+	setTimerTick(0.0f);
+
+	m_frameCount = config.getNumberU32("bench_frameCount");
+	m_warmupFrameCount = config.getNumberU32("bench_warmupFrameCount");
+	ANKI_CHECK(createScene(config.getNumberU32("bench_gridSize")));
+
+	return Error::NONE;
+}
+
+Error BenchApp::createScene(U32 gridSize)
+{
+	SceneGraph& scene = getSceneGraph();
+	const F32 spacing = 12.0f;
+	const F32 offset = -F32(gridSize) * spacing / 2.0f;
+	U32 count = 0;
+
+	for(U32 z = 0; z < gridSize; ++z)
+	{
+		for(U32 x = 0; x < gridSize; ++x)
+		{
+			const Vec4 origin(offset + F32(x) * spacing, 0.0f, offset + F32(z) * spacing, 0.0f);
+			const CString modelFname = ((x + z) & 1) ? "assets/column_walls.ankimdl" : "assets/room_walls.ankimdl";
+
+			StringAuto name(getAllocator());
+			name.sprintf("model%u", count);
+			ModelNode* model;
+			ANKI_CHECK(scene.newSceneNode<ModelNode>(name.toCString(), model, modelFname));
+			model->getComponent<MoveComponent>().setLocalOrigin(origin);
+
+			// Alternate point and spot lights. Only a few cast shadows
+			const Bool shadow = (count % 8) == 0;
+			name.destroy();
+			name.sprintf("light%u", count);
+			LightNode* light;
+			if(count & 1)
+			{
+				PointLightNode* point;
+				ANKI_CHECK(scene.newSceneNode<PointLightNode>(name.toCString(), point));
+				point->getComponent<LightComponent>().setRadius(spacing);
+				light = point;
+			}
+			else
+			{
+				SpotLightNode* spot;
+				ANKI_CHECK(scene.newSceneNode<SpotLightNode>(name.toCString(), spot));
+				spot->getComponent<LightComponent>().setDistance(spacing * 1.5f);
+				spot->getComponent<LightComponent>().setOuterAngle(toRad(60.0f));
+				spot->getComponent<LightComponent>().setInnerAngle(toRad(30.0f));
+				light = spot;
+			}
+
+			LightComponent& lc = light->getComponent<LightComponent>();
+			lc.setDiffuseColor(Vec4(F32(x % 3) + 1.0f, F32(z % 3) + 1.0f, 2.0f, 0.0f));
+			lc.setShadowEnabled(shadow);
+
+			Transform trf(Transform::getIdentity());
+			trf.setOrigin(origin + Vec4(0.0f, 4.0f, 0.0f, 0.0f));
+			trf.setRotation(Mat3x4(Euler(toRad(-90.0f), 0.0f, 0.0f))); // Look down
+			light->getComponent<MoveComponent>().setLocalTransform(trf);
+
+			++count;
+		}
+	}
+
+	ANKI_LOGI("Created %u models and %u lights", count, count);
+	return Error::NONE;
+}
+
+Error BenchApp::userMainLoop(Bool& quit)
+{
+	// Gather the stats of the previous frame
+	const Second now = HighRezTimer::getCurrentTime();
+	if(m_frame > m_warmupFrameCount)
+	{
+		const SceneGraphStats& sceneStats = getSceneGraph().getStats();
+		const MainRendererStats& rStats = getMainRenderer().getStats();
+
+		m_timings.m_frame += now - m_frameStartTime;
+		m_timings.m_sceneUpdate += sceneStats.m_updateTime;
+		m_timings.m_visibilityTests += sceneStats.m_visibilityTestsTime;
+		m_timings.m_physics += sceneStats.m_physicsUpdate;
+		m_timings.m_render += rStats.m_renderingCpuTime;
+		m_timings.m_lightBin += rStats.m_lightBinTime;
+	}
+
+	m_frameStartTime = now;
+
+	if(m_frame == m_warmupFrameCount + m_frameCount)
+	{
+		quit = true;
+		return Error::NONE;
+	}
+
+	// Fly the camera in a deterministic circle around the scene
+	const F32 angle = F32(m_frame) / 100.0f;
+	const F32 radius = 40.0f;
+	Transform trf(Transform::getIdentity());
+	trf.setOrigin(Vec4(sin(angle) * radius, 10.0f, cos(angle) * radius, 0.0f));
+	trf.setRotation(Mat3x4(Euler(toRad(-15.0f), angle, 0.0f)));
+	getSceneGraph().getActiveCameraNode().getComponent<MoveComponent>().setLocalTransform(trf);
+
+	++m_frame;
+	quit = false;
+	return Error::NONE;
+}
+
+void BenchApp::printResults() const
+{
+	const F64 frames = F64(m_frameCount);
+	const F64 toMs = 1000.0 / frames;
+
+	ANKI_LOGI("Frames:           %u", m_frameCount);
+	ANKI_LOGI("Frame:            %.4f ms", m_timings.m_frame * toMs);
+	ANKI_LOGI("Scene update:     %.4f ms", m_timings.m_sceneUpdate * toMs);
+	ANKI_LOGI("Physics update:   %.4f ms", m_timings.m_physics * toMs);
+	ANKI_LOGI("Visibility tests: %.4f ms", m_timings.m_visibilityTests * toMs);
+	ANKI_LOGI("Render:           %.4f ms", m_timings.m_render * toMs);
+	ANKI_LOGI("Light binning:    %.4f ms", m_timings.m_lightBin * toMs);
+}
+
+int main(int argc, char* argv[])
+{
+	Error err = Error::NONE;
+
+	BenchApp* app = new BenchApp;
+	err = app->init(argc, argv);
+	if(!err)
+	{
+		err = app->mainLoop();
+	}
+
+	if(!err)
+	{
+		app->printResults();
+	}
+	else
+	{
+		ANKI_LOGE("Error reported. Bye!");
+	}
+
+	delete app;
+	return (err) ? 1 : 0;
+}
@@ -23,6 +23,7 @@
 #include <anki/scene/TriggerNode.h>
 #include <anki/scene/FogDensityNode.h>
 #include <anki/scene/GlobalIlluminationProbeNode.h>
+#include <anki/scene/SceneBinaryLoader.h>
 
 #include <anki/scene/components/MoveComponent.h>
 #include <anki/scene/components/RenderComponent.h>
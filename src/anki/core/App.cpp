@@ -39,7 +39,11 @@ ANKI_REGISTER_CONFIG_OPTION(height, 768, 16, 16 * 1024, "Height")
 ANKI_REGISTER_CONFIG_OPTION(core_mainThreadCount, max(2u, getCpuCoresCount() / 2u), 2u, 1024u)
 ANKI_REGISTER_CONFIG_OPTION(core_displayStats, 0, 0, 1)
 ANKI_REGISTER_CONFIG_OPTION(core_clearCaches, 0, 0, 1)
+ANKI_REGISTER_CONFIG_OPTION(
+	core_asyncLogging, 0, 0, 1, "Pass the log messages to the handlers from a background thread. May drop messages")
 ANKI_REGISTER_CONFIG_OPTION(window_fullscreen, 0, 0, 1)
+ANKI_REGISTER_CONFIG_OPTION(
+	physics_multithreaded, 0, 0, 1, "Solve the physics in the ThreadHive. Needs ANKI_PHYSICS_MULTITHREADED")
 
 #if ANKI_OS_ANDROID
 /// The one and only android hack
@@ -92,6 +96,14 @@ public:
 	U64 m_vkCpuMem = 0;
 	U64 m_vkGpuMem = 0;
 	U32 m_vkCmdbCount = 0;
+	U32 m_queueSubmitCount = 0;
+	U32 m_submittedCmdbCount = 0;
+	U32 m_dsCacheHits = 0;
+	U32 m_dsCacheMisses = 0;
+	U32 m_dsAllocations = 0;
+
+	PtrSize m_rtMem = 0;
+	PtrSize m_rtMemWithoutAliasing = 0;
 
 	PtrSize m_drawableCount = 0;
 
@@ -144,10 +156,17 @@ public:
 			labelUint(m_freeCount, "Total frees");
 			labelBytes(m_vkCpuMem, "Vulkan CPU");
 			labelBytes(m_vkGpuMem, "Vulkan GPU");
+			labelBytes(m_rtMem, "Render targets");
+			labelBytes(m_rtMemWithoutAliasing, "RTs w/o aliasing");
 
 			ImGui::Text("----");
 			ImGui::Text("Vulkan:");
 			labelUint(m_vkCmdbCount, "Cmd buffers");
+			labelUint(m_queueSubmitCount, "Queue submits");
+			labelUint(m_submittedCmdbCount, "Submitted cmd buffers");
+			labelUint(m_dsCacheHits, "DS cache hits");
+			labelUint(m_dsCacheMisses, "DS cache misses");
+			labelUint(m_dsAllocations, "DS allocations");
 
 			ImGui::Text("----");
 			ImGui::Text("Other:");
@@ -297,6 +316,8 @@ void App::cleanup()
 
 	m_settingsDir.destroy(m_heapAlloc);
 	m_cacheDir.destroy(m_heapAlloc);
+
+	LoggerSingleton::get().stopAsync();
 }
 
 Error App::init(const ConfigSet& config, AllocAlignedCallback allocCb, void* allocCbUserData)
@@ -316,6 +337,11 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	ConfigSet config = config_;
 	m_displayStats = config.getNumberU32("core_displayStats");
 
+	if(config.getNumberU32("core_asyncLogging"))
+	{
+		LoggerSingleton::get().startAsync();
+	}
+
 	initMemoryCallbacks(allocCb, allocCbUserData);
 	m_heapAlloc = HeapAllocator<U8>(m_allocCb, m_allocCbData);
 
@@ -420,7 +446,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	m_physics = m_heapAlloc.newInstance<PhysicsWorld>();
 
-	ANKI_CHECK(m_physics->create(m_allocCb, m_allocCbData));
+	ANKI_CHECK(m_physics->create(
+		m_allocCb, m_allocCbData, (config.getBool("physics_multithreaded")) ? m_threadHive : nullptr));
 
 	//
 	// Resource FS
@@ -572,7 +599,8 @@ Error App::mainLoop()
 			// Update
 			ANKI_CHECK(m_input->handleEvents());
 
-			// User update
+			// User update. It might touch the physics objects so wait for the physics step of the previous frame
+			ANKI_CHECK(m_scene->syncPhysics());
 			ANKI_CHECK(userMainLoop(quit));
 
 			ANKI_CHECK(m_scene->update(prevUpdateTime, crntTime));
@@ -635,6 +663,14 @@ Error App::mainLoop()
 				statsUi.m_vkCpuMem = grStats.m_cpuMemory;
 				statsUi.m_vkGpuMem = grStats.m_gpuMemory;
 				statsUi.m_vkCmdbCount = grStats.m_commandBufferCount;
+				statsUi.m_queueSubmitCount = grStats.m_queueSubmitCount;
+				statsUi.m_submittedCmdbCount = grStats.m_submittedCommandBufferCount;
+				statsUi.m_dsCacheHits = grStats.m_descriptorSetCacheHits;
+				statsUi.m_dsCacheMisses = grStats.m_descriptorSetCacheMisses;
+				statsUi.m_dsAllocations = grStats.m_descriptorSetAllocations;
+
+				statsUi.m_rtMem = m_renderer->getStats().m_renderTargetMemory;
+				statsUi.m_rtMemWithoutAliasing = m_renderer->getStats().m_renderTargetMemoryWithoutAliasing;
 
 				statsUi.m_drawableCount = rqueue.countAllRenderables();
 			}
@@ -19,6 +19,11 @@ Error NativeWindow::init(NativeWindowInitInfo& init, HeapAllocator<U8>& alloc)
 	m_alloc = alloc;
 	m_impl = m_alloc.newInstance<NativeWindowImpl>();
 
+#if ANKI_GR_BACKEND_NULL
+	// Nothing will be presented so don't require a display. Don't overwrite the user's choice
+	SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+#endif
+
 	if(SDL_Init(INIT_SUBSYSTEMS) != 0)
 	{
 		ANKI_CORE_LOGE("SDL_Init() failed");
@@ -60,6 +65,8 @@ Error NativeWindow::init(NativeWindowInitInfo& init, HeapAllocator<U8>& alloc)
 	flags |= SDL_WINDOW_OPENGL;
 #elif ANKI_GR_BACKEND_VULKAN
 	flags |= SDL_WINDOW_VULKAN;
+#elif ANKI_GR_BACKEND_NULL
+	flags |= SDL_WINDOW_HIDDEN;
 #endif
 
 	if(init.m_fullscreenDesktopRez)
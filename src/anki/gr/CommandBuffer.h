@@ -101,6 +101,11 @@ enum class CommandBufferFlag : U8
 
 	/// Will contain compute work.
 	COMPUTE_WORK = 1 << 6,
+
+	/// Will be submitted to a dedicated transfer queue if the GPU has one. It can only contain copies, fills and
+	/// barriers. Textures should start from TextureUsageBit::NONE or a transfer usage. Textures created with an initial
+	/// usage and buffers that come from non-transfer usages make the transfer queue wait for the graphics queue.
+	TRANSFER_QUEUE = 1 << 7,
 };
 ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(CommandBufferFlag, inline)
 
@@ -39,6 +39,13 @@ public:
 	PtrSize m_cpuMemory = 0;
 	PtrSize m_gpuMemory = 0;
 	U32 m_commandBufferCount = 0;
+	U32 m_queueSubmitCount = 0; ///< The queue submissions of the previous frame.
+	U32 m_submittedCommandBufferCount = 0; ///< The command buffers submitted in the previous frame.
+	U32 m_descriptorSetCacheHits = 0; ///< The descriptor sets that were reused in the previous frame.
+	U32 m_descriptorSetCacheMisses = 0; ///< The descriptor sets that were written in the previous frame.
+	U32 m_descriptorSetAllocations = 0; ///< The descriptor sets that were allocated in the previous frame.
+	U32 m_createdPipelineCount = 0; ///< The graphics pipelines created so far.
+	U32 m_prewarmedPipelineCount = 0; ///< The graphics pipelines the pipeline manifest asked to precompile so far.
 };
 
 /// The graphics manager, owner of all graphics objects.
@@ -25,6 +25,36 @@ static inline U32 getTextureSurfOrVolCount(const TexturePtr& tex)
 	return tex->getMipmapCount() * tex->getLayerCount() * (textureTypeIsCube(tex->getTextureType()) ? 6 : 1);
 }
 
+static inline U32 getTextureSurfOrVolCount(const TextureInitInfo& init)
+{
+	return init.m_mipmapCount * init.m_layerCount * (textureTypeIsCube(init.m_type) ? 6 : 1);
+}
+
+/// Estimate the memory of a texture. Ignores alignment and any padding the driver might add.
+static PtrSize computeTextureMemory(const TextureInitInfo& init)
+{
+	const U32 faceCount = textureTypeIsCube(init.m_type) ? 6 : 1;
+
+	PtrSize size = 0;
+	for(U32 mip = 0; mip < init.m_mipmapCount; ++mip)
+	{
+		const U32 width = max(init.m_width >> mip, 1u);
+		const U32 height = max(init.m_height >> mip, 1u);
+
+		if(init.m_type == TextureType::_3D)
+		{
+			const U32 depth = max(init.m_depth >> mip, 1u);
+			size += computeVolumeSize(width, height, depth, init.m_format);
+		}
+		else
+		{
+			size += computeSurfaceSize(width, height, init.m_format) * init.m_layerCount * faceCount;
+		}
+	}
+
+	return size;
+}
+
 /// Contains some extra things for render targets.
 class RenderGraph::RT
 {
@@ -32,6 +62,10 @@ public:
 	DynamicArray<TextureUsageBit> m_surfOrVolUsages;
 	DynamicArray<U16> m_lastBatchThatTransitionedIt;
 	TexturePtr m_texture; ///< Hold a reference.
+	U64 m_cacheHash; ///< The hash of the texture in m_renderTargetCache. Zero for imported RTs.
+	U32 m_aliasedRtIdx = MAX_U32; ///< The RT that used the same texture earlier in the frame.
+	U16 m_firstBatch = MAX_U16; ///< The first batch that uses the RT.
+	U16 m_lastBatch = 0; ///< The last batch that uses the RT.
 	Bool m_imported;
 };
 
@@ -106,6 +140,9 @@ public:
 	void* m_userData;
 
 	DynamicArray<CommandBufferPtr> m_secondLevelCmdbs;
+#if ANKI_ENABLE_TRACE
+	DynamicArray<Second> m_secondLevelCmdbRecordingTimes; ///< To find how balanced the work of the threads is.
+#endif
 	/// Will reuse the m_secondLevelCmdbInitInfo.m_framebuffer to get the framebuffer.
 	CommandBufferInitInfo m_secondLevelCmdbInitInfo;
 	Array<U32, 4> m_fbRenderArea;
@@ -136,6 +173,28 @@ public:
 	CommandBuffer* m_cmdb; ///< Someone else holds the ref already so have a ptr here.
 };
 
+/// The result of a graph compilation that doesn't depend on the actual resources. Can be reused by graphs with the same
+/// structure.
+class RenderGraph::Schedule
+{
+public:
+	DynamicArray<U32> m_passIndices; ///< The passes of all batches.
+	DynamicArray<U32> m_batchFirstPass; ///< Offset to m_passIndices. One per batch plus one.
+	DynamicArray<Barrier> m_barriers; ///< The barriers of all batches.
+	DynamicArray<U32> m_batchFirstBarrier; ///< Offset to m_barriers. One per batch plus one.
+	DynamicArray<TextureUsageBit> m_rtFinalUsages; ///< The m_surfOrVolUsages of all RTs after the last batch.
+	U64 m_lastUsedVersion = 0;
+
+	void destroy(GrAllocator<U8> alloc)
+	{
+		m_passIndices.destroy(alloc);
+		m_batchFirstPass.destroy(alloc);
+		m_barriers.destroy(alloc);
+		m_batchFirstBarrier.destroy(alloc);
+		m_rtFinalUsages.destroy(alloc);
+	}
+};
+
 /// The RenderGraph build context.
 class RenderGraph::BakeContext
 {
@@ -253,6 +312,14 @@ RenderGraph::~RenderGraph()
 	}
 
 	m_importedRenderTargets.destroy(getAllocator());
+
+	for(Schedule* schedule : m_scheduleCache)
+	{
+		schedule->destroy(getAllocator());
+		getAllocator().deleteInstance(schedule);
+	}
+
+	m_scheduleCache.destroy(getAllocator());
 }
 
 RenderGraph* RenderGraph::newInstance(GrManager* manager)
@@ -324,6 +391,9 @@ void RenderGraph::reset()
 	{
 		p.fb().reset(nullptr);
 		p.m_secondLevelCmdbs.destroy(m_ctx->m_alloc);
+#if ANKI_ENABLE_TRACE
+		p.m_secondLevelCmdbRecordingTimes.destroy(m_ctx->m_alloc);
+#endif
 	}
 
 	m_ctx->m_graphicsCmdbs.destroy(m_ctx->m_alloc);
@@ -379,25 +449,18 @@ TexturePtr RenderGraph::getOrCreateRenderTarget(const TextureInitInfo& initInf,
 }
 
 FramebufferPtr RenderGraph::getOrCreateFramebuffer(
-	const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name, Bool& drawsToPresentable)
+	const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name)
 {
 	ANKI_ASSERT(rtHandles);
 	U64 hash = fbDescr.m_hash;
 	ANKI_ASSERT(hash > 0);
 
-	drawsToPresentable = false;
-
 	// Create a hash that includes the render targets
 	Array<U64, MAX_COLOR_ATTACHMENTS + 1> uuids;
 	U count = 0;
 	for(U i = 0; i < fbDescr.m_colorAttachmentCount; ++i)
 	{
 		uuids[count++] = m_ctx->m_rts[rtHandles[i].m_idx].m_texture->getUuid();
-
-		if(!!(m_ctx->m_rts[rtHandles[i].m_idx].m_texture->getTextureUsage() & TextureUsageBit::PRESENT))
-		{
-			drawsToPresentable = true;
-		}
 	}
 
 	if(!!fbDescr.m_depthStencilAttachment.m_aspect)
@@ -613,29 +676,27 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
 
 		const Bool imported = inRt.m_importedTex.isCreated();
+		U32 surfOrVolumeCount;
 		if(imported)
 		{
 			// It's imported
 			outRt.m_texture = inRt.m_importedTex;
+			outRt.m_cacheHash = 0;
+			surfOrVolumeCount = getTextureSurfOrVolCount(outRt.m_texture);
 		}
 		else
 		{
-			// Need to create new
+			// Need to create new. The texture will be given when the lifetime of the RT is known
 
-			// Create a new TextureInitInfo with the derived usage
-			TextureInitInfo initInf = inRt.m_initInfo;
-			initInf.m_usage = inRt.m_usageDerivedByDeps;
-			ANKI_ASSERT(initInf.m_usage != TextureUsageBit::NONE);
+			ANKI_ASSERT(inRt.m_usageDerivedByDeps != TextureUsageBit::NONE);
 
-			// Create the new hash
-			const U64 hash = appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
-
-			// Get or create the texture
-			outRt.m_texture = getOrCreateRenderTarget(initInf, hash);
+			// Create the new hash that includes the derived usage
+			outRt.m_cacheHash =
+				appendHash(&inRt.m_usageDerivedByDeps, sizeof(inRt.m_usageDerivedByDeps), inRt.m_hash);
+			surfOrVolumeCount = getTextureSurfOrVolCount(inRt.m_initInfo);
 		}
 
 		// Init the usage
-		const U32 surfOrVolumeCount = getTextureSurfOrVolCount(outRt.m_texture);
 		outRt.m_surfOrVolUsages.create(alloc, surfOrVolumeCount, TextureUsageBit::NONE);
 		if(imported && inRt.m_importedAndUndefinedUsage)
 		{
@@ -681,7 +742,8 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initRenderPassesAndSetDeps(
+	const RenderGraphDescription& descr, StackAllocator<U8>& alloc, Bool setDeps)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -709,33 +771,24 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 			memcpy(&inf, &inDep.m_texture, sizeof(inf));
 		}
 
-		// Create command buffers and framebuffer
+		// Check if the pass draws to the swapchain. Only imported RTs can be presentable
 		if(inPass.m_type == RenderPassDescriptionBase::Type::GRAPHICS)
 		{
 			const GraphicsRenderPassDescription& graphicsPass =
 				static_cast<const GraphicsRenderPassDescription&>(inPass);
 
-			if(graphicsPass.hasFramebuffer())
+			for(U i = 0; graphicsPass.hasFramebuffer() && i < graphicsPass.m_fbDescr.m_colorAttachmentCount; ++i)
 			{
-				Bool drawsToPresentable;
-				outPass.fb() = getOrCreateFramebuffer(
-					graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0], inPass.m_name.cstr(), drawsToPresentable);
-
-				outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
-				outPass.m_drawsToPresentable = drawsToPresentable;
-			}
-			else
-			{
-				ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
+				const TexturePtr& tex = descr.m_renderTargets[graphicsPass.m_rtHandles[i].m_idx].m_importedTex;
+				if(tex.isCreated() && !!(tex->getTextureUsage() & TextureUsageBit::PRESENT))
+				{
+					outPass.m_drawsToPresentable = true;
+				}
 			}
 		}
-		else
-		{
-			ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
-		}
 
 		// Set dependencies by checking all previous subpasses.
-		U32 prevPassIdx = passIdx;
+		U32 prevPassIdx = (setDeps) ? passIdx : 0;
 		while(prevPassIdx--)
 		{
 			const RenderPassDescriptionBase& prevPass = *descr.m_passes[prevPassIdx];
@@ -775,42 +828,47 @@ void RenderGraph::initBatches()
 			}
 		}
 
-		// Get or create cmdb for the batch.
-		// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
-		// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
-		if(m_ctx->m_graphicsCmdbs.isEmpty() || drawsToPresentable)
+		initBatchCommandBuffer(batch, drawsToPresentable, setTimestamp);
+
+		// Mark batch's passes done
+		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
 		{
-			CommandBufferInitInfo cmdbInit;
-			cmdbInit.m_flags = CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::GRAPHICS_WORK;
-			CommandBufferPtr cmdb = getManager().newCommandBuffer(cmdbInit);
+			m_ctx->m_passIsInBatch.set(passIdx);
+			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+		}
+	}
+}
 
-			m_ctx->m_graphicsCmdbs.emplaceBack(m_ctx->m_alloc, cmdb);
+void RenderGraph::initBatchCommandBuffer(Batch& batch, Bool drawsToPresentable, Bool& setTimestamp)
+{
+	// Get or create cmdb for the batch.
+	// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
+	// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
+	if(m_ctx->m_graphicsCmdbs.isEmpty() || drawsToPresentable)
+	{
+		CommandBufferInitInfo cmdbInit;
+		cmdbInit.m_flags = CommandBufferFlag::COMPUTE_WORK | CommandBufferFlag::GRAPHICS_WORK;
+		CommandBufferPtr cmdb = getManager().newCommandBuffer(cmdbInit);
 
-			batch.m_cmdb = cmdb.get();
+		m_ctx->m_graphicsCmdbs.emplaceBack(m_ctx->m_alloc, cmdb);
 
-			// Maybe write a timestamp
-			if(ANKI_UNLIKELY(setTimestamp))
-			{
-				setTimestamp = false;
-				TimestampQueryPtr query = getManager().newTimestampQuery();
-				cmdb->writeTimestamp(query);
+		batch.m_cmdb = cmdb.get();
 
-				m_statistics.m_nextTimestamp = (m_statistics.m_nextTimestamp + 1) % MAX_TIMESTAMPS_BUFFERED;
-				m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2] = query;
-			}
-		}
-		else
+		// Maybe write a timestamp
+		if(ANKI_UNLIKELY(setTimestamp))
 		{
-			batch.m_cmdb = m_ctx->m_graphicsCmdbs.getBack().get();
-		}
+			setTimestamp = false;
+			TimestampQueryPtr query = getManager().newTimestampQuery();
+			cmdb->writeTimestamp(query);
 
-		// Mark batch's passes done
-		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
-		{
-			m_ctx->m_passIsInBatch.set(passIdx);
-			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+			m_statistics.m_nextTimestamp = (m_statistics.m_nextTimestamp + 1) % MAX_TIMESTAMPS_BUFFERED;
+			m_statistics.m_timestamps[m_statistics.m_nextTimestamp * 2] = query;
 		}
 	}
+	else
+	{
+		batch.m_cmdb = m_ctx->m_graphicsCmdbs.getBack().get();
+	}
 }
 
 void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
@@ -832,6 +890,10 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 
 			if(graphicsPass.hasFramebuffer())
 			{
+				outPass.fb() =
+					getOrCreateFramebuffer(graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0], inPass.m_name.cstr());
+				outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
+
 				// Init the usage bits
 				TextureUsageBit usage;
 				for(U i = 0; i < graphicsPass.m_fbDescr.m_colorAttachmentCount; ++i)
@@ -860,6 +922,9 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 				if(inPass.m_secondLevelCmdbsCount)
 				{
 					outPass.m_secondLevelCmdbs.create(alloc, inPass.m_secondLevelCmdbsCount);
+#if ANKI_ENABLE_TRACE
+					outPass.m_secondLevelCmdbRecordingTimes.create(alloc, inPass.m_secondLevelCmdbsCount, 0.0);
+#endif
 					CommandBufferInitInfo& cmdbInit = outPass.m_secondLevelCmdbInitInfo;
 					cmdbInit.m_flags = CommandBufferFlag::GRAPHICS_WORK | CommandBufferFlag::SECOND_LEVEL;
 					ANKI_ASSERT(cmdbInit.m_framebuffer.isCreated());
@@ -879,6 +944,85 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 	}
 }
 
+void RenderGraph::initRenderTargets(const RenderGraphDescription& descr)
+{
+	BakeContext& ctx = *m_ctx;
+
+	// Compute the lifetimes of the RTs
+	for(U32 passIdx = 0; passIdx < ctx.m_passes.getSize(); ++passIdx)
+	{
+		const U16 batchIdx = U16(ctx.m_passes[passIdx].m_batchIdx);
+		for(const RenderPassDependency& dep : descr.m_passes[passIdx]->m_rtDeps)
+		{
+			RT& rt = ctx.m_rts[dep.m_texture.m_handle.m_idx];
+			rt.m_firstBatch = min(rt.m_firstBatch, batchIdx);
+			rt.m_lastBatch = max(rt.m_lastBatch, batchIdx);
+		}
+	}
+
+	// Visit the non-imported RTs in the order they start living
+	DynamicArrayAuto<U32> rtIndices(ctx.m_alloc);
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		if(!ctx.m_rts[rtIdx].m_imported)
+		{
+			rtIndices.emplaceBack(rtIdx);
+		}
+	}
+
+	std::sort(rtIndices.getBegin(), rtIndices.getEnd(), [&](U32 a, U32 b) {
+		const U16 firstBatchA = ctx.m_rts[a].m_firstBatch;
+		const U16 firstBatchB = ctx.m_rts[b].m_firstBatch;
+		return (firstBatchA != firstBatchB) ? firstBatchA < firstBatchB : a < b;
+	});
+
+	// Give textures. If the last RT that used a compatible texture is done with it re-use the texture
+	DynamicArrayAuto<U32> textureOwners(ctx.m_alloc); ///< The last RT that used each of the frame's textures.
+	PtrSize memory = 0;
+	PtrSize memoryWithoutAliasing = 0;
+	for(U32 rtIdx : rtIndices)
+	{
+		RT& rt = ctx.m_rts[rtIdx];
+		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+
+		TextureInitInfo initInf = inRt.m_initInfo;
+		initInf.m_usage = inRt.m_usageDerivedByDeps;
+		const PtrSize texMemory = computeTextureMemory(initInf);
+		memoryWithoutAliasing += texMemory;
+
+		U32* owner = nullptr;
+		for(U32& ownerRtIdx : textureOwners)
+		{
+			const RT& ownerRt = ctx.m_rts[ownerRtIdx];
+			if(ownerRt.m_cacheHash == rt.m_cacheHash && ownerRt.m_lastBatch < rt.m_firstBatch)
+			{
+				owner = &ownerRtIdx;
+				break;
+			}
+		}
+
+		if(owner)
+		{
+			// Alias
+			rt.m_texture = ctx.m_rts[*owner].m_texture;
+			rt.m_aliasedRtIdx = *owner;
+			*owner = rtIdx;
+		}
+		else
+		{
+			// Get or create a new one
+			rt.m_texture = getOrCreateRenderTarget(initInf, rt.m_cacheHash);
+			textureOwners.emplaceBack(rtIdx);
+			memory += texMemory;
+		}
+
+		ANKI_ASSERT(getTextureSurfOrVolCount(rt.m_texture) == rt.m_surfOrVolUsages.getSize());
+	}
+
+	m_statistics.m_transientRenderTargetMemory = memory;
+	m_statistics.m_transientRenderTargetMemoryWithoutAliasing = memoryWithoutAliasing;
+}
+
 template<typename TFunc>
 void RenderGraph::iterateSurfsOrVolumes(const TexturePtr& tex, const TextureSubresourceInfo& subresource, TFunc func)
 {
@@ -915,7 +1059,13 @@ void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& de
 	iterateSurfsOrVolumes(
 		rt.m_texture, dep.m_texture.m_subresource, [&](U32 surfOrVolIdx, const TextureSurfaceInfo& surf) {
 			TextureUsageBit& crntUsage = rt.m_surfOrVolUsages[surfOrVolIdx];
-			if(crntUsage != depUsage)
+
+			// The 1st time an RT touches a texture that was used by another RT a barrier is needed even if the usage
+			// is the same. The previous RT might still be working on the memory
+			const Bool aliasingBarrier =
+				rt.m_aliasedRtIdx != MAX_U32 && rt.m_lastBatchThatTransitionedIt[surfOrVolIdx] == MAX_U16;
+
+			if(crntUsage != depUsage || aliasingBarrier)
 			{
 				// Check if we can merge barriers
 				if(rt.m_lastBatchThatTransitionedIt[surfOrVolIdx] == batchIdx)
@@ -961,8 +1111,25 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 	// For all batches
 	for(Batch& batch : ctx.m_batches)
 	{
+		const U32 batchIdx = U32(&batch - &ctx.m_batches[0]);
 		BitSet<MAX_RENDER_GRAPH_BUFFERS, U64> buffHasBarrierMask = {false};
 
+		// RTs that start in this batch and re-use the texture of another RT continue from the usage the other RT left
+		// the texture in
+		for(RT& rt : ctx.m_rts)
+		{
+			if(rt.m_aliasedRtIdx != MAX_U32 && rt.m_firstBatch == batchIdx)
+			{
+				const RT& prevRt = ctx.m_rts[rt.m_aliasedRtIdx];
+				ANKI_ASSERT(prevRt.m_lastBatch < batchIdx);
+				ANKI_ASSERT(prevRt.m_surfOrVolUsages.getSize() == rt.m_surfOrVolUsages.getSize());
+				for(U32 surfOrVolIdx = 0; surfOrVolIdx < rt.m_surfOrVolUsages.getSize(); ++surfOrVolIdx)
+				{
+					rt.m_surfOrVolUsages[surfOrVolIdx] = prevRt.m_surfOrVolUsages[surfOrVolIdx];
+				}
+			}
+		}
+
 		// For all passes of that batch
 		for(U32 passIdx : batch.m_passIndices)
 		{
@@ -1059,18 +1226,46 @@ void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllo
 	BakeContext& ctx = *newContext(descr, alloc);
 	m_ctx = &ctx;
 
+	// The renderer submits the same graph almost every frame. Try to re-use the batches and the barriers
+	const U64 scheduleHash = computeScheduleHash(descr, alloc);
+	auto it = m_scheduleCache.find(scheduleHash);
+	if(it != m_scheduleCache.getEnd())
+	{
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_SCHEDULE_CACHE_HITS, 1);
+		++m_statistics.m_scheduleCacheHits;
+
+		// Init the passes but skip the dependencies. They are only needed to create the batches
+		initRenderPassesAndSetDeps(descr, alloc, false);
+
+		applySchedule(**it);
+		(*it)->m_lastUsedVersion = m_version;
+
+		initRenderTargets(descr);
+		initGraphicsPasses(descr, alloc);
+		return;
+	}
+
+	ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_SCHEDULE_CACHE_MISSES, 1);
+	++m_statistics.m_scheduleCacheMisses;
+
 	// Init the passes and find the dependencies between passes
-	initRenderPassesAndSetDeps(descr, alloc);
+	initRenderPassesAndSetDeps(descr, alloc, true);
 
 	// Walk the graph and create pass batches
 	initBatches();
 
+	// Now that the batches are known give textures to the RTs. RTs with disjoint lifetimes will share textures
+	initRenderTargets(descr);
+
 	// Now that we know the batches every pass belongs init the graphics passes
 	initGraphicsPasses(descr, alloc);
 
 	// Create barriers between batches
 	setBatchBarriers(descr);
 
+	// Remember the result for the next frames
+	storeSchedule(scheduleHash);
+
 #if ANKI_DBG_RENDER_GRAPH
 	if(dumpDependencyDotFile(descr, ctx, "./"))
 	{
@@ -1079,6 +1274,199 @@ void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllo
 #endif
 }
 
+U64 RenderGraph::computeScheduleHash(const RenderGraphDescription& descr, StackAllocator<U8>& alloc) const
+{
+	const BakeContext& ctx = *m_ctx;
+
+	// Gather everything in a single array of words and hash once. Avoid hashing structs directly because of padding
+	DynamicArrayAuto<U32> words(alloc);
+
+	words.emplaceBack(descr.m_passes.getSize());
+	for(const RenderPassDescriptionBase* pass : descr.m_passes)
+	{
+		words.emplaceBack(pass->m_rtDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_rtDeps)
+		{
+			const TextureSubresourceInfo& subresource = dep.m_texture.m_subresource;
+			words.emplaceBack(dep.m_texture.m_handle.m_idx);
+			words.emplaceBack(U32(dep.m_texture.m_usage));
+			words.emplaceBack(subresource.m_firstMipmap);
+			words.emplaceBack(subresource.m_mipmapCount);
+			words.emplaceBack(subresource.m_firstLayer);
+			words.emplaceBack(subresource.m_layerCount);
+			words.emplaceBack(U32(subresource.m_firstFace) | (U32(subresource.m_faceCount) << 8u)
+							  | (U32(subresource.m_depthStencilAspect) << 16u));
+		}
+
+		words.emplaceBack(pass->m_buffDeps.getSize());
+		for(const RenderPassDependency& dep : pass->m_buffDeps)
+		{
+			words.emplaceBack(dep.m_buffer.m_handle.m_idx);
+			words.emplaceBack(U32(U64(dep.m_buffer.m_usage)));
+			words.emplaceBack(U32(U64(dep.m_buffer.m_usage) >> 32ull));
+		}
+	}
+
+	// The initial state of the resources. Barriers depend on it
+	words.emplaceBack(ctx.m_rts.getSize());
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		const RT& rt = ctx.m_rts[rtIdx];
+
+		if(rt.m_imported)
+		{
+			// The layout of the surfaces or volumes
+			words.emplaceBack(rt.m_texture->getMipmapCount());
+			words.emplaceBack(rt.m_texture->getLayerCount());
+			words.emplaceBack(textureTypeIsCube(rt.m_texture->getTextureType()));
+
+			for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+			{
+				words.emplaceBack(U32(usage));
+			}
+		}
+		else
+		{
+			// The cache hash covers the layout. It also decides which RTs can share textures and that affects the
+			// barriers
+			words.emplaceBack(U32(rt.m_cacheHash));
+			words.emplaceBack(U32(rt.m_cacheHash >> 32ull));
+		}
+	}
+
+	words.emplaceBack(ctx.m_buffers.getSize());
+	for(const Buffer& buff : ctx.m_buffers)
+	{
+		words.emplaceBack(U32(U64(buff.m_usage)));
+		words.emplaceBack(U32(U64(buff.m_usage) >> 32ull));
+	}
+
+	return computeHash(&words[0], words.getSizeInBytes());
+}
+
+void RenderGraph::storeSchedule(U64 hash)
+{
+	const BakeContext& ctx = *m_ctx;
+	auto alloc = getAllocator();
+
+	Schedule* schedule = alloc.newInstance<Schedule>();
+	schedule->m_lastUsedVersion = m_version;
+
+	const U32 batchCount = ctx.m_batches.getSize();
+	schedule->m_batchFirstPass.create(alloc, batchCount + 1);
+	schedule->m_batchFirstBarrier.create(alloc, batchCount + 1);
+
+	U32 passCount = 0;
+	U32 barrierCount = 0;
+	for(U32 batchIdx = 0; batchIdx < batchCount; ++batchIdx)
+	{
+		schedule->m_batchFirstPass[batchIdx] = passCount;
+		schedule->m_batchFirstBarrier[batchIdx] = barrierCount;
+		passCount += ctx.m_batches[batchIdx].m_passIndices.getSize();
+		barrierCount += ctx.m_batches[batchIdx].m_barriersBefore.getSize();
+	}
+	schedule->m_batchFirstPass[batchCount] = passCount;
+	schedule->m_batchFirstBarrier[batchCount] = barrierCount;
+
+	schedule->m_passIndices.create(alloc, passCount);
+	if(barrierCount)
+	{
+		// Barrier is not default constructible, copy construct from a dummy one
+		schedule->m_barriers.create(alloc, barrierCount, Barrier(0, BufferUsageBit::NONE, BufferUsageBit::NONE));
+	}
+
+	passCount = 0;
+	barrierCount = 0;
+	for(const Batch& batch : ctx.m_batches)
+	{
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			schedule->m_passIndices[passCount++] = passIdx;
+		}
+
+		for(const Barrier& barrier : batch.m_barriersBefore)
+		{
+			schedule->m_barriers[barrierCount++] = barrier;
+		}
+	}
+
+	// Store the final usages
+	U32 usageCount = 0;
+	for(const RT& rt : ctx.m_rts)
+	{
+		usageCount += rt.m_surfOrVolUsages.getSize();
+	}
+
+	schedule->m_rtFinalUsages.create(alloc, usageCount);
+	usageCount = 0;
+	for(const RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			schedule->m_rtFinalUsages[usageCount++] = usage;
+		}
+	}
+
+	m_scheduleCache.emplace(alloc, hash, schedule);
+}
+
+void RenderGraph::applySchedule(const Schedule& schedule)
+{
+	BakeContext& ctx = *m_ctx;
+	const U32 batchCount = schedule.m_batchFirstPass.getSize() - 1;
+	Bool setTimestamp = ctx.m_gatherStatistics;
+
+	ctx.m_batches.create(ctx.m_alloc, batchCount);
+	for(U32 batchIdx = 0; batchIdx < batchCount; ++batchIdx)
+	{
+		Batch& batch = ctx.m_batches[batchIdx];
+
+		// Passes
+		const U32 firstPass = schedule.m_batchFirstPass[batchIdx];
+		const U32 passCount = schedule.m_batchFirstPass[batchIdx + 1] - firstPass;
+		ANKI_ASSERT(passCount > 0);
+		batch.m_passIndices.create(ctx.m_alloc, passCount);
+
+		Bool drawsToPresentable = false;
+		for(U32 i = 0; i < passCount; ++i)
+		{
+			const U32 passIdx = schedule.m_passIndices[firstPass + i];
+			batch.m_passIndices[i] = passIdx;
+
+			ctx.m_passIsInBatch.set(passIdx);
+			ctx.m_passes[passIdx].m_batchIdx = batchIdx;
+
+			// That depends on the presentable texture of the frame so it's not part of the schedule
+			drawsToPresentable = drawsToPresentable || ctx.m_passes[passIdx].m_drawsToPresentable;
+		}
+
+		// Barriers
+		const U32 firstBarrier = schedule.m_batchFirstBarrier[batchIdx];
+		const U32 barrierCount = schedule.m_batchFirstBarrier[batchIdx + 1] - firstBarrier;
+		if(barrierCount)
+		{
+			batch.m_barriersBefore.create(ctx.m_alloc, barrierCount, schedule.m_barriers[firstBarrier]);
+			for(U32 i = 1; i < barrierCount; ++i)
+			{
+				batch.m_barriersBefore[i] = schedule.m_barriers[firstBarrier + i];
+			}
+		}
+
+		initBatchCommandBuffer(batch, drawsToPresentable, setTimestamp);
+	}
+
+	// The final usages of the RTs. The imported ones will be stored at reset()
+	U32 usageCount = 0;
+	for(RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit& usage : rt.m_surfOrVolUsages)
+		{
+			usage = schedule.m_rtFinalUsages[usageCount++];
+		}
+	}
+	ANKI_ASSERT(usageCount == schedule.m_rtFinalUsages.getSize());
+}
+
 TexturePtr RenderGraph::getTexture(RenderTargetHandle handle) const
 {
 	ANKI_ASSERT(m_ctx->m_rts[handle.m_idx].m_texture.isCreated());
@@ -1116,12 +1504,20 @@ void RenderGraph::runSecondLevel(U32 threadIdx)
 
 			ANKI_ASSERT(ctx.m_commandBuffer.isCreated());
 
+#if ANKI_ENABLE_TRACE
+			const Second startTime = HighRezTimer::getCurrentTime();
+#endif
+
 			{
 				ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_CALLBACK);
 				p.m_callback(ctx);
 			}
 
 			ctx.m_commandBuffer->flush();
+
+#if ANKI_ENABLE_TRACE
+			p.m_secondLevelCmdbRecordingTimes[threadIdx] = HighRezTimer::getCurrentTime() - startTime;
+#endif
 		}
 	}
 }
@@ -1136,6 +1532,30 @@ void RenderGraph::run() const
 	ctx.m_currentSecondLevelCommandBufferIndex = 0;
 	ctx.m_secondLevelCommandBufferCount = 0;
 
+#if ANKI_ENABLE_TRACE
+	// The second level command buffers are recorded by now. Find how much time the threads waited for the slowest
+	// thread of each pass
+	Second imbalance = 0.0;
+	for(const Pass& p : m_ctx->m_passes)
+	{
+		const U32 count = p.m_secondLevelCmdbRecordingTimes.getSize();
+		if(count > 1)
+		{
+			Second maxTime = 0.0;
+			Second totalTime = 0.0;
+			for(Second time : p.m_secondLevelCmdbRecordingTimes)
+			{
+				maxTime = max(maxTime, time);
+				totalTime += time;
+			}
+
+			imbalance += maxTime - totalTime / Second(count);
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_2ND_LEVEL_IMBALANCE_US, U64(imbalance * 1000000.0));
+#endif
+
 	for(const Batch& batch : m_ctx->m_batches)
 	{
 		ctx.m_commandBuffer.reset(batch.m_cmdb);
@@ -1279,6 +1699,25 @@ void RenderGraph::periodicCleanup()
 	{
 		ANKI_GR_LOGI("Cleaned %u render targets", rtsCleanedCount);
 	}
+
+	// Remove the schedules that haven't been used for a while
+	Bool schedulesRemoved = true;
+	while(schedulesRemoved)
+	{
+		schedulesRemoved = false;
+		for(auto it = m_scheduleCache.getBegin(); it != m_scheduleCache.getEnd(); ++it)
+		{
+			Schedule* schedule = *it;
+			if(schedule->m_lastUsedVersion + PERIODIC_CLEANUP_EVERY < m_version)
+			{
+				schedule->destroy(getAllocator());
+				getAllocator().deleteInstance(schedule);
+				m_scheduleCache.erase(getAllocator(), it);
+				schedulesRemoved = true;
+				break;
+			}
+		}
+	}
 }
 
 void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
@@ -1304,6 +1743,11 @@ void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
 		statistics.m_gpuTime = -1.0;
 		statistics.m_cpuStartTime = -1.0;
 	}
+
+	statistics.m_transientRenderTargetMemory = m_statistics.m_transientRenderTargetMemory;
+	statistics.m_transientRenderTargetMemoryWithoutAliasing = m_statistics.m_transientRenderTargetMemoryWithoutAliasing;
+	statistics.m_scheduleCacheHits = m_statistics.m_scheduleCacheHits;
+	statistics.m_scheduleCacheMisses = m_statistics.m_scheduleCacheMisses;
 }
 
 #if ANKI_DBG_RENDER_GRAPH
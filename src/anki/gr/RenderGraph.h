@@ -534,6 +534,11 @@ class RenderGraphStatistics
 public:
 	Second m_gpuTime; ///< Time spent in the GPU.
 	Second m_cpuStartTime; ///< Time the work was submited from the CPU (almost)
+	PtrSize m_transientRenderTargetMemory; ///< Estimated memory of the textures that back the non-imported RTs.
+	/// Estimated memory of the non-imported RTs if each of them had its own texture.
+	PtrSize m_transientRenderTargetMemoryWithoutAliasing;
+	U32 m_scheduleCacheHits; ///< How many compiled graphs re-used a cached schedule.
+	U32 m_scheduleCacheMisses; ///< How many compiled graphs had to build a new schedule.
 };
 
 /// Accepts a descriptor of the frame's render passes and sets the dependencies between them.
@@ -603,6 +608,7 @@ private:
 	class RT;
 	class Buffer;
 	class Barrier;
+	class Schedule;
 
 	/// Render targets of the same type+size+format.
 	class RenderTargetCacheEntry
@@ -622,6 +628,7 @@ private:
 	HashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
 	HashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
 	HashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	HashMap<U64, Schedule*> m_scheduleCache; ///< Compiled schedules of previous graphs.
 
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
@@ -633,6 +640,10 @@ private:
 		Array<TimestampQueryPtr, MAX_TIMESTAMPS_BUFFERED * 2> m_timestamps;
 		Array<Second, MAX_TIMESTAMPS_BUFFERED> m_cpuStartTimes;
 		U8 m_nextTimestamp = 0;
+		PtrSize m_transientRenderTargetMemory = 0;
+		PtrSize m_transientRenderTargetMemoryWithoutAliasing = 0;
+		U32 m_scheduleCacheHits = 0;
+		U32 m_scheduleCacheMisses = 0;
 	} m_statistics;
 
 	RenderGraph(GrManager* manager, CString name);
@@ -642,16 +653,32 @@ private:
 	static ANKI_USE_RESULT RenderGraph* newInstance(GrManager* manager);
 
 	BakeContext* newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc, Bool setDeps);
 	void initBatches();
+	void initBatchCommandBuffer(Batch& batch, Bool drawsToPresentable, Bool& setTimestamp);
 	void initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+
+	/// Give textures to the non-imported RTs. RTs whose lifetimes (in batches) don't overlap share the same texture.
+	void initRenderTargets(const RenderGraphDescription& descr);
+
 	void setBatchBarriers(const RenderGraphDescription& descr);
 
+	/// @name Schedule caching
+	/// @{
+
+	/// Hash everything that affects the batches and the barriers. Needs the initial usages of the resources.
+	U64 computeScheduleHash(const RenderGraphDescription& descr, StackAllocator<U8>& alloc) const;
+
+	/// Store the batches, the barriers and the final usages of the current graph.
+	void storeSchedule(U64 hash);
+
+	/// Create the batches and the barriers using a previously compiled schedule.
+	void applySchedule(const Schedule& schedule);
+	/// @}
+
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
-	FramebufferPtr getOrCreateFramebuffer(const FramebufferDescription& fbDescr,
-		const RenderTargetHandle* rtHandles,
-		CString name,
-		Bool& drawsToPresentableTex);
+	FramebufferPtr getOrCreateFramebuffer(
+		const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name);
 
 	/// Every N number of frames clean unused cached items.
 	void periodicCleanup();
@@ -54,72 +54,25 @@ void CommandBuffer::flush(FencePtr* fence)
 void CommandBuffer::bindVertexBuffer(
 	U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		BufferPtr m_buff;
-		U32 m_binding;
-		PtrSize m_offset;
-		PtrSize m_stride;
-		Bool m_instanced;
-
-		Cmd(U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, Bool instanced)
-			: m_buff(buff)
-			, m_binding(binding)
-			, m_offset(offset)
-			, m_stride(stride)
-			, m_instanced(instanced)
-		{
-		}
-
-		Error operator()(GlState& state)
-		{
-			glBindVertexBuffer(m_binding, static_cast<const BufferImpl&>(*m_buff).getGlName(), m_offset, m_stride);
-			glVertexBindingDivisor(m_binding, (m_instanced) ? 1 : 0);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_ASSERT(buff);
 	ANKI_ASSERT(stride > 0);
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	if(self.m_state.bindVertexBuffer(binding, buff, offset, stride, stepRate))
 	{
-		self.pushBackNewCommand<Cmd>(binding, buff, offset, stride, stepRate == VertexStepRate::INSTANCE);
+		GlBindVertexBufferCommand& cmd =
+			self.pushBackPodCommand<GlBindVertexBufferCommand>(GlCommandType::BIND_VERTEX_BUFFER);
+		cmd.m_buff = static_cast<const BufferImpl*>(buff.get());
+		cmd.m_offset = offset;
+		cmd.m_stride = stride;
+		cmd.m_binding = binding;
+		cmd.m_instanced = stepRate == VertexStepRate::INSTANCE;
+		self.pushObjectRef(buff);
 	}
 }
 
 void CommandBuffer::setVertexAttribute(U32 location, U32 buffBinding, Format fmt, PtrSize relativeOffset)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		U32 m_location;
-		U32 m_buffBinding;
-		U8 m_compSize;
-		GLenum m_fmt;
-		Bool m_normalized;
-		PtrSize m_relativeOffset;
-
-		Cmd(U32 location, U32 buffBinding, U8 compSize, GLenum fmt, Bool normalized, PtrSize relativeOffset)
-			: m_location(location)
-			, m_buffBinding(buffBinding)
-			, m_compSize(compSize)
-			, m_fmt(fmt)
-			, m_normalized(normalized)
-			, m_relativeOffset(relativeOffset)
-		{
-		}
-
-		Error operator()(GlState& state)
-		{
-			glVertexAttribFormat(m_location, m_compSize, m_fmt, m_normalized, m_relativeOffset);
-			glVertexAttribBinding(m_location, m_buffBinding);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	if(self.m_state.setVertexAttribute(location, buffBinding, fmt, relativeOffset))
@@ -130,35 +83,27 @@ void CommandBuffer::setVertexAttribute(U32 location, U32 buffBinding, Format fmt
 
 		convertVertexFormat(fmt, compCount, type, normalized);
 
-		self.pushBackNewCommand<Cmd>(location, buffBinding, compCount, type, normalized, relativeOffset);
+		GlSetVertexAttributeCommand& cmd =
+			self.pushBackPodCommand<GlSetVertexAttributeCommand>(GlCommandType::SET_VERTEX_ATTRIBUTE);
+		cmd.m_relativeOffset = relativeOffset;
+		cmd.m_location = location;
+		cmd.m_buffBinding = buffBinding;
+		cmd.m_fmt = type;
+		cmd.m_compSize = U8(compCount);
+		cmd.m_normalized = normalized;
 	}
 }
 
 void CommandBuffer::bindIndexBuffer(BufferPtr buff, PtrSize offset, IndexType type)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		BufferPtr m_buff;
-
-		Cmd(BufferPtr buff)
-			: m_buff(buff)
-		{
-		}
-
-		Error operator()(GlState& state)
-		{
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, static_cast<const BufferImpl&>(*m_buff).getGlName());
-			return Error::NONE;
-		}
-	};
-
 	ANKI_ASSERT(buff);
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	if(self.m_state.bindIndexBuffer(buff, offset, type))
 	{
-		self.pushBackNewCommand<Cmd>(buff);
+		self.pushBackPodCommand<GlBindIndexBufferCommand>(GlCommandType::BIND_INDEX_BUFFER).m_buff =
+			static_cast<const BufferImpl*>(buff.get());
+		self.pushObjectRef(buff);
 	}
 }
 
@@ -198,27 +143,11 @@ void CommandBuffer::setPrimitiveRestart(Bool enable)
 
 void CommandBuffer::setViewport(U32 minx, U32 miny, U32 width, U32 height)
 {
-	class ViewportCommand final : public GlCommand
-	{
-	public:
-		Array<U32, 4> m_value;
-
-		ViewportCommand(U32 a, U32 b, U32 c, U32 d)
-		{
-			m_value = {{a, b, c, d}};
-		}
-
-		Error operator()(GlState& state)
-		{
-			glViewport(m_value[0], m_value[1], m_value[2], m_value[3]);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_GL_SELF(CommandBufferImpl);
 	if(self.m_state.setViewport(minx, miny, width, height))
 	{
-		self.pushBackNewCommand<ViewportCommand>(minx, miny, width, height);
+		self.pushBackPodCommand<GlSetViewportCommand>(GlCommandType::SET_VIEWPORT).m_value = {
+			{minx, miny, width, height}};
 	}
 }
 
@@ -616,108 +545,55 @@ void CommandBuffer::setBlendOperation(U32 attachment, BlendOperation funcRgb, Bl
 void CommandBuffer::bindTextureAndSampler(
 	U32 set, U32 binding, TextureViewPtr texView, SamplerPtr sampler, TextureUsageBit usage)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		U32 m_unit;
-		TextureViewPtr m_texView;
-		SamplerPtr m_sampler;
-
-		Cmd(U32 unit, TextureViewPtr texView, SamplerPtr sampler)
-			: m_unit(unit)
-			, m_texView(texView)
-			, m_sampler(sampler)
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			glBindTextureUnit(m_unit, static_cast<const TextureViewImpl&>(*m_texView).m_view.m_glName);
-			glBindSampler(m_unit, static_cast<const SamplerImpl&>(*m_sampler).getGlName());
-			return Error::NONE;
-		}
-	};
-
 	ANKI_GL_SELF(CommandBufferImpl);
 	ANKI_ASSERT(static_cast<const TextureViewImpl&>(*texView).m_tex->isSubresourceGoodForSampling(
 		static_cast<const TextureViewImpl&>(*texView).getSubresource()));
 
 	if(self.m_state.bindTextureViewAndSampler(set, binding, texView, sampler))
 	{
-		U unit = binding + MAX_TEXTURE_BINDINGS * set;
-		self.pushBackNewCommand<Cmd>(unit, texView, sampler);
+		GlBindTextureAndSamplerCommand& cmd =
+			self.pushBackPodCommand<GlBindTextureAndSamplerCommand>(GlCommandType::BIND_TEXTURE_AND_SAMPLER);
+		cmd.m_texView = static_cast<const TextureViewImpl*>(texView.get());
+		cmd.m_sampler = static_cast<const SamplerImpl*>(sampler.get());
+		cmd.m_unit = binding + MAX_TEXTURE_BINDINGS * set;
+		self.pushObjectRef(texView);
+		self.pushObjectRef(sampler);
 	}
 }
 
 void CommandBuffer::bindUniformBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		BufferPtr m_buff;
-		PtrSize m_binding;
-		PtrSize m_offset;
-		PtrSize m_range;
-
-		Cmd(U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
-			: m_buff(buff)
-			, m_binding(binding)
-			, m_offset(offset)
-			, m_range(range)
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			static_cast<const BufferImpl&>(*m_buff).bind(GL_UNIFORM_BUFFER, m_binding, m_offset, m_range);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_ASSERT(buff);
 	ANKI_ASSERT(range > 0);
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	if(self.m_state.bindUniformBuffer(set, binding, buff, offset, range))
 	{
-		binding = binding + MAX_UNIFORM_BUFFER_BINDINGS * set;
-		self.pushBackNewCommand<Cmd>(binding, buff, offset, range);
+		GlBindBufferRangeCommand& cmd =
+			self.pushBackPodCommand<GlBindBufferRangeCommand>(GlCommandType::BIND_UNIFORM_BUFFER);
+		cmd.m_buff = static_cast<const BufferImpl*>(buff.get());
+		cmd.m_offset = offset;
+		cmd.m_range = range;
+		cmd.m_binding = binding + MAX_UNIFORM_BUFFER_BINDINGS * set;
+		self.pushObjectRef(buff);
 	}
 }
 
 void CommandBuffer::bindStorageBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		BufferPtr m_buff;
-		PtrSize m_binding;
-		PtrSize m_offset;
-		PtrSize m_range;
-
-		Cmd(U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
-			: m_buff(buff)
-			, m_binding(binding)
-			, m_offset(offset)
-			, m_range(range)
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			static_cast<const BufferImpl&>(*m_buff).bind(GL_SHADER_STORAGE_BUFFER, m_binding, m_offset, m_range);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_ASSERT(buff);
 	ANKI_ASSERT(range > 0);
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	if(self.m_state.bindStorageBuffer(set, binding, buff, offset, range))
 	{
-		binding = binding + MAX_STORAGE_BUFFER_BINDINGS * set;
-		self.pushBackNewCommand<Cmd>(binding, buff, offset, range);
+		GlBindBufferRangeCommand& cmd =
+			self.pushBackPodCommand<GlBindBufferRangeCommand>(GlCommandType::BIND_STORAGE_BUFFER);
+		cmd.m_buff = static_cast<const BufferImpl*>(buff.get());
+		cmd.m_offset = offset;
+		cmd.m_range = range;
+		cmd.m_binding = binding + MAX_STORAGE_BUFFER_BINDINGS * set;
+		self.pushObjectRef(buff);
 	}
 }
 
@@ -812,30 +688,14 @@ void CommandBuffer::bindTextureBuffer(U32 set, U32 binding, BufferPtr buff, PtrS
 
 void CommandBuffer::bindShaderProgram(ShaderProgramPtr prog)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		ShaderProgramPtr m_prog;
-
-		Cmd(const ShaderProgramPtr& prog)
-			: m_prog(prog)
-		{
-		}
-
-		Error operator()(GlState& state)
-		{
-			state.m_crntProg = m_prog;
-			glUseProgram(static_cast<const ShaderProgramImpl&>(*m_prog).getGlName());
-			return Error::NONE;
-		}
-	};
-
 	ANKI_ASSERT(prog);
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	if(self.m_state.bindShaderProgram(prog))
 	{
-		self.pushBackNewCommand<Cmd>(prog);
+		self.pushBackPodCommand<GlBindShaderProgramCommand>(GlCommandType::BIND_SHADER_PROGRAM).m_prog =
+			static_cast<ShaderProgramImpl*>(prog.get());
+		self.pushObjectRef(prog);
 	}
 	else
 	{
@@ -906,36 +766,6 @@ void CommandBuffer::endRenderPass()
 void CommandBuffer::drawElements(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		GLenum m_topology;
-		GLenum m_indexType;
-		DrawElementsIndirectInfo m_info;
-
-		Cmd(GLenum topology, GLenum indexType, const DrawElementsIndirectInfo& info)
-			: m_topology(topology)
-			, m_indexType(indexType)
-			, m_info(info)
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			glDrawElementsInstancedBaseVertexBaseInstance(m_topology,
-				m_info.m_count,
-				m_indexType,
-				numberToPtr<void*>(m_info.m_firstIndex),
-				m_info.m_instanceCount,
-				m_info.m_baseVertex,
-				m_info.m_baseInstance);
-
-			ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
-			ANKI_TRACE_INC_COUNTER(GR_VERTICES, m_info.m_instanceCount * m_info.m_count);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	self.m_state.checkIndexedDracall();
@@ -954,42 +784,22 @@ void CommandBuffer::drawElements(
 
 	firstIndex = firstIndex * idxBytes + self.m_state.m_idx.m_offset;
 
-	DrawElementsIndirectInfo info(count, instanceCount, firstIndex, baseVertex, baseInstance);
-	self.pushBackNewCommand<Cmd>(convertPrimitiveTopology(topology), self.m_state.m_idx.m_indexType, info);
+	GlDrawElementsCommand& cmd = self.pushBackPodCommand<GlDrawElementsCommand>(GlCommandType::DRAW_ELEMENTS);
+	cmd.m_info = DrawElementsIndirectInfo(count, instanceCount, firstIndex, baseVertex, baseInstance);
+	cmd.m_topology = convertPrimitiveTopology(topology);
+	cmd.m_indexType = self.m_state.m_idx.m_indexType;
 }
 
 void CommandBuffer::drawArrays(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
 {
-	class DrawArraysCommand final : public GlCommand
-	{
-	public:
-		GLenum m_topology;
-		DrawArraysIndirectInfo m_info;
-
-		DrawArraysCommand(GLenum topology, const DrawArraysIndirectInfo& info)
-			: m_topology(topology)
-			, m_info(info)
-		{
-		}
-
-		Error operator()(GlState& state)
-		{
-			glDrawArraysInstancedBaseInstance(
-				m_topology, m_info.m_first, m_info.m_count, m_info.m_instanceCount, m_info.m_baseInstance);
-
-			ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
-			ANKI_TRACE_INC_COUNTER(GR_VERTICES, m_info.m_instanceCount * m_info.m_count);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	self.m_state.checkNonIndexedDrawcall();
 	self.flushDrawcall(*this);
 
-	DrawArraysIndirectInfo info(count, instanceCount, first, baseInstance);
-	self.pushBackNewCommand<DrawArraysCommand>(convertPrimitiveTopology(topology), info);
+	GlDrawArraysCommand& cmd = self.pushBackPodCommand<GlDrawArraysCommand>(GlCommandType::DRAW_ARRAYS);
+	cmd.m_info = DrawArraysIndirectInfo(count, instanceCount, first, baseInstance);
+	cmd.m_topology = convertPrimitiveTopology(topology);
 }
 
 void CommandBuffer::drawElementsIndirect(
@@ -1085,28 +895,12 @@ void CommandBuffer::drawArraysIndirect(
 
 void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
 {
-	class DispatchCommand final : public GlCommand
-	{
-	public:
-		Array<U32, 3> m_size;
-
-		DispatchCommand(U32 x, U32 y, U32 z)
-			: m_size({{x, y, z}})
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			glDispatchCompute(m_size[0], m_size[1], m_size[2]);
-			return Error::NONE;
-		}
-	};
-
 	ANKI_GL_SELF(CommandBufferImpl);
 
 	ANKI_ASSERT(!!(self.m_flags & CommandBufferFlag::COMPUTE_WORK));
 	self.m_state.checkDispatch();
-	self.pushBackNewCommand<DispatchCommand>(groupCountX, groupCountY, groupCountZ);
+	self.pushBackPodCommand<GlDispatchComputeCommand>(GlCommandType::DISPATCH_COMPUTE).m_size = {
+		{groupCountX, groupCountY, groupCountZ}};
 }
 
 void CommandBuffer::resetOcclusionQuery(OcclusionQueryPtr query)
@@ -1306,23 +1100,6 @@ void CommandBuffer::blitTextureViews(TextureViewPtr srcView, TextureViewPtr dest
 void CommandBuffer::setBufferBarrier(
 	BufferPtr buff, BufferUsageBit prevUsage, BufferUsageBit nextUsage, PtrSize offset, PtrSize size)
 {
-	class SetBufferMemBarrierCommand final : public GlCommand
-	{
-	public:
-		GLenum m_barrier;
-
-		SetBufferMemBarrierCommand(GLenum barrier)
-			: m_barrier(barrier)
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			glMemoryBarrier(m_barrier);
-			return Error::NONE;
-		}
-	};
-
 	GLenum d = GL_NONE;
 	BufferUsageBit all = prevUsage | nextUsage;
 
@@ -1364,7 +1141,7 @@ void CommandBuffer::setBufferBarrier(
 
 	ANKI_ASSERT(d);
 	ANKI_GL_SELF(CommandBufferImpl);
-	self.pushBackNewCommand<SetBufferMemBarrierCommand>(d);
+	self.pushBackPodCommand<GlMemoryBarrierCommand>(GlCommandType::MEMORY_BARRIER).m_barrier = d;
 }
 
 void CommandBuffer::setTextureSurfaceBarrier(
@@ -1384,23 +1161,6 @@ void CommandBuffer::setTextureVolumeBarrier(
 void CommandBuffer::setTextureBarrier(
 	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureSubresourceInfo& subresource)
 {
-	class Cmd final : public GlCommand
-	{
-	public:
-		GLenum m_barrier;
-
-		Cmd(GLenum barrier)
-			: m_barrier(barrier)
-		{
-		}
-
-		Error operator()(GlState&)
-		{
-			glMemoryBarrier(m_barrier);
-			return Error::NONE;
-		}
-	};
-
 	const TextureUsageBit usage = nextUsage;
 	GLenum e = 0;
 
@@ -1438,7 +1198,7 @@ void CommandBuffer::setTextureBarrier(
 	if(e != 0)
 	{
 		ANKI_GL_SELF(CommandBufferImpl);
-		self.pushBackNewCommand<Cmd>(e);
+		self.pushBackPodCommand<GlMemoryBarrierCommand>(GlCommandType::MEMORY_BARRIER).m_barrier = e;
 	}
 }
 
@@ -13,6 +13,9 @@
 #include <anki/gr/gl/OcclusionQueryImpl.h>
 #include <anki/gr/Buffer.h>
 #include <anki/gr/gl/BufferImpl.h>
+#include <anki/gr/gl/TextureViewImpl.h>
+#include <anki/gr/gl/SamplerImpl.h>
+#include <anki/gr/gl/ShaderProgramImpl.h>
 
 #include <anki/util/Logger.h>
 #include <anki/core/Trace.h>
@@ -46,30 +49,82 @@ void CommandBufferImpl::destroy()
 	ANKI_TRACE_SCOPED_EVENT(GL_CMD_BUFFER_DESTROY);
 
 #if ANKI_EXTRA_CHECKS
-	if(!m_executed && m_firstCommand)
+	if(!m_executed && m_firstChunk)
 	{
 		ANKI_GL_LOGW("Chain contains commands but never executed. This should only happen on exceptions");
 	}
 #endif
 
-	GlCommand* command = m_firstCommand;
-	while(command != nullptr)
+	// Only the generic records own something
+	GlCommandChunk* chunk = m_firstChunk;
+	while(chunk != nullptr)
 	{
-		GlCommand* next = command->m_nextCommand; // Get next before deleting
-		m_alloc.deleteInstance(command);
-		command = next;
+		const U8* it = chunk->getData();
+		const U8* const end = it + chunk->m_size;
+		while(it < end)
+		{
+			const GlCommandHeader& header = *reinterpret_cast<const GlCommandHeader*>(it);
+			if(header.m_type == GlCommandType::GENERIC)
+			{
+				const GlGenericCommand& cmd = *reinterpret_cast<const GlGenericCommand*>(it + sizeof(GlCommandHeader));
+				m_alloc.deleteInstance(cmd.m_command);
+			}
+
+			it += header.m_size;
+		}
+
+		GlCommandChunk* next = chunk->m_next; // Get next before deleting
+		m_alloc.deallocate(chunk, 1);
+		chunk = next;
 	}
 
+	m_firstChunk = m_lastChunk = nullptr;
+	m_objectRefs.destroy(m_alloc);
+
 	ANKI_ASSERT(m_alloc.getMemoryPool().getUsersCount() == 1
 				&& "Someone is holding a reference to the command buffer's allocator");
 
 	m_alloc = CommandBufferAllocator<U8>();
 }
 
+void* CommandBufferImpl::allocateCommand(GlCommandType type, PtrSize size)
+{
+	ANKI_ASSERT(!m_immutable);
+
+	const U32 recordSize = U32(getAlignedRoundUp(COMMAND_ALIGNMENT, sizeof(GlCommandHeader) + size));
+
+	if(ANKI_UNLIKELY(m_lastChunk == nullptr || m_lastChunk->m_size + recordSize > m_lastChunk->m_capacity))
+	{
+		// Records don't straddle chunks so start a new one
+		const U32 capacity = (recordSize > COMMAND_CHUNK_SIZE) ? recordSize : U32(COMMAND_CHUNK_SIZE);
+		void* mem = m_alloc.allocate(sizeof(GlCommandChunk) + capacity, COMMAND_ALIGNMENT);
+		GlCommandChunk* chunk = ::new(mem) GlCommandChunk();
+		chunk->m_capacity = capacity;
+
+		if(m_lastChunk)
+		{
+			m_lastChunk->m_next = chunk;
+		}
+		else
+		{
+			m_firstChunk = chunk;
+		}
+		m_lastChunk = chunk;
+	}
+
+	U8* record = m_lastChunk->getData() + m_lastChunk->m_size;
+	m_lastChunk->m_size += recordSize;
+
+	GlCommandHeader& header = *reinterpret_cast<GlCommandHeader*>(record);
+	header.m_type = type;
+	header.m_size = recordSize;
+
+	return record + sizeof(GlCommandHeader);
+}
+
 Error CommandBufferImpl::executeAllCommands()
 {
-	ANKI_ASSERT(m_firstCommand != nullptr && "Empty command buffer");
-	ANKI_ASSERT(m_lastCommand != nullptr && "Empty command buffer");
+	ANKI_ASSERT(m_firstChunk != nullptr && "Empty command buffer");
 #if ANKI_EXTRA_CHECKS
 	m_executed = true;
 #endif
@@ -77,14 +132,129 @@ Error CommandBufferImpl::executeAllCommands()
 	Error err = Error::NONE;
 	GlState& state = static_cast<GrManagerImpl&>(getManager()).getState();
 
-	GlCommand* command = m_firstCommand;
+	const GlCommandChunk* chunk = m_firstChunk;
+	while(chunk != nullptr && !err)
+	{
+		const U8* it = chunk->getData();
+		const U8* const end = it + chunk->m_size;
+		while(it < end && !err)
+		{
+			const GlCommandHeader& header = *reinterpret_cast<const GlCommandHeader*>(it);
+			err = executeCommand(header.m_type, it + sizeof(GlCommandHeader), state);
+			ANKI_CHECK_GL_ERROR();
+
+			it += header.m_size;
+		}
+
+		chunk = chunk->m_next;
+	}
+
+	return err;
+}
+
+Error CommandBufferImpl::executeCommand(GlCommandType type, const void* cmd, GlState& state)
+{
+	Error err = Error::NONE;
 
-	while(command != nullptr && !err)
+	switch(type)
+	{
+	case GlCommandType::GENERIC:
+	{
+		const GlGenericCommand& c = *static_cast<const GlGenericCommand*>(cmd);
+		err = (*c.m_command)(state);
+		break;
+	}
+	case GlCommandType::BIND_VERTEX_BUFFER:
+	{
+		const GlBindVertexBufferCommand& c = *static_cast<const GlBindVertexBufferCommand*>(cmd);
+		glBindVertexBuffer(c.m_binding, c.m_buff->getGlName(), c.m_offset, c.m_stride);
+		glVertexBindingDivisor(c.m_binding, (c.m_instanced) ? 1 : 0);
+		break;
+	}
+	case GlCommandType::SET_VERTEX_ATTRIBUTE:
+	{
+		const GlSetVertexAttributeCommand& c = *static_cast<const GlSetVertexAttributeCommand*>(cmd);
+		glVertexAttribFormat(c.m_location, c.m_compSize, c.m_fmt, c.m_normalized, c.m_relativeOffset);
+		glVertexAttribBinding(c.m_location, c.m_buffBinding);
+		break;
+	}
+	case GlCommandType::BIND_INDEX_BUFFER:
+	{
+		const GlBindIndexBufferCommand& c = *static_cast<const GlBindIndexBufferCommand*>(cmd);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, c.m_buff->getGlName());
+		break;
+	}
+	case GlCommandType::SET_VIEWPORT:
+	{
+		const GlSetViewportCommand& c = *static_cast<const GlSetViewportCommand*>(cmd);
+		glViewport(c.m_value[0], c.m_value[1], c.m_value[2], c.m_value[3]);
+		break;
+	}
+	case GlCommandType::BIND_TEXTURE_AND_SAMPLER:
 	{
-		err = (*command)(state);
-		ANKI_CHECK_GL_ERROR();
+		const GlBindTextureAndSamplerCommand& c = *static_cast<const GlBindTextureAndSamplerCommand*>(cmd);
+		glBindTextureUnit(c.m_unit, c.m_texView->m_view.m_glName);
+		glBindSampler(c.m_unit, c.m_sampler->getGlName());
+		break;
+	}
+	case GlCommandType::BIND_UNIFORM_BUFFER:
+	{
+		const GlBindBufferRangeCommand& c = *static_cast<const GlBindBufferRangeCommand*>(cmd);
+		c.m_buff->bind(GL_UNIFORM_BUFFER, c.m_binding, c.m_offset, c.m_range);
+		break;
+	}
+	case GlCommandType::BIND_STORAGE_BUFFER:
+	{
+		const GlBindBufferRangeCommand& c = *static_cast<const GlBindBufferRangeCommand*>(cmd);
+		c.m_buff->bind(GL_SHADER_STORAGE_BUFFER, c.m_binding, c.m_offset, c.m_range);
+		break;
+	}
+	case GlCommandType::BIND_SHADER_PROGRAM:
+	{
+		const GlBindShaderProgramCommand& c = *static_cast<const GlBindShaderProgramCommand*>(cmd);
+		state.m_crntProg.reset(c.m_prog);
+		glUseProgram(c.m_prog->getGlName());
+		break;
+	}
+	case GlCommandType::DRAW_ELEMENTS:
+	{
+		const GlDrawElementsCommand& c = *static_cast<const GlDrawElementsCommand*>(cmd);
+		glDrawElementsInstancedBaseVertexBaseInstance(c.m_topology,
+			c.m_info.m_count,
+			c.m_indexType,
+			numberToPtr<void*>(c.m_info.m_firstIndex),
+			c.m_info.m_instanceCount,
+			c.m_info.m_baseVertex,
+			c.m_info.m_baseInstance);
+
+		ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+		ANKI_TRACE_INC_COUNTER(GR_VERTICES, c.m_info.m_instanceCount * c.m_info.m_count);
+		break;
+	}
+	case GlCommandType::DRAW_ARRAYS:
+	{
+		const GlDrawArraysCommand& c = *static_cast<const GlDrawArraysCommand*>(cmd);
+		glDrawArraysInstancedBaseInstance(
+			c.m_topology, c.m_info.m_first, c.m_info.m_count, c.m_info.m_instanceCount, c.m_info.m_baseInstance);
 
-		command = command->m_nextCommand;
+		ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+		ANKI_TRACE_INC_COUNTER(GR_VERTICES, c.m_info.m_instanceCount * c.m_info.m_count);
+		break;
+	}
+	case GlCommandType::DISPATCH_COMPUTE:
+	{
+		const GlDispatchComputeCommand& c = *static_cast<const GlDispatchComputeCommand*>(cmd);
+		glDispatchCompute(c.m_size[0], c.m_size[1], c.m_size[2]);
+		break;
+	}
+	case GlCommandType::MEMORY_BARRIER:
+	{
+		const GlMemoryBarrierCommand& c = *static_cast<const GlMemoryBarrierCommand*>(cmd);
+		glMemoryBarrier(c.m_barrier);
+		break;
+	}
+	default:
+		ANKI_ASSERT(0);
 	}
 
 	return err;
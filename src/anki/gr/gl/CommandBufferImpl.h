@@ -15,6 +15,8 @@ namespace anki
 
 // Forward
 class GlState;
+class TextureViewImpl;
+class ShaderProgramImpl;
 
 /// @addtogroup opengl
 /// @{
@@ -22,12 +24,10 @@ class GlState;
 template<typename T>
 using CommandBufferAllocator = StackAllocator<T>;
 
-/// The base of all GL commands.
+/// The base of all GL commands that can't be encoded as POD records.
 class GlCommand
 {
 public:
-	GlCommand* m_nextCommand = nullptr;
-
 	virtual ~GlCommand()
 	{
 	}
@@ -36,12 +36,157 @@ public:
 	virtual ANKI_USE_RESULT Error operator()(GlState& state) = 0;
 };
 
-/// A number of GL commands organized in a chain
+/// The type of a record in the command stream.
+enum class GlCommandType : U8
+{
+	GENERIC, ///< A GlCommand that will be executed using virtual dispatch.
+	BIND_VERTEX_BUFFER,
+	SET_VERTEX_ATTRIBUTE,
+	BIND_INDEX_BUFFER,
+	SET_VIEWPORT,
+	BIND_TEXTURE_AND_SAMPLER,
+	BIND_UNIFORM_BUFFER,
+	BIND_STORAGE_BUFFER,
+	BIND_SHADER_PROGRAM,
+	DRAW_ELEMENTS,
+	DRAW_ARRAYS,
+	DISPATCH_COMPUTE,
+	MEMORY_BARRIER,
+
+	COUNT
+};
+
+/// The header of every record in the command stream.
+class GlCommandHeader
+{
+public:
+	GlCommandType m_type;
+	U32 m_size; ///< The size of the record including the header.
+};
+
+/// @name Command stream records
+/// The records hold raw pointers. The command buffer holds the references.
+/// @{
+class GlGenericCommand
+{
+public:
+	GlCommand* m_command;
+};
+
+class GlBindVertexBufferCommand
+{
+public:
+	const BufferImpl* m_buff;
+	PtrSize m_offset;
+	PtrSize m_stride;
+	U32 m_binding;
+	Bool m_instanced;
+};
+
+class GlSetVertexAttributeCommand
+{
+public:
+	PtrSize m_relativeOffset;
+	U32 m_location;
+	U32 m_buffBinding;
+	GLenum m_fmt;
+	U8 m_compSize;
+	Bool m_normalized;
+};
+
+class GlBindIndexBufferCommand
+{
+public:
+	const BufferImpl* m_buff;
+};
+
+class GlSetViewportCommand
+{
+public:
+	Array<U32, 4> m_value;
+};
+
+class GlBindTextureAndSamplerCommand
+{
+public:
+	const TextureViewImpl* m_texView;
+	const SamplerImpl* m_sampler;
+	U32 m_unit;
+};
+
+/// Used for uniform and storage buffers.
+class GlBindBufferRangeCommand
+{
+public:
+	const BufferImpl* m_buff;
+	PtrSize m_offset;
+	PtrSize m_range;
+	U32 m_binding;
+};
+
+class GlBindShaderProgramCommand
+{
+public:
+	ShaderProgramImpl* m_prog;
+};
+
+class GlDrawElementsCommand
+{
+public:
+	DrawElementsIndirectInfo m_info;
+	GLenum m_topology;
+	GLenum m_indexType;
+};
+
+class GlDrawArraysCommand
+{
+public:
+	DrawArraysIndirectInfo m_info;
+	GLenum m_topology;
+};
+
+class GlDispatchComputeCommand
+{
+public:
+	Array<U32, 3> m_size;
+};
+
+class GlMemoryBarrierCommand
+{
+public:
+	GLbitfield m_barrier;
+};
+/// @}
+
+/// A chunk of the command stream. The records follow the chunk in memory.
+class GlCommandChunk
+{
+public:
+	GlCommandChunk* m_next = nullptr;
+	U32 m_size = 0; ///< The bytes in use.
+	U32 m_capacity = 0;
+
+	U8* getData()
+	{
+		return reinterpret_cast<U8*>(this + 1);
+	}
+
+	const U8* getData() const
+	{
+		return reinterpret_cast<const U8*>(this + 1);
+	}
+};
+
+/// A number of GL commands encoded in a stream of POD records.
 class CommandBufferImpl final : public CommandBuffer
 {
 public:
-	GlCommand* m_firstCommand = nullptr;
-	GlCommand* m_lastCommand = nullptr;
+	static constexpr U32 COMMAND_ALIGNMENT = 8;
+	static constexpr U32 COMMAND_CHUNK_SIZE = 4_KB;
+
+	GlCommandChunk* m_firstChunk = nullptr;
+	GlCommandChunk* m_lastChunk = nullptr;
+	DynamicArray<IntrusivePtr<GrObject>> m_objectRefs;
 	CommandBufferAllocator<U8> m_alloc;
 	Bool m_immutable = false;
 	CommandBufferFlag m_flags;
@@ -72,10 +217,23 @@ public:
 		return m_alloc;
 	}
 
-	/// Create a new command and add it to the chain.
+	/// Create a new polymorphic command and add a record that points to it in the stream. Use it for the rare commands
+	/// that can't be described by a POD record.
 	template<typename TCommand, typename... TArgs>
 	void pushBackNewCommand(TArgs&&... args);
 
+	/// Add a new POD record to the stream and return it for the caller to fill.
+	template<typename TCommand>
+	TCommand& pushBackPodCommand(GlCommandType type);
+
+	/// Hold a reference to an object that is used by a POD record.
+	template<typename T>
+	void pushObjectRef(T& x)
+	{
+		GrObject* grobj = x.get();
+		m_objectRefs.emplaceBack(m_alloc, IntrusivePtr<GrObject>(grobj));
+	}
+
 	/// Execute all commands
 	ANKI_USE_RESULT Error executeAllCommands();
 
@@ -95,7 +253,7 @@ public:
 
 	Bool isEmpty() const
 	{
-		return m_firstCommand == nullptr;
+		return m_firstChunk == nullptr;
 	}
 
 	Bool isSecondLevel() const
@@ -107,27 +265,27 @@ public:
 
 private:
 	void destroy();
+
+	/// Allocate space for a new record in the stream.
+	void* allocateCommand(GlCommandType type, PtrSize size);
+
+	static ANKI_USE_RESULT Error executeCommand(GlCommandType type, const void* cmd, GlState& state);
 };
 
 template<typename TCommand, typename... TArgs>
 inline void CommandBufferImpl::pushBackNewCommand(TArgs&&... args)
 {
-	ANKI_ASSERT(!m_immutable);
 	TCommand* newCommand = m_alloc.template newInstance<TCommand>(std::forward<TArgs>(args)...);
+	pushBackPodCommand<GlGenericCommand>(GlCommandType::GENERIC).m_command = newCommand;
+}
 
-	if(m_firstCommand != nullptr)
-	{
-		ANKI_ASSERT(m_lastCommand != nullptr);
-		ANKI_ASSERT(m_lastCommand->m_nextCommand == nullptr);
-		m_lastCommand->m_nextCommand = newCommand;
-		m_lastCommand = newCommand;
-	}
-	else
-	{
-		ANKI_ASSERT(m_lastCommand == nullptr);
-		m_firstCommand = newCommand;
-		m_lastCommand = newCommand;
-	}
+template<typename TCommand>
+inline TCommand& CommandBufferImpl::pushBackPodCommand(GlCommandType type)
+{
+	static_assert(std::is_trivially_destructible<TCommand>::value, "Records should be POD");
+	static_assert(alignof(TCommand) <= COMMAND_ALIGNMENT, "Wrong alignment");
+	void* mem = allocateCommand(type, sizeof(TCommand));
+	return *::new(mem) TCommand();
 }
 /// @}
 
@@ -476,30 +476,35 @@ public:
 	{
 	public:
 		BufferImpl* m_buff = nullptr;
-		PtrSize m_offset;
-		PtrSize m_range;
+		PtrSize m_offset = MAX_PTR_SIZE;
+		PtrSize m_range = 0;
+
+		Bool set(BufferPtr buff, PtrSize offset, PtrSize range)
+		{
+			BufferImpl* const buffImpl = static_cast<BufferImpl*>(buff.get());
+			if(m_buff != buffImpl || m_offset != offset || m_range != range)
+			{
+				m_buff = buffImpl;
+				m_offset = offset;
+				m_range = range;
+				return true;
+			}
+			return false;
+		}
 	};
 
 	Array2d<ShaderBufferBinding, MAX_DESCRIPTOR_SETS, MAX_UNIFORM_BUFFER_BINDINGS> m_ubos;
 
 	Bool bindUniformBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
 	{
-		ShaderBufferBinding& b = m_ubos[set][binding];
-		b.m_buff = static_cast<BufferImpl*>(buff.get());
-		b.m_offset = offset;
-		b.m_range = range;
-		return true;
+		return m_ubos[set][binding].set(buff, offset, range);
 	}
 
 	Array2d<ShaderBufferBinding, MAX_DESCRIPTOR_SETS, MAX_STORAGE_BUFFER_BINDINGS> m_ssbos;
 
 	Bool bindStorageBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range)
 	{
-		ShaderBufferBinding& b = m_ssbos[set][binding];
-		b.m_buff = static_cast<BufferImpl*>(buff.get());
-		b.m_offset = offset;
-		b.m_range = range;
-		return true;
+		return m_ssbos[set][binding].set(buff, offset, range);
 	}
 
 	class ImageBinding
@@ -513,8 +518,12 @@ public:
 	Bool bindImage(U32 set, U32 binding, const TextureViewPtr& img)
 	{
 		ImageBinding& b = m_images[set][binding];
-		b.m_texViewUuid = img->getUuid();
-		return true;
+		if(b.m_texViewUuid != img->getUuid())
+		{
+			b.m_texViewUuid = img->getUuid();
+			return true;
+		}
+		return false;
 	}
 
 	ShaderProgramImpl* m_prog = nullptr;
@@ -0,0 +1,61 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/BufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+BufferImpl::~BufferImpl()
+{
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(!m_mapped);
+#endif
+
+	if(m_memory)
+	{
+		getAllocator().getMemoryPool().free(m_memory);
+		static_cast<GrManagerImpl&>(getManager()).updateCpuMemory(-I64(m_size));
+	}
+}
+
+Error BufferImpl::init(const BufferInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	m_size = inf.m_size;
+	m_usage = inf.m_usage;
+	m_access = inf.m_access;
+
+	if(!!m_access)
+	{
+		m_memory = static_cast<U8*>(getAllocator().getMemoryPool().allocate(m_size, 16));
+		if(ANKI_UNLIKELY(m_memory == nullptr))
+		{
+			ANKI_NULL_LOGE("Out of memory");
+			return Error::OUT_OF_MEMORY;
+		}
+
+		static_cast<GrManagerImpl&>(getManager()).updateCpuMemory(I64(m_size));
+	}
+
+	return Error::NONE;
+}
+
+void* BufferImpl::map(PtrSize offset, PtrSize range, BufferMapAccessBit access)
+{
+	ANKI_ASSERT(m_memory && "Buffer is not mappable");
+	ANKI_ASSERT(!!(access & m_access) && (access & m_access) == access);
+	ANKI_ASSERT(isRangeValid(offset, range));
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(!m_mapped);
+	m_mapped = true;
+#endif
+
+	return m_memory + offset;
+}
+
+} // end namespace anki
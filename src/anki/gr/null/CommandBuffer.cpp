@@ -0,0 +1,487 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/CommandBuffer.h>
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/null/FramebufferImpl.h>
+#include <anki/gr/null/TimestampQueryImpl.h>
+#include <anki/gr/null/FenceImpl.h>
+#include <anki/util/HighRezTimer.h>
+
+namespace anki
+{
+
+CommandBuffer* CommandBuffer::newInstance(GrManager* manager, const CommandBufferInitInfo& init)
+{
+	CommandBufferImpl* impl = manager->getAllocator().newInstance<CommandBufferImpl>(manager, init.getName());
+	Error err = impl->init(init);
+	if(err)
+	{
+		manager->getAllocator().deleteInstance(impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void CommandBuffer::flush(FencePtr* fence)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRecording();
+
+	if(!self.isSecondLevel())
+	{
+		static_cast<GrManagerImpl&>(getManager()).flushCommandBuffer(self.getCounters());
+
+		if(fence)
+		{
+			// Nothing runs on a GPU so the fence is signaled from the start
+			fence->reset(getAllocator().newInstance<FenceImpl>(&getManager(), "N/A"));
+		}
+	}
+	else
+	{
+		ANKI_ASSERT(fence == nullptr);
+	}
+}
+
+void CommandBuffer::bindVertexBuffer(
+	U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(binding < MAX_VERTEX_ATTRIBUTES);
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::VERTEX));
+	ANKI_ASSERT(stride > 0 && offset < buff->getSize());
+}
+
+void CommandBuffer::setVertexAttribute(U32 location, U32 buffBinding, Format fmt, PtrSize relativeOffset)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(location < MAX_VERTEX_ATTRIBUTES && buffBinding < MAX_VERTEX_ATTRIBUTES);
+}
+
+void CommandBuffer::bindIndexBuffer(BufferPtr buff, PtrSize offset, IndexType type)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::INDEX));
+	ANKI_ASSERT(offset < buff->getSize());
+}
+
+void CommandBuffer::setPrimitiveRestart(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setViewport(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(width > 0 && height > 0);
+}
+
+void CommandBuffer::setScissor(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(width > 0 && height > 0);
+}
+
+void CommandBuffer::setFillMode(FillMode mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setCullMode(FaceSelectionBit mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setPolygonOffset(F32 factor, F32 units)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setStencilOperations(FaceSelectionBit face,
+	StencilOperation stencilFail,
+	StencilOperation stencilPassDepthFail,
+	StencilOperation stencilPassDepthPass)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setStencilCompareOperation(FaceSelectionBit face, CompareOperation comp)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setStencilCompareMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setStencilWriteMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setStencilReference(FaceSelectionBit face, U32 ref)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setDepthWrite(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setDepthCompareOperation(CompareOperation op)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setAlphaToCoverage(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setColorChannelWriteMask(U32 attachment, ColorBit mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(attachment < MAX_COLOR_ATTACHMENTS);
+}
+
+void CommandBuffer::setBlendFactors(
+	U32 attachment, BlendFactor srcRgb, BlendFactor dstRgb, BlendFactor srcA, BlendFactor dstA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(attachment < MAX_COLOR_ATTACHMENTS);
+}
+
+void CommandBuffer::setBlendOperation(U32 attachment, BlendOperation funcRgb, BlendOperation funcA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(attachment < MAX_COLOR_ATTACHMENTS);
+}
+
+void CommandBuffer::bindTextureAndSampler(
+	U32 set, U32 binding, TextureViewPtr texView, SamplerPtr sampler, TextureUsageBit usage, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sampler.isCreated());
+	self.bindTextureCommon(set, binding, static_cast<const TextureViewImpl&>(*texView), usage);
+}
+
+void CommandBuffer::bindTexture(U32 set, U32 binding, TextureViewPtr texView, TextureUsageBit usage, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindTextureCommon(set, binding, static_cast<const TextureViewImpl&>(*texView), usage);
+}
+
+void CommandBuffer::bindSampler(U32 set, U32 binding, SamplerPtr sampler, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sampler.isCreated());
+	self.bindResourceCommon(set, binding);
+}
+
+void CommandBuffer::bindUniformBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(range == MAX_PTR_SIZE || range <= getManager().getDeviceCapabilities().m_uniformBufferMaxRange);
+	self.bindBufferCommon(
+		set, binding, static_cast<const BufferImpl&>(*buff), offset, range, BufferUsageBit::UNIFORM_ALL);
+}
+
+void CommandBuffer::bindStorageBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(range == MAX_PTR_SIZE || range <= getManager().getDeviceCapabilities().m_storageBufferMaxRange);
+	self.bindBufferCommon(
+		set, binding, static_cast<const BufferImpl&>(*buff), offset, range, BufferUsageBit::STORAGE_ALL);
+}
+
+void CommandBuffer::bindImage(U32 set, U32 binding, TextureViewPtr img, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindResourceCommon(set, binding);
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*img);
+	ANKI_ASSERT(view.getTextureImpl().isSubresourceGoodForImageLoadStore(view.getSubresource()));
+	(void)view;
+}
+
+void CommandBuffer::bindTextureBuffer(
+	U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, Format fmt, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindBufferCommon(
+		set, binding, static_cast<const BufferImpl&>(*buff), offset, range, BufferUsageBit::TEXTURE_ALL);
+}
+
+void CommandBuffer::bindAllBindless(U32 set)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindResourceCommon(set, 0);
+}
+
+U32 CommandBuffer::bindBindlessTexture(TextureViewPtr tex, TextureUsageBit usage)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	return 0;
+}
+
+U32 CommandBuffer::bindBindlessImage(TextureViewPtr img)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	return 0;
+}
+
+void CommandBuffer::bindShaderProgram(ShaderProgramPtr prog)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindShaderProgram(static_cast<const ShaderProgramImpl&>(*prog));
+}
+
+void CommandBuffer::beginRenderPass(FramebufferPtr fb,
+	const Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS>& colorAttachmentUsages,
+	TextureUsageBit depthStencilAttachmentUsage,
+	U32 minx,
+	U32 miny,
+	U32 width,
+	U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	const FramebufferImpl& fbImpl = static_cast<const FramebufferImpl&>(*fb);
+	for(U i = 0; i < fbImpl.getColorAttachmentCount(); ++i)
+	{
+		ANKI_ASSERT(!!(colorAttachmentUsages[i] & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE));
+	}
+	ANKI_ASSERT(!fbImpl.hasDepthStencil()
+				|| !!(depthStencilAttachmentUsage & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE));
+	(void)fbImpl;
+
+	self.beginRenderPass();
+}
+
+void CommandBuffer::endRenderPass()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRenderPass();
+}
+
+void CommandBuffer::drawElements(
+	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawcallCommon();
+	ANKI_ASSERT(count > 0 && instanceCount > 0);
+}
+
+void CommandBuffer::drawArrays(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawcallCommon();
+	ANKI_ASSERT(count > 0 && instanceCount > 0);
+}
+
+void CommandBuffer::drawArraysIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawcallCommon();
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::INDIRECT_GRAPHICS));
+	ANKI_ASSERT(offset + sizeof(DrawArraysIndirectInfo) * drawCount <= buff->getSize());
+}
+
+void CommandBuffer::drawElementsIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawcallCommon();
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::INDIRECT_GRAPHICS));
+	ANKI_ASSERT(offset + sizeof(DrawElementsIndirectInfo) * drawCount <= buff->getSize());
+}
+
+void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.dispatchCommon();
+	ANKI_ASSERT(groupCountX > 0 && groupCountY > 0 && groupCountZ > 0);
+}
+
+void CommandBuffer::generateMipmaps2d(TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	ANKI_ASSERT(view.getTextureImpl().isSubresourceGoodForMipmapGeneration(view.getSubresource()));
+	(void)view;
+}
+
+void CommandBuffer::generateMipmaps3d(TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+}
+
+void CommandBuffer::blitTextureViews(TextureViewPtr srcView, TextureViewPtr destView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+}
+
+void CommandBuffer::clearTextureView(TextureViewPtr texView, const ClearValue& clearValue)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+	ANKI_ASSERT(!!(static_cast<const TextureViewImpl&>(*texView).getTextureImpl().getTextureUsage()
+				   & TextureUsageBit::CLEAR));
+}
+
+void CommandBuffer::copyBufferToTextureView(BufferPtr buff, PtrSize offset, PtrSize range, TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::TEXTURE_UPLOAD_SOURCE));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).isRangeValid(offset, range));
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	ANKI_ASSERT(view.getTextureImpl().isSubresourceGoodForCopyFromBuffer(view.getSubresource()));
+	(void)view;
+}
+
+void CommandBuffer::fillBuffer(BufferPtr buff, PtrSize offset, PtrSize size, U32 value)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::FILL));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).isRangeValid(offset, size));
+}
+
+void CommandBuffer::writeOcclusionQueryResultToBuffer(OcclusionQueryPtr query, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+	ANKI_ASSERT(!!(buff->getBufferUsage() & BufferUsageBit::QUERY_RESULT));
+	ANKI_ASSERT(offset + sizeof(U32) <= buff->getSize());
+}
+
+void CommandBuffer::copyBufferToBuffer(
+	BufferPtr src, PtrSize srcOffset, BufferPtr dst, PtrSize dstOffset, PtrSize range)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.transferCommon();
+	ANKI_ASSERT(!!(src->getBufferUsage() & BufferUsageBit::BUFFER_UPLOAD_SOURCE));
+	ANKI_ASSERT(!!(dst->getBufferUsage() & BufferUsageBit::BUFFER_UPLOAD_DESTINATION));
+	ANKI_ASSERT(range > 0 && srcOffset + range <= src->getSize() && dstOffset + range <= dst->getSize());
+}
+
+void CommandBuffer::setTextureBarrier(
+	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureSubresourceInfo& subresource)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.barrierCommon();
+	ANKI_ASSERT(tex->isSubresourceValid(subresource));
+	ANKI_ASSERT(!!(tex->getTextureUsage() & nextUsage) && "Transitioning to a usage the texture doesn't have");
+}
+
+void CommandBuffer::setTextureSurfaceBarrier(
+	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureSurfaceInfo& surf)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.barrierCommon();
+	ANKI_ASSERT(!!(tex->getTextureUsage() & nextUsage) && "Transitioning to a usage the texture doesn't have");
+}
+
+void CommandBuffer::setTextureVolumeBarrier(
+	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureVolumeInfo& vol)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.barrierCommon();
+	ANKI_ASSERT(tex->getTextureType() == TextureType::_3D);
+}
+
+void CommandBuffer::setBufferBarrier(
+	BufferPtr buff, BufferUsageBit before, BufferUsageBit after, PtrSize offset, PtrSize size)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.barrierCommon();
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).isRangeValid(offset, size));
+}
+
+void CommandBuffer::resetOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::beginOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::endOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::pushSecondLevelCommandBuffer(CommandBufferPtr cmdb)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushSecondLevelCommandBuffer(static_cast<CommandBufferImpl&>(*cmdb));
+}
+
+void CommandBuffer::writeTimestamp(TimestampQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	static_cast<TimestampQueryImpl&>(*query).m_timestamp = HighRezTimer::getCurrentTime();
+}
+
+Bool CommandBuffer::isEmpty() const
+{
+	ANKI_NULL_SELF_CONST(CommandBufferImpl);
+	return self.isEmpty();
+}
+
+void CommandBuffer::setPushConstants(const void* data, U32 dataSize)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+	ANKI_ASSERT(data && dataSize > 0 && (dataSize % 16) == 0);
+	ANKI_ASSERT(dataSize <= getManager().getDeviceCapabilities().m_pushConstantsSize && "Exceeded the limit");
+}
+
+void CommandBuffer::setRasterizationOrder(RasterizationOrder order)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+void CommandBuffer::setLineWidth(F32 width)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.commandCommon();
+}
+
+} // end namespace anki
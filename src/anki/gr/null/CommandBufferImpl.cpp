@@ -0,0 +1,26 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/FramebufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
+{
+	m_flags = init.m_flags;
+
+	if(isSecondLevel())
+	{
+		ANKI_ASSERT(init.m_framebuffer.isCreated() && "Second level command buffers need a framebuffer");
+	}
+
+	static_cast<GrManagerImpl&>(getManager()).newCommandBufferCreated();
+	return Error::NONE;
+}
+
+} // end namespace anki
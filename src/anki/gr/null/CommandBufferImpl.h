@@ -0,0 +1,167 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/CommandBuffer.h>
+#include <anki/gr/null/Common.h>
+#include <anki/gr/null/BufferImpl.h>
+#include <anki/gr/null/TextureViewImpl.h>
+#include <anki/gr/null/ShaderProgramImpl.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Command buffer implementation. It doesn't record anything. It validates the commands against the state of the
+/// command buffer and it counts them.
+class CommandBufferImpl final : public CommandBuffer
+{
+public:
+	CommandBufferImpl(GrManager* manager, CString name)
+		: CommandBuffer(manager, name)
+	{
+	}
+
+	~CommandBufferImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const CommandBufferInitInfo& init);
+
+	Bool isSecondLevel() const
+	{
+		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
+	}
+
+	Bool isEmpty() const
+	{
+		return m_counters.m_commandCount == 0;
+	}
+
+	const NullCommandCounters& getCounters() const
+	{
+		return m_counters;
+	}
+
+	void commandCommon()
+	{
+		ANKI_ASSERT(!m_finalized && "Command buffer is flushed");
+		++m_counters.m_commandCount;
+	}
+
+	void bindShaderProgram(const ShaderProgramImpl& prog)
+	{
+		commandCommon();
+		m_boundProgram = (prog.isCompute()) ? BoundProgram::COMPUTE : BoundProgram::GRAPHICS;
+	}
+
+	void beginRenderPass()
+	{
+		commandCommon();
+		ANKI_ASSERT(!insideRenderPass() && "Already inside a render pass");
+		m_insideRenderPass = true;
+		++m_counters.m_renderPassCount;
+	}
+
+	void endRenderPass()
+	{
+		commandCommon();
+		ANKI_ASSERT(m_insideRenderPass && "Not inside a render pass");
+		m_insideRenderPass = false;
+	}
+
+	void drawcallCommon()
+	{
+		commandCommon();
+		ANKI_ASSERT(insideRenderPass() && "Drawcalls should be inside a render pass");
+		ANKI_ASSERT(m_boundProgram == BoundProgram::GRAPHICS && "Need a graphics program");
+		++m_counters.m_drawcallCount;
+	}
+
+	void dispatchCommon()
+	{
+		commandCommon();
+		ANKI_ASSERT(!insideRenderPass() && "Compute can't run inside a render pass");
+		ANKI_ASSERT(m_boundProgram == BoundProgram::COMPUTE && "Need a compute program");
+		++m_counters.m_dispatchCount;
+	}
+
+	/// Copies, clears, blits and mipmap generation.
+	void transferCommon()
+	{
+		commandCommon();
+		ANKI_ASSERT(!insideRenderPass() && "Transfers can't happen inside a render pass");
+		++m_counters.m_transferCount;
+	}
+
+	void barrierCommon()
+	{
+		commandCommon();
+		ANKI_ASSERT(!insideRenderPass() && "Barriers can't be set inside a render pass");
+		++m_counters.m_barrierCount;
+	}
+
+	void bindResourceCommon(U32 set, U32 binding)
+	{
+		commandCommon();
+		ANKI_ASSERT(set < MAX_DESCRIPTOR_SETS && binding < MAX_BINDINGS_PER_DESCRIPTOR_SET);
+	}
+
+	void bindBufferCommon(
+		U32 set, U32 binding, const BufferImpl& buff, PtrSize offset, PtrSize range, BufferUsageBit usage)
+	{
+		bindResourceCommon(set, binding);
+		ANKI_ASSERT(!!(buff.getBufferUsage() & usage) && "Wrong buffer usage");
+		ANKI_ASSERT(buff.isRangeValid(offset, range));
+	}
+
+	void bindTextureCommon(U32 set, U32 binding, const TextureViewImpl& view, TextureUsageBit usage)
+	{
+		bindResourceCommon(set, binding);
+		ANKI_ASSERT(!!(view.getTextureImpl().getTextureUsage() & usage) && "Wrong texture usage");
+		ANKI_ASSERT(view.getTextureImpl().isSubresourceGoodForSampling(view.getSubresource()));
+	}
+
+	void pushSecondLevelCommandBuffer(CommandBufferImpl& cmdb)
+	{
+		commandCommon();
+		ANKI_ASSERT(m_insideRenderPass && "Second level command buffers should be pushed inside a render pass");
+		ANKI_ASSERT(cmdb.isSecondLevel() && cmdb.m_finalized);
+		m_counters += cmdb.m_counters;
+	}
+
+	void endRecording()
+	{
+		ANKI_ASSERT(!m_finalized && "Flushed twice");
+		ANKI_ASSERT(!m_insideRenderPass && "Forgot to end the render pass");
+		m_finalized = true;
+	}
+
+private:
+	enum class BoundProgram : U8
+	{
+		NONE,
+		GRAPHICS,
+		COMPUTE
+	};
+
+	NullCommandCounters m_counters;
+	CommandBufferFlag m_flags = CommandBufferFlag::NONE;
+	BoundProgram m_boundProgram = BoundProgram::NONE;
+	Bool m_insideRenderPass = false;
+	Bool m_finalized = false;
+
+	/// Second level command buffers are always inside a render pass.
+	Bool insideRenderPass() const
+	{
+		return m_insideRenderPass || isSecondLevel();
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,51 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Common.h>
+
+namespace anki
+{
+
+// Forward
+class GrManagerImpl;
+
+/// @addtogroup null
+/// @{
+
+#define ANKI_NULL_LOGI(...) ANKI_LOG("NULL", NORMAL, __VA_ARGS__)
+#define ANKI_NULL_LOGE(...) ANKI_LOG("NULL", ERROR, __VA_ARGS__)
+#define ANKI_NULL_LOGW(...) ANKI_LOG("NULL", WARNING, __VA_ARGS__)
+#define ANKI_NULL_LOGF(...) ANKI_LOG("NULL", FATAL, __VA_ARGS__)
+
+#define ANKI_NULL_SELF(class_) class_& self = *static_cast<class_*>(this)
+#define ANKI_NULL_SELF_CONST(class_) const class_& self = *static_cast<const class_*>(this)
+
+/// The commands that a command buffer recorded. The null backend doesn't execute anything so that's all it keeps.
+class NullCommandCounters
+{
+public:
+	U64 m_commandCount = 0;
+	U64 m_drawcallCount = 0;
+	U64 m_dispatchCount = 0;
+	U64 m_renderPassCount = 0;
+	U64 m_barrierCount = 0;
+	U64 m_transferCount = 0;
+
+	NullCommandCounters& operator+=(const NullCommandCounters& b)
+	{
+		m_commandCount += b.m_commandCount;
+		m_drawcallCount += b.m_drawcallCount;
+		m_dispatchCount += b.m_dispatchCount;
+		m_renderPassCount += b.m_renderPassCount;
+		m_barrierCount += b.m_barrierCount;
+		m_transferCount += b.m_transferCount;
+		return *this;
+	}
+};
+/// @}
+
+} // end namespace anki
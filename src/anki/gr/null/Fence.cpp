@@ -0,0 +1,24 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/Fence.h>
+#include <anki/gr/null/FenceImpl.h>
+#include <anki/gr/GrManager.h>
+
+namespace anki
+{
+
+Fence* Fence::newInstance(GrManager* manager)
+{
+	return manager->getAllocator().newInstance<FenceImpl>(manager, "N/A");
+}
+
+Bool Fence::clientWait(Second seconds)
+{
+	// Nothing to wait for
+	return true;
+}
+
+} // end namespace anki
@@ -0,0 +1,54 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Framebuffer.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Framebuffer implementation.
+class FramebufferImpl final : public Framebuffer
+{
+public:
+	FramebufferImpl(GrManager* manager, CString name)
+		: Framebuffer(manager, name)
+	{
+	}
+
+	~FramebufferImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const FramebufferInitInfo& init)
+	{
+		ANKI_ASSERT(init.isValid());
+		m_colorAttachmentCount = init.m_colorAttachmentCount;
+		m_hasDepthStencil = init.m_depthStencilAttachment.m_textureView.isCreated();
+		return Error::NONE;
+	}
+
+	U32 getColorAttachmentCount() const
+	{
+		return m_colorAttachmentCount;
+	}
+
+	Bool hasDepthStencil() const
+	{
+		return m_hasDepthStencil;
+	}
+
+private:
+	U32 m_colorAttachmentCount = 0;
+	Bool m_hasDepthStencil = false;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,98 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/Texture.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/core/NativeWindow.h>
+
+namespace anki
+{
+
+// Same options as the other backends so the configs stay interchangeable
+ANKI_REGISTER_CONFIG_OPTION(gr_debugContext, 0, 0, 1)
+ANKI_REGISTER_CONFIG_OPTION(gr_vsync, 0, 0, 1)
+ANKI_REGISTER_CONFIG_OPTION(gr_debugMarkers, 0, 0, 1)
+ANKI_REGISTER_CONFIG_OPTION(gr_diskShaderCacheMaxSize, 128_MB, 1_MB, 1_GB)
+ANKI_REGISTER_CONFIG_OPTION(gr_vkminor, 1, 1, 1)
+ANKI_REGISTER_CONFIG_OPTION(gr_vkmajor, 1, 1, 1)
+
+GrManagerImpl::~GrManagerImpl()
+{
+	for(TexturePtr& tex : m_presentableTextures)
+	{
+		tex.reset(nullptr);
+	}
+
+	ANKI_NULL_LOGI("Frames %" PRIu64 ", commands %" PRIu64 ", drawcalls %" PRIu64 ", dispatches %" PRIu64
+				   ", render passes %" PRIu64 ", barriers %" PRIu64 ", transfers %" PRIu64,
+		m_frame,
+		m_totalCounters.m_commandCount,
+		m_totalCounters.m_drawcallCount,
+		m_totalCounters.m_dispatchCount,
+		m_totalCounters.m_renderPassCount,
+		m_totalCounters.m_barrierCount,
+		m_totalCounters.m_transferCount);
+}
+
+Error GrManagerImpl::init(const GrManagerInitInfo& init)
+{
+	ANKI_NULL_LOGI("Initializing the null graphics backend. Nothing will be rendered");
+
+	// Pretend to be a typical desktop Vulkan implementation
+	m_capabilities.m_uniformBufferBindOffsetAlignment = max<U32>(ANKI_SAFE_ALIGNMENT, 256);
+	m_capabilities.m_uniformBufferMaxRange = 64_KB;
+	m_capabilities.m_storageBufferBindOffsetAlignment = max<U32>(ANKI_SAFE_ALIGNMENT, 256);
+	m_capabilities.m_storageBufferMaxRange = MAX_U32;
+	m_capabilities.m_textureBufferBindOffsetAlignment = max<U32>(ANKI_SAFE_ALIGNMENT, 256);
+	m_capabilities.m_textureBufferMaxRange = MAX_U32;
+	m_capabilities.m_gpuVendor = GpuVendor::UNKNOWN;
+	m_capabilities.m_majorApiVersion = init.m_config->getNumberU8("gr_vkmajor");
+	m_capabilities.m_minorApiVersion = init.m_config->getNumberU8("gr_vkminor");
+
+	// Create the presentable textures
+	for(TexturePtr& tex : m_presentableTextures)
+	{
+		TextureInitInfo texInit("SwapchainImg");
+		texInit.m_width = init.m_window->getWidth();
+		texInit.m_height = init.m_window->getHeight();
+		texInit.m_format = Format::B8G8R8A8_UNORM;
+		texInit.m_usage = TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE
+						  | TextureUsageBit::PRESENT;
+		texInit.m_type = TextureType::_2D;
+
+		tex = newTexture(texInit);
+		if(!tex.isCreated())
+		{
+			return Error::FUNCTION_FAILED;
+		}
+	}
+
+	return Error::NONE;
+}
+
+TexturePtr GrManagerImpl::acquireNextPresentableTexture()
+{
+	return m_presentableTextures[m_frame % MAX_FRAMES_IN_FLIGHT];
+}
+
+void GrManagerImpl::endFrame()
+{
+	LockGuard<SpinLock> lock(m_countersLock);
+	m_totalCounters += m_frameCounters;
+	m_frameCounters = NullCommandCounters();
+	m_prevFrameFlushCount.store(m_frameFlushCount);
+	m_frameFlushCount = 0;
+	++m_frame;
+}
+
+void GrManagerImpl::flushCommandBuffer(const NullCommandCounters& counters)
+{
+	LockGuard<SpinLock> lock(m_countersLock);
+	m_frameCounters += counters;
+	++m_frameFlushCount;
+}
+
+} // end namespace anki
@@ -0,0 +1,85 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/GrManager.h>
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Null implementation of GrManager. It validates the calls and counts the commands without a device. It's used to
+/// measure the CPU cost of the renderer on machines without a GPU.
+class GrManagerImpl final : public GrManager
+{
+public:
+	GrManagerImpl()
+	{
+	}
+
+	~GrManagerImpl();
+
+	ANKI_USE_RESULT Error init(const GrManagerInitInfo& init);
+
+	TexturePtr acquireNextPresentableTexture();
+
+	void endFrame();
+
+	void finish()
+	{
+	}
+
+	/// "Execute" a command buffer.
+	void flushCommandBuffer(const NullCommandCounters& counters);
+
+	/// Track the memory of the mappable buffers.
+	void updateCpuMemory(I64 size)
+	{
+		m_cpuMemory.fetchAdd(PtrSize(size));
+	}
+
+	PtrSize getCpuMemory() const
+	{
+		return m_cpuMemory.load();
+	}
+
+	U32 getCreatedCommandBufferCount() const
+	{
+		return m_cmdbCount.load();
+	}
+
+	void newCommandBufferCreated()
+	{
+		m_cmdbCount.fetchAdd(1);
+	}
+
+	/// Every flushed command buffer counts as a queue submission.
+	U32 getPreviousFrameFlushCount() const
+	{
+		return m_prevFrameFlushCount.load();
+	}
+
+private:
+	Array<TexturePtr, MAX_FRAMES_IN_FLIGHT> m_presentableTextures;
+	U64 m_frame = 0;
+
+	Atomic<PtrSize> m_cpuMemory = {0};
+	Atomic<U32> m_cmdbCount = {0};
+
+	SpinLock m_countersLock;
+	NullCommandCounters m_frameCounters;
+	NullCommandCounters m_totalCounters;
+	U32 m_frameFlushCount = 0;
+	Atomic<U32> m_prevFrameFlushCount = {0};
+};
+/// @}
+
+} // end namespace anki
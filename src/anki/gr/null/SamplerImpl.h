@@ -0,0 +1,32 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Sampler.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Sampler implementation.
+class SamplerImpl final : public Sampler
+{
+public:
+	SamplerImpl(GrManager* manager, CString name)
+		: Sampler(manager, name)
+	{
+	}
+
+	~SamplerImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,47 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/ShaderProgram.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Shader program implementation.
+class ShaderProgramImpl final : public ShaderProgram
+{
+public:
+	ShaderProgramImpl(GrManager* manager, CString name)
+		: ShaderProgram(manager, name)
+	{
+	}
+
+	~ShaderProgramImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const ShaderProgramInitInfo& init)
+	{
+		ANKI_ASSERT(init.isValid());
+		m_compute = init.m_shaders[ShaderType::COMPUTE].isCreated();
+		return Error::NONE;
+	}
+
+	Bool isCompute() const
+	{
+		return m_compute;
+	}
+
+private:
+	Bool m_compute = false;
+};
+/// @}
+
+} // end namespace anki
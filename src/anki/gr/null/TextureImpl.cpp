@@ -0,0 +1,46 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/TextureImpl.h>
+
+namespace anki
+{
+
+Error TextureImpl::init(const TextureInitInfo& init)
+{
+	ANKI_ASSERT(init.isValid());
+
+	m_width = init.m_width;
+	m_height = init.m_height;
+	m_depth = init.m_depth;
+	m_layerCount = init.m_layerCount;
+	m_mipCount = init.m_mipmapCount;
+	m_texType = init.m_type;
+	m_usage = init.m_usage;
+	m_format = init.m_format;
+	m_aspect = computeFormatAspect(m_format);
+
+	return Error::NONE;
+}
+
+TextureType TextureImpl::computeNewTexTypeOfSubresource(const TextureSubresourceInfo& subresource) const
+{
+	ANKI_ASSERT(isSubresourceValid(subresource));
+	if(textureTypeIsCube(m_texType))
+	{
+		if(subresource.m_faceCount != 6)
+		{
+			ANKI_ASSERT(subresource.m_faceCount == 1);
+			return (subresource.m_layerCount > 1) ? TextureType::_2D_ARRAY : TextureType::_2D;
+		}
+		else if(subresource.m_layerCount == 1)
+		{
+			return TextureType::CUBE;
+		}
+	}
+	return m_texType;
+}
+
+} // end namespace anki
@@ -0,0 +1,37 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Texture implementation. It has no memory.
+class TextureImpl final : public Texture
+{
+public:
+	TextureImpl(GrManager* manager, CString name)
+		: Texture(manager, name)
+	{
+	}
+
+	~TextureImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const TextureInitInfo& init);
+
+	/// Compute the type that a view of that subresource will have.
+	TextureType computeNewTexTypeOfSubresource(const TextureSubresourceInfo& subresource) const;
+};
+/// @}
+
+} // end namespace anki
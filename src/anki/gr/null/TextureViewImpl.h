@@ -0,0 +1,49 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/TextureView.h>
+#include <anki/gr/null/TextureImpl.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Texture view implementation.
+class TextureViewImpl final : public TextureView
+{
+public:
+	TextureViewImpl(GrManager* manager, CString name)
+		: TextureView(manager, name)
+	{
+	}
+
+	~TextureViewImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const TextureViewInitInfo& inf)
+	{
+		ANKI_ASSERT(inf.isValid());
+		m_subresource = inf;
+		m_tex = inf.m_texture;
+		m_texType = static_cast<const TextureImpl&>(*m_tex).computeNewTexTypeOfSubresource(inf);
+		return Error::NONE;
+	}
+
+	const TextureImpl& getTextureImpl() const
+	{
+		return static_cast<const TextureImpl&>(*m_tex);
+	}
+
+private:
+	TexturePtr m_tex; ///< Hold a reference.
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,34 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/TimestampQuery.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Timestamp query implementation. It holds the CPU time of the CommandBuffer::writeTimestamp call.
+class TimestampQueryImpl final : public TimestampQuery
+{
+public:
+	Second m_timestamp = -1.0;
+
+	TimestampQueryImpl(GrManager* manager, CString name)
+		: TimestampQuery(manager, name)
+	{
+	}
+
+	~TimestampQueryImpl()
+	{
+	}
+};
+/// @}
+
+} // end namespace anki
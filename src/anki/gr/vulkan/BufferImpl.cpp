@@ -43,10 +43,17 @@ Error BufferImpl::init(const BufferInitInfo& inf)
 	ci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	ci.size = size;
 	ci.usage = convertBufferUsageBit(usage);
-	ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-	ci.queueFamilyIndexCount = 1;
-	U32 queueIdx = getGrManagerImpl().getGraphicsQueueFamily();
-	ci.pQueueFamilyIndices = &queueIdx;
+	// Buffers that the transfer queue can copy to or from are shared with it to avoid the ownership transfers. Buffers
+	// have no layouts or compression so the concurrent sharing costs little. The rest stay exclusive
+	ConstWeakArray<U32> queueFamilies = getGrManagerImpl().getBufferQueueFamilies();
+	if(!(usage & (BufferUsageBit::TRANSFER_ALL & ~BufferUsageBit::QUERY_RESULT)))
+	{
+		queueFamilies = ConstWeakArray<U32>(&queueFamilies[0], 1);
+	}
+	m_sharedWithTransferQueue = queueFamilies.getSize() > 1;
+	ci.sharingMode = (m_sharedWithTransferQueue) ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	ci.queueFamilyIndexCount = U32(queueFamilies.getSize());
+	ci.pQueueFamilyIndices = &queueFamilies[0];
 	ANKI_VK_CHECK(vkCreateBuffer(getDevice(), &ci, nullptr, &m_handle));
 	getGrManagerImpl().trySetVulkanHandleName(inf.getName(), VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, m_handle);
 
@@ -58,6 +58,12 @@ public:
 		return m_actualSize;
 	}
 
+	/// The buffer can be used by the transfer queue without ownership transfers.
+	Bool isSharedWithTransferQueue() const
+	{
+		return m_sharedWithTransferQueue;
+	}
+
 	void computeBarrierInfo(BufferUsageBit before,
 		BufferUsageBit after,
 		VkPipelineStageFlags& srcStages,
@@ -70,6 +76,7 @@ private:
 	GpuMemoryHandle m_memHandle;
 	VkMemoryPropertyFlags m_memoryFlags = 0;
 	PtrSize m_actualSize = 0;
+	Bool m_sharedWithTransferQueue = false;
 
 #if ANKI_EXTRA_CHECKS
 	Bool m_mapped = false;
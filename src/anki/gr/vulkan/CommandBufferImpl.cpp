@@ -32,6 +32,8 @@ CommandBufferImpl::~CommandBufferImpl()
 	m_queryResetAtoms.destroy(m_alloc);
 	m_writeQueryAtoms.destroy(m_alloc);
 	m_secondLevelAtoms.destroy(m_alloc);
+	m_queueAcquireBarriers.destroy(m_alloc);
+	m_queueAcquireTextures.destroy(m_alloc);
 }
 
 Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
@@ -39,7 +41,12 @@ Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
 	m_tid = Thread::getCurrentThreadId();
 	m_flags = init.m_flags;
 
-	ANKI_CHECK(getGrManagerImpl().getCommandBufferFactory().newCommandBuffer(m_tid, m_flags, m_microCmdb));
+	m_onTransferQueue = !!(m_flags & CommandBufferFlag::TRANSFER_QUEUE) && getGrManagerImpl().hasTransferQueue();
+	ANKI_ASSERT(!m_onTransferQueue || !(m_flags & CommandBufferFlag::SECOND_LEVEL));
+
+	CommandBufferFactory& factory = (m_onTransferQueue) ? getGrManagerImpl().getTransferCommandBufferFactory()
+														: getGrManagerImpl().getCommandBufferFactory();
+	ANKI_CHECK(factory.newCommandBuffer(m_tid, m_flags, m_microCmdb));
 	m_handle = m_microCmdb->getHandle();
 
 	m_alloc = m_microCmdb->getFastAllocator();
@@ -247,6 +254,29 @@ void CommandBufferImpl::endRecording()
 #endif
 }
 
+void CommandBufferImpl::recordQueueAcquireBarriers(MicroCommandBuffer& graphicsCmdb) const
+{
+	ANKI_ASSERT(m_onTransferQueue && m_finalized);
+	ANKI_ASSERT(m_queueAcquireBarrierCount > 0);
+
+	vkCmdPipelineBarrier(graphicsCmdb.getHandle(),
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		m_queueAcquireStageMask,
+		0,
+		0,
+		nullptr,
+		0,
+		nullptr,
+		m_queueAcquireBarrierCount,
+		&m_queueAcquireBarriers[0]);
+
+	for(U32 i = 0; i < m_queueAcquireBarrierCount; ++i)
+	{
+		TexturePtr tex = m_queueAcquireTextures[i];
+		graphicsCmdb.pushObjectRef(tex);
+	}
+}
+
 void CommandBufferImpl::generateMipmaps2d(TextureViewPtr texView)
 {
 	commandCommon();
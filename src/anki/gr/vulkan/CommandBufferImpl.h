@@ -83,6 +83,34 @@ public:
 		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
 	}
 
+	/// @name transfer_queue
+	/// @{
+	Bool isOnTransferQueue() const
+	{
+		return m_onTransferQueue;
+	}
+
+	/// The command buffer uses resources that the graphics queue touched before.
+	Bool waitsForGraphicsQueue() const
+	{
+		return m_waitForGraphicsQueue;
+	}
+
+	/// The command buffer hands resources to the graphics queue.
+	Bool signalsGraphicsQueue() const
+	{
+		return m_signalGraphicsQueue;
+	}
+
+	Bool hasQueueAcquireBarriers() const
+	{
+		return m_queueAcquireBarrierCount > 0;
+	}
+
+	/// Record the barriers that acquire the ownership of the textures to a graphics queue command buffer.
+	void recordQueueAcquireBarriers(MicroCommandBuffer& graphicsCmdb) const;
+	/// @}
+
 	void bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
 	{
 		commandCommon();
@@ -440,6 +468,23 @@ private:
 	VkPipelineStageFlags m_dstStageMask = 0;
 	/// @}
 
+	/// @name transfer_queue
+	/// @{
+	Bool m_onTransferQueue = false;
+	Bool m_waitForGraphicsQueue = false;
+	Bool m_signalGraphicsQueue = false;
+
+	/// The graphics queue half of the ownership transfers.
+	DynamicArray<VkImageMemoryBarrier> m_queueAcquireBarriers;
+	DynamicArray<TexturePtr> m_queueAcquireTextures;
+	U16 m_queueAcquireBarrierCount = 0;
+	VkPipelineStageFlags m_queueAcquireStageMask = 0;
+
+	/// Transfer queues support a few pipeline stages. Keep what's supported, the semaphores between the queues cover
+	/// the rest.
+	static void clampToTransferQueue(VkPipelineStageFlags& stage, VkAccessFlags& access, VkPipelineStageFlags fallback);
+	/// @}
+
 	/// @name reset_query_batch
 	/// @{
 	class QueryResetAtom
@@ -480,7 +525,8 @@ private:
 	/// batch.
 	void flushBatches(CommandBufferCommandType type);
 
-	void drawcallCommon();
+	/// @return False if the drawcall should be skipped.
+	ANKI_USE_RESULT Bool drawcallCommon();
 
 	Bool insideRenderPass() const
 	{
@@ -508,7 +554,9 @@ private:
 		VkAccessFlags dstAccess,
 		VkImageLayout newLayout,
 		VkImage img,
-		const VkImageSubresourceRange& range);
+		const VkImageSubresourceRange& range,
+		U32 srcQueueFamily = VK_QUEUE_FAMILY_IGNORED,
+		U32 dstQueueFamily = VK_QUEUE_FAMILY_IGNORED);
 
 	void beginRecording();
 
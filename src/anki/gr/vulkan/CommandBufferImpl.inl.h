@@ -93,7 +93,9 @@ inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage,
 	VkAccessFlags dstAccess,
 	VkImageLayout newLayout,
 	VkImage img,
-	const VkImageSubresourceRange& range)
+	const VkImageSubresourceRange& range,
+	U32 srcQueueFamily,
+	U32 dstQueueFamily)
 {
 	ANKI_ASSERT(img);
 	commandCommon();
@@ -104,8 +106,8 @@ inline void CommandBufferImpl::setImageBarrier(VkPipelineStageFlags srcStage,
 	inf.dstAccessMask = dstAccess;
 	inf.oldLayout = prevLayout;
 	inf.newLayout = newLayout;
-	inf.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	inf.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	inf.srcQueueFamilyIndex = srcQueueFamily;
+	inf.dstQueueFamilyIndex = dstQueueFamily;
 	inf.image = img;
 	inf.subresourceRange = range;
 
@@ -144,7 +146,69 @@ inline void CommandBufferImpl::setTextureBarrierRange(
 	oldLayout = impl.computeLayout(prevUsage, range.baseMipLevel);
 	newLayout = impl.computeLayout(nextUsage, range.baseMipLevel);
 
-	setImageBarrier(srcStage, srcAccess, oldLayout, dstStage, dstAccess, newLayout, impl.m_imageHandle, range);
+	if(!m_onTransferQueue)
+	{
+		setImageBarrier(srcStage, srcAccess, oldLayout, dstStage, dstAccess, newLayout, impl.m_imageHandle, range);
+	}
+	else
+	{
+		ANKI_ASSERT(!(prevUsage & ~TextureUsageBit::TRANSFER_ALL)
+					&& "Can't take textures from the graphics queue. Only the initial upload is supported");
+		clampToTransferQueue(srcStage, srcAccess, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+
+		// The graphics queue might still transition the texture to its initial usage. Wait for it. Textures created
+		// with TextureUsageBit::NONE never touched the graphics queue
+		if(impl.m_initialUsageOnGraphicsQueue)
+		{
+			m_waitForGraphicsQueue = true;
+		}
+
+		if(!(nextUsage & ~TextureUsageBit::TRANSFER_ALL))
+		{
+			setImageBarrier(srcStage, srcAccess, oldLayout, dstStage, dstAccess, newLayout, impl.m_imageHandle, range);
+		}
+		else
+		{
+			// The texture will be used by the graphics queue. Release the ownership here and store the acquire for
+			// the graphics queue
+			const U32 srcFamily = getGrManagerImpl().getTransferQueueFamily();
+			const U32 dstFamily = getGrManagerImpl().getGraphicsQueueFamily();
+
+			setImageBarrier(srcStage,
+				srcAccess,
+				oldLayout,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0,
+				newLayout,
+				impl.m_imageHandle,
+				range,
+				srcFamily,
+				dstFamily);
+
+			VkImageMemoryBarrier acquire = {};
+			acquire.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			acquire.dstAccessMask = dstAccess;
+			acquire.oldLayout = oldLayout;
+			acquire.newLayout = newLayout;
+			acquire.srcQueueFamilyIndex = srcFamily;
+			acquire.dstQueueFamilyIndex = dstFamily;
+			acquire.image = impl.m_imageHandle;
+			acquire.subresourceRange = range;
+
+			if(m_queueAcquireBarriers.getSize() <= m_queueAcquireBarrierCount)
+			{
+				const U32 newSize = max<U32>(2, m_queueAcquireBarrierCount * 2);
+				m_queueAcquireBarriers.resize(m_alloc, newSize);
+				m_queueAcquireTextures.resize(m_alloc, newSize);
+			}
+
+			m_queueAcquireBarriers[m_queueAcquireBarrierCount] = acquire;
+			m_queueAcquireTextures[m_queueAcquireBarrierCount] = tex;
+			++m_queueAcquireBarrierCount;
+			m_queueAcquireStageMask |= dstStage;
+			m_signalGraphicsQueue = true;
+		}
+	}
 
 	m_microCmdb->pushObjectRef(tex);
 }
@@ -254,16 +318,52 @@ inline void CommandBufferImpl::setBufferBarrier(
 	VkAccessFlags dstAccess;
 	impl.computeBarrierInfo(before, after, srcStage, srcAccess, dstStage, dstAccess);
 
+	if(m_onTransferQueue)
+	{
+		// The buffers are shared between the queues so only the semaphores are needed
+		ANKI_ASSERT(impl.isSharedWithTransferQueue());
+		if(!!(before & ~BufferUsageBit::TRANSFER_ALL))
+		{
+			m_waitForGraphicsQueue = true;
+		}
+
+		if(!!(after & ~BufferUsageBit::TRANSFER_ALL))
+		{
+			m_signalGraphicsQueue = true;
+		}
+
+		clampToTransferQueue(srcStage, srcAccess, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+		clampToTransferQueue(dstStage, dstAccess, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+	}
+
 	setBufferBarrier(srcStage, srcAccess, dstStage, dstAccess, offset, size, impl.getHandle());
 
 	m_microCmdb->pushObjectRef(buff);
 }
 
+inline void CommandBufferImpl::clampToTransferQueue(
+	VkPipelineStageFlags& stage, VkAccessFlags& access, VkPipelineStageFlags fallback)
+{
+	stage &= VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+			 | VK_PIPELINE_STAGE_HOST_BIT;
+	if(stage == 0)
+	{
+		stage = fallback;
+	}
+
+	access &= VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT
+			  | VK_ACCESS_HOST_WRITE_BIT;
+}
+
 inline void CommandBufferImpl::drawArrays(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDraw(m_handle, count, instanceCount, first, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -271,7 +371,11 @@ inline void CommandBufferImpl::drawElements(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDrawIndexed(m_handle, count, instanceCount, firstIndex, baseVertex, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -279,7 +383,11 @@ inline void CommandBufferImpl::drawArraysIndirect(
 	PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_GRAPHICS));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -293,7 +401,11 @@ inline void CommandBufferImpl::drawElementsIndirect(
 	PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_ALL));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -307,6 +419,7 @@ inline void CommandBufferImpl::dispatchCompute(U32 groupCountX, U32 groupCountY,
 {
 	ANKI_ASSERT(m_computeProg);
 	ANKI_ASSERT(!!(m_flags & CommandBufferFlag::COMPUTE_WORK));
+	ANKI_ASSERT(!m_onTransferQueue);
 	ANKI_ASSERT(m_computeProg->getReflectionInfo().m_pushConstantsSize == m_setPushConstantsSize
 				&& "Forgot to set pushConstants");
 
@@ -480,10 +593,11 @@ inline void CommandBufferImpl::pushSecondLevelCommandBuffer(CommandBufferPtr cmd
 	m_microCmdb->pushObjectRef(cmdb);
 }
 
-inline void CommandBufferImpl::drawcallCommon()
+inline Bool CommandBufferImpl::drawcallCommon()
 {
 	// Preconditions
 	commandCommon();
+	ANKI_ASSERT(!m_onTransferQueue);
 	ANKI_ASSERT(insideRenderPass() || secondLevel());
 	ANKI_ASSERT(m_subpassContents == VK_SUBPASS_CONTENTS_MAX_ENUM || m_subpassContents == VK_SUBPASS_CONTENTS_INLINE);
 	ANKI_ASSERT(m_graphicsProg->getReflectionInfo().m_pushConstantsSize == m_setPushConstantsSize
@@ -502,7 +616,12 @@ inline void CommandBufferImpl::drawcallCommon()
 	ANKI_ASSERT(m_graphicsProg);
 	Pipeline ppline;
 	Bool stateDirty;
-	m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty);
+	if(ANKI_UNLIKELY(!m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty)))
+	{
+		// The pipeline is being compiled in the background, skip the drawcall
+		ANKI_TRACE_INC_COUNTER(GR_SKIPPED_DRAWCALLS, 1);
+		return false;
+	}
 
 	if(stateDirty)
 	{
@@ -598,6 +717,7 @@ inline void CommandBufferImpl::drawcallCommon()
 #endif
 
 	ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+	return true;
 }
 
 inline void CommandBufferImpl::commandCommon()
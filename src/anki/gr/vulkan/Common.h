@@ -62,8 +62,8 @@ ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(VulkanExtensions, inline)
 
 /// @name Constants
 /// @{
-const U DESCRIPTOR_POOL_INITIAL_SIZE = 64;
-const F32 DESCRIPTOR_POOL_SIZE_SCALE = 2.0;
+const U32 DESCRIPTOR_POOL_MIN_SIZE = 16;
+const U32 DESCRIPTOR_POOL_MAX_SIZE = 1024;
 const U DESCRIPTOR_FRAME_BUFFERING = 60 * 5; ///< How many frames worth of descriptors to buffer.
 /// @}
 
@@ -27,17 +27,26 @@ public:
 class alignas(ANKI_CACHE_LINE_SIZE) DSThreadAllocator : public NonCopyable
 {
 public:
-	const DSLayoutCacheEntry* m_layoutEntry; ///< Know your father.
+	DSLayoutCacheEntry* m_layoutEntry; ///< Know your father.
+	DSThreadAllocator* m_next = nullptr; ///< Next in the lock-free list of the DSLayoutCacheEntry.
 
 	ThreadId m_tid;
 	DynamicArray<VkDescriptorPool> m_pools;
-	U32 m_lastPoolDSCount = 0;
 	U32 m_lastPoolFreeDSCount = 0;
+	U32 m_allocatedSetCount = 0;
 
-	IntrusiveList<DS> m_list; ///< At the left of the list are the least used sets.
+	IntrusiveList<DS> m_list; ///< LRU. At the left of the list are the least recently used sets.
 	HashMap<U64, DS*> m_hashmap;
 
-	DSThreadAllocator(const DSLayoutCacheEntry* layout, ThreadId tid)
+	/// @name Stats
+	/// Only the owner thread writes them so they are not incremented atomically. The endFrame() reads them.
+	/// @{
+	Atomic<U64> m_hitCount = {0};
+	Atomic<U64> m_missCount = {0};
+	Atomic<U64> m_allocationCount = {0};
+	/// @}
+
+	DSThreadAllocator(DSLayoutCacheEntry* layout, ThreadId tid)
 		: m_layoutEntry(layout)
 		, m_tid(tid)
 	{
@@ -58,11 +67,21 @@ public:
 		if(out == nullptr)
 		{
 			ANKI_CHECK(newSet(hash, bindings, tmpAlloc, out));
+			increment(m_missCount);
+		}
+		else
+		{
+			increment(m_hitCount);
 		}
 
 		return Error::NONE;
 	}
 
+	static void increment(Atomic<U64>& counter)
+	{
+		counter.store(counter.load() + 1);
+	}
+
 private:
 	ANKI_USE_RESULT const DS* tryFindSet(U64 hash);
 	ANKI_USE_RESULT Error newSet(U64 hash,
@@ -92,8 +111,13 @@ public:
 	Array<VkDescriptorPoolSize, U(DescriptorType::COUNT)> m_poolSizesCreateInf = {};
 	VkDescriptorPoolCreateInfo m_poolCreateInf = {};
 
-	DynamicArray<DSThreadAllocator*> m_threadAllocs;
-	SpinLock m_threadAllocsMtx;
+	DSLayoutCacheEntry* m_next = nullptr; ///< Next in the lock-free list of the DescriptorSetFactory.
+
+	/// Lock-free list of the thread allocators. Only the thread itself creates its allocator so there is no race for
+	/// the same thread ID.
+	Atomic<DSThreadAllocator*> m_threadAllocs = {nullptr};
+	Atomic<U32> m_threadAllocCount = {0};
+	Atomic<U32> m_allocatedSetCount = {0}; ///< The sets that all the thread allocators have allocated.
 
 	DSLayoutCacheEntry(DescriptorSetFactory* factory)
 		: m_factory(factory)
@@ -136,9 +160,21 @@ Error DSThreadAllocator::init()
 
 Error DSThreadAllocator::createNewPool()
 {
-	m_lastPoolDSCount = (m_lastPoolDSCount != 0) ? U32(F32(m_lastPoolDSCount) * DESCRIPTOR_POOL_SIZE_SCALE)
-												 : DESCRIPTOR_POOL_INITIAL_SIZE;
-	m_lastPoolFreeDSCount = m_lastPoolDSCount;
+	// Size the pool based on the usage. The first pool gets what the other threads needed on average for the same
+	// layout. The next pools match the sets that are alive
+	U32 setCount;
+	if(m_pools.getSize() == 0)
+	{
+		const U32 threadCount = max<U32>(1, m_layoutEntry->m_threadAllocCount.load());
+		setCount = m_layoutEntry->m_allocatedSetCount.load() / threadCount;
+	}
+	else
+	{
+		setCount = m_allocatedSetCount;
+	}
+
+	setCount = clamp(setCount, DESCRIPTOR_POOL_MIN_SIZE, DESCRIPTOR_POOL_MAX_SIZE);
+	m_lastPoolFreeDSCount = setCount;
 
 	// Set the create info
 	Array<VkDescriptorPoolSize, U(DescriptorType::COUNT)> poolSizes;
@@ -148,13 +184,13 @@ Error DSThreadAllocator::createNewPool()
 
 	for(U i = 0; i < m_layoutEntry->m_poolCreateInf.poolSizeCount; ++i)
 	{
-		poolSizes[i].descriptorCount *= m_lastPoolDSCount;
+		poolSizes[i].descriptorCount *= setCount;
 		ANKI_ASSERT(poolSizes[i].descriptorCount > 0);
 	}
 
 	VkDescriptorPoolCreateInfo ci = m_layoutEntry->m_poolCreateInf;
 	ci.pPoolSizes = &poolSizes[0];
-	ci.maxSets = m_lastPoolDSCount;
+	ci.maxSets = setCount;
 
 	// Create
 	VkDescriptorPool pool;
@@ -197,29 +233,21 @@ Error DSThreadAllocator::newSet(U64 hash,
 {
 	DS* out = nullptr;
 
-	// First try to see if there are unused to recycle
+	// First try to recycle the least recently used set. If that one is in use none of the others can be recycled
 	const U64 crntFrame = m_layoutEntry->m_factory->m_frameCount;
-	auto it = m_list.getBegin();
-	const auto end = m_list.getEnd();
-	while(it != end)
+	if(!m_list.isEmpty() && crntFrame - m_list.getFront().m_lastFrameUsed > DESCRIPTOR_FRAME_BUFFERING)
 	{
-		DS* set = &(*it);
-		U64 frameDiff = crntFrame - set->m_lastFrameUsed;
-		if(frameDiff > DESCRIPTOR_FRAME_BUFFERING)
-		{
-			// Found something, recycle
-			auto it2 = m_hashmap.find(set->m_hash);
-			ANKI_ASSERT(it2 != m_hashmap.getEnd());
-			m_hashmap.erase(m_layoutEntry->m_factory->m_alloc, it2);
-			m_list.erase(set);
+		DS* set = &m_list.getFront();
 
-			m_list.pushBack(set);
-			m_hashmap.emplace(m_layoutEntry->m_factory->m_alloc, hash, set);
+		auto it = m_hashmap.find(set->m_hash);
+		ANKI_ASSERT(it != m_hashmap.getEnd());
+		m_hashmap.erase(m_layoutEntry->m_factory->m_alloc, it);
+		m_list.popFront();
 
-			out = set;
-			break;
-		}
-		++it;
+		m_list.pushBack(set);
+		m_hashmap.emplace(m_layoutEntry->m_factory->m_alloc, hash, set);
+
+		out = set;
 	}
 
 	if(out == nullptr)
@@ -246,6 +274,10 @@ Error DSThreadAllocator::newSet(U64 hash,
 		ANKI_ASSERT(rez == VK_SUCCESS && "That allocation can't fail");
 		ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_CREATE, 1);
 
+		++m_allocatedSetCount;
+		m_layoutEntry->m_allocatedSetCount.fetchAdd(1);
+		increment(m_allocationCount);
+
 		out = m_layoutEntry->m_factory->m_alloc.newInstance<DS>();
 		out->m_handle = handle;
 
@@ -388,13 +420,14 @@ DSLayoutCacheEntry::~DSLayoutCacheEntry()
 {
 	auto alloc = m_factory->m_alloc;
 
-	for(DSThreadAllocator* a : m_threadAllocs)
+	DSThreadAllocator* a = m_threadAllocs.load();
+	while(a)
 	{
+		DSThreadAllocator* next = a->m_next;
 		alloc.deleteInstance(a);
+		a = next;
 	}
 
-	m_threadAllocs.destroy(alloc);
-
 	if(m_layoutHandle)
 	{
 		vkDestroyDescriptorSetLayout(m_factory->m_dev, m_layoutHandle, nullptr);
@@ -478,49 +511,28 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 
 Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc)
 {
-	alloc = nullptr;
-
-	LockGuard<SpinLock> lock(m_threadAllocsMtx);
-
-	class Comp
+	// Lock-free search
+	for(alloc = m_threadAllocs.load(AtomicMemoryOrder::ACQUIRE); alloc; alloc = alloc->m_next)
 	{
-	public:
-		Bool operator()(const DSThreadAllocator* a, ThreadId tid) const
+		if(alloc->m_tid == tid)
 		{
-			return a->m_tid < tid;
+			return Error::NONE;
 		}
-
-		Bool operator()(ThreadId tid, const DSThreadAllocator* a) const
-		{
-			return tid < a->m_tid;
-		}
-	};
-
-	// Find using binary search
-	auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-
-	if(it != m_threadAllocs.getEnd())
-	{
-		ANKI_ASSERT((*it)->m_tid == tid);
-		alloc = *it;
 	}
-	else
-	{
-		// Need to create one
 
-		alloc = m_factory->m_alloc.newInstance<DSThreadAllocator>(this, tid);
-		ANKI_CHECK(alloc->init());
+	// Need to create one
+	alloc = m_factory->m_alloc.newInstance<DSThreadAllocator>(this, tid);
+	ANKI_CHECK(alloc->init());
 
-		m_threadAllocs.resize(m_factory->m_alloc, m_threadAllocs.getSize() + 1);
-		m_threadAllocs[m_threadAllocs.getSize() - 1] = alloc;
+	// Store it to the list without locking
+	DSThreadAllocator* head = m_threadAllocs.load();
+	do
+	{
+		alloc->m_next = head;
+	} while(!m_threadAllocs.compareExchange(head, alloc, AtomicMemoryOrder::SEQ_CST));
 
-		// Sort for fast find
-		std::sort(m_threadAllocs.getBegin(),
-			m_threadAllocs.getEnd(),
-			[](const DSThreadAllocator* a, const DSThreadAllocator* b) { return a->m_tid < b->m_tid; });
-	}
+	m_threadAllocCount.fetchAdd(1);
 
-	ANKI_ASSERT(alloc);
 	return Error::NONE;
 }
 
@@ -660,12 +672,28 @@ void DescriptorSetFactory::init(const GrAllocator<U8>& alloc, VkDevice dev)
 
 void DescriptorSetFactory::destroy()
 {
-	for(DSLayoutCacheEntry* l : m_caches)
+	DSLayoutCacheEntry* l = m_caches.load();
+	while(l)
 	{
+		DSLayoutCacheEntry* next = l->m_next;
 		m_alloc.deleteInstance(l);
+		l = next;
+	}
+
+	m_caches.store(nullptr);
+}
+
+DSLayoutCacheEntry* DescriptorSetFactory::findCacheEntry(DSLayoutCacheEntry* begin, DSLayoutCacheEntry* end, U64 hash)
+{
+	for(DSLayoutCacheEntry* it = begin; it != end; it = it->m_next)
+	{
+		if(it->m_hash == hash)
+		{
+			return it;
+		}
 	}
 
-	m_caches.destroy(m_alloc);
+	return nullptr;
 }
 
 Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInitInfo& init, DescriptorSetLayout& layout)
@@ -690,28 +718,48 @@ Error DescriptorSetFactory::newDescriptorSetLayout(const DescriptorSetLayoutInit
 		hash = 1;
 	}
 
-	// Find or create the cache entry
-	LockGuard<SpinLock> lock(m_cachesMtx);
+	// Find the cache entry without locking
+	DSLayoutCacheEntry* head = m_caches.load(AtomicMemoryOrder::ACQUIRE);
+	DSLayoutCacheEntry* cache = findCacheEntry(head, nullptr, hash);
 
-	DSLayoutCacheEntry* cache = nullptr;
-	U count = 0;
-	for(DSLayoutCacheEntry* it : m_caches)
+	if(cache == nullptr)
 	{
-		if(it->m_hash == hash)
+		// Create a new entry
+		DSLayoutCacheEntry* newCache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
+		const Error err = newCache->init(&bindings[0], bindingCount, hash);
+		if(err)
 		{
-			cache = it;
-			break;
+			m_alloc.deleteInstance(newCache);
+			return err;
 		}
-		++count;
-	}
 
-	if(cache == nullptr)
-	{
-		cache = m_alloc.newInstance<DSLayoutCacheEntry>(this);
-		ANKI_CHECK(cache->init(&bindings[0], bindingCount, hash));
+		// Publish it. If some other thread added entries in the meantime check if it added the same layout
+		DSLayoutCacheEntry* expected = head;
+		do
+		{
+			if(expected != head)
+			{
+				cache = findCacheEntry(expected, head, hash);
+				if(cache)
+				{
+					break;
+				}
 
-		m_caches.resize(m_alloc, m_caches.getSize() + 1);
-		m_caches[m_caches.getSize() - 1] = cache;
+				head = expected;
+			}
+
+			newCache->m_next = expected;
+		} while(!m_caches.compareExchange(expected, newCache, AtomicMemoryOrder::SEQ_CST));
+
+		if(cache)
+		{
+			// Lost the race, use the other one
+			m_alloc.deleteInstance(newCache);
+		}
+		else
+		{
+			cache = newCache;
+		}
 	}
 
 	// Set the layout
@@ -1003,4 +1051,30 @@ Error BindlessDescriptorSet::initDeviceFeatures(
 	return Error::NONE;
 }
 
+void DescriptorSetFactory::endFrame()
+{
+	// Gather the stats of all thread allocators
+	U64 hits = 0;
+	U64 misses = 0;
+	U64 allocations = 0;
+	for(DSLayoutCacheEntry* l = m_caches.load(AtomicMemoryOrder::ACQUIRE); l; l = l->m_next)
+	{
+		for(DSThreadAllocator* a = l->m_threadAllocs.load(AtomicMemoryOrder::ACQUIRE); a; a = a->m_next)
+		{
+			hits += a->m_hitCount.load();
+			misses += a->m_missCount.load();
+			allocations += a->m_allocationCount.load();
+		}
+	}
+
+	m_prevFrameHitCount.store(U32(hits - m_totalHitCount));
+	m_prevFrameMissCount.store(U32(misses - m_totalMissCount));
+	m_prevFrameAllocationCount.store(U32(allocations - m_totalAllocationCount));
+	m_totalHitCount = hits;
+	m_totalMissCount = misses;
+	m_totalAllocationCount = allocations;
+
+	++m_frameCount;
+}
+
 } // end namespace anki
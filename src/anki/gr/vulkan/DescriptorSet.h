@@ -12,6 +12,7 @@
 #include <anki/gr/vulkan/SamplerImpl.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/BitSet.h>
+#include <anki/util/Atomic.h>
 
 namespace anki
 {
@@ -387,9 +388,18 @@ public:
 		Array<PtrSize, MAX_BINDINGS_PER_DESCRIPTOR_SET>& dynamicOffsets,
 		U32& dynamicOffsetCount);
 
-	void endFrame()
+	/// Gather the stats of the frame and advance the frame.
+	void endFrame();
+
+	/// Get the stats of the previous frame.
+	/// @param[out] hits The sets that were found in the caches.
+	/// @param[out] misses The sets that had to be written.
+	/// @param[out] allocations The sets that had to be allocated. It's a subset of the misses.
+	void getPreviousFrameStats(U32& hits, U32& misses, U32& allocations) const
 	{
-		++m_frameCount;
+		hits = m_prevFrameHitCount.load();
+		misses = m_prevFrameMissCount.load();
+		allocations = m_prevFrameAllocationCount.load();
 	}
 
 private:
@@ -397,8 +407,17 @@ private:
 	VkDevice m_dev = VK_NULL_HANDLE;
 	U64 m_frameCount = 0;
 
-	DynamicArray<DSLayoutCacheEntry*> m_caches;
-	SpinLock m_cachesMtx; ///< Not a mutex because after a while there will be no reason to lock
+	/// Lock-free list of the cache entries. The entries are never removed so the lookups don't need to lock.
+	Atomic<DSLayoutCacheEntry*> m_caches = {nullptr};
+
+	U64 m_totalHitCount = 0;
+	U64 m_totalMissCount = 0;
+	U64 m_totalAllocationCount = 0;
+	Atomic<U32> m_prevFrameHitCount = {0};
+	Atomic<U32> m_prevFrameMissCount = {0};
+	Atomic<U32> m_prevFrameAllocationCount = {0};
+
+	static DSLayoutCacheEntry* findCacheEntry(DSLayoutCacheEntry* begin, DSLayoutCacheEntry* end, U64 hash);
 };
 
 /// Wraps a global descriptor set that is used to store bindless textures.
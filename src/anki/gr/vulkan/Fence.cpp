@@ -5,6 +5,7 @@
 
 #include <anki/gr/Fence.h>
 #include <anki/gr/vulkan/FenceImpl.h>
+#include <anki/gr/vulkan/GrManagerImpl.h>
 #include <anki/gr/GrManager.h>
 
 namespace anki
@@ -17,7 +18,12 @@ Fence* Fence::newInstance(GrManager* manager)
 
 Bool Fence::clientWait(Second seconds)
 {
-	return static_cast<FenceImpl*>(this)->m_fence->clientWait(seconds);
+	ANKI_VK_SELF(FenceImpl);
+
+	// The command buffers of the fence might be waiting for their batch to be submitted
+	self.getGrManagerImpl().submitPendingCommandBuffers(self.m_fence);
+
+	return self.m_fence->clientWait(seconds);
 }
 
 } // end namespace anki
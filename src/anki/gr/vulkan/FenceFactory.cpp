@@ -24,24 +24,31 @@ MicroFence* FenceFactory::newFence()
 
 	LockGuard<Mutex> lock(m_mtx);
 
-	U32 count = m_fenceCount;
-	while(count--)
+	// The fences are recycled in the order they were released so the oldest are the most likely to be signaled. Take
+	// the first signaled one. Don't stop at the first one that isn't, it might belong to a batch that is still pending
+	for(U32 i = 0; i < m_fenceCount; ++i)
 	{
+		MicroFence* fence = m_fences[i];
+		if(!fence->isSubmitted())
+		{
+			continue;
+		}
+
 		VkResult status;
-		ANKI_VK_CHECKF(status = vkGetFenceStatus(m_dev, m_fences[count]->getHandle()));
+		ANKI_VK_CHECKF(status = vkGetFenceStatus(m_dev, fence->getHandle()));
 		if(status == VK_SUCCESS)
 		{
-			out = m_fences[count];
-			ANKI_VK_CHECKF(vkResetFences(m_dev, 1, &m_fences[count]->getHandle()));
+			out = fence;
+			ANKI_VK_CHECKF(vkResetFences(m_dev, 1, &fence->getHandle()));
+			out->m_submitted.store(false, AtomicMemoryOrder::RELAXED);
 
 			// Pop it
-			for(U32 i = count; i < m_fenceCount - 1; ++i)
+			for(U32 j = i; j < m_fenceCount - 1; ++j)
 			{
-				m_fences[i] = m_fences[i + 1];
+				m_fences[j] = m_fences[j + 1];
 			}
 
 			--m_fenceCount;
-
 			break;
 		}
 		else if(status != VK_NOT_READY)
@@ -40,16 +40,33 @@ public:
 
 	GrAllocator<U8> getAllocator() const;
 
+	/// Wait for the fence. It should be submitted.
 	void wait();
 
+	/// Check if the fence is signaled. It returns false without asking the driver if the fence is not submitted.
 	Bool done() const;
 
+	/// Wait for the fence. If @a seconds is zero it's the same as done(). It should be submitted if @a seconds is not
+	/// zero.
 	Bool clientWait(Second seconds);
 
+	/// The fence is given to command buffers before their batch is submitted. Call this after the vkQueueSubmit() that
+	/// signals it.
+	void setSubmitted()
+	{
+		m_submitted.store(true, AtomicMemoryOrder::RELEASE);
+	}
+
+	Bool isSubmitted() const
+	{
+		return m_submitted.load(AtomicMemoryOrder::ACQUIRE);
+	}
+
 private:
 	VkFence m_handle = VK_NULL_HANDLE;
 	Atomic<U32> m_refcount = {0};
 	FenceFactory* m_factory = nullptr;
+	Atomic<Bool> m_submitted = {false};
 };
 
 /// Deleter for FencePtr.
@@ -36,12 +36,19 @@ inline GrAllocator<U8> MicroFence::getAllocator() const
 inline void MicroFence::wait()
 {
 	ANKI_ASSERT(m_handle);
+	ANKI_ASSERT(isSubmitted() && "Waiting for a fence that is not submitted will never finish");
 	ANKI_VK_CHECKF(vkWaitForFences(m_factory->m_dev, 1, &m_handle, true, ~0U));
 }
 
 inline Bool MicroFence::done() const
 {
 	ANKI_ASSERT(m_handle);
+	if(!isSubmitted())
+	{
+		// The batch of the fence is still pending. Polling the command buffers of the batch should not flush it
+		return false;
+	}
+
 	VkResult status = vkGetFenceStatus(m_factory->m_dev, m_handle);
 	if(status == VK_SUCCESS)
 	{
@@ -63,6 +70,7 @@ inline Bool MicroFence::clientWait(Second seconds)
 	}
 	else
 	{
+		ANKI_ASSERT(isSubmitted() && "Waiting for a fence that is not submitted will never finish");
 		VkResult res;
 		F64 nsf = 1e+9 * seconds;
 		U64 ns = U64(nsf);
@@ -92,6 +92,12 @@ GrManagerStats GrManager::getStats() const
 
 	self.getGpuMemoryManager().getAllocatedMemory(out.m_gpuMemory, out.m_cpuMemory);
 	out.m_commandBufferCount = self.getCommandBufferFactory().getCreatedCommandBufferCount();
+	out.m_queueSubmitCount = self.getPreviousFrameQueueSubmitCount();
+	out.m_submittedCommandBufferCount = self.getPreviousFrameSubmittedCommandBufferCount();
+	self.getDescriptorSetFactory().getPreviousFrameStats(
+		out.m_descriptorSetCacheHits, out.m_descriptorSetCacheMisses, out.m_descriptorSetAllocations);
+	out.m_createdPipelineCount = self.getPipelineCompiler().getCreatedPipelineCount();
+	out.m_prewarmedPipelineCount = self.getPipelineCompiler().getPrewarmedPipelineCount();
 
 	return out;
 }
@@ -123,7 +129,13 @@ ShaderPtr GrManager::newShader(const ShaderInitInfo& init)
 
 ShaderProgramPtr GrManager::newShaderProgram(const ShaderProgramInitInfo& init)
 {
-	return ShaderProgramPtr(ShaderProgram::newInstance(this, init));
+	ANKI_VK_SELF(GrManagerImpl);
+	ShaderProgramPtr prog(ShaderProgram::newInstance(this, init));
+	if(prog.isCreated())
+	{
+		self.getPipelineCompiler().prewarmPipelines(prog);
+	}
+	return prog;
 }
 
 CommandBufferPtr GrManager::newCommandBuffer(const CommandBufferInitInfo& init)
@@ -22,6 +22,15 @@ ANKI_REGISTER_CONFIG_OPTION(gr_debugMarkers, 0, 0, 1)
 ANKI_REGISTER_CONFIG_OPTION(gr_diskShaderCacheMaxSize, 128_MB, 1_MB, 1_GB)
 ANKI_REGISTER_CONFIG_OPTION(gr_vkminor, 1, 1, 1)
 ANKI_REGISTER_CONFIG_OPTION(gr_vkmajor, 1, 1, 1)
+ANKI_REGISTER_CONFIG_OPTION(
+	gr_maxCommandBuffersPerSubmit, 16, 1, 32, "Batch that many flushed command buffers in a single queue submit")
+ANKI_REGISTER_CONFIG_OPTION(
+	gr_transferQueue, 1, 0, 1, "Upload resources using a dedicated transfer queue if there is one")
+ANKI_REGISTER_CONFIG_OPTION(gr_pipelineCompilerThreadCount, 2, 1, 16, "The number of threads that compile pipelines")
+ANKI_REGISTER_CONFIG_OPTION(
+	gr_asyncPipelines, 0, 0, 1, "Skip the drawcalls while their pipelines are being compiled in the background")
+ANKI_REGISTER_CONFIG_OPTION(
+	gr_pipelineManifest, 1, 0, 1, "Store the used pipelines on disk and precompile them in the next run")
 
 GrManagerImpl::~GrManagerImpl()
 {
@@ -29,11 +38,21 @@ GrManagerImpl::~GrManagerImpl()
 	if(m_queue)
 	{
 		LockGuard<Mutex> lock(m_globalMtx);
+		submitPendingCommandBuffersInternal();
 		vkQueueWaitIdle(m_queue);
 		m_queue = VK_NULL_HANDLE;
+
+		if(m_transferQueue)
+		{
+			vkQueueWaitIdle(m_transferQueue);
+			m_transferQueue = VK_NULL_HANDLE;
+		}
 	}
 
+	m_pplineCompiler.destroy(); // Destroy before the pipeline cache
+
 	m_cmdbFactory.destroy();
+	m_transferCmdbFactory.destroy();
 
 	// SECOND THING: The destroy everything that has a reference to GrObjects.
 	for(auto& x : m_perFrame)
@@ -115,16 +134,29 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 	ANKI_CHECK(initSurface(init));
 	ANKI_CHECK(initDevice(init));
 	vkGetDeviceQueue(m_device, m_queueIdx, 0, &m_queue);
+	m_bufferQueueFamilies[0] = m_queueIdx;
+	if(m_transferQueueIdx != MAX_U32)
+	{
+		vkGetDeviceQueue(m_device, m_transferQueueIdx, 0, &m_transferQueue);
+		m_bufferQueueFamilies[1] = m_transferQueueIdx;
+	}
 
 	m_swapchainFactory.init(this, init.m_config->getBool("gr_vsync"));
+	m_maxCommandBuffersPerSubmit = init.m_config->getNumberU32("gr_maxCommandBuffersPerSubmit");
 
 	m_crntSwapchain = m_swapchainFactory.newInstance();
 
 	ANKI_CHECK(m_pplineCache.init(m_device, m_physicalDevice, init.m_cacheDirectory, *init.m_config, getAllocator()));
+	ANKI_CHECK(m_pplineCompiler.init(
+		getAllocator(), m_device, m_pplineCache.m_cacheHandle, init.m_cacheDirectory, *init.m_config));
 
 	ANKI_CHECK(initMemory(*init.m_config));
 
 	ANKI_CHECK(m_cmdbFactory.init(getAllocator(), m_device, m_queueIdx));
+	if(m_transferQueue)
+	{
+		ANKI_CHECK(m_transferCmdbFactory.init(getAllocator(), m_device, m_transferQueueIdx));
+	}
 
 	for(PerFrame& f : m_perFrame)
 	{
@@ -484,17 +516,46 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 
 	m_queueIdx = desiredFamilyIdx;
 
+	// Try to find a transfer only queue family. Those are usually backed by DMA engines that can run in parallel with
+	// the rest of the GPU
+	if(init.m_config->getBool("gr_transferQueue"))
+	{
+		const VkQueueFlags OTHER_QUEUE_FLAGS = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT;
+		for(U32 i = 0; i < count; ++i)
+		{
+			const VkExtent3D& granularity = queueInfos[i].minImageTransferGranularity;
+			if((queueInfos[i].queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueInfos[i].queueFlags & OTHER_QUEUE_FLAGS)
+				&& granularity.width == 1 && granularity.height == 1 && granularity.depth == 1)
+			{
+				m_transferQueueIdx = i;
+				break;
+			}
+		}
+
+		if(m_transferQueueIdx != MAX_U32)
+		{
+			ANKI_VK_LOGI("Using a dedicated transfer queue (family %u)", m_transferQueueIdx);
+		}
+		else
+		{
+			ANKI_VK_LOGI("No dedicated transfer queue found. Uploads will use the graphics queue");
+		}
+	}
+
 	F32 priority = 1.0;
-	VkDeviceQueueCreateInfo q = {};
-	q.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	q.queueFamilyIndex = desiredFamilyIdx;
-	q.queueCount = 1;
-	q.pQueuePriorities = &priority;
+	Array<VkDeviceQueueCreateInfo, 2> q = {};
+	q[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	q[0].queueFamilyIndex = desiredFamilyIdx;
+	q[0].queueCount = 1;
+	q[0].pQueuePriorities = &priority;
+
+	q[1] = q[0];
+	q[1].queueFamilyIndex = m_transferQueueIdx;
 
 	VkDeviceCreateInfo ci = {};
 	ci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	ci.queueCreateInfoCount = 1;
-	ci.pQueueCreateInfos = &q;
+	ci.queueCreateInfoCount = (m_transferQueueIdx != MAX_U32) ? 2 : 1;
+	ci.pQueueCreateInfos = &q[0];
 	ci.pEnabledFeatures = &m_devFeatures;
 
 	// Extensions
@@ -753,6 +814,14 @@ void GrManagerImpl::endFrame()
 
 	LockGuard<Mutex> lock(m_globalMtx);
 
+	// The frame ends, submit everything before presenting
+	submitPendingCommandBuffersInternal();
+
+	m_prevFrameSubmitCount.store(m_crntFrameSubmitCount);
+	m_prevFrameSubmittedCmdbCount.store(m_crntFrameSubmittedCmdbCount);
+	m_crntFrameSubmitCount = 0;
+	m_crntFrameSubmittedCmdbCount = 0;
+
 	PerFrame& frame = m_perFrame[m_frame % MAX_FRAMES_IN_FLIGHT];
 
 	// Wait for the fence of N-2 frame
@@ -811,66 +880,293 @@ void GrManagerImpl::resetFrame(PerFrame& frame)
 void GrManagerImpl::flushCommandBuffer(CommandBufferPtr cmdb, FencePtr* outFence, Bool wait)
 {
 	CommandBufferImpl& impl = static_cast<CommandBufferImpl&>(*cmdb);
-	VkCommandBuffer handle = impl.getHandle();
 
-	VkSubmitInfo submit = {};
-	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	LockGuard<Mutex> lock(m_globalMtx);
 
-	MicroFencePtr fence = newFence();
+	if(impl.isOnTransferQueue())
+	{
+		flushTransferCommandBuffer(impl, outFence);
+
+		if(wait)
+		{
+			submitPendingCommandBuffersInternal();
+			vkQueueWaitIdle(m_transferQueue);
+			vkQueueWaitIdle(m_queue);
+		}
+
+		return;
+	}
+
+	// All the command buffers of a batch share the same fence
+	if(!m_pendingFence)
+	{
+		m_pendingFence = newFence();
+	}
 
 	// Create fence
 	if(outFence)
 	{
 		outFence->reset(getAllocator().newInstance<FenceImpl>(this, "Flush"));
-		static_cast<FenceImpl&>(**outFence).m_fence = fence;
+		static_cast<FenceImpl&>(**outFence).m_fence = m_pendingFence;
 	}
 
-	LockGuard<Mutex> lock(m_globalMtx);
-
-	PerFrame& frame = m_perFrame[m_frame % MAX_FRAMES_IN_FLIGHT];
-
 	// Do some special stuff for the last command buffer
-	VkPipelineStageFlags waitFlags;
 	if(impl.renderedToDefaultFramebuffer())
 	{
-		submit.pWaitSemaphores = &frame.m_acquireSemaphore->getHandle();
-		waitFlags = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-					| VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT; // TODO That depends on how we use the swapchain img
-		submit.pWaitDstStageMask = &waitFlags;
-		submit.waitSemaphoreCount = 1;
+		PerFrame& frame = m_perFrame[m_frame % MAX_FRAMES_IN_FLIGHT];
 
 		// Create the semaphore to signal
 		ANKI_ASSERT(!frame.m_renderSemaphore && "Only one begin/end render pass is allowed with the default fb");
-		frame.m_renderSemaphore = m_semaphores.newInstance(fence);
-
-		submit.signalSemaphoreCount = 1;
-		submit.pSignalSemaphores = &frame.m_renderSemaphore->getHandle();
+		frame.m_renderSemaphore = m_semaphores.newInstance(m_pendingFence);
 
-		frame.m_presentFence = fence;
+		frame.m_presentFence = m_pendingFence;
 
 		// Update the swapchain's fence
-		m_crntSwapchain->setFence(fence);
+		m_crntSwapchain->setFence(m_pendingFence);
+	}
+
+	impl.setFence(m_pendingFence);
+
+	PendingCommandBuffer pending;
+	pending.m_cmdb = cmdb;
+	pushPendingCommandBuffer(pending);
+
+	if(wait)
+	{
+		submitPendingCommandBuffersInternal();
+		vkQueueWaitIdle(m_queue);
+	}
+}
+
+void GrManagerImpl::flushTransferCommandBuffer(CommandBufferImpl& impl, FencePtr* outFence)
+{
+	ANKI_ASSERT(m_transferQueue);
+
+	MicroFencePtr fence = newFence();
+	if(outFence)
+	{
+		outFence->reset(getAllocator().newInstance<FenceImpl>(this, "Transfer"));
+		static_cast<FenceImpl&>(**outFence).m_fence = fence;
 	}
 
+	impl.setFence(fence);
+
+	VkSubmitInfo submit = {};
+	submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	VkCommandBuffer handle = impl.getHandle();
 	submit.commandBufferCount = 1;
 	submit.pCommandBuffers = &handle;
 
-	impl.setFence(fence);
+	// The command buffer touches resources that the graphics queue used. Submit all the graphics work so far and wait
+	// for it. The semaphore is recycled when the transfer fence is signaled and by then the wait is complete. This
+	// breaks the graphics batch so it should be rare. Streamed resources start on the transfer queue and don't need it
+	MicroSemaphorePtr waitSemaphore;
+	const VkPipelineStageFlags waitFlags = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	if(impl.waitsForGraphicsQueue())
+	{
+		ANKI_TRACE_INC_COUNTER(VK_TRANSFER_QUEUE_GRAPHICS_WAITS, 1);
+		waitSemaphore = m_semaphores.newInstance(fence);
+
+		if(!submitPendingCommandBuffersInternal(waitSemaphore->getHandle()))
+		{
+			// Nothing pending. Signal after the work that is already in the queue
+			VkSubmitInfo signalSubmit = {};
+			signalSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			signalSubmit.signalSemaphoreCount = 1;
+			signalSubmit.pSignalSemaphores = &waitSemaphore->getHandle();
+			ANKI_VK_CHECKF(vkQueueSubmit(m_queue, 1, &signalSubmit, VK_NULL_HANDLE));
+			++m_crntFrameSubmitCount;
+		}
+
+		submit.waitSemaphoreCount = 1;
+		submit.pWaitSemaphores = &waitSemaphore->getHandle();
+		submit.pWaitDstStageMask = &waitFlags;
+	}
+
+	// The graphics queue should wait for the transfers and acquire the ownership of the textures. The acquire happens
+	// in the next batch of the graphics queue so the semaphore is recycled when that batch is done
+	PendingCommandBuffer acquire;
+	if(impl.signalsGraphicsQueue())
+	{
+		if(!m_pendingFence)
+		{
+			m_pendingFence = newFence();
+		}
+
+		acquire.m_waitSemaphore = m_semaphores.newInstance(m_pendingFence);
+		submit.signalSemaphoreCount = 1;
+		submit.pSignalSemaphores = &acquire.m_waitSemaphore->getHandle();
+
+		if(impl.hasQueueAcquireBarriers())
+		{
+			if(m_cmdbFactory.newCommandBuffer(
+				   Thread::getCurrentThreadId(), CommandBufferFlag::SMALL_BATCH, acquire.m_microCmdb))
+			{
+				ANKI_VK_LOGF("Failed to create a command buffer");
+			}
+
+			VkCommandBufferBeginInfo begin = {};
+			begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			ANKI_VK_CHECKF(vkBeginCommandBuffer(acquire.m_microCmdb->getHandle(), &begin));
+			impl.recordQueueAcquireBarriers(*acquire.m_microCmdb);
+			ANKI_VK_CHECKF(vkEndCommandBuffer(acquire.m_microCmdb->getHandle()));
+
+			acquire.m_microCmdb->setFence(m_pendingFence);
+		}
+	}
 
 	{
 		ANKI_TRACE_SCOPED_EVENT(VK_QUEUE_SUBMIT);
-		ANKI_VK_CHECKF(vkQueueSubmit(m_queue, 1, &submit, fence->getHandle()));
+		ANKI_VK_CHECKF(vkQueueSubmit(m_transferQueue, 1, &submit, fence->getHandle()));
 	}
 
-	if(wait)
+	fence->setSubmitted();
+
+	++m_crntFrameSubmitCount;
+	++m_crntFrameSubmittedCmdbCount;
+
+	if(acquire.m_waitSemaphore)
 	{
-		vkQueueWaitIdle(m_queue);
+		pushPendingCommandBuffer(acquire);
+	}
+}
+
+void GrManagerImpl::pushPendingCommandBuffer(PendingCommandBuffer& pending)
+{
+	ANKI_ASSERT(m_pendingFence);
+	ANKI_ASSERT(m_pendingCmdbCount < m_maxCommandBuffersPerSubmit);
+
+	PendingCommandBuffer& out = m_pendingCmdbs[m_pendingCmdbCount++];
+	out.m_cmdb = std::move(pending.m_cmdb);
+	out.m_microCmdb = std::move(pending.m_microCmdb);
+	out.m_waitSemaphore = std::move(pending.m_waitSemaphore);
+
+	if(m_pendingCmdbCount >= m_maxCommandBuffersPerSubmit)
+	{
+		submitPendingCommandBuffersInternal();
+	}
+}
+
+void GrManagerImpl::submitPendingCommandBuffers(const MicroFencePtr& fence)
+{
+	LockGuard<Mutex> lock(m_globalMtx);
+	if(fence == m_pendingFence)
+	{
+		submitPendingCommandBuffersInternal();
+	}
+}
+
+Bool GrManagerImpl::submitPendingCommandBuffersInternal(VkSemaphore signalSemaphore)
+{
+	if(m_pendingCmdbCount == 0)
+	{
+		ANKI_ASSERT(!m_pendingFence);
+		return false;
 	}
+
+	// Split the command buffers to submits. The one that renders to the default framebuffer and the ones that wait for
+	// the transfer queue need their own because they wait and signal semaphores
+	PerFrame& frame = m_perFrame[m_frame % MAX_FRAMES_IN_FLIGHT];
+	Array<VkCommandBuffer, MAX_COMMAND_BUFFERS_PER_SUBMIT> handles;
+	U32 handleCount = 0;
+	Array<VkSubmitInfo, MAX_COMMAND_BUFFERS_PER_SUBMIT + 1> submits;
+	U32 submitCount = 0;
+	const VkPipelineStageFlags waitFlags =
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+		| VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT; // TODO That depends on how we use the swapchain img
+	const VkPipelineStageFlags transferWaitFlags = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	Bool prevNeedsOwnSubmit = false;
+
+	for(U32 i = 0; i < m_pendingCmdbCount; ++i)
+	{
+		const PendingCommandBuffer& pending = m_pendingCmdbs[i];
+		const CommandBufferImpl* impl = static_cast<const CommandBufferImpl*>(pending.m_cmdb.get());
+
+		const Bool renderedToDefaultFb = impl && impl->renderedToDefaultFramebuffer();
+		const Bool needsOwnSubmit = renderedToDefaultFb || pending.m_waitSemaphore;
+
+		if(i == 0 || needsOwnSubmit || prevNeedsOwnSubmit)
+		{
+			VkSubmitInfo& submit = submits[submitCount++];
+			submit = {};
+			submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submit.pCommandBuffers = &handles[handleCount];
+
+			if(renderedToDefaultFb)
+			{
+				submit.pWaitSemaphores = &frame.m_acquireSemaphore->getHandle();
+				submit.pWaitDstStageMask = &waitFlags;
+				submit.waitSemaphoreCount = 1;
+
+				submit.signalSemaphoreCount = 1;
+				submit.pSignalSemaphores = &frame.m_renderSemaphore->getHandle();
+			}
+			else if(pending.m_waitSemaphore)
+			{
+				submit.pWaitSemaphores = &pending.m_waitSemaphore->getHandle();
+				submit.pWaitDstStageMask = &transferWaitFlags;
+				submit.waitSemaphoreCount = 1;
+			}
+		}
+
+		prevNeedsOwnSubmit = needsOwnSubmit;
+
+		if(impl)
+		{
+			handles[handleCount++] = impl->getHandle();
+			++submits[submitCount - 1].commandBufferCount;
+		}
+		else if(pending.m_microCmdb)
+		{
+			handles[handleCount++] = pending.m_microCmdb->getHandle();
+			++submits[submitCount - 1].commandBufferCount;
+		}
+	}
+
+	// Signal the extra semaphore with the last submit. If that signals already then add an empty submit to the batch
+	if(signalSemaphore)
+	{
+		if(submits[submitCount - 1].signalSemaphoreCount > 0)
+		{
+			VkSubmitInfo& submit = submits[submitCount++];
+			submit = {};
+			submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		}
+
+		submits[submitCount - 1].signalSemaphoreCount = 1;
+		submits[submitCount - 1].pSignalSemaphores = &signalSemaphore;
+	}
+
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_QUEUE_SUBMIT);
+		ANKI_VK_CHECKF(vkQueueSubmit(m_queue, submitCount, &submits[0], m_pendingFence->getHandle()));
+	}
+
+	m_pendingFence->setSubmitted();
+
+	++m_crntFrameSubmitCount;
+	m_crntFrameSubmittedCmdbCount += handleCount;
+
+	// Reset the batch
+	for(U32 i = 0; i < m_pendingCmdbCount; ++i)
+	{
+		m_pendingCmdbs[i] = PendingCommandBuffer();
+	}
+	m_pendingCmdbCount = 0;
+	m_pendingFence.reset(nullptr);
+
+	return true;
 }
 
 void GrManagerImpl::finish()
 {
 	LockGuard<Mutex> lock(m_globalMtx);
+	submitPendingCommandBuffersInternal();
+	if(m_transferQueue)
+	{
+		vkQueueWaitIdle(m_transferQueue);
+	}
 	vkQueueWaitIdle(m_queue);
 }
 
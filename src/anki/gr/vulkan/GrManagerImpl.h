@@ -18,9 +18,11 @@
 #include <anki/gr/vulkan/SwapchainFactory.h>
 #include <anki/gr/vulkan/PipelineLayout.h>
 #include <anki/gr/vulkan/PipelineCache.h>
+#include <anki/gr/vulkan/PipelineCompiler.h>
 #include <anki/gr/vulkan/DescriptorSet.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/File.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -30,6 +32,7 @@ namespace anki
 
 // Forward
 class TextureFallbackUploader;
+class CommandBufferImpl;
 class ConfigSet;
 
 /// @addtogroup vulkan
@@ -52,6 +55,24 @@ public:
 		return m_queueIdx;
 	}
 
+	/// Return true if there is a dedicated transfer queue.
+	Bool hasTransferQueue() const
+	{
+		return m_transferQueue != VK_NULL_HANDLE;
+	}
+
+	U32 getTransferQueueFamily() const
+	{
+		ANKI_ASSERT(hasTransferQueue());
+		return m_transferQueueIdx;
+	}
+
+	/// Get the queue families that the buffers are shared with.
+	ConstWeakArray<U32> getBufferQueueFamilies() const
+	{
+		return ConstWeakArray<U32>(&m_bufferQueueFamilies[0], (hasTransferQueue()) ? 2 : 1);
+	}
+
 	const VkPhysicalDeviceProperties& getPhysicalDeviceProperties() const
 	{
 		return m_devProps;
@@ -88,6 +109,12 @@ public:
 		return m_cmdbFactory;
 	}
 
+	CommandBufferFactory& getTransferCommandBufferFactory()
+	{
+		ANKI_ASSERT(hasTransferQueue());
+		return m_transferCmdbFactory;
+	}
+
 	MicroFencePtr newFence()
 	{
 		return m_fences.newInstance();
@@ -99,8 +126,24 @@ public:
 	}
 	/// @}
 
+	/// Flush a command buffer. The command buffers are submitted to the queue in batches. A batch is submitted when it's
+	/// full, when someone waits for its fence or at the end of the frame.
 	void flushCommandBuffer(CommandBufferPtr ptr, FencePtr* fence, Bool wait = false);
 
+	/// Submit the batch of command buffers that the fence belongs to, if it's not submitted yet.
+	/// @note It's thread-safe.
+	void submitPendingCommandBuffers(const MicroFencePtr& fence);
+
+	U32 getPreviousFrameQueueSubmitCount() const
+	{
+		return m_prevFrameSubmitCount.load();
+	}
+
+	U32 getPreviousFrameSubmittedCommandBufferCount() const
+	{
+		return m_prevFrameSubmittedCmdbCount.load();
+	}
+
 	/// @name Memory
 	/// @{
 	GpuMemoryManager& getGpuMemoryManager()
@@ -149,12 +192,27 @@ public:
 		return m_descrFactory;
 	}
 
+	const DescriptorSetFactory& getDescriptorSetFactory() const
+	{
+		return m_descrFactory;
+	}
+
 	VkPipelineCache getPipelineCache() const
 	{
 		ANKI_ASSERT(m_pplineCache.m_cacheHandle);
 		return m_pplineCache.m_cacheHandle;
 	}
 
+	PipelineCompiler& getPipelineCompiler()
+	{
+		return m_pplineCompiler;
+	}
+
+	const PipelineCompiler& getPipelineCompiler() const
+	{
+		return m_pplineCompiler;
+	}
+
 	PipelineLayoutFactory& getPipelineLayoutFactory()
 	{
 		return m_pplineLayoutFactory;
@@ -254,6 +312,9 @@ private:
 	VkDevice m_device = VK_NULL_HANDLE;
 	U32 m_queueIdx = MAX_U32;
 	VkQueue m_queue = VK_NULL_HANDLE;
+	U32 m_transferQueueIdx = MAX_U32;
+	VkQueue m_transferQueue = VK_NULL_HANDLE; ///< The dedicated transfer queue or null.
+	Array<U32, 2> m_bufferQueueFamilies = {};
 	Mutex m_globalMtx;
 
 	VkPhysicalDeviceProperties m_devProps = {};
@@ -295,6 +356,38 @@ private:
 	/// @}
 
 	CommandBufferFactory m_cmdbFactory;
+	CommandBufferFactory m_transferCmdbFactory;
+
+	/// @name Submission
+	/// @{
+	static const U32 MAX_COMMAND_BUFFERS_PER_SUBMIT = 32;
+
+	/// A command buffer that waits to be submitted to the graphics queue.
+	class PendingCommandBuffer
+	{
+	public:
+		CommandBufferPtr m_cmdb;
+
+		/// An internal command buffer that acquires the resources uploaded in the transfer queue.
+		MicroCommandBufferPtr m_microCmdb;
+
+		/// Wait for the transfer queue.
+		MicroSemaphorePtr m_waitSemaphore;
+	};
+
+	/// The command buffers that have been flushed but not submitted. They all share m_pendingFence. The internal users
+	/// of the fence (recyclers, swapchain) only poll it and it reports not done until it's submitted.
+	/// Fence::clientWait() submits the batch before waiting.
+	Array<PendingCommandBuffer, MAX_COMMAND_BUFFERS_PER_SUBMIT> m_pendingCmdbs;
+	U32 m_pendingCmdbCount = 0;
+	MicroFencePtr m_pendingFence;
+	U32 m_maxCommandBuffersPerSubmit = 1;
+
+	U32 m_crntFrameSubmitCount = 0;
+	U32 m_crntFrameSubmittedCmdbCount = 0;
+	Atomic<U32> m_prevFrameSubmitCount = {0};
+	Atomic<U32> m_prevFrameSubmittedCmdbCount = {0};
+	/// @}
 
 	FenceFactory m_fences;
 	SemaphoreFactory m_semaphores;
@@ -312,6 +405,7 @@ private:
 	QueryFactory m_timestampQueryFactory;
 
 	PipelineCache m_pplineCache;
+	PipelineCompiler m_pplineCompiler;
 
 	BindlessDescriptorSet m_bindlessDset;
 
@@ -341,6 +435,17 @@ private:
 
 	void resetFrame(PerFrame& frame);
 
+	/// Submit the pending command buffers. m_globalMtx should be locked.
+	/// @param signalSemaphore Optionally signal a semaphore when the batch is done.
+	/// @return True if there was something to submit.
+	Bool submitPendingCommandBuffersInternal(VkSemaphore signalSemaphore = VK_NULL_HANDLE);
+
+	/// Add a command buffer to the pending batch. m_globalMtx should be locked.
+	void pushPendingCommandBuffer(PendingCommandBuffer& pending);
+
+	/// Submit a command buffer to the transfer queue. m_globalMtx should be locked.
+	void flushTransferCommandBuffer(CommandBufferImpl& impl, FencePtr* outFence);
+
 	static VkBool32 debugReportCallbackEXT(VkDebugReportFlagsEXT flags,
 		VkDebugReportObjectTypeEXT objectType,
 		uint64_t object,
@@ -5,12 +5,46 @@
 
 #include <anki/gr/vulkan/Pipeline.h>
 #include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/gr/vulkan/PipelineCompiler.h>
 #include <anki/gr/utils/Functions.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
 
+template<typename T>
+static void rebasePointer(const PipelineCreateInfo& src, PipelineCreateInfo& dst, T*& ptr)
+{
+	const U8* begin = reinterpret_cast<const U8*>(&src);
+	const U8* p = reinterpret_cast<const U8*>(ptr);
+	if(p >= begin && p < begin + sizeof(src))
+	{
+		ptr = reinterpret_cast<T*>(reinterpret_cast<U8*>(&dst) + (p - begin));
+	}
+}
+
+void PipelineCreateInfo::copyTo(PipelineCreateInfo& b) const
+{
+	memcpy(&b, this, sizeof(*this));
+
+	rebasePointer(*this, b, b.m_vert.pVertexBindingDescriptions);
+	rebasePointer(*this, b, b.m_vert.pVertexAttributeDescriptions);
+	rebasePointer(*this, b, b.m_rast.pNext);
+	rebasePointer(*this, b, b.m_color.pAttachments);
+
+	VkGraphicsPipelineCreateInfo& ci = b.m_ppline;
+	rebasePointer(*this, b, ci.pVertexInputState);
+	rebasePointer(*this, b, ci.pInputAssemblyState);
+	rebasePointer(*this, b, ci.pTessellationState);
+	rebasePointer(*this, b, ci.pViewportState);
+	rebasePointer(*this, b, ci.pRasterizationState);
+	rebasePointer(*this, b, ci.pMultisampleState);
+	rebasePointer(*this, b, ci.pDepthStencilState);
+	rebasePointer(*this, b, ci.pColorBlendState);
+	rebasePointer(*this, b, ci.pDynamicState);
+}
+
 void PipelineStateTracker::reset()
 {
 	m_state.reset();
@@ -393,7 +427,8 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 class PipelineFactory::PipelineInternal
 {
 public:
-	VkPipeline m_handle = VK_NULL_HANDLE;
+	VkPipeline m_handle = VK_NULL_HANDLE; ///< If it's null the pipeline is being compiled in the background.
+	Bool m_prewarming = false; ///< It's queued by the prewarming and no drawcall asked for it yet.
 
 	/// The pipeline needs a render pass and the framebuffers are the owners of that. So the internal pipeline will
 	/// hold a ref to the FB in order to hold a ref to the render pass.
@@ -423,7 +458,7 @@ void PipelineFactory::destroy()
 	m_pplines.destroy(m_alloc);
 }
 
-void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty)
+Bool PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty)
 {
 	U64 hash;
 	state.flush(hash, stateDirty);
@@ -431,37 +466,120 @@ void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline,
 	if(ANKI_UNLIKELY(!stateDirty))
 	{
 		ppline.m_handle = VK_NULL_HANDLE;
-		return;
+		return true;
 	}
 
-	LockGuard<SpinLock> lock(m_pplinesMtx);
-
-	auto it = m_pplines.find(hash);
-	if(it != m_pplines.getEnd())
+	const Bool async = m_compiler->getAsyncCompilation();
+	while(true)
 	{
-		ppline.m_handle = (*it).m_handle;
+		{
+			LockGuard<SpinLock> lock(m_pplinesMtx);
+
+			auto it = m_pplines.find(hash);
+			if(it != m_pplines.getEnd() && (*it).m_handle)
+			{
+				ppline.m_handle = (*it).m_handle;
+				return true;
+			}
+			else if(it == m_pplines.getEnd() && async)
+			{
+				// Compile it in the background. Leave the handle empty to mark it as compiling
+				PipelineInternal pp;
+				pp.m_fb = state.getFb();
+				m_pplines.emplace(m_alloc, hash, pp);
+
+				m_compiler->compilePipeline(*this, hash, state, false);
+				m_compiler->recordPipeline(state);
+				break;
+			}
+			else if(it == m_pplines.getEnd())
+			{
+				PipelineInternal pp;
+				pp.m_fb = state.getFb();
+				pp.m_handle = compilePipeline(state, hash);
+				m_pplines.emplace(m_alloc, hash, pp);
+				ppline.m_handle = pp.m_handle;
+
+				m_compiler->recordPipeline(state);
+				return true;
+			}
+			else if((*it).m_prewarming)
+			{
+				// The prewarming queued it and it might be behind many others. Don't wait for them
+				(*it).m_prewarming = false;
+				if(async)
+				{
+					m_compiler->prioritizePipeline(*this, hash);
+					break;
+				}
+				else if(m_compiler->cancelPipeline(*this, hash))
+				{
+					(*it).m_fb = state.getFb();
+					(*it).m_handle = compilePipeline(state, hash);
+					ppline.m_handle = (*it).m_handle;
+					return true;
+				}
+			}
+			else if(async)
+			{
+				// Still compiling
+				break;
+			}
+		}
+
+		// A thread is compiling it, wait for it
+		HighRezTimer::sleep(0.0001);
 	}
-	else
+
+	// Not ready. Make the next drawcall to look for the pipeline again
+	state.m_hashes.m_lastSuperHash = 0;
+	return false;
+}
+
+VkPipeline PipelineFactory::compilePipeline(PipelineStateTracker& state, U64 hash)
+{
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
+
+	VkPipeline handle;
 	{
-		PipelineInternal pp;
-		const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
-		pp.m_fb = state.getFb();
+		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &handle));
+	}
 
-		{
-			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
-		}
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+	m_compiler->incrementCreatedPipelineCount();
 
-		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+	// Print shader info
+	const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
+	shaderImpl.getGrManagerImpl().printPipelineShaderInfo(handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
 
-		m_pplines.emplace(m_alloc, hash, pp);
-		ppline.m_handle = pp.m_handle;
+	return handle;
+}
 
-		// Print shader info
-		const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
-		shaderImpl.getGrManagerImpl().printPipelineShaderInfo(
-			pp.m_handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+void PipelineFactory::prewarmPipeline(PipelineStateTracker& state)
+{
+	U64 hash;
+	Bool stateDirty;
+	state.flush(hash, stateDirty);
+
+	LockGuard<SpinLock> lock(m_pplinesMtx);
+
+	if(m_pplines.find(hash) == m_pplines.getEnd())
+	{
+		PipelineInternal pp;
+		pp.m_prewarming = true;
+		m_pplines.emplace(m_alloc, hash, pp);
+		m_compiler->compilePipeline(*this, hash, state, true);
 	}
 }
 
+void PipelineFactory::onPipelineCompiled(U64 hash, VkPipeline handle)
+{
+	LockGuard<SpinLock> lock(m_pplinesMtx);
+
+	auto it = m_pplines.find(hash);
+	ANKI_ASSERT(it != m_pplines.getEnd() && !(*it).m_handle);
+	(*it).m_handle = handle;
+}
+
 } // end namespace anki
@@ -15,6 +15,9 @@
 namespace anki
 {
 
+// Forward
+class PipelineCompiler;
+
 /// @addtogroup vulkan
 /// @{
 
@@ -173,10 +176,34 @@ public:
 	}
 };
 
+/// The create info of a graphics pipeline. The structures point to each other.
+class PipelineCreateInfo
+{
+public:
+	Array<VkVertexInputBindingDescription, MAX_VERTEX_ATTRIBUTES> m_vertBindings;
+	Array<VkVertexInputAttributeDescription, MAX_VERTEX_ATTRIBUTES> m_attribs;
+	VkPipelineVertexInputStateCreateInfo m_vert;
+	VkPipelineInputAssemblyStateCreateInfo m_ia;
+	VkPipelineViewportStateCreateInfo m_vp;
+	VkPipelineTessellationStateCreateInfo m_tess;
+	VkPipelineRasterizationStateCreateInfo m_rast;
+	VkPipelineMultisampleStateCreateInfo m_ms;
+	VkPipelineDepthStencilStateCreateInfo m_ds;
+	Array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> m_colAttachments;
+	VkPipelineColorBlendStateCreateInfo m_color;
+	VkPipelineDynamicStateCreateInfo m_dyn;
+	VkGraphicsPipelineCreateInfo m_ppline;
+	VkPipelineRasterizationStateRasterizationOrderAMD m_rasterOrder;
+
+	/// Copy and fix the pointers that point inside this object to point inside @a b.
+	void copyTo(PipelineCreateInfo& b) const;
+};
+
 /// Track changes in the static state.
 class PipelineStateTracker : public NonCopyable
 {
 	friend class PipelineFactory;
+	friend class PipelineCompiler;
 
 public:
 	PipelineStateTracker()
@@ -512,25 +539,7 @@ private:
 		}
 	} m_hashes;
 
-	// Create info
-	class CreateInfo
-	{
-	public:
-		Array<VkVertexInputBindingDescription, MAX_VERTEX_ATTRIBUTES> m_vertBindings;
-		Array<VkVertexInputAttributeDescription, MAX_VERTEX_ATTRIBUTES> m_attribs;
-		VkPipelineVertexInputStateCreateInfo m_vert;
-		VkPipelineInputAssemblyStateCreateInfo m_ia;
-		VkPipelineViewportStateCreateInfo m_vp;
-		VkPipelineTessellationStateCreateInfo m_tess;
-		VkPipelineRasterizationStateCreateInfo m_rast;
-		VkPipelineMultisampleStateCreateInfo m_ms;
-		VkPipelineDepthStencilStateCreateInfo m_ds;
-		Array<VkPipelineColorBlendAttachmentState, MAX_COLOR_ATTACHMENTS> m_colAttachments;
-		VkPipelineColorBlendStateCreateInfo m_color;
-		VkPipelineDynamicStateCreateInfo m_dyn;
-		VkGraphicsPipelineCreateInfo m_ppline;
-		VkPipelineRasterizationStateRasterizationOrderAMD m_rasterOrder;
-	} m_ci;
+	PipelineCreateInfo m_ci;
 
 	Bool updateHashes();
 	void updateSuperHash();
@@ -564,17 +573,28 @@ public:
 	{
 	}
 
-	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache)
+	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, PipelineCompiler* compiler)
 	{
 		m_alloc = alloc;
 		m_dev = dev;
 		m_pplineCache = pplineCache;
+		m_compiler = compiler;
 	}
 
 	void destroy();
 
+	/// Get or create a pipeline.
+	/// @return False if the pipeline is still being compiled in the background and the drawcall should be skipped.
+	/// @note Thread-safe.
+	ANKI_USE_RESULT Bool newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty);
+
+	/// Start compiling a pipeline in the background if it doesn't exist.
 	/// @note Thread-safe.
-	void newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty);
+	void prewarmPipeline(PipelineStateTracker& state);
+
+	/// The PipelineCompiler calls this when a background compilation is done.
+	/// @note Thread-safe.
+	void onPipelineCompiled(U64 hash, VkPipeline handle);
 
 private:
 	class PipelineInternal;
@@ -583,9 +603,13 @@ private:
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
 	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+	PipelineCompiler* m_compiler = nullptr;
 
 	HashMap<U64, PipelineInternal, Hasher> m_pplines;
 	SpinLock m_pplinesMtx;
+
+	/// Create a pipeline in the calling thread.
+	VkPipeline compilePipeline(PipelineStateTracker& state, U64 hash);
 };
 /// @}
 
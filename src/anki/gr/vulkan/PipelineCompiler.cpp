@@ -0,0 +1,563 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/PipelineCompiler.h>
+#include <anki/gr/vulkan/GrManagerImpl.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+#include <anki/util/Tracer.h>
+#include <algorithm>
+
+namespace anki
+{
+
+class PipelineCompiler::Job : public IntrusiveListEnabled<Job>
+{
+public:
+	PipelineFactory* m_factory = nullptr;
+	U64 m_hash = 0;
+	ShaderProgramPtr m_prog; ///< Hold a ref to the program to keep the factory and the shader modules alive.
+	FramebufferPtr m_fb; ///< Hold a ref to the render pass. Empty for the prewarming jobs.
+	PipelineCreateInfo m_ci;
+};
+
+/// The manifest stores the entries as they are.
+class PipelineCompiler::ManifestEntry
+{
+public:
+	U64 m_programHash;
+	Array<U8, sizeof(PipelineInfoState)> m_state; ///< The PipelineInfoState without the program.
+	BitSet<MAX_VERTEX_ATTRIBUTES, U8> m_setAttribs = {false};
+	BitSet<MAX_VERTEX_ATTRIBUTES, U8> m_setVertBindings = {false};
+	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_colorAttachmentMask = {false};
+	Bool m_depth;
+	Bool m_stencil;
+	Bool m_defaultFb;
+	Array<VkFormat, MAX_COLOR_ATTACHMENTS + 1> m_formats; ///< The color formats and then the depth stencil format.
+};
+
+class PipelineCompiler::ManifestHeader
+{
+public:
+	Array<char, 8> m_magic;
+	U32 m_version;
+	U32 m_entryCount;
+	U64 m_layoutHash; ///< See computeManifestLayoutHash().
+	U64 m_entriesHash; ///< The hash of all the entries. To catch truncated or corrupted files.
+};
+
+PipelineCompiler::PipelineCompiler()
+{
+}
+
+PipelineCompiler::~PipelineCompiler()
+{
+	ANKI_ASSERT(m_threads.getSize() == 0 && "Forgot to call destroy()");
+}
+
+Error PipelineCompiler::init(
+	GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, CString cacheDir, const ConfigSet& cfg)
+{
+	ANKI_ASSERT(dev && cacheDir);
+	m_alloc = alloc;
+	m_dev = dev;
+	m_pplineCache = pplineCache;
+	m_asyncCompilation = cfg.getBool("gr_asyncPipelines");
+	m_manifestEnabled = cfg.getBool("gr_pipelineManifest");
+
+	if(m_manifestEnabled)
+	{
+		m_manifestFilename.sprintf(m_alloc, "%s/vk_pipeline_manifest", &cacheDir[0]);
+		ANKI_CHECK(loadManifest());
+	}
+
+	m_threads.create(m_alloc, cfg.getNumberU32("gr_pipelineCompilerThreadCount"));
+	for(U32 i = 0; i < m_threads.getSize(); ++i)
+	{
+		m_threads[i] = m_alloc.newInstance<Thread>("anki_pplcomp");
+		m_threads[i]->start(this, threadCallback);
+	}
+
+	return Error::NONE;
+}
+
+void PipelineCompiler::destroy()
+{
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_quit = true;
+		m_condVar.notifyAll();
+	}
+
+	for(U32 i = 0; i < m_threads.getSize(); ++i)
+	{
+		Error err = m_threads[i]->join();
+		(void)err;
+		m_alloc.deleteInstance(m_threads[i]);
+	}
+	m_threads.destroy(m_alloc);
+
+	// The pipelines that didn't make it will not be needed
+	while(!m_jobs.isEmpty())
+	{
+		m_alloc.deleteInstance(m_jobs.popFront());
+	}
+
+	if(m_manifestEnabled && storeManifest())
+	{
+		ANKI_VK_LOGE("An error occurred while storing the pipeline manifest to disk. Will ignore");
+	}
+
+	m_manifestFilename.destroy(m_alloc);
+	m_replayEntries.destroy(m_alloc);
+	m_recordedEntries.destroy(m_alloc);
+
+	for(VkRenderPass rpass : m_rpasses)
+	{
+		vkDestroyRenderPass(m_dev, rpass, nullptr);
+	}
+	m_rpasses.destroy(m_alloc);
+}
+
+Error PipelineCompiler::threadCallback(ThreadCallbackInfo& info)
+{
+	PipelineCompiler& self = *static_cast<PipelineCompiler*>(info.m_userData);
+	self.threadWorker();
+	return Error::NONE;
+}
+
+void PipelineCompiler::threadWorker()
+{
+	while(true)
+	{
+		Job* job;
+
+		{
+			LockGuard<Mutex> lock(m_mtx);
+			while(m_jobs.isEmpty() && !m_quit)
+			{
+				m_condVar.wait(m_mtx);
+			}
+
+			if(m_quit)
+			{
+				break;
+			}
+
+			job = m_jobs.popFront();
+		}
+
+		VkPipeline ppline;
+		{
+			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &job->m_ci.m_ppline, nullptr, &ppline));
+		}
+
+		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+		incrementCreatedPipelineCount();
+
+		// Print shader info
+		const ShaderProgramImpl& progImpl = static_cast<const ShaderProgramImpl&>(*job->m_prog);
+		progImpl.getGrManagerImpl().printPipelineShaderInfo(
+			ppline, progImpl.getName(), progImpl.getStages(), job->m_hash);
+
+		job->m_factory->onPipelineCompiled(job->m_hash, ppline);
+		m_alloc.deleteInstance(job);
+	}
+}
+
+void PipelineCompiler::compilePipeline(PipelineFactory& factory, U64 hash, PipelineStateTracker& state, Bool prewarm)
+{
+	Job* job = m_alloc.newInstance<Job>();
+	job->m_factory = &factory;
+	job->m_hash = hash;
+	job->m_prog = state.m_state.m_prog;
+	job->m_fb = state.m_fb;
+
+	state.updatePipelineCreateInfo();
+	state.m_ci.copyTo(job->m_ci);
+
+	LockGuard<Mutex> lock(m_mtx);
+	if(prewarm)
+	{
+		m_jobs.pushBack(job);
+	}
+	else
+	{
+		m_jobs.pushFront(job);
+	}
+	m_condVar.notifyOne();
+}
+
+PipelineCompiler::Job* PipelineCompiler::findJob(const PipelineFactory& factory, U64 hash)
+{
+	for(Job& job : m_jobs)
+	{
+		if(job.m_factory == &factory && job.m_hash == hash)
+		{
+			return &job;
+		}
+	}
+
+	return nullptr;
+}
+
+void PipelineCompiler::prioritizePipeline(const PipelineFactory& factory, U64 hash)
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	Job* job = findJob(factory, hash);
+	if(job)
+	{
+		m_jobs.erase(job);
+		m_jobs.pushFront(job);
+	}
+}
+
+Bool PipelineCompiler::cancelPipeline(const PipelineFactory& factory, U64 hash)
+{
+	Job* job;
+	{
+		LockGuard<Mutex> lock(m_mtx);
+
+		job = findJob(factory, hash);
+		if(job)
+		{
+			m_jobs.erase(job);
+		}
+	}
+
+	if(job)
+	{
+		m_alloc.deleteInstance(job);
+	}
+
+	return job != nullptr;
+}
+
+void PipelineCompiler::recordPipeline(const PipelineStateTracker& state)
+{
+	if(!m_manifestEnabled)
+	{
+		return;
+	}
+
+	// Zero it because it will be hashed and stored as it is
+	ManifestEntry entry;
+	zeroMemory(entry);
+
+	const ShaderProgramImpl& progImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
+	entry.m_programHash = progImpl.getContentHash();
+
+	ANKI_ASSERT(reinterpret_cast<const U8*>(&state.m_state.m_prog) == reinterpret_cast<const U8*>(&state.m_state));
+	memcpy(&entry.m_state[sizeof(ShaderProgramPtr)],
+		reinterpret_cast<const U8*>(&state.m_state) + sizeof(ShaderProgramPtr),
+		sizeof(PipelineInfoState) - sizeof(ShaderProgramPtr));
+
+	entry.m_setAttribs = state.m_set.m_attribs;
+	entry.m_setVertBindings = state.m_set.m_vertBindings;
+	entry.m_colorAttachmentMask = state.m_fbColorAttachmentMask;
+	entry.m_depth = state.m_fbDepth;
+	entry.m_stencil = state.m_fbStencil;
+	entry.m_defaultFb = state.m_defaultFb;
+
+	const FramebufferImpl& fbImpl = static_cast<const FramebufferImpl&>(*state.m_fb);
+	for(U32 i = 0; i < fbImpl.getAttachmentCount(); ++i)
+	{
+		entry.m_formats[i] = fbImpl.getAttachmentFormat(i);
+	}
+
+	const U64 key = computeHash(&entry, sizeof(entry));
+
+	LockGuard<Mutex> lock(m_recordedEntriesMtx);
+	if(m_recordedEntries.find(key) == m_recordedEntries.getEnd())
+	{
+		m_recordedEntries.emplace(m_alloc, key, entry);
+	}
+}
+
+void PipelineCompiler::prewarmPipelines(const ShaderProgramPtr& prog)
+{
+	ShaderProgramImpl& progImpl = static_cast<ShaderProgramImpl&>(*prog);
+	if(m_replayEntries.getSize() == 0 || !progImpl.isGraphics())
+	{
+		return;
+	}
+
+	const U64 programHash = progImpl.getContentHash();
+	const ManifestEntry* it = std::lower_bound(m_replayEntries.getBegin(),
+		m_replayEntries.getEnd(),
+		programHash,
+		[](const ManifestEntry& entry, U64 hash) { return entry.m_programHash < hash; });
+
+	U32 count = 0;
+	for(; it != m_replayEntries.getEnd() && it->m_programHash == programHash; ++it)
+	{
+		PipelineStateTracker state;
+		state.bindShaderProgram(prog);
+		memcpy(reinterpret_cast<U8*>(&state.m_state) + sizeof(ShaderProgramPtr),
+			&it->m_state[sizeof(ShaderProgramPtr)],
+			sizeof(PipelineInfoState) - sizeof(ShaderProgramPtr));
+
+		state.m_set.m_attribs = it->m_setAttribs;
+		state.m_set.m_vertBindings = it->m_setVertBindings;
+		state.m_fbColorAttachmentMask = it->m_colorAttachmentMask;
+		state.m_fbDepth = it->m_depth;
+		state.m_fbStencil = it->m_stencil;
+		state.m_defaultFb = it->m_defaultFb;
+		state.m_rpass = getCompatibleRenderPass(*it);
+
+		progImpl.getPipelineFactory().prewarmPipeline(state);
+		++count;
+	}
+
+	m_prewarmedPipelineCount.fetchAdd(count);
+
+	if(count)
+	{
+		ANKI_VK_LOGI("Prewarming %u pipelines of program: %s", count, progImpl.getName().cstr());
+	}
+}
+
+VkRenderPass PipelineCompiler::getCompatibleRenderPass(const ManifestEntry& entry)
+{
+	U64 hash = computeHash(&entry.m_formats[0], sizeof(entry.m_formats));
+	hash = appendHash(&entry.m_colorAttachmentMask, sizeof(entry.m_colorAttachmentMask), hash);
+	const Bool hasDepthStencil = entry.m_depth || entry.m_stencil;
+	hash = appendHash(&hasDepthStencil, sizeof(hasDepthStencil), hash);
+
+	LockGuard<Mutex> lock(m_rpassesMtx);
+
+	auto it = m_rpasses.find(hash);
+	if(it != m_rpasses.getEnd())
+	{
+		return *it;
+	}
+
+	// Create a render pass that has the same formats. The layouts and the load/store operations don't affect the
+	// compatibility
+	Array<VkAttachmentDescription, MAX_COLOR_ATTACHMENTS + 1> attachments = {};
+	Array<VkAttachmentReference, MAX_COLOR_ATTACHMENTS + 1> references = {};
+	const U32 colorAttachmentCount = entry.m_colorAttachmentMask.getEnabledBitCount();
+	const U32 attachmentCount = colorAttachmentCount + ((hasDepthStencil) ? 1 : 0);
+	for(U32 i = 0; i < attachmentCount; ++i)
+	{
+		const VkImageLayout layout = (i < colorAttachmentCount) ? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+																: VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentDescription& desc = attachments[i];
+		desc.format = entry.m_formats[i];
+		desc.samples = VK_SAMPLE_COUNT_1_BIT;
+		desc.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		desc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		desc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_STORE;
+		desc.initialLayout = layout;
+		desc.finalLayout = layout;
+
+		references[i].attachment = i;
+		references[i].layout = layout;
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = colorAttachmentCount;
+	subpass.pColorAttachments = (colorAttachmentCount) ? &references[0] : nullptr;
+	subpass.pDepthStencilAttachment = (hasDepthStencil) ? &references[colorAttachmentCount] : nullptr;
+
+	VkRenderPassCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	ci.attachmentCount = attachmentCount;
+	ci.pAttachments = &attachments[0];
+	ci.subpassCount = 1;
+	ci.pSubpasses = &subpass;
+
+	VkRenderPass rpass;
+	ANKI_VK_CHECKF(vkCreateRenderPass(m_dev, &ci, nullptr, &rpass));
+	m_rpasses.emplace(m_alloc, hash, rpass);
+
+	return rpass;
+}
+
+Error PipelineCompiler::loadManifest()
+{
+	if(!fileExists(m_manifestFilename.toCString()))
+	{
+		ANKI_VK_LOGI("Pipeline manifest not found: %s", &m_manifestFilename[0]);
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_manifestFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::READ));
+
+	ManifestHeader header;
+	const PtrSize fileSize = file.getSize();
+	if(fileSize >= sizeof(header))
+	{
+		ANKI_CHECK(file.read(&header, sizeof(header)));
+	}
+
+	if(fileSize < sizeof(header) || memcmp(&header.m_magic[0], MANIFEST_MAGIC, sizeof(header.m_magic)) != 0
+		|| header.m_version != MANIFEST_VERSION || header.m_layoutHash != computeManifestLayoutHash()
+		|| fileSize != sizeof(header) + PtrSize(header.m_entryCount) * sizeof(ManifestEntry))
+	{
+		ANKI_VK_LOGI("Pipeline manifest is not compatible. Will ignore it: %s", &m_manifestFilename[0]);
+		return Error::NONE;
+	}
+
+	if(header.m_entryCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	DynamicArrayAuto<ManifestEntry> entries(m_alloc);
+	entries.create(header.m_entryCount);
+	ANKI_CHECK(file.read(&entries[0], entries.getSizeInBytes()));
+
+	if(computeHash(&entries[0], entries.getSizeInBytes()) != header.m_entriesHash)
+	{
+		ANKI_VK_LOGW("Pipeline manifest is corrupted. Will ignore it: %s", &m_manifestFilename[0]);
+		return Error::NONE;
+	}
+
+	// Keep the entries that make sense
+	U32 validCount = 0;
+	for(const ManifestEntry& entry : entries)
+	{
+		if(validateManifestEntry(entry))
+		{
+			entries[validCount++] = entry;
+		}
+	}
+
+	if(validCount < entries.getSize())
+	{
+		ANKI_VK_LOGW("Dropped %u invalid entries from the pipeline manifest", entries.getSize() - validCount);
+	}
+
+	if(validCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	m_replayEntries.create(m_alloc, validCount);
+	memcpy(&m_replayEntries[0], &entries[0], m_replayEntries.getSizeInBytes());
+
+	std::sort(m_replayEntries.getBegin(), m_replayEntries.getEnd(), [](const ManifestEntry& a, const ManifestEntry& b) {
+		return a.m_programHash < b.m_programHash;
+	});
+
+	// Store them again at the end
+	for(const ManifestEntry& entry : m_replayEntries)
+	{
+		const U64 key = computeHash(&entry, sizeof(entry));
+		if(m_recordedEntries.find(key) == m_recordedEntries.getEnd())
+		{
+			m_recordedEntries.emplace(m_alloc, key, entry);
+		}
+	}
+
+	ANKI_VK_LOGI("Loaded %u entries from the pipeline manifest", validCount);
+	return Error::NONE;
+}
+
+Error PipelineCompiler::storeManifest()
+{
+	ManifestHeader header;
+	memcpy(&header.m_magic[0], MANIFEST_MAGIC, sizeof(header.m_magic));
+	header.m_version = MANIFEST_VERSION;
+	header.m_layoutHash = computeManifestLayoutHash();
+	header.m_entryCount = 0;
+	header.m_entriesHash = 0;
+	for(const ManifestEntry& entry : m_recordedEntries)
+	{
+		header.m_entriesHash = (header.m_entryCount == 0) ? computeHash(&entry, sizeof(entry))
+															: appendHash(&entry, sizeof(entry), header.m_entriesHash);
+		++header.m_entryCount;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_manifestFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::WRITE));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	for(const ManifestEntry& entry : m_recordedEntries)
+	{
+		ANKI_CHECK(file.write(&entry, sizeof(entry)));
+	}
+
+	ANKI_VK_LOGI("Stored %u entries to the pipeline manifest", header.m_entryCount);
+	return Error::NONE;
+}
+
+U64 PipelineCompiler::computeManifestLayoutHash()
+{
+	const Array<PtrSize, 16> sizes = {{sizeof(ManifestEntry),
+		sizeof(PipelineInfoState),
+		sizeof(PPVertexBufferBinding),
+		sizeof(PPVertexAttributeBinding),
+		sizeof(PPVertexStateInfo),
+		sizeof(PPInputAssemblerStateInfo),
+		sizeof(PPTessellationStateInfo),
+		sizeof(PPViewportStateInfo),
+		sizeof(PPRasterizerStateInfo),
+		sizeof(PPDepthStateInfo),
+		sizeof(PPStencilStateInfo::S),
+		sizeof(PPColorAttachmentStateInfo),
+		sizeof(PPColorStateInfo),
+		sizeof(Format),
+		MAX_VERTEX_ATTRIBUTES,
+		MAX_COLOR_ATTACHMENTS}};
+
+	return computeHash(&sizes[0], sizeof(sizes));
+}
+
+Bool PipelineCompiler::validateManifestEntry(const ManifestEntry& entry)
+{
+	const PipelineInfoState& state = *reinterpret_cast<const PipelineInfoState*>(&entry.m_state[0]);
+
+	Bool valid = state.m_inputAssembler.m_topology <= PrimitiveTopology::PATCHES;
+	valid = valid && state.m_rasterizer.m_fillMode < FillMode::COUNT;
+	valid = valid && state.m_rasterizer.m_cullMode <= FaceSelectionBit::FRONT_AND_BACK;
+	valid = valid && state.m_rasterizer.m_rasterizationOrder < RasterizationOrder::COUNT;
+	valid = valid && state.m_depth.m_depthCompareFunction < CompareOperation::COUNT;
+
+	for(const PPStencilStateInfo::S& face : state.m_stencil.m_face)
+	{
+		valid = valid && face.m_stencilFailOperation < StencilOperation::COUNT;
+		valid = valid && face.m_stencilPassDepthFailOperation < StencilOperation::COUNT;
+		valid = valid && face.m_stencilPassDepthPassOperation < StencilOperation::COUNT;
+		valid = valid && face.m_compareFunction < CompareOperation::COUNT;
+	}
+
+	for(const PPColorAttachmentStateInfo& att : state.m_color.m_attachments)
+	{
+		valid = valid && att.m_srcBlendFactorRgb < BlendFactor::COUNT && att.m_srcBlendFactorA < BlendFactor::COUNT;
+		valid = valid && att.m_dstBlendFactorRgb < BlendFactor::COUNT && att.m_dstBlendFactorA < BlendFactor::COUNT;
+		valid = valid && att.m_blendFunctionRgb < BlendOperation::COUNT && att.m_blendFunctionA < BlendOperation::COUNT;
+		valid = valid && (att.m_channelWriteMask & ~ColorBit::ALL) == ColorBit::NONE;
+	}
+
+	for(U32 i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
+	{
+		const Bool bindingSet = entry.m_setVertBindings.get(i);
+		valid = valid && (!bindingSet || state.m_vertex.m_bindings[i].m_stepRate < VertexStepRate::COUNT);
+	}
+
+	// The render pass is created assuming the color attachments are the first ones and that they have formats
+	const U32 colorAttachmentCount = entry.m_colorAttachmentMask.getEnabledBitCount();
+	for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+	{
+		valid = valid && entry.m_colorAttachmentMask.get(i) == (i < colorAttachmentCount);
+		valid = valid && (i >= colorAttachmentCount || entry.m_formats[i] != VK_FORMAT_UNDEFINED);
+	}
+
+	const Bool hasDepthStencil = entry.m_depth || entry.m_stencil;
+	valid = valid && (!hasDepthStencil || entry.m_formats[colorAttachmentCount] != VK_FORMAT_UNDEFINED);
+
+	return valid;
+}
+
+} // end namespace anki
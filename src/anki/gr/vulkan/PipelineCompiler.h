@@ -0,0 +1,139 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/vulkan/Pipeline.h>
+#include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/List.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/DynamicArray.h>
+
+namespace anki
+{
+
+// Forward
+class ConfigSet;
+
+/// @addtogroup vulkan
+/// @{
+
+/// Compiles graphics pipelines in worker threads. It also records the pipelines that got created into a manifest that
+/// is stored on disk. Next time a shader program is created the pipelines the manifest has for it are compiled in the
+/// background before the first drawcall needs them.
+class PipelineCompiler
+{
+public:
+	PipelineCompiler();
+
+	~PipelineCompiler();
+
+	ANKI_USE_RESULT Error init(
+		GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, CString cacheDir, const ConfigSet& cfg);
+
+	/// Stop the threads, drop the pending work and store the manifest.
+	void destroy();
+
+	/// If true the drawcalls will be skipped while their pipelines are being compiled.
+	Bool getAsyncCompilation() const
+	{
+		return m_asyncCompilation;
+	}
+
+	/// Compile a pipeline in the background. It will call PipelineFactory::onPipelineCompiled when done.
+	/// @param prewarm If false the pipeline is needed by a drawcall and it will be compiled before the prewarming ones.
+	/// @note Thread-safe.
+	void compilePipeline(PipelineFactory& factory, U64 hash, PipelineStateTracker& state, Bool prewarm);
+
+	/// Move a pending compilation in front of the others. Used when a drawcall needs a pipeline that is being
+	/// prewarmed.
+	/// @note Thread-safe.
+	void prioritizePipeline(const PipelineFactory& factory, U64 hash);
+
+	/// Remove a pending compilation. The caller should compile the pipeline itself.
+	/// @return False if a thread already started compiling it.
+	/// @note Thread-safe.
+	ANKI_USE_RESULT Bool cancelPipeline(const PipelineFactory& factory, U64 hash);
+
+	/// Add the pipeline to the manifest.
+	/// @note Thread-safe.
+	void recordPipeline(const PipelineStateTracker& state);
+
+	/// Start compiling the pipelines the manifest has for a program.
+	/// @note Thread-safe.
+	void prewarmPipelines(const ShaderProgramPtr& prog);
+
+	/// Count a new pipeline. Both the threads and the drawcalls create them.
+	/// @note Thread-safe.
+	void incrementCreatedPipelineCount()
+	{
+		m_createdPipelineCount.fetchAdd(1);
+	}
+
+	/// Get the number of pipelines created so far.
+	U32 getCreatedPipelineCount() const
+	{
+		return m_createdPipelineCount.load();
+	}
+
+	/// Get the number of pipelines the manifest asked to prewarm so far.
+	U32 getPrewarmedPipelineCount() const
+	{
+		return m_prewarmedPipelineCount.load();
+	}
+
+private:
+	class Job;
+	class ManifestEntry;
+	class ManifestHeader;
+
+	static constexpr const char* MANIFEST_MAGIC = "ANKIPSO_";
+	static constexpr U32 MANIFEST_VERSION = 2; ///< Bump it when the pipeline state changes meaning.
+
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+	Bool m_asyncCompilation = false;
+	Bool m_manifestEnabled = false;
+
+	DynamicArray<Thread*> m_threads;
+	Mutex m_mtx;
+	ConditionVariable m_condVar;
+	IntrusiveList<Job> m_jobs;
+	Bool m_quit = false;
+
+	String m_manifestFilename;
+	DynamicArray<ManifestEntry> m_replayEntries; ///< The entries of the stored manifest sorted by program.
+	HashMap<U64, ManifestEntry> m_recordedEntries; ///< The entries to store. Includes the replayed ones.
+	Mutex m_recordedEntriesMtx;
+
+	HashMap<U64, VkRenderPass> m_rpasses; ///< Render passes that are compatible with the replayed entries.
+	Mutex m_rpassesMtx;
+
+	Atomic<U32> m_createdPipelineCount = {0};
+	Atomic<U32> m_prewarmedPipelineCount = {0};
+
+	static ANKI_USE_RESULT Error threadCallback(ThreadCallbackInfo& info);
+
+	void threadWorker();
+
+	/// Find a pending job. Needs m_mtx to be locked.
+	Job* findJob(const PipelineFactory& factory, U64 hash);
+
+	ANKI_USE_RESULT Error loadManifest();
+	ANKI_USE_RESULT Error storeManifest();
+
+	/// Hash the size of the structures that are stored in the manifest to catch changes of the layout.
+	static U64 computeManifestLayoutHash();
+
+	/// Check that the enums of the stored state have valid values.
+	static Bool validateManifestEntry(const ManifestEntry& entry);
+
+	VkRenderPass getCompatibleRenderPass(const ManifestEntry& entry);
+};
+/// @}
+
+} // end namespace anki
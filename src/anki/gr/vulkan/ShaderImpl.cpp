@@ -106,6 +106,14 @@ Error ShaderImpl::init(const ShaderInitInfo& inf)
 		}
 	}
 
+	// Compute the hash
+	m_contentHash = computeHash(&inf.m_binary[0], inf.m_binary.getSize());
+	m_contentHash = appendHash(&m_shaderType, sizeof(m_shaderType), m_contentHash);
+	if(m_specConstInfo.dataSize)
+	{
+		m_contentHash = appendHash(m_specConstInfo.pData, m_specConstInfo.dataSize, m_contentHash);
+	}
+
 	return Error::NONE;
 }
 
@@ -31,6 +31,17 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	ANKI_ASSERT(inf.isValid());
 	m_shaders = inf.m_shaders;
 
+	// Compute the hash of the shaders
+	//
+	for(ShaderType stype = ShaderType::FIRST; stype < ShaderType::COUNT; ++stype)
+	{
+		if(m_shaders[stype].isCreated())
+		{
+			const U64 hash = static_cast<const ShaderImpl&>(*m_shaders[stype]).m_contentHash;
+			m_contentHash = (m_contentHash) ? appendHash(&hash, sizeof(hash), m_contentHash) : hash;
+		}
+	}
+
 	// Merge bindings
 	//
 	Array2d<DescriptorBinding, MAX_DESCRIPTOR_SETS, MAX_BINDINGS_PER_DESCRIPTOR_SET> bindings;
@@ -160,8 +171,10 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	if(graphicsProg)
 	{
 		m_pplineFactory = getAllocator().newInstance<PipelineFactory>();
-		m_pplineFactory->init(
-			getGrManagerImpl().getAllocator(), getGrManagerImpl().getDevice(), getGrManagerImpl().getPipelineCache());
+		m_pplineFactory->init(getGrManagerImpl().getAllocator(),
+			getGrManagerImpl().getDevice(),
+			getGrManagerImpl().getPipelineCache(),
+			&getGrManagerImpl().getPipelineCompiler());
 	}
 
 	// Create the pipeline if compute
@@ -88,9 +88,17 @@ public:
 		return m_stages;
 	}
 
+	/// A hash of the shaders that is the same between runs.
+	U64 getContentHash() const
+	{
+		ANKI_ASSERT(m_contentHash);
+		return m_contentHash;
+	}
+
 private:
 	Array<ShaderPtr, U(ShaderType::COUNT)> m_shaders;
 	ShaderTypeBit m_stages = ShaderTypeBit::NONE;
+	U64 m_contentHash = 0;
 
 	Array<VkPipelineShaderStageCreateInfo, U(ShaderType::COUNT) - 1> m_shaderCreateInfos;
 	U32 m_shaderCreateInfoCount = 0;
@@ -128,6 +128,7 @@ Error TextureImpl::initInternal(VkImage externalImage, const TextureInitInfo& in
 
 		static_cast<CommandBufferImpl&>(*cmdb).endRecording();
 		getGrManagerImpl().flushCommandBuffer(cmdb, nullptr);
+		m_initialUsageOnGraphicsQueue = true;
 	}
 
 	return Error::NONE;
@@ -77,6 +77,9 @@ public:
 
 	VkImageViewCreateInfo m_viewCreateInfoTemplate;
 
+	/// The graphics queue transitioned the texture to its initial usage.
+	Bool m_initialUsageOnGraphicsQueue = false;
+
 	TextureImpl(GrManager* manager, CString name)
 		: Texture(manager, name)
 	{
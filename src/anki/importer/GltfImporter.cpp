@@ -224,6 +224,11 @@ Error GltfImporter::writeAll()
 		return threadErr;
 	}
 
+	if(!err)
+	{
+		err = writeBinaryScene();
+	}
+
 	return err;
 }
 
@@ -422,6 +427,13 @@ Error GltfImporter::visitNode(
 				getNodeName(node).cstr(),
 				fname.cstr()));
 
+			SceneBinaryFile::Node& binNode = newBinaryNode((gpuParticles)
+					? SceneBinaryFile::NodeType::GPU_PARTICLE_EMITTER
+					: SceneBinaryFile::NodeType::PARTICLE_EMITTER,
+				getNodeName(node));
+			binNode.m_resource =
+				addBinaryResource(SceneBinaryFile::ResourceType::PARTICLE_EMITTER, fname.toCString());
+
 			Transform localTrf;
 			ANKI_CHECK(getNodeTransform(node, localTrf));
 			ANKI_CHECK(writeTransform(parentTrf.combineTransformations(localTrf)));
@@ -446,6 +458,13 @@ Error GltfImporter::visitNode(
 				m_rpath.cstr(),
 				node.mesh->name));
 
+			StringAuto collisionFname(m_alloc);
+			collisionFname.sprintf("%s%s.ankicl", m_rpath.cstr(), node.mesh->name);
+			SceneBinaryFile::Node& binNode =
+				newBinaryNode(SceneBinaryFile::NodeType::STATIC_COLLISION, getNodeName(node));
+			binNode.m_resource =
+				addBinaryResource(SceneBinaryFile::ResourceType::COLLISION, collisionFname.toCString());
+
 			Transform localTrf;
 			ANKI_CHECK(getNodeTransform(node, localTrf));
 			ANKI_CHECK(writeTransform(parentTrf.combineTransformations(localTrf)));
@@ -471,6 +490,13 @@ Error GltfImporter::visitNode(
 				aabbMax.y(),
 				aabbMax.z()));
 
+			SceneBinaryFile::Node& binNode =
+				newBinaryNode(SceneBinaryFile::NodeType::REFLECTION_PROBE, getNodeName(node));
+			binNode.m_probe.m_aabbMin = {{aabbMin.x(), aabbMin.y(), aabbMin.z()}};
+			binNode.m_probe.m_aabbMax = {{aabbMax.x(), aabbMax.y(), aabbMax.z()}};
+			binNode.m_probe.m_fadeDistance = -1.0f;
+			binNode.m_probe.m_cellSize = -1.0f;
+
 			Transform localTrf = Transform(tsl.xyz0(), Mat3x4(rot), 1.0f);
 			ANKI_CHECK(writeTransform(parentTrf.combineTransformations(localTrf)));
 		}
@@ -519,6 +545,13 @@ Error GltfImporter::visitNode(
 				ANKI_CHECK(m_sceneFile.writeText("comp:setCellSize(%f)\n", cellSize));
 			}
 
+			SceneBinaryFile::Node& binNode =
+				newBinaryNode(SceneBinaryFile::NodeType::GLOBAL_ILLUMINATION_PROBE, getNodeName(node));
+			binNode.m_probe.m_aabbMin = {{aabbMin.x(), aabbMin.y(), aabbMin.z()}};
+			binNode.m_probe.m_aabbMax = {{aabbMax.x(), aabbMax.y(), aabbMax.z()}};
+			binNode.m_probe.m_fadeDistance = fadeDistance;
+			binNode.m_probe.m_cellSize = cellSize;
+
 			Transform localTrf = Transform(tsl.xyz0(), Mat3x4(rot), 1.0f);
 			ANKI_CHECK(writeTransform(parentTrf.combineTransformations(localTrf)));
 		}
@@ -578,6 +611,23 @@ Error GltfImporter::visitNode(
 					specularRougnessMetallicFactor));
 			}
 
+			SceneBinaryFile::Node& binNode = newBinaryNode(SceneBinaryFile::NodeType::DECAL, getNodeName(node));
+			if(diffuseAtlas)
+			{
+				binNode.m_decal.m_atlases[0] =
+					addBinaryResource(SceneBinaryFile::ResourceType::TEXTURE_ATLAS, diffuseAtlas.toCString());
+				binNode.m_decal.m_subTextures[0] = addBinaryString(diffuseSubtexture.toCString());
+				binNode.m_decal.m_blendFactors[0] = diffuseFactor;
+			}
+
+			if(specularRougnessMetallicAtlas)
+			{
+				binNode.m_decal.m_atlases[1] = addBinaryResource(
+					SceneBinaryFile::ResourceType::TEXTURE_ATLAS, specularRougnessMetallicAtlas.toCString());
+				binNode.m_decal.m_subTextures[1] = addBinaryString(specularRougnessMetallicSubtexture.toCString());
+				binNode.m_decal.m_blendFactors[1] = specularRougnessMetallicFactor;
+			}
+
 			Vec3 tsl;
 			Mat3 rot;
 			Vec3 scale;
@@ -680,6 +730,20 @@ Error GltfImporter::visitNode(
 						getNodeName(node).cstr(),
 						m_rpath.cstr(),
 						node.mesh->name));
+
+				StringAuto name(m_alloc);
+				name.sprintf("%s_cl", getNodeName(node).cstr());
+				StringAuto collisionFname(m_alloc);
+				collisionFname.sprintf("%s%s.ankicl", m_rpath.cstr(), node.mesh->name);
+
+				const SceneBinaryFile::Node modelNode = m_binNodes.getBack();
+				SceneBinaryFile::Node& binNode =
+					newBinaryNode(SceneBinaryFile::NodeType::STATIC_COLLISION, name.toCString());
+				binNode.m_resource =
+					addBinaryResource(SceneBinaryFile::ResourceType::COLLISION, collisionFname.toCString());
+				binNode.m_origin = modelNode.m_origin;
+				binNode.m_rotation = modelNode.m_rotation;
+				binNode.m_scale = modelNode.m_scale;
 			}
 		}
 	}
@@ -724,6 +788,115 @@ Error GltfImporter::writeTransform(const Transform& trf)
 
 	ANKI_CHECK(m_sceneFile.writeText("node:getSceneNodeBase():getMoveComponent():setLocalTransform(trf)\n"));
 
+	if(m_binNodeNeedsTransform)
+	{
+		SceneBinaryFile::Node& binNode = m_binNodes.getBack();
+		binNode.m_origin = {{trf.getOrigin().x(), trf.getOrigin().y(), trf.getOrigin().z()}};
+		for(U i = 0; i < 12; i++)
+		{
+			binNode.m_rotation[i] = trf.getRotation()[i];
+		}
+		binNode.m_scale = trf.getScale();
+
+		m_binNodeNeedsTransform = false;
+	}
+
+	return Error::NONE;
+}
+
+SceneBinaryFile::Node& GltfImporter::newBinaryNode(SceneBinaryFile::NodeType type, CString name)
+{
+	SceneBinaryFile::Node& node = *m_binNodes.emplaceBack();
+	memset(&node, 0, sizeof(node));
+	node.m_type = type;
+	node.m_flags = SceneBinaryFile::NodeFlag::NONE;
+	node.m_name = addBinaryString(name);
+	node.m_resource = SceneBinaryFile::NONE;
+	node.m_scale = 1.0f;
+	node.m_rotation = {{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f}};
+
+	if(type == SceneBinaryFile::NodeType::POINT_LIGHT || type == SceneBinaryFile::NodeType::SPOT_LIGHT
+		|| type == SceneBinaryFile::NodeType::DIRECTIONAL_LIGHT)
+	{
+		node.m_light.m_lensFlare = SceneBinaryFile::NONE;
+	}
+	else if(type == SceneBinaryFile::NodeType::DECAL)
+	{
+		node.m_decal.m_atlases = {{SceneBinaryFile::NONE, SceneBinaryFile::NONE}};
+	}
+
+	m_binNodeNeedsTransform = true;
+	return node;
+}
+
+U32 GltfImporter::addBinaryString(CString str)
+{
+	const U32 offset = m_binStrings.getSize();
+	const U32 len = str.getLength();
+	m_binStrings.resize(offset + len + 1);
+	if(len)
+	{
+		memcpy(&m_binStrings[offset], str.cstr(), len);
+	}
+	m_binStrings[offset + len] = '\0';
+	return offset;
+}
+
+U32 GltfImporter::addBinaryResource(SceneBinaryFile::ResourceType type, CString filename)
+{
+	const U64 hash = appendHash(&type, sizeof(type), computeHash(filename.cstr(), filename.getLength()));
+
+	auto it = m_binResourceIndices.find(hash);
+	if(it != m_binResourceIndices.getEnd())
+	{
+		const SceneBinaryFile::Resource& rsrc = m_binResources[*it];
+		ANKI_ASSERT(rsrc.m_type == type && CString(&m_binStrings[rsrc.m_filename]) == filename);
+		(void)rsrc;
+		return *it;
+	}
+
+	SceneBinaryFile::Resource& rsrc = *m_binResources.emplaceBack();
+	rsrc.m_type = type;
+	rsrc.m_filename = addBinaryString(filename);
+
+	const U32 idx = m_binResources.getSize() - 1;
+	m_binResourceIndices.emplace(hash, idx);
+	return idx;
+}
+
+Error GltfImporter::writeBinaryScene()
+{
+	StringAuto fname(m_alloc);
+	fname.sprintf("%sscene.ankiscene", m_outDir.cstr());
+	ANKI_GLTF_LOGI("Writing binary scene %s", fname.cstr());
+
+	if(m_binStrings.getSize() == 0)
+	{
+		addBinaryString("");
+	}
+
+	SceneBinaryFile::Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(&header.m_magic[0], SceneBinaryFile::MAGIC, sizeof(header.m_magic));
+	header.m_resourceCount = m_binResources.getSize();
+	header.m_nodeCount = m_binNodes.getSize();
+	header.m_stringTableSize = m_binStrings.getSize();
+
+	File file;
+	ANKI_CHECK(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+	if(m_binResources.getSize())
+	{
+		ANKI_CHECK(file.write(&m_binResources[0], m_binResources.getSizeInBytes()));
+	}
+
+	if(m_binNodes.getSize())
+	{
+		ANKI_CHECK(file.write(&m_binNodes[0], m_binNodes.getSizeInBytes()));
+	}
+
+	ANKI_CHECK(file.write(&m_binStrings[0], m_binStrings.getSizeInBytes()));
+
 	return Error::NONE;
 }
 
@@ -1030,16 +1203,20 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 	ANKI_CHECK(getExtras(node.extras, extras));
 
 	CString lightTypeStr;
+	SceneBinaryFile::NodeType binType;
 	switch(light.type)
 	{
 	case cgltf_light_type_point:
 		lightTypeStr = "Point";
+		binType = SceneBinaryFile::NodeType::POINT_LIGHT;
 		break;
 	case cgltf_light_type_spot:
 		lightTypeStr = "Spot";
+		binType = SceneBinaryFile::NodeType::SPOT_LIGHT;
 		break;
 	case cgltf_light_type_directional:
 		lightTypeStr = "Directional";
+		binType = SceneBinaryFile::NodeType::DIRECTIONAL_LIGHT;
 		break;
 	default:
 		ANKI_GLTF_LOGE("Unsupporter light type %d", light.type);
@@ -1049,10 +1226,14 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 	ANKI_CHECK(m_sceneFile.writeText("\nnode = scene:new%sLightNode(\"%s\")\n", lightTypeStr.cstr(), nodeName.cstr()));
 	ANKI_CHECK(m_sceneFile.writeText("lcomp = node:getSceneNodeBase():getLightComponent()\n"));
 
+	SceneBinaryFile::Node& binNode = newBinaryNode(binType, nodeName.toCString());
+	SceneBinaryFile::Light& binLight = binNode.m_light;
+
 	Vec3 color(light.color[0], light.color[1], light.color[2]);
 	color *= light.intensity;
 	ANKI_CHECK(
 		m_sceneFile.writeText("lcomp:setDiffuseColor(Vec4.new(%f, %f, %f, 1))\n", color.x(), color.y(), color.z()));
+	binLight.m_diffuseColor = {{color.x(), color.y(), color.z()}};
 
 	auto shadow = extras.find("shadow");
 	if(shadow != extras.getEnd())
@@ -1060,30 +1241,39 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 		if(*shadow == "true")
 		{
 			ANKI_CHECK(m_sceneFile.writeText("lcomp:setShadowEnabled(1)\n"));
+			binNode.m_flags |= SceneBinaryFile::NodeFlag::SHADOW_ENABLED;
 		}
 		else
 		{
 			ANKI_CHECK(m_sceneFile.writeText("lcomp:setShadowEnabled(0)\n"));
+			binNode.m_flags |= SceneBinaryFile::NodeFlag::SHADOW_DISABLED;
 		}
 	}
 
 	if(light.type == cgltf_light_type_point)
 	{
-		ANKI_CHECK(m_sceneFile.writeText(
-			"lcomp:setRadius(%f)\n", (light.range > 0.0f) ? light.range : computeLightRadius(color)));
+		binLight.m_radius = (light.range > 0.0f) ? light.range : computeLightRadius(color);
+		ANKI_CHECK(m_sceneFile.writeText("lcomp:setRadius(%f)\n", binLight.m_radius));
 	}
 	else if(light.type == cgltf_light_type_spot)
 	{
-		ANKI_CHECK(m_sceneFile.writeText(
-			"lcomp:setDistance(%f)\n", (light.range > 0.0f) ? light.range : computeLightRadius(color)));
-		ANKI_CHECK(m_sceneFile.writeText("lcomp:setOuterAngle(%f)\n", light.spot_outer_cone_angle * 2.0f));
-		ANKI_CHECK(m_sceneFile.writeText("lcomp:setInnerAngle(%f)\n", light.spot_inner_cone_angle * 2.0f));
+		binLight.m_radius = (light.range > 0.0f) ? light.range : computeLightRadius(color);
+		binLight.m_outerAngle = light.spot_outer_cone_angle * 2.0f;
+		binLight.m_innerAngle = light.spot_inner_cone_angle * 2.0f;
+		ANKI_CHECK(m_sceneFile.writeText("lcomp:setDistance(%f)\n", binLight.m_radius));
+		ANKI_CHECK(m_sceneFile.writeText("lcomp:setOuterAngle(%f)\n", binLight.m_outerAngle));
+		ANKI_CHECK(m_sceneFile.writeText("lcomp:setInnerAngle(%f)\n", binLight.m_innerAngle));
 	}
 
 	auto lensFlaresFname = extras.find("lens_flare");
 	if(lensFlaresFname != extras.getEnd())
 	{
 		ANKI_CHECK(m_sceneFile.writeText("node:loadLensFlare(\"%s\")\n", lensFlaresFname->cstr()));
+		if(binType != SceneBinaryFile::NodeType::DIRECTIONAL_LIGHT)
+		{
+			binLight.m_lensFlare =
+				addBinaryResource(SceneBinaryFile::ResourceType::TEXTURE, lensFlaresFname->toCString());
+		}
 
 		auto lsSpriteSize = extras.find("lens_flare_first_sprite_size");
 		auto lsColor = extras.find("lens_flare_color");
@@ -1100,6 +1290,8 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 			ANKI_CHECK(parseArrayOfNumbers(lsSpriteSize->toCString(), numbers, &count));
 
 			ANKI_CHECK(m_sceneFile.writeText("lfcomp:setFirstFlareSize(Vec2.new(%f, %f))\n", numbers[0], numbers[1]));
+			binNode.m_flags |= SceneBinaryFile::NodeFlag::LENS_FLARE_FIRST_SPRITE_SIZE;
+			binLight.m_lensFlareFirstSpriteSize = {{F32(numbers[0]), F32(numbers[1])}};
 		}
 
 		if(lsColor != extras.getEnd())
@@ -1113,6 +1305,8 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 				numbers[1],
 				numbers[2],
 				numbers[3]));
+			binNode.m_flags |= SceneBinaryFile::NodeFlag::LENS_FLARE_COLOR;
+			binLight.m_lensFlareColor = {{F32(numbers[0]), F32(numbers[1]), F32(numbers[2]), F32(numbers[3])}};
 		}
 	}
 
@@ -1121,6 +1315,7 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 	if(lightEventIntensity != extras.getEnd() || lightEventFrequency != extras.getEnd())
 	{
 		ANKI_CHECK(m_sceneFile.writeText("event = events:newLightEvent(0.0, -1.0, node:getSceneNodeBase())\n"));
+		binNode.m_flags |= SceneBinaryFile::NodeFlag::LIGHT_EVENT;
 
 		if(lightEventIntensity != extras.getEnd())
 		{
@@ -1132,6 +1327,9 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 				numbers[1],
 				numbers[2],
 				numbers[3]));
+			binNode.m_flags |= SceneBinaryFile::NodeFlag::LIGHT_EVENT_INTENSITY;
+			binLight.m_eventIntensityMultiplier = {
+				{F32(numbers[0]), F32(numbers[1]), F32(numbers[2]), F32(numbers[3])}};
 		}
 
 		if(lightEventFrequency != extras.getEnd())
@@ -1140,6 +1338,8 @@ Error GltfImporter::writeLight(const cgltf_node& node, const HashMapAuto<CString
 			const U count = 2;
 			ANKI_CHECK(parseArrayOfNumbers(lightEventFrequency->toCString(), numbers, &count));
 			ANKI_CHECK(m_sceneFile.writeText("event:setFrequency(%f, %f)\n", numbers[0], numbers[1]));
+			binNode.m_flags |= SceneBinaryFile::NodeFlag::LIGHT_EVENT_FREQUENCY;
+			binLight.m_eventFrequency = {{F32(numbers[0]), F32(numbers[1])}};
 		}
 	}
 
@@ -1167,6 +1367,12 @@ Error GltfImporter::writeCamera(const cgltf_node& node, const HashMapAuto<CStrin
 		cam.yfov,
 		cam.yfov));
 
+	SceneBinaryFile::Node& binNode =
+		newBinaryNode(SceneBinaryFile::NodeType::PERSPECTIVE_CAMERA, getNodeName(node).toCString());
+	binNode.m_camera.m_near = cam.znear;
+	binNode.m_camera.m_far = cam.zfar;
+	binNode.m_camera.m_fovY = cam.yfov;
+
 	return Error::NONE;
 }
 
@@ -1183,6 +1389,9 @@ Error GltfImporter::writeModelNode(const cgltf_node& node, const HashMapAuto<CSt
 	ANKI_CHECK(m_sceneFile.writeText(
 		"\nnode = scene:newModelNode(\"%s\", \"%s\")\n", getNodeName(node).cstr(), modelFname.cstr()));
 
+	SceneBinaryFile::Node& binNode = newBinaryNode(SceneBinaryFile::NodeType::MODEL, getNodeName(node).toCString());
+	binNode.m_resource = addBinaryResource(SceneBinaryFile::ResourceType::MODEL, modelFname.toCString());
+
 	return Error::NONE;
 }
 
@@ -9,6 +9,7 @@
 #include <anki/util/File.h>
 #include <anki/util/HashMap.h>
 #include <anki/Math.h>
+#include <anki/scene/SceneBinaryLoader.h>
 #include <cgltf/cgltf.h>
 
 namespace anki
@@ -22,7 +23,7 @@ namespace anki
 #define ANKI_GLTF_LOGW(...) ANKI_LOG("GLTF", WARNING, __VA_ARGS__)
 #define ANKI_GLTF_LOGF(...) ANKI_LOG("GLTF", FATAL, __VA_ARGS__)
 
-/// Import GLTF and spit AnKi scenes.
+/// Import GLTF and spit AnKi scenes. The scene is written both as a script and as a SceneBinaryFile.
 class GltfImporter
 {
 public:
@@ -67,6 +68,13 @@ private:
 
 	File m_sceneFile;
 
+	// Binary scene. It mirrors the script
+	DynamicArrayAuto<SceneBinaryFile::Resource> m_binResources{m_alloc};
+	DynamicArrayAuto<SceneBinaryFile::Node> m_binNodes{m_alloc};
+	DynamicArrayAuto<char> m_binStrings{m_alloc};
+	HashMapAuto<U64, U32> m_binResourceIndices{m_alloc}; ///< Hash of the resource to its index.
+	Bool m_binNodeNeedsTransform = false; ///< The last binary node didn't get its transform yet.
+
 	Atomic<I32> m_errorInThread{0};
 
 	HashMapAuto<const void*, U32, PtrHasher> m_nodePtrToIdx{m_alloc}; ///< Need an index for the unnamed nodes.
@@ -100,6 +108,10 @@ private:
 
 	// Scene
 	ANKI_USE_RESULT Error writeTransform(const Transform& trf);
+	ANKI_USE_RESULT Error writeBinaryScene();
+	SceneBinaryFile::Node& newBinaryNode(SceneBinaryFile::NodeType type, CString name);
+	U32 addBinaryString(CString str);
+	U32 addBinaryResource(SceneBinaryFile::ResourceType type, CString filename);
 	ANKI_USE_RESULT Error visitNode(
 		const cgltf_node& node, const Transform& parentTrf, const HashMapAuto<CString, StringAuto>& parentExtras);
 	ANKI_USE_RESULT Error writeLight(const cgltf_node& node, const HashMapAuto<CString, StringAuto>& parentExtras);
@@ -114,6 +114,7 @@ class SubMesh
 public:
 	DynamicArrayAuto<TempVertex> m_verts;
 	DynamicArrayAuto<U32> m_indices;
+	DynamicArrayAuto<MeshBinaryFile::Meshlet> m_meshlets; ///< The indices of the meshlets are relative to the submesh.
 
 	Vec3 m_aabbMin{MAX_F32};
 	Vec3 m_aabbMax{MIN_F32};
@@ -124,6 +125,7 @@ public:
 	SubMesh(GenericMemoryPoolAllocator<U8>& alloc)
 		: m_verts(alloc)
 		, m_indices(alloc)
+		, m_meshlets(alloc)
 	{
 	}
 };
@@ -265,6 +267,131 @@ static void decimateSubmesh(F32 factor, SubMesh& submesh, GenericMemoryPoolAlloc
 	submesh.m_verts = std::move(newVerts);
 }
 
+/// Compute the bounding sphere and the normal cone of a meshlet.
+static void computeMeshletBounds(const SubMesh& submesh, MeshBinaryFile::Meshlet& meshlet)
+{
+	// Bounding sphere
+	Vec3 aabbMin(MAX_F32);
+	Vec3 aabbMax(MIN_F32);
+	for(U32 i = meshlet.m_firstIndex; i < meshlet.m_firstIndex + meshlet.m_indexCount; ++i)
+	{
+		const Vec3& pos = submesh.m_verts[submesh.m_indices[i]].m_position;
+		aabbMin = aabbMin.min(pos);
+		aabbMax = aabbMax.max(pos);
+	}
+
+	meshlet.m_sphereCenter = (aabbMin + aabbMax) / 2.0f;
+	F32 radiusSq = 0.0f;
+	for(U32 i = meshlet.m_firstIndex; i < meshlet.m_firstIndex + meshlet.m_indexCount; ++i)
+	{
+		const Vec3& pos = submesh.m_verts[submesh.m_indices[i]].m_position;
+		radiusSq = max(radiusSq, (pos - meshlet.m_sphereCenter).getLengthSquared());
+	}
+	meshlet.m_sphereRadius = max(sqrt(radiusSq), EPSILON);
+
+	// Normal cone. The axis is the average of the triangle normals and the cutoff depends on the normal that deviates
+	// the most from that axis
+	Vec3 axis(0.0f);
+	for(U32 i = meshlet.m_firstIndex; i < meshlet.m_firstIndex + meshlet.m_indexCount; i += 3)
+	{
+		const Vec3& v0 = submesh.m_verts[submesh.m_indices[i + 0]].m_position;
+		const Vec3& v1 = submesh.m_verts[submesh.m_indices[i + 1]].m_position;
+		const Vec3& v2 = submesh.m_verts[submesh.m_indices[i + 2]].m_position;
+
+		const Vec3 normal = (v1 - v0).cross(v2 - v0);
+		if(normal.getLengthSquared() > EPSILON * EPSILON)
+		{
+			axis += normal.getNormalized();
+		}
+	}
+
+	meshlet.m_coneCutoff = 1.0f;
+	meshlet.m_coneAxis = Vec3(0.0f, 0.0f, 1.0f);
+	if(axis.getLengthSquared() <= EPSILON)
+	{
+		return;
+	}
+
+	axis.normalize();
+	F32 minDot = 1.0f;
+	for(U32 i = meshlet.m_firstIndex; i < meshlet.m_firstIndex + meshlet.m_indexCount; i += 3)
+	{
+		const Vec3& v0 = submesh.m_verts[submesh.m_indices[i + 0]].m_position;
+		const Vec3& v1 = submesh.m_verts[submesh.m_indices[i + 1]].m_position;
+		const Vec3& v2 = submesh.m_verts[submesh.m_indices[i + 2]].m_position;
+
+		const Vec3 normal = (v1 - v0).cross(v2 - v0);
+		if(normal.getLengthSquared() > EPSILON * EPSILON)
+		{
+			minDot = min(minDot, normal.getNormalized().dot(axis));
+		}
+	}
+
+	meshlet.m_coneAxis = axis;
+	if(minDot > 0.0f)
+	{
+		// The cone is narrower than a hemisphere so it can be used. Store the sine of the half angle
+		meshlet.m_coneCutoff = sqrt(1.0f - minDot * minDot);
+	}
+}
+
+/// Split a submesh into meshlets. The triangles are visited in index buffer order (which is already optimized for the
+/// vertex cache) so every meshlet is a contiguous range of the index buffer.
+static void generateMeshlets(SubMesh& submesh, GenericMemoryPoolAllocator<U8> alloc)
+{
+	ANKI_ASSERT((submesh.m_indices.getSize() % 3) == 0 && "Meshlets are made of triangles");
+
+	// Holds the meshlet that last used a vertex
+	DynamicArrayAuto<U32> vertToMeshlet(alloc);
+	vertToMeshlet.create(submesh.m_verts.getSize(), MAX_U32);
+
+	MeshBinaryFile::Meshlet meshlet = {};
+	U32 meshletVertCount = 0;
+	U32 meshletIdx = 0;
+	for(U32 i = 0; i < submesh.m_indices.getSize(); i += 3)
+	{
+		U32 newVertCount = 0;
+		for(U32 j = 0; j < 3; ++j)
+		{
+			if(vertToMeshlet[submesh.m_indices[i + j]] != meshletIdx)
+			{
+				++newVertCount;
+			}
+		}
+
+		// Flush the meshlet if it's full
+		if(meshletVertCount + newVertCount > MeshBinaryFile::MAX_MESHLET_VERTICES
+			|| meshlet.m_indexCount / 3 + 1 > MeshBinaryFile::MAX_MESHLET_TRIANGLES)
+		{
+			computeMeshletBounds(submesh, meshlet);
+			submesh.m_meshlets.emplaceBack(meshlet);
+
+			++meshletIdx;
+			meshlet = {};
+			meshlet.m_firstIndex = i;
+			meshletVertCount = 0;
+		}
+
+		for(U32 j = 0; j < 3; ++j)
+		{
+			U32& vertMeshlet = vertToMeshlet[submesh.m_indices[i + j]];
+			if(vertMeshlet != meshletIdx)
+			{
+				vertMeshlet = meshletIdx;
+				++meshletVertCount;
+			}
+		}
+
+		meshlet.m_indexCount += 3;
+	}
+
+	if(meshlet.m_indexCount > 0)
+	{
+		computeMeshletBounds(submesh, meshlet);
+		submesh.m_meshlets.emplaceBack(meshlet);
+	}
+}
+
 Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32 decimateFactor)
 {
 	StringAuto fname(m_alloc);
@@ -274,6 +401,7 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	ListAuto<SubMesh> submeshes(m_alloc);
 	U32 totalIndexCount = 0;
 	U32 totalVertexCount = 0;
+	U32 totalMeshletCount = 0;
 	Vec3 aabbMin(MAX_F32);
 	Vec3 aabbMax(MIN_F32);
 	F32 maxUvDistance = MIN_F32;
@@ -546,6 +674,9 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		else
 		{
 			// Finalize
+			generateMeshlets(submesh, m_alloc);
+			totalMeshletCount += submesh.m_meshlets.getSize();
+
 			submesh.m_firstIdx = totalIndexCount;
 			submesh.m_idxCount = submesh.m_indices.getSize();
 			totalIndexCount += submesh.m_idxCount;
@@ -696,7 +827,8 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 	// Write some other header stuff
 	{
 		memcpy(&header.m_magic[0], MeshBinaryFile::MAGIC, 8);
-		header.m_flags = MeshBinaryFile::Flag::NONE;
+		// Only triangle primitives are imported so the mesh is never QUAD and it can have meshlets
+		header.m_flags = MeshBinaryFile::Flag::MESHLETS;
 		if(convex)
 		{
 			header.m_flags |= MeshBinaryFile::Flag::CONVEX;
@@ -728,6 +860,17 @@ Error GltfImporter::writeMesh(const cgltf_mesh& mesh, CString nameOverride, F32
 		ANKI_CHECK(file.write(&out, sizeof(out)));
 	}
 
+	// Write meshlets
+	ANKI_CHECK(file.write(&totalMeshletCount, sizeof(totalMeshletCount)));
+	for(const SubMesh& submesh : submeshes)
+	{
+		for(MeshBinaryFile::Meshlet meshlet : submesh.m_meshlets)
+		{
+			meshlet.m_firstIndex += submesh.m_firstIdx;
+			ANKI_CHECK(file.write(&meshlet, sizeof(meshlet)));
+		}
+	}
+
 	// Write indices
 	for(const SubMesh& submesh : submeshes)
 	{
@@ -0,0 +1,405 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/math/Batch.h>
+
+#define ANKI_MATH_BATCH_AVX2 (ANKI_SIMD_SSE && ANKI_COMPILER_GCC_COMPATIBLE)
+
+#if ANKI_MATH_BATCH_AVX2
+#	include <immintrin.h>
+#	define ANKI_AVX2_FMA_FUNC __attribute__((target("avx2,fma")))
+#endif
+
+namespace anki
+{
+
+static MathBatchBackend detectBestMathBatchBackend()
+{
+	return (isMathBatchBackendSupported(MathBatchBackend::AVX2_FMA)) ? MathBatchBackend::AVX2_FMA
+																	 : MathBatchBackend::GENERIC;
+}
+
+static MathBatchBackend g_mathBatchBackend = detectBestMathBatchBackend();
+
+Bool isMathBatchBackendSupported(MathBatchBackend backend)
+{
+	switch(backend)
+	{
+	case MathBatchBackend::GENERIC:
+		return true;
+	case MathBatchBackend::AVX2_FMA:
+#if ANKI_MATH_BATCH_AVX2
+		// It might run before the static constructors so initialize the CPU info
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+		return false;
+#endif
+	default:
+		ANKI_ASSERT(0);
+		return false;
+	}
+}
+
+void setMathBatchBackend(MathBatchBackend backend)
+{
+	ANKI_ASSERT(isMathBatchBackendSupported(backend));
+	g_mathBatchBackend = backend;
+}
+
+MathBatchBackend getMathBatchBackend()
+{
+	return g_mathBatchBackend;
+}
+
+#if ANKI_MATH_BATCH_AVX2
+/// Put the same 4 floats in both lanes.
+ANKI_AVX2_FMA_FUNC static inline __m256 splat128(__m128 a)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(a), a, 1);
+}
+
+/// Load 2 Vec3 without touching the memory after them.
+ANKI_AVX2_FMA_FUNC static inline __m256 loadVec3x2(const Vec3* v)
+{
+	const __m128i mask = _mm_setr_epi32(-1, -1, -1, 0);
+	const __m128 a = _mm_maskload_ps(&v[0][0], mask);
+	const __m128 b = _mm_maskload_ps(&v[1][0], mask);
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(a), b, 1);
+}
+
+/// Store 2 Vec3 without touching the memory after them.
+ANKI_AVX2_FMA_FUNC static inline void storeVec3x2(Vec3* v, __m256 a)
+{
+	const __m128i mask = _mm_setr_epi32(-1, -1, -1, 0);
+	_mm_maskstore_ps(&v[0][0], mask, _mm256_castps256_ps128(a));
+	_mm_maskstore_ps(&v[1][0], mask, _mm256_extractf128_ps(a, 1));
+}
+
+/// The columns of a 3x4 matrix, in both lanes. The 4th component is zero.
+class Mat3x4Columns
+{
+public:
+	Array<__m256, 4> m_cols;
+
+	ANKI_AVX2_FMA_FUNC Mat3x4Columns(const Mat3x4& m)
+	{
+		for(U i = 0; i < 4; ++i)
+		{
+			m_cols[i] = splat128(_mm_setr_ps(m(0, i), m(1, i), m(2, i), 0.0f));
+		}
+	}
+
+	/// Compute the rotation part only.
+	ANKI_AVX2_FMA_FUNC __m256 rotate(__m256 v) const
+	{
+		__m256 out = _mm256_mul_ps(m_cols[0], _mm256_permute_ps(v, 0x00));
+		out = _mm256_fmadd_ps(m_cols[1], _mm256_permute_ps(v, 0x55), out);
+		return _mm256_fmadd_ps(m_cols[2], _mm256_permute_ps(v, 0xAA), out);
+	}
+
+	ANKI_AVX2_FMA_FUNC __m256 transform(__m256 v) const
+	{
+		return _mm256_add_ps(rotate(v), m_cols[3]);
+	}
+};
+
+ANKI_AVX2_FMA_FUNC static void transformPointsAvx2(const Mat3x4& m, ConstWeakArray<Vec3> in, WeakArray<Vec3> out)
+{
+	const Mat3x4Columns cols(m);
+	const U32 count = in.getSize();
+
+	U32 i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		const __m256 a = loadVec3x2(&in[i]);
+		const __m256 b = loadVec3x2(&in[i + 2]);
+		storeVec3x2(&out[i], cols.transform(a));
+		storeVec3x2(&out[i + 2], cols.transform(b));
+	}
+
+	for(; i < count; ++i)
+	{
+		out[i] = m * Vec4(in[i], 1.0f);
+	}
+}
+
+ANKI_AVX2_FMA_FUNC static void transformPointsAvx2(const Mat4& m, ConstWeakArray<Vec4> in, WeakArray<Vec4> out)
+{
+	Array<__m256, 4> cols;
+	for(U i = 0; i < 4; ++i)
+	{
+		cols[i] = splat128(_mm_setr_ps(m(0, i), m(1, i), m(2, i), m(3, i)));
+	}
+
+	const U32 count = in.getSize();
+	U32 i = 0;
+	for(; i + 2 <= count; i += 2)
+	{
+		const __m256 v = _mm256_loadu_ps(&in[i][0]);
+		__m256 r = _mm256_mul_ps(cols[0], _mm256_permute_ps(v, 0x00));
+		r = _mm256_fmadd_ps(cols[1], _mm256_permute_ps(v, 0x55), r);
+		r = _mm256_fmadd_ps(cols[2], _mm256_permute_ps(v, 0xAA), r);
+		r = _mm256_fmadd_ps(cols[3], _mm256_permute_ps(v, 0xFF), r);
+		_mm256_storeu_ps(&out[i][0], r);
+	}
+
+	for(; i < count; ++i)
+	{
+		out[i] = m * in[i];
+	}
+}
+
+ANKI_AVX2_FMA_FUNC static void transformAabbsAvx2(const Mat3x4& m,
+	ConstWeakArray<Vec3> inMins,
+	ConstWeakArray<Vec3> inMaxs,
+	WeakArray<Vec3> outMins,
+	WeakArray<Vec3> outMaxs)
+{
+	const Mat3x4Columns cols(m);
+
+	// The absolute of the rotation part
+	Mat3x4Columns absCols(m);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	for(U i = 0; i < 3; ++i)
+	{
+		absCols.m_cols[i] = _mm256_andnot_ps(signMask, absCols.m_cols[i]);
+	}
+
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const U32 count = inMins.getSize();
+	U32 i = 0;
+	for(; i + 2 <= count; i += 2)
+	{
+		const __m256 mins = loadVec3x2(&inMins[i]);
+		const __m256 maxs = loadVec3x2(&inMaxs[i]);
+
+		const __m256 center = _mm256_mul_ps(_mm256_add_ps(mins, maxs), half);
+		const __m256 extend = _mm256_mul_ps(_mm256_sub_ps(maxs, mins), half);
+
+		const __m256 newCenter = cols.transform(center);
+		const __m256 newExtend = absCols.rotate(extend);
+
+		storeVec3x2(&outMins[i], _mm256_sub_ps(newCenter, newExtend));
+		storeVec3x2(&outMaxs[i], _mm256_add_ps(newCenter, newExtend));
+	}
+
+	if(i < count)
+	{
+		// Do the last one with the generic path
+		ANKI_ASSERT(i + 1 == count);
+		const Vec3 center = (inMins[i] + inMaxs[i]) * 0.5f;
+		const Vec3 extend = (inMaxs[i] - inMins[i]) * 0.5f;
+
+		const Vec3 newCenter = m * Vec4(center, 1.0f);
+		Vec3 newExtend;
+		for(U j = 0; j < 3; ++j)
+		{
+			newExtend[j] = absolute(m(j, 0)) * extend.x() + absolute(m(j, 1)) * extend.y()
+						   + absolute(m(j, 2)) * extend.z();
+		}
+
+		outMins[i] = newCenter - newExtend;
+		outMaxs[i] = newCenter + newExtend;
+	}
+}
+
+ANKI_AVX2_FMA_FUNC static void multiplyMatricesAvx2(const Mat4& a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out)
+{
+	// For every pair of output rows and every k hold a(row, k) and a(row + 1, k) in the 2 lanes
+	Array2d<__m256, 2, 4> as;
+	for(U pair = 0; pair < 2; ++pair)
+	{
+		for(U k = 0; k < 4; ++k)
+		{
+			as[pair][k] = _mm256_insertf128_ps(
+				_mm256_castps128_ps256(_mm_set1_ps(a(pair * 2, k))), _mm_set1_ps(a(pair * 2 + 1, k)), 1);
+		}
+	}
+
+	const U32 count = b.getSize();
+	for(U32 i = 0; i < count; ++i)
+	{
+		const F32* brows = reinterpret_cast<const F32*>(&b[i]);
+		const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(brows + 0));
+		const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(brows + 4));
+		const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(brows + 8));
+		const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(brows + 12));
+
+		Array<__m256, 2> rows;
+		for(U pair = 0; pair < 2; ++pair)
+		{
+			__m256 r = _mm256_mul_ps(as[pair][0], b0);
+			r = _mm256_fmadd_ps(as[pair][1], b1, r);
+			r = _mm256_fmadd_ps(as[pair][2], b2, r);
+			rows[pair] = _mm256_fmadd_ps(as[pair][3], b3, r);
+		}
+
+		_mm256_storeu_ps(&out[i][0], rows[0]);
+		_mm256_storeu_ps(&out[i][8], rows[1]);
+	}
+}
+
+ANKI_AVX2_FMA_FUNC static void combineTransformationsAvx2(
+	const Mat3x4& a, ConstWeakArray<Mat3x4> b, WeakArray<Mat3x4> out)
+{
+	// Rows 0 and 1 go to the 2 lanes of the 256bit registers. Row 2 uses the 128bit ones
+	Array<__m256, 3> as01;
+	Array<__m128, 3> as2;
+	for(U k = 0; k < 3; ++k)
+	{
+		as01[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(a(0, k))), _mm_set1_ps(a(1, k)), 1);
+		as2[k] = _mm_set1_ps(a(2, k));
+	}
+
+	// The translation of a goes to the 4th component
+	const __m256 t01 = _mm256_setr_ps(0.0f, 0.0f, 0.0f, a(0, 3), 0.0f, 0.0f, 0.0f, a(1, 3));
+	const __m128 t2 = _mm_setr_ps(0.0f, 0.0f, 0.0f, a(2, 3));
+
+	const U32 count = b.getSize();
+	for(U32 i = 0; i < count; ++i)
+	{
+		const F32* brows = reinterpret_cast<const F32*>(&b[i]);
+		const __m128 b0 = _mm_loadu_ps(brows + 0);
+		const __m128 b1 = _mm_loadu_ps(brows + 4);
+		const __m128 b2 = _mm_loadu_ps(brows + 8);
+
+		__m256 r01 = _mm256_fmadd_ps(as01[0], splat128(b0), t01);
+		r01 = _mm256_fmadd_ps(as01[1], splat128(b1), r01);
+		r01 = _mm256_fmadd_ps(as01[2], splat128(b2), r01);
+
+		__m128 r2 = _mm_fmadd_ps(as2[0], b0, t2);
+		r2 = _mm_fmadd_ps(as2[1], b1, r2);
+		r2 = _mm_fmadd_ps(as2[2], b2, r2);
+
+		_mm256_storeu_ps(&out[i][0], r01);
+		_mm_storeu_ps(&out[i][8], r2);
+	}
+}
+#endif
+
+void batchTransformPoints(const Mat3x4& m, ConstWeakArray<Vec3> in, WeakArray<Vec3> out)
+{
+	ANKI_ASSERT(in.getSize() == out.getSize());
+
+#if ANKI_MATH_BATCH_AVX2
+	if(g_mathBatchBackend == MathBatchBackend::AVX2_FMA)
+	{
+		transformPointsAvx2(m, in, out);
+		return;
+	}
+#endif
+
+	for(U32 i = 0; i < in.getSize(); ++i)
+	{
+		out[i] = m * Vec4(in[i], 1.0f);
+	}
+}
+
+void batchTransformPoints(const Mat4& m, ConstWeakArray<Vec4> in, WeakArray<Vec4> out)
+{
+	ANKI_ASSERT(in.getSize() == out.getSize());
+
+#if ANKI_MATH_BATCH_AVX2
+	if(g_mathBatchBackend == MathBatchBackend::AVX2_FMA)
+	{
+		transformPointsAvx2(m, in, out);
+		return;
+	}
+#endif
+
+	for(U32 i = 0; i < in.getSize(); ++i)
+	{
+		out[i] = m * in[i];
+	}
+}
+
+void batchTransformAabbs(const Mat3x4& m,
+	ConstWeakArray<Vec3> inMins,
+	ConstWeakArray<Vec3> inMaxs,
+	WeakArray<Vec3> outMins,
+	WeakArray<Vec3> outMaxs)
+{
+	ANKI_ASSERT(inMins.getSize() == inMaxs.getSize());
+	ANKI_ASSERT(inMins.getSize() == outMins.getSize() && inMins.getSize() == outMaxs.getSize());
+
+#if ANKI_MATH_BATCH_AVX2
+	if(g_mathBatchBackend == MathBatchBackend::AVX2_FMA)
+	{
+		transformAabbsAvx2(m, inMins, inMaxs, outMins, outMaxs);
+		return;
+	}
+#endif
+
+	// Arvo's method: Transform the center and use the absolute rotation to transform the extend
+	Mat3 absRot = m.getRotationPart();
+	for(U i = 0; i < 9; ++i)
+	{
+		absRot[i] = absolute(absRot[i]);
+	}
+
+	for(U32 i = 0; i < inMins.getSize(); ++i)
+	{
+		const Vec3 center = (inMins[i] + inMaxs[i]) * 0.5f;
+		const Vec3 extend = (inMaxs[i] - inMins[i]) * 0.5f;
+
+		const Vec3 newCenter = m * Vec4(center, 1.0f);
+		const Vec3 newExtend = absRot * extend;
+
+		outMins[i] = newCenter - newExtend;
+		outMaxs[i] = newCenter + newExtend;
+	}
+}
+
+void batchMultiplyMatrices(const Mat4& a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out)
+{
+	ANKI_ASSERT(b.getSize() == out.getSize());
+
+#if ANKI_MATH_BATCH_AVX2
+	if(g_mathBatchBackend == MathBatchBackend::AVX2_FMA)
+	{
+		multiplyMatricesAvx2(a, b, out);
+		return;
+	}
+#endif
+
+	for(U32 i = 0; i < b.getSize(); ++i)
+	{
+		out[i] = a * b[i];
+	}
+}
+
+void batchCombineTransformations(const Mat3x4& a, ConstWeakArray<Mat3x4> b, WeakArray<Mat3x4> out)
+{
+	ANKI_ASSERT(b.getSize() == out.getSize());
+
+#if ANKI_MATH_BATCH_AVX2
+	if(g_mathBatchBackend == MathBatchBackend::AVX2_FMA)
+	{
+		combineTransformationsAvx2(a, b, out);
+		return;
+	}
+#endif
+
+	for(U32 i = 0; i < b.getSize(); ++i)
+	{
+		out[i] = a.combineTransformations(b[i]);
+	}
+}
+
+void batchSlerpQuats(
+	ConstWeakArray<Quat> from, ConstWeakArray<Quat> to, ConstWeakArray<F32> factors, WeakArray<Quat> out)
+{
+	ANKI_ASSERT(from.getSize() == to.getSize());
+	ANKI_ASSERT(from.getSize() == factors.getSize() && from.getSize() == out.getSize());
+
+	// The slerp branches on the angle and it needs acos and sin so all the backends share the same loop
+	for(U32 i = 0; i < from.getSize(); ++i)
+	{
+		out[i] = from[i].slerp(to[i], factors[i]);
+	}
+}
+
+} // end namespace anki
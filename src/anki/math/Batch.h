@@ -0,0 +1,62 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/math/Vec.h>
+#include <anki/math/Mat.h>
+#include <anki/math/Quat.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup math
+/// @{
+
+/// The implementation of the batch math functions.
+enum class MathBatchBackend : U8
+{
+	GENERIC, ///< Loops over the math classes so it uses SSE or NEON if they are enabled.
+	AVX2_FMA,
+
+	COUNT
+};
+
+/// Check if the CPU can run a backend.
+Bool isMathBatchBackendSupported(MathBatchBackend backend);
+
+/// Set the backend of the batch math functions. The default is the best backend the CPU supports.
+/// @note It's not thread-safe.
+void setMathBatchBackend(MathBatchBackend backend);
+
+/// Get the backend of the batch math functions.
+MathBatchBackend getMathBatchBackend();
+
+/// Transform points. out[i] = m * Vec4(in[i], 1.0). The input and output can be the same array.
+void batchTransformPoints(const Mat3x4& m, ConstWeakArray<Vec3> in, WeakArray<Vec3> out);
+
+/// Transform homogeneous points. out[i] = m * in[i]. The input and output can be the same array.
+void batchTransformPoints(const Mat4& m, ConstWeakArray<Vec4> in, WeakArray<Vec4> out);
+
+/// Transform AABBs and compute the AABBs of the results. The input and output can be the same arrays.
+void batchTransformAabbs(const Mat3x4& m,
+	ConstWeakArray<Vec3> inMins,
+	ConstWeakArray<Vec3> inMaxs,
+	WeakArray<Vec3> outMins,
+	WeakArray<Vec3> outMaxs);
+
+/// Multiply matrices. out[i] = a * b[i]. The b and out can be the same array.
+void batchMultiplyMatrices(const Mat4& a, ConstWeakArray<Mat4> b, WeakArray<Mat4> out);
+
+/// Combine transformations. out[i] = a.combineTransformations(b[i]). The b and out can be the same array.
+void batchCombineTransformations(const Mat3x4& a, ConstWeakArray<Mat3x4> b, WeakArray<Mat3x4> out);
+
+/// Spherical interpolation. out[i] = from[i].slerp(to[i], factors[i]).
+void batchSlerpQuats(
+	ConstWeakArray<Quat> from, ConstWeakArray<Quat> to, ConstWeakArray<F32> factors, WeakArray<Quat> out);
+/// @}
+
+} // end namespace anki
@@ -23,10 +23,16 @@
 #	pragma warning(push)
 #	pragma warning(disable : 4305)
 #endif
-#define BT_THREADSAFE 0
+#define BT_THREADSAFE ANKI_PHYSICS_MULTITHREADED
 #define BT_NO_PROFILE 1
 #include <btBulletCollisionCommon.h>
 #include <btBulletDynamicsCommon.h>
+#if ANKI_PHYSICS_MULTITHREADED
+#	include <LinearMath/btThreads.h>
+#	include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#	include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#	include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#endif
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 #include <BulletDynamics/Character/btKinematicCharacterController.h>
 #include <BulletCollision/Gimpact/btGImpactShape.h>
@@ -61,6 +61,7 @@ PhysicsBody::~PhysicsBody()
 
 void PhysicsBody::setMass(F32 mass)
 {
+	assertNoUpdateInFlight();
 	ANKI_ASSERT(m_mass > 0.0f && "Only relevant for dynamic bodies");
 	ANKI_ASSERT(mass > 0.0f);
 	btVector3 inertia;
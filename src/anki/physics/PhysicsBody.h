@@ -32,6 +32,7 @@ class PhysicsBody : public PhysicsFilteredObject
 public:
 	static const PhysicsObjectType CLASS_TYPE = PhysicsObjectType::BODY;
 
+	/// Get the transform of the last simulation step that was made visible by PhysicsWorld.
 	const Transform& getTransform() const
 	{
 		return m_trf;
@@ -39,12 +40,15 @@ public:
 
 	void setTransform(const Transform& trf)
 	{
+		assertNoUpdateInFlight();
 		m_trf = trf;
+		m_simulatedTrf = trf;
 		m_body->setWorldTransform(toBt(trf));
 	}
 
 	void applyForce(const Vec3& force, const Vec3& relPos)
 	{
+		assertNoUpdateInFlight();
 		m_body->applyForce(toBt(force), toBt(relPos));
 	}
 
@@ -57,6 +61,7 @@ public:
 
 	void activate(Bool activate)
 	{
+		assertNoUpdateInFlight();
 		m_body->forceActivationState((activate) ? ACTIVE_TAG : DISABLE_SIMULATION);
 		if(activate)
 		{
@@ -66,26 +71,31 @@ public:
 
 	void clearForces()
 	{
+		assertNoUpdateInFlight();
 		m_body->clearForces();
 	}
 
 	void setLinearVelocity(const Vec3& velocity)
 	{
+		assertNoUpdateInFlight();
 		m_body->setLinearVelocity(toBt(velocity));
 	}
 
 	void setAngularVelocity(const Vec3& velocity)
 	{
+		assertNoUpdateInFlight();
 		m_body->setAngularVelocity(toBt(velocity));
 	}
 
 	void setGravity(const Vec3& gravity)
 	{
+		assertNoUpdateInFlight();
 		m_body->setGravity(toBt(gravity));
 	}
 
 	void setAngularFactor(const Vec3& factor)
 	{
+		assertNoUpdateInFlight();
 		m_body->setAngularFactor(toBt(factor));
 	}
 
@@ -100,6 +110,12 @@ anki_internal:
 		return m_body.get();
 	}
 
+	/// Make the results of the simulation visible to getTransform().
+	void publishTransform()
+	{
+		m_trf = m_simulatedTrf;
+	}
+
 private:
 	class MotionState : public btMotionState
 	{
@@ -108,19 +124,21 @@ private:
 
 		void getWorldTransform(btTransform& worldTrans) const override
 		{
-			worldTrans = toBt(m_body->m_trf);
+			worldTrans = toBt(m_body->m_simulatedTrf);
 		}
 
 		void setWorldTransform(const btTransform& worldTrans) override
 		{
-			m_body->m_trf = toAnki(worldTrans);
+			// Bullet passes the interpolated transform of the fixed time step here
+			m_body->m_simulatedTrf = toAnki(worldTrans);
 		}
 	};
 
 	/// Store the data of the btRigidBody in place to avoid additional allocations.
 	ClassWrapper<btRigidBody> m_body;
 
-	Transform m_trf = Transform::getIdentity();
+	Transform m_trf = Transform::getIdentity(); ///< The published transform.
+	Transform m_simulatedTrf = Transform::getIdentity(); ///< Written by the simulation, possibly in another thread.
 	MotionState m_motionState;
 
 	PhysicsCollisionShapePtr m_shape;
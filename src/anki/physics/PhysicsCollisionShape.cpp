@@ -35,8 +35,39 @@ PhysicsBox::~PhysicsBox()
 	m_box.destroy();
 }
 
-PhysicsTriangleSoup::PhysicsTriangleSoup(
-	PhysicsWorld* world, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex)
+/// Check that a deserialized BVH can be traversed and that it points to existing triangles.
+static Bool validateBvh(btOptimizedBvh& bvh, U32 triangleCount)
+{
+	if(!bvh.isQuantized())
+	{
+		return false;
+	}
+
+	const QuantizedNodeArray& nodes = bvh.getQuantizedNodeArray();
+	for(I32 i = 0; i < nodes.size(); ++i)
+	{
+		const btQuantizedBvhNode& node = nodes[i];
+		if(node.isLeafNode())
+		{
+			if(node.getPartId() != 0 || node.getTriangleIndex() < 0 || U32(node.getTriangleIndex()) >= triangleCount)
+			{
+				return false;
+			}
+		}
+		else if(node.getEscapeIndex() <= 0 || i + node.getEscapeIndex() > nodes.size())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+PhysicsTriangleSoup::PhysicsTriangleSoup(PhysicsWorld* world,
+	ConstWeakArray<Vec3> positions,
+	ConstWeakArray<U32> indices,
+	Bool convex,
+	ConstWeakArray<U8> serializedBvh)
 	: PhysicsCollisionShape(world, ShapeType::TRI_MESH)
 {
 	if(!convex)
@@ -57,8 +88,42 @@ PhysicsTriangleSoup::PhysicsTriangleSoup(
 		m_triMesh.m_dynamic->updateBound();
 		m_triMesh.m_dynamic->setUserPointer(static_cast<PhysicsObject*>(this));
 
-		// And the static one
-		m_triMesh.m_static.init(m_mesh.get(), true);
+		// And the static one. Try to use the serialized BVH first since building it is expensive. Bullet reads the
+		// header of the BVH without checking the size
+		if(serializedBvh.getSize() >= sizeof(btOptimizedBvh))
+		{
+			// Bullet deserializes in place so copy it to memory with the correct alignment
+			m_bvhBuffer = getAllocator().getMemoryPool().allocate(serializedBvh.getSize(), 16);
+			memcpy(m_bvhBuffer, &serializedBvh[0], serializedBvh.getSize());
+
+			m_bvh = btOptimizedBvh::deSerializeInPlace(m_bvhBuffer, U32(serializedBvh.getSize()), false);
+			if(m_bvh && !validateBvh(*m_bvh, indices.getSize() / 3))
+			{
+				m_bvh->~btOptimizedBvh();
+				m_bvh = nullptr;
+			}
+
+			if(m_bvh == nullptr)
+			{
+				ANKI_PHYS_LOGW("Failed to deserialize the BVH. Will build it");
+				getAllocator().getMemoryPool().free(m_bvhBuffer);
+				m_bvhBuffer = nullptr;
+			}
+		}
+		else if(serializedBvh.getSize() > 0)
+		{
+			ANKI_PHYS_LOGW("The serialized BVH is too small. Will build it");
+		}
+
+		if(m_bvh)
+		{
+			m_triMesh.m_static.init(m_mesh.get(), true, false);
+			m_triMesh.m_static->setOptimizedBvh(m_bvh);
+		}
+		else
+		{
+			m_triMesh.m_static.init(m_mesh.get(), true);
+		}
 		m_triMesh.m_static->setMargin(getWorld().getCollisionMargin());
 		m_triMesh.m_static->setUserPointer(static_cast<PhysicsObject*>(this));
 	}
@@ -79,6 +144,12 @@ PhysicsTriangleSoup::~PhysicsTriangleSoup()
 		m_triMesh.m_dynamic.destroy();
 		m_triMesh.m_static.destroy();
 		m_mesh.destroy();
+
+		if(m_bvh)
+		{
+			m_bvh->~btOptimizedBvh();
+			getAllocator().getMemoryPool().free(m_bvhBuffer);
+		}
 	}
 	else
 	{
@@ -87,4 +158,25 @@ PhysicsTriangleSoup::~PhysicsTriangleSoup()
 	}
 }
 
+void PhysicsTriangleSoup::serializeBvh(DynamicArrayAuto<U8>& out) const
+{
+	ANKI_ASSERT(m_type == ShapeType::TRI_MESH);
+	// Bullet doesn't have a const getter
+	const btOptimizedBvh* bvh = const_cast<btBvhTriangleMeshShape*>(m_triMesh.m_static.get())->getOptimizedBvh();
+	ANKI_ASSERT(bvh);
+
+	// Bullet wants an aligned buffer
+	const U32 size = bvh->calculateSerializeBufferSize();
+	void* buffer = getAllocator().getMemoryPool().allocate(size, 16);
+
+	const Bool ok = bvh->serializeInPlace(buffer, size, false);
+	(void)ok;
+	ANKI_ASSERT(ok);
+
+	out.resize(size);
+	memcpy(&out[0], buffer, size);
+
+	getAllocator().getMemoryPool().free(buffer);
+}
+
 } // end namespace anki
@@ -8,6 +8,7 @@
 #include <anki/physics/PhysicsObject.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/ClassWrapper.h>
+#include <anki/util/DynamicArray.h>
 
 namespace anki
 {
@@ -129,11 +130,30 @@ class PhysicsTriangleSoup final : public PhysicsCollisionShape
 {
 	ANKI_PHYSICS_OBJECT
 
+public:
+	/// Serialize the BVH of the static shape. It can be passed to the constructor of another PhysicsTriangleSoup with
+	/// the same triangles to skip building the BVH. It's not valid for convex shapes.
+	void serializeBvh(DynamicArrayAuto<U8>& out) const;
+
+	/// Check if the BVH got loaded from a serialized BVH.
+	Bool isBvhDeserialized() const
+	{
+		return m_bvh != nullptr;
+	}
+
 private:
 	ClassWrapper<btTriangleMesh> m_mesh;
 
-	PhysicsTriangleSoup(
-		PhysicsWorld* world, ConstWeakArray<Vec3> positions, ConstWeakArray<U32> indices, Bool convex = false);
+	void* m_bvhBuffer = nullptr; ///< The memory that the deserialized BVH lives in.
+	btOptimizedBvh* m_bvh = nullptr; ///< The deserialized BVH.
+
+	/// @param serializedBvh Optional. The output of serializeBvh() for the same triangles. If it's not valid the BVH
+	///                      will be built.
+	PhysicsTriangleSoup(PhysicsWorld* world,
+		ConstWeakArray<Vec3> positions,
+		ConstWeakArray<U32> indices,
+		Bool convex = false,
+		ConstWeakArray<U8> serializedBvh = ConstWeakArray<U8>());
 
 	~PhysicsTriangleSoup();
 };
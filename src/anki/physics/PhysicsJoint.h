@@ -23,6 +23,7 @@ public:
 	/// Set the breaking impulse.
 	void setBreakingImpulseThreshold(F32 impulse)
 	{
+		assertNoUpdateInFlight();
 		getJoint()->setBreakingImpulseThreshold(impulse);
 	}
 
@@ -35,6 +36,7 @@ public:
 	/// Break the joint.
 	void brake()
 	{
+		assertNoUpdateInFlight();
 		getJoint()->setEnabled(false);
 	}
 
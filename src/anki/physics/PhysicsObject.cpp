@@ -14,4 +14,9 @@ HeapAllocator<U8> PhysicsObject::getAllocator() const
 	return m_world->getAllocator();
 }
 
+Bool PhysicsObject::isWorldUpdateInFlight() const
+{
+	return m_world->isUpdateInFlight();
+}
+
 } // end namespace anki
\ No newline at end of file
@@ -81,10 +81,18 @@ public:
 protected:
 	PhysicsWorld* m_world = nullptr;
 
+	/// The objects can't be touched while the world steps in parallel. See PhysicsWorld::beginUpdate().
+	void assertNoUpdateInFlight() const
+	{
+		ANKI_ASSERT(!isWorldUpdateInFlight() && "Touching a physics object while the world is stepping");
+	}
+
 private:
 	Atomic<I32> m_refcount = {0};
 	PhysicsObjectType m_type;
 	void* m_userData = nullptr;
+
+	Bool isWorldUpdateInFlight() const;
 };
 
 #define ANKI_PHYSICS_OBJECT \
@@ -37,6 +37,7 @@ PhysicsPlayerController::PhysicsPlayerController(PhysicsWorld* world, const Phys
 
 	// Need to call this else the player is upside down
 	moveToPosition(init.m_position);
+	publishTransform();
 }
 
 PhysicsPlayerController::~PhysicsPlayerController()
@@ -54,6 +55,7 @@ PhysicsPlayerController::~PhysicsPlayerController()
 
 void PhysicsPlayerController::moveToPosition(const Vec4& position)
 {
+	assertNoUpdateInFlight();
 	auto lock = getWorld().lockBtWorld();
 
 	getWorld().getBtWorld()->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(
@@ -37,16 +37,26 @@ public:
 	// Update the state machine
 	void setVelocity(F32 forwardSpeed, F32 strafeSpeed, F32 jumpSpeed, const Vec4& forwardDir)
 	{
+		assertNoUpdateInFlight();
 		m_controller->setWalkDirection(toBt((forwardDir * forwardSpeed).xyz()));
 	}
 
 	void moveToPosition(const Vec4& position);
 
+	/// Get the transform of the last simulation step that was made visible by PhysicsWorld.
 	Transform getTransform(Bool& updated)
 	{
-		Transform out = toAnki(m_ghostObject->getWorldTransform());
-		updated = m_prevTrf != out;
-		return out;
+		updated = m_trfUpdated;
+		return m_trf;
+	}
+
+anki_internal:
+	/// Make the results of the simulation visible to getTransform().
+	void publishTransform()
+	{
+		const Transform trf = toAnki(m_ghostObject->getWorldTransform());
+		m_trfUpdated = trf != m_trf;
+		m_trf = trf;
 	}
 
 private:
@@ -54,7 +64,8 @@ private:
 	ClassWrapper<btCapsuleShape> m_convexShape;
 	ClassWrapper<btKinematicCharacterController> m_controller;
 
-	Transform m_prevTrf = Transform::getIdentity();
+	Transform m_trf = Transform::getIdentity(); ///< The published transform.
+	Bool m_trfUpdated = true;
 
 	PhysicsPlayerController(PhysicsWorld* world, const PhysicsPlayerControllerInitInfo& init);
 
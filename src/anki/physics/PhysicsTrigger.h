@@ -37,6 +37,7 @@ public:
 
 	void setTransform(const Transform& trf)
 	{
+		assertNoUpdateInFlight();
 		m_ghostShape->setWorldTransform(toBt(trf));
 	}
 
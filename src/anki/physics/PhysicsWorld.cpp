@@ -7,8 +7,16 @@
 #include <anki/physics/PhysicsCollisionShape.h>
 #include <anki/physics/PhysicsBody.h>
 #include <anki/physics/PhysicsTrigger.h>
+#include <anki/physics/PhysicsPlayerController.h>
 #include <anki/util/Rtti.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Tracer.h>
 #include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
+#include <BulletCollision/CollisionShapes/btTriangleShape.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
+#include <BulletCollision/NarrowPhaseCollision/btGjkEpaPenetrationDepthSolver.h>
+#include <BulletCollision/NarrowPhaseCollision/btVoronoiSimplexSolver.h>
+#include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
 
 namespace anki
 {
@@ -139,6 +147,170 @@ public:
 	}
 };
 
+/// Splits a loop into chunks and processes them in the ThreadHive. The calling thread processes chunks as well. It
+/// returns when all the chunks are done without waiting for the tasks that didn't get any chunk to start running. That
+/// way it's safe to use from a ThreadHive task even when all the threads are busy. The context lives in the hive's
+/// scratch memory because those tasks might touch it after it returns. ThreadHive::waitAllTasks() waits for them before
+/// it frees the memory.
+class PhysicsWorld::MyParallelFor
+{
+public:
+	using Callback = void (*)(void* userData, I32 begin, I32 end);
+
+	static void run(
+		ThreadHive* hive, U32 threadCount, I32 begin, I32 end, I32 grainSize, Callback callback, void* userData)
+	{
+		ANKI_ASSERT(end >= begin && grainSize > 0 && threadCount > 0 && callback);
+		const I32 chunkCount = (end - begin + grainSize - 1) / grainSize;
+		const U32 taskCount =
+			(hive && chunkCount > 1) ? min<U32>(min<U32>(chunkCount, threadCount) - 1, ThreadHive::MAX_THREADS) : 0;
+
+		if(taskCount == 0)
+		{
+			if(begin < end)
+			{
+				callback(userData, begin, end);
+			}
+			return;
+		}
+
+		Context* ctx = ::new(hive->allocateScratchMemory(sizeof(Context), alignof(Context))) Context();
+		ctx->m_callback = callback;
+		ctx->m_userData = userData;
+		ctx->m_begin = begin;
+		ctx->m_end = end;
+		ctx->m_grainSize = grainSize;
+		ctx->m_chunkCount = chunkCount;
+
+		Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+		for(U32 i = 0; i < taskCount; ++i)
+		{
+			tasks[i] = ANKI_THREAD_HIVE_TASK({ runChunks(*self); }, ctx, nullptr, nullptr);
+		}
+
+		hive->submitTasks(&tasks[0], taskCount);
+
+		// Work in this thread until all the chunks are taken
+		runChunks(*ctx);
+
+		// Wait for the chunks that other threads are still processing. They are at most one per thread. Acquire to see
+		// what they wrote
+		while(ctx->m_doneChunks.load(AtomicMemoryOrder::ACQUIRE) < chunkCount)
+		{
+			Thread::yield();
+		}
+	}
+
+private:
+	class Context
+	{
+	public:
+		Callback m_callback = nullptr;
+		void* m_userData = nullptr;
+		I32 m_begin = 0;
+		I32 m_end = 0;
+		I32 m_grainSize = 0;
+		I32 m_chunkCount = 0;
+		Atomic<I32> m_nextChunk = {0};
+		Atomic<I32> m_doneChunks = {0};
+	};
+
+	static void runChunks(Context& ctx)
+	{
+		I32 chunk;
+		while((chunk = ctx.m_nextChunk.fetchAdd(1)) < ctx.m_chunkCount)
+		{
+			const I32 begin = ctx.m_begin + chunk * ctx.m_grainSize;
+			const I32 end = min(begin + ctx.m_grainSize, ctx.m_end);
+			ctx.m_callback(ctx.m_userData, begin, end);
+
+			ctx.m_doneChunks.fetchAdd(1, AtomicMemoryOrder::RELEASE);
+		}
+	}
+};
+
+#if ANKI_PHYSICS_MULTITHREADED
+/// Bullet task scheduler that runs the parallel loops in the ThreadHive. The calling thread participates as well.
+class PhysicsWorld::MyTaskScheduler : public btITaskScheduler
+{
+public:
+	MyTaskScheduler(ThreadHive& hive)
+		: btITaskScheduler("ThreadHive")
+		, m_hive(&hive)
+	{
+		m_threadCount = getMaxNumThreads();
+	}
+
+	int getMaxNumThreads() const override
+	{
+		// Bullet sizes its per-thread data with that and indexes it with btGetCurrentThreadIndex(). The thread that
+		// created the world has the index 0 and the hive threads take the rest, so count it even if it never steps
+		return min<int>(m_hive->getThreadCount() + 1, BT_MAX_THREAD_COUNT);
+	}
+
+	int getNumThreads() const override
+	{
+		return m_threadCount;
+	}
+
+	void setNumThreads(int numThreads) override
+	{
+		m_threadCount = clamp(numThreads, 1, getMaxNumThreads());
+	}
+
+	void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+	{
+		MyParallelFor::run(m_hive,
+			getWorkerCount(),
+			iBegin,
+			iEnd,
+			grainSize,
+			[](void* ud, I32 begin, I32 end) { static_cast<const btIParallelForBody*>(ud)->forLoop(begin, end); },
+			const_cast<btIParallelForBody*>(&body));
+	}
+
+	btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+	{
+		SumContext ctx;
+		ctx.m_body = &body;
+		MyParallelFor::run(m_hive,
+			getWorkerCount(),
+			iBegin,
+			iEnd,
+			grainSize,
+			[](void* ud, I32 begin, I32 end) {
+				SumContext& ctx = *static_cast<SumContext*>(ud);
+				const btScalar sum = ctx.m_body->sumLoop(begin, end);
+
+				LockGuard<SpinLock> lock(ctx.m_lock);
+				ctx.m_sum += sum;
+			},
+			&ctx);
+		return ctx.m_sum;
+	}
+
+private:
+	class SumContext
+	{
+	public:
+		const btIParallelSumBody* m_body = nullptr;
+		SpinLock m_lock;
+		btScalar m_sum = 0.0f;
+	};
+
+	ThreadHive* m_hive;
+	int m_threadCount;
+
+	/// The number of threads that can work on a loop, including the caller. When the world is stepped in a hive task
+	/// the caller is one of the hive threads so don't count it twice.
+	U32 getWorkerCount() const
+	{
+		const U32 hiveThreadCount = U32(m_threadCount - 1);
+		return (btIsMainThread()) ? hiveThreadCount + 1 : max<U32>(hiveThreadCount, 1);
+	}
+};
+#endif
+
 PhysicsWorld::PhysicsWorld()
 {
 }
@@ -151,10 +323,26 @@ PhysicsWorld::~PhysicsWorld()
 		ANKI_ASSERT(m_objectLists[type].isEmpty() && "Someone is holding refs to some physics objects");
 	}
 #endif
+	ANKI_ASSERT(!m_asyncUpdateInFlight && "Forgot to call endUpdate()");
 
-	m_world.destroy();
-	m_solver.destroy();
-	m_dispatcher.destroy();
+#if ANKI_PHYSICS_MULTITHREADED
+	if(m_taskScheduler)
+	{
+		m_worldMt.destroy();
+		m_solverMt.destroy();
+		m_solverPoolMt.destroy();
+		m_dispatcherMt.destroy();
+
+		btSetTaskScheduler(nullptr);
+		m_alloc.deleteInstance(m_taskScheduler);
+	}
+	else
+#endif
+	{
+		m_world.destroy();
+		m_solver.destroy();
+		m_dispatcher.destroy();
+	}
 	m_collisionConfig.destroy();
 	m_broadphase.destroy();
 	m_gpc.destroy();
@@ -163,7 +351,7 @@ PhysicsWorld::~PhysicsWorld()
 	gAlloc = nullptr;
 }
 
-Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
+Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* hive)
 {
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbData);
 	m_tmpAlloc = StackAllocator<U8>(allocCb, allocCbData, 1_KB, 2.0f);
@@ -181,39 +369,124 @@ Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
 
 	m_collisionConfig.init();
 
-	m_dispatcher.init(m_collisionConfig.get());
-	btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher.get());
+#if ANKI_PHYSICS_MULTITHREADED
+	if(hive)
+	{
+		// Bullet will use the scheduler for the narrowphase, the island solving and the integration
+		m_taskScheduler = m_alloc.newInstance<MyTaskScheduler>(*hive);
+		btSetTaskScheduler(m_taskScheduler);
+
+		m_dispatcherMt.init(m_collisionConfig.get(), 40);
+		btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcherMt.get());
 
-	m_solver.init();
+		m_solverPoolMt.init(m_taskScheduler->getNumThreads());
+		m_solverMt.init();
 
-	m_world.init(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), m_collisionConfig.get());
-	m_world->setGravity(btVector3(0.0f, -9.8f, 0.0f));
+		m_worldMt.init(m_dispatcherMt.get(),
+			m_broadphase.get(),
+			m_solverPoolMt.get(),
+			m_solverMt.get(),
+			m_collisionConfig.get());
+		m_btWorld = m_worldMt.get();
+
+		ANKI_PHYS_LOGI("Using multithreaded physics with %d threads", m_taskScheduler->getNumThreads());
+	}
+	else
+#endif
+	{
+		m_dispatcher.init(m_collisionConfig.get());
+		btGImpactCollisionAlgorithm::registerAlgorithm(m_dispatcher.get());
+
+		m_solver.init();
+
+		m_world.init(m_dispatcher.get(), m_broadphase.get(), m_solver.get(), m_collisionConfig.get());
+		m_btWorld = m_world.get();
+	}
+
+	m_btWorld->setGravity(btVector3(0.0f, -9.8f, 0.0f));
 
 	return Error::NONE;
 }
 
 Error PhysicsWorld::update(Second dt)
 {
-	// Update world
+	ANKI_ASSERT(!m_asyncUpdateInFlight);
+	step(dt);
+	publishUpdate();
+	return Error::NONE;
+}
+
+void PhysicsWorld::beginUpdate(Second dt, ThreadHive& hive)
+{
+	ANKI_ASSERT(!m_asyncUpdateInFlight);
+	m_asyncUpdateInFlight = true;
+	m_asyncStepDone = false;
+	m_asyncDt = dt;
+
+	hive.submitTask(
+		[](void* ud, U32, ThreadHive&, ThreadHiveSemaphore*) {
+			PhysicsWorld& self = *static_cast<PhysicsWorld*>(ud);
+			self.step(self.m_asyncDt);
+
+			LockGuard<Mutex> lock(self.m_asyncMtx);
+			self.m_asyncStepDone = true;
+			self.m_asyncCondVar.notifyAll();
+		},
+		this);
+}
+
+Error PhysicsWorld::endUpdate()
+{
+	if(!m_asyncUpdateInFlight)
 	{
-		auto lock = lockBtWorld();
-		m_world->stepSimulation(F32(dt), 1, 1.0f / 60.0f);
+		return Error::NONE;
 	}
 
-	// Process trigger contacts
 	{
-		LockGuard<Mutex> lock(m_objectListsMtx);
-
-		for(PhysicsObject& trigger : m_objectLists[PhysicsObjectType::TRIGGER])
+		LockGuard<Mutex> lock(m_asyncMtx);
+		while(!m_asyncStepDone)
 		{
-			static_cast<PhysicsTrigger&>(trigger).processContacts();
+			m_asyncCondVar.wait(m_asyncMtx);
 		}
 	}
 
+	m_asyncUpdateInFlight = false;
+	publishUpdate();
+	return Error::NONE;
+}
+
+void PhysicsWorld::step(Second dt)
+{
+	ANKI_TRACE_SCOPED_EVENT(PHYSICS_STEP);
+
+	// Bullet will step with a fixed time step and it will interpolate the transforms it passes to the motion states
+	auto lock = lockBtWorld();
+	m_btWorld->stepSimulation(F32(dt), 1, 1.0f / 60.0f);
+}
+
+void PhysicsWorld::publishUpdate()
+{
+	LockGuard<Mutex> lock(m_objectListsMtx);
+
+	// Publish the transforms
+	for(PhysicsObject& body : m_objectLists[PhysicsObjectType::BODY])
+	{
+		static_cast<PhysicsBody&>(body).publishTransform();
+	}
+
+	for(PhysicsObject& player : m_objectLists[PhysicsObjectType::PLAYER_CONTROLLER])
+	{
+		static_cast<PhysicsPlayerController&>(player).publishTransform();
+	}
+
+	// Process trigger contacts
+	for(PhysicsObject& trigger : m_objectLists[PhysicsObjectType::TRIGGER])
+	{
+		static_cast<PhysicsTrigger&>(trigger).processContacts();
+	}
+
 	// Reset the pool
 	m_tmpAlloc.getMemoryPool().reset();
-
-	return Error::NONE;
 }
 
 void PhysicsWorld::destroyObject(PhysicsObject* obj)
@@ -237,7 +510,313 @@ void PhysicsWorld::rayCast(WeakArray<PhysicsWorldRayCastCallback*> rayCasts)
 	for(PhysicsWorldRayCastCallback* cb : rayCasts)
 	{
 		callback.m_raycast = cb;
-		m_world->rayTest(toBt(cb->m_from), toBt(cb->m_to), callback);
+		m_btWorld->rayTest(toBt(cb->m_from), toBt(cb->m_to), callback);
+	}
+}
+
+/// Holds the state of PhysicsWorld::query.
+class PhysicsWorld::MyQueryContext
+{
+public:
+	const PhysicsWorld* m_world = nullptr;
+	ConstWeakArray<PhysicsWorldQuery> m_queries;
+	WeakArray<PhysicsWorldQueryResult> m_results;
+};
+
+/// Test a convex shape against a collision object using GJK. It doesn't use the dispatcher so it's thread-safe.
+class MyOverlapTester
+{
+public:
+	const btConvexShape* m_queryShape = nullptr;
+	btTransform m_queryTrf;
+	const btCollisionObject* m_hitObject = nullptr;
+	btVector3 m_hitPosition;
+	btVector3 m_hitNormal;
+
+	Bool test(const btCollisionObject& obj)
+	{
+		const btCollisionShape* shape = obj.getCollisionShape();
+		const btTransform& objTrf = obj.getWorldTransform();
+
+		if(shape->isConvex())
+		{
+			return testConvex(*static_cast<const btConvexShape*>(shape), objTrf, obj);
+		}
+		else if(shape->isConcave())
+		{
+			// Gather the triangles that touch the query shape in the local space of the object
+			TriangleCallback cb;
+			cb.m_tester = this;
+			cb.m_objTrf = &objTrf;
+			cb.m_obj = &obj;
+
+			btVector3 aabbMin, aabbMax;
+			m_queryShape->getAabb(objTrf.inverse() * m_queryTrf, aabbMin, aabbMax);
+			static_cast<const btConcaveShape*>(shape)->processAllTriangles(&cb, aabbMin, aabbMax);
+
+			return m_hitObject != nullptr;
+		}
+
+		// Compound shapes are not used
+		return false;
+	}
+
+private:
+	class TriangleCallback : public btTriangleCallback
+	{
+	public:
+		MyOverlapTester* m_tester = nullptr;
+		const btTransform* m_objTrf = nullptr;
+		const btCollisionObject* m_obj = nullptr;
+
+		void processTriangle(btVector3* triangle, int partId, int triangleIndex) override
+		{
+			if(m_tester->m_hitObject == nullptr)
+			{
+				btTriangleShape tri(triangle[0], triangle[1], triangle[2]);
+				m_tester->testConvex(tri, *m_objTrf, *m_obj);
+			}
+		}
+	};
+
+	Bool testConvex(const btConvexShape& shape, const btTransform& shapeTrf, const btCollisionObject& obj)
+	{
+		btVoronoiSimplexSolver simplexSolver;
+		btGjkEpaPenetrationDepthSolver penetrationSolver;
+		btGjkPairDetector gjk(m_queryShape, &shape, &simplexSolver, &penetrationSolver);
+
+		btGjkPairDetector::ClosestPointInput input;
+		input.m_transformA = m_queryTrf;
+		input.m_transformB = shapeTrf;
+
+		btPointCollector output;
+		gjk.getClosestPoints(input, output, nullptr);
+
+		if(output.m_hasResult && output.m_distance <= 0.0f)
+		{
+			m_hitObject = &obj;
+			m_hitPosition = output.m_pointInWorld;
+			m_hitNormal = output.m_normalOnBInWorld;
+			return true;
+		}
+
+		return false;
+	}
+};
+
+/// Visits the broadphase leafs for a single query and runs the narrowphase on them.
+class MyQueryLeafVisitor : public btDbvt::ICollide
+{
+public:
+	const PhysicsWorldQuery* m_query = nullptr;
+	btTransform m_fromTrf;
+	btTransform m_toTrf;
+	const btConvexShape* m_castShape = nullptr; ///< It's nullptr for rays.
+
+	btCollisionWorld::ClosestRayResultCallback* m_rayCallback = nullptr;
+	btCollisionWorld::ClosestConvexResultCallback* m_sweepCallback = nullptr;
+	MyOverlapTester* m_overlapTester = nullptr;
+
+	void Process(const btDbvtNode* leaf) override
+	{
+		const btBroadphaseProxy* proxy = static_cast<const btBroadphaseProxy*>(leaf->data);
+		btCollisionObject* obj = static_cast<btCollisionObject*>(proxy->m_clientObject);
+		ANKI_ASSERT(obj);
+
+		const PhysicsObject* pobj = static_cast<const PhysicsObject*>(obj->getUserPointer());
+		if(pobj == nullptr)
+		{
+			return;
+		}
+
+		const PhysicsFilteredObject* fobj = dcast<const PhysicsFilteredObject*>(pobj);
+		if(!(fobj->getMaterialGroup() & m_query->m_materialMask))
+		{
+			return;
+		}
+
+		if(m_rayCallback)
+		{
+			btCollisionWorld::rayTestSingle(
+				m_fromTrf, m_toTrf, obj, obj->getCollisionShape(), obj->getWorldTransform(), *m_rayCallback);
+		}
+		else if(m_sweepCallback)
+		{
+			btCollisionWorld::objectQuerySingle(m_castShape,
+				m_fromTrf,
+				m_toTrf,
+				obj,
+				obj->getCollisionShape(),
+				obj->getWorldTransform(),
+				*m_sweepCallback,
+				0.0f);
+		}
+		else if(m_overlapTester->m_hitObject == nullptr)
+		{
+			m_overlapTester->test(*obj);
+		}
+	}
+};
+
+void PhysicsWorld::query(
+	ConstWeakArray<PhysicsWorldQuery> queries, WeakArray<PhysicsWorldQueryResult> results, ThreadHive* hive) const
+{
+	ANKI_TRACE_SCOPED_EVENT(PHYSICS_QUERY);
+	ANKI_ASSERT(queries.getSize() == results.getSize());
+
+	// Lock once. Nothing will touch the broadphase and the collision objects until the batch is done
+	auto lock = lockBtWorld();
+
+	MyQueryContext ctx;
+	ctx.m_world = this;
+	ctx.m_queries = queries;
+	ctx.m_results = results;
+
+	const U32 threadCount = (hive) ? hive->getThreadCount() + 1 : 1;
+	const I32 grainSize = 32;
+	MyParallelFor::run(hive,
+		threadCount,
+		0,
+		I32(queries.getSize()),
+		grainSize,
+		[](void* ud, I32 begin, I32 end) {
+			const MyQueryContext& ctx = *static_cast<const MyQueryContext*>(ud);
+			for(I32 i = begin; i < end; ++i)
+			{
+				ctx.m_world->runQuery(ctx.m_queries[i], ctx.m_results[i]);
+			}
+		},
+		&ctx);
+}
+
+void PhysicsWorld::runQuery(const PhysicsWorldQuery& q, PhysicsWorldQueryResult& result) const
+{
+	result = PhysicsWorldQueryResult();
+
+	const Bool overlap = q.m_type == PhysicsWorldQueryType::SPHERE_OVERLAP
+						 || q.m_type == PhysicsWorldQueryType::BOX_OVERLAP;
+	const Bool sweep =
+		q.m_type == PhysicsWorldQueryType::SPHERE_SWEEP || q.m_type == PhysicsWorldQueryType::BOX_SWEEP;
+
+	// The rays and the sweeps should have some length
+	if(!overlap && (q.m_to - q.m_from).getLengthSquared() <= EPSILON * EPSILON)
+	{
+		return;
+	}
+
+	// Create the query shape
+	btSphereShape sphere(q.m_extend.x());
+	btBoxShape box(toBt(q.m_extend));
+	const btConvexShape* castShape = nullptr;
+	if(q.m_type == PhysicsWorldQueryType::SPHERE_SWEEP || q.m_type == PhysicsWorldQueryType::SPHERE_OVERLAP)
+	{
+		ANKI_ASSERT(q.m_extend.x() > 0.0f);
+		castShape = &sphere;
+	}
+	else if(q.m_type != PhysicsWorldQueryType::RAY_CAST)
+	{
+		ANKI_ASSERT(q.m_extend > Vec3(0.0f));
+		castShape = &box;
+	}
+
+	const Mat3& r = q.m_rotation;
+	const btMatrix3x3 rot(r(0, 0), r(0, 1), r(0, 2), r(1, 0), r(1, 1), r(1, 2), r(2, 0), r(2, 1), r(2, 2));
+
+	MyQueryLeafVisitor visitor;
+	visitor.m_query = &q;
+	visitor.m_fromTrf = btTransform(rot, toBt(q.m_from));
+	visitor.m_toTrf = btTransform(rot, toBt(q.m_to));
+	visitor.m_castShape = castShape;
+
+	btCollisionWorld::ClosestRayResultCallback rayCallback(toBt(q.m_from), toBt(q.m_to));
+	btCollisionWorld::ClosestConvexResultCallback sweepCallback(toBt(q.m_from), toBt(q.m_to));
+	MyOverlapTester overlapTester;
+
+	const btDbvtBroadphase& broadphase = *m_broadphase.get();
+	if(overlap)
+	{
+		overlapTester.m_queryShape = castShape;
+		overlapTester.m_queryTrf = visitor.m_fromTrf;
+		visitor.m_overlapTester = &overlapTester;
+
+		btVector3 aabbMin, aabbMax;
+		castShape->getAabb(visitor.m_fromTrf, aabbMin, aabbMax);
+		const btDbvtVolume volume = btDbvtVolume::FromMM(aabbMin, aabbMax);
+
+		for(const btDbvt& tree : broadphase.m_sets)
+		{
+			if(tree.m_root && overlapTester.m_hitObject == nullptr)
+			{
+				tree.collideTV(tree.m_root, volume, visitor);
+			}
+		}
+
+		if(overlapTester.m_hitObject)
+		{
+			result.m_object =
+				dcast<PhysicsFilteredObject*>(static_cast<PhysicsObject*>(overlapTester.m_hitObject->getUserPointer()));
+			result.m_worldPosition = toAnki(overlapTester.m_hitPosition);
+			result.m_worldNormal = toAnki(overlapTester.m_hitNormal);
+		}
+	}
+	else
+	{
+		// Same setup as btDbvtBroadphase::rayTest but with a local stack
+		const btVector3 from = toBt(q.m_from);
+		const btVector3 to = toBt(q.m_to);
+		const btVector3 rayDir = (to - from).normalized();
+
+		btVector3 rayDirInverse;
+		unsigned int signs[3];
+		for(U i = 0; i < 3; ++i)
+		{
+			rayDirInverse[i] = (rayDir[i] == 0.0f) ? BT_LARGE_FLOAT : 1.0f / rayDir[i];
+			signs[i] = rayDirInverse[i] < 0.0f;
+		}
+		const btScalar lambdaMax = rayDir.dot(to - from);
+
+		btVector3 aabbMin(0.0f, 0.0f, 0.0f);
+		btVector3 aabbMax(0.0f, 0.0f, 0.0f);
+		if(sweep)
+		{
+			castShape->getAabb(btTransform(rot), aabbMin, aabbMax);
+			visitor.m_sweepCallback = &sweepCallback;
+		}
+		else
+		{
+			visitor.m_rayCallback = &rayCallback;
+		}
+
+		btAlignedObjectArray<const btDbvtNode*> stack;
+		for(const btDbvt& tree : broadphase.m_sets)
+		{
+			if(tree.m_root)
+			{
+				tree.rayTestInternal(
+					tree.m_root, from, to, rayDirInverse, signs, lambdaMax, aabbMin, aabbMax, stack, visitor);
+			}
+		}
+
+		const btCollisionObject* hitObj = nullptr;
+		if(sweep && sweepCallback.hasHit())
+		{
+			hitObj = sweepCallback.m_hitCollisionObject;
+			result.m_worldPosition = toAnki(sweepCallback.m_hitPointWorld);
+			result.m_worldNormal = toAnki(sweepCallback.m_hitNormalWorld);
+			result.m_hitFraction = sweepCallback.m_closestHitFraction;
+		}
+		else if(!sweep && rayCallback.hasHit())
+		{
+			hitObj = rayCallback.m_collisionObject;
+			result.m_worldPosition = toAnki(rayCallback.m_hitPointWorld);
+			result.m_worldNormal = toAnki(rayCallback.m_hitNormalWorld);
+			result.m_hitFraction = rayCallback.m_closestHitFraction;
+		}
+
+		if(hitObj)
+		{
+			result.m_object = dcast<PhysicsFilteredObject*>(static_cast<PhysicsObject*>(hitObj->getUserPointer()));
+		}
 	}
 }
 
@@ -14,6 +14,9 @@
 namespace anki
 {
 
+// Forward
+class ThreadHive;
+
 /// @addtogroup physics
 /// @{
 
@@ -37,6 +40,41 @@ public:
 	virtual void processResult(PhysicsFilteredObject& obj, const Vec3& worldNormal, const Vec3& worldPosition) = 0;
 };
 
+/// The type of a PhysicsWorldQuery.
+enum class PhysicsWorldQueryType : U8
+{
+	RAY_CAST,
+	SPHERE_SWEEP,
+	BOX_SWEEP,
+	SPHERE_OVERLAP,
+	BOX_OVERLAP,
+
+	COUNT
+};
+
+/// A query for PhysicsWorld::query.
+class PhysicsWorldQuery
+{
+public:
+	Vec3 m_from = Vec3(0.0f); ///< The start of the ray or the sweep. The center of the shape for overlaps.
+	Vec3 m_to = Vec3(0.0f); ///< The end of the ray or the sweep. Not used by overlaps.
+	Vec3 m_extend = Vec3(0.0f); ///< The radius of the sphere is in x. The half extents of the box otherwise.
+	Mat3 m_rotation = Mat3::getIdentity(); ///< The rotation of the box.
+	PhysicsMaterialBit m_materialMask = PhysicsMaterialBit::ALL; ///< Materials to check.
+	PhysicsWorldQueryType m_type = PhysicsWorldQueryType::RAY_CAST;
+};
+
+/// The result of a PhysicsWorldQuery.
+class PhysicsWorldQueryResult
+{
+public:
+	/// The closest object that got hit or the first object found to overlap. It's nullptr if there was no hit.
+	PhysicsFilteredObject* m_object = nullptr;
+	Vec3 m_worldPosition = Vec3(0.0f);
+	Vec3 m_worldNormal = Vec3(0.0f);
+	F32 m_hitFraction = 0.0f; ///< Where in the [m_from, m_to] segment the hit happened. Zero for overlaps.
+};
+
 /// The master container for all physics related stuff.
 class PhysicsWorld
 {
@@ -44,7 +82,12 @@ public:
 	PhysicsWorld();
 	~PhysicsWorld();
 
-	ANKI_USE_RESULT Error create(AllocAlignedCallback allocCb, void* allocCbData);
+	/// Create the world.
+	/// @param allocCb The allocation callback.
+	/// @param allocCbData The user data of allocCb.
+	/// @param hive If it's not nullptr and ANKI_PHYSICS_MULTITHREADED is enabled the world will use Bullet's
+	///             multithreaded world and solvers and it will schedule their work in that ThreadHive.
+	ANKI_USE_RESULT Error create(AllocAlignedCallback allocCb, void* allocCbData, ThreadHive* hive = nullptr);
 
 	template<typename T, typename... TArgs>
 	PhysicsPtr<T> newInstance(TArgs&&... args)
@@ -61,6 +104,15 @@ public:
 	/// Do the update.
 	Error update(Second dt);
 
+	/// Start an update that will run in a ThreadHive task. The world shouldn't be touched until endUpdate() is called.
+	/// The transforms of the bodies and the player controllers will keep returning the results of the previous update
+	/// until then.
+	void beginUpdate(Second dt, ThreadHive& hive);
+
+	/// Wait for the update started by beginUpdate() to finish and publish its results. It's a no-op if there is no
+	/// update in flight.
+	Error endUpdate();
+
 	HeapAllocator<U8> getAllocator() const
 	{
 		return m_alloc;
@@ -80,15 +132,26 @@ public:
 		rayCast(arr);
 	}
 
+	/// Run a batch of queries. The world is locked once for the whole batch and the queries run against the
+	/// broadphase without any further locking. The batch is split across the ThreadHive workers and the caller.
+	/// @param queries The queries.
+	/// @param results Where to write the results. It should have the same size as queries.
+	/// @param hive If it's nullptr the queries will run in the calling thread. It uses some of the hive's scratch memory
+	///             so ThreadHive::waitAllTasks() should be called at some point.
+	/// @note It's safe to call it from a ThreadHive task.
+	void query(ConstWeakArray<PhysicsWorldQuery> queries,
+		WeakArray<PhysicsWorldQueryResult> results,
+		ThreadHive* hive = nullptr) const;
+
 anki_internal:
 	btDynamicsWorld* getBtWorld()
 	{
-		return m_world.get();
+		return m_btWorld;
 	}
 
 	const btDynamicsWorld* getBtWorld() const
 	{
-		return m_world.get();
+		return m_btWorld;
 	}
 
 	F32 getCollisionMargin() const
@@ -103,9 +166,18 @@ anki_internal:
 
 	void destroyObject(PhysicsObject* obj);
 
+	/// Check if an update started by beginUpdate() hasn't been ended.
+	Bool isUpdateInFlight() const
+	{
+		return m_asyncUpdateInFlight;
+	}
+
 private:
 	class MyOverlapFilterCallback;
 	class MyRaycastCallback;
+	class MyTaskScheduler;
+	class MyParallelFor;
+	class MyQueryContext;
 
 	HeapAllocator<U8> m_alloc;
 	StackAllocator<U8> m_tmpAlloc;
@@ -118,10 +190,34 @@ private:
 	ClassWrapper<btCollisionDispatcher> m_dispatcher;
 	ClassWrapper<btSequentialImpulseConstraintSolver> m_solver;
 	ClassWrapper<btDiscreteDynamicsWorld> m_world;
+#if ANKI_PHYSICS_MULTITHREADED
+	ClassWrapper<btCollisionDispatcherMt> m_dispatcherMt;
+	ClassWrapper<btConstraintSolverPoolMt> m_solverPoolMt;
+	ClassWrapper<btSequentialImpulseConstraintSolverMt> m_solverMt;
+	ClassWrapper<btDiscreteDynamicsWorldMt> m_worldMt;
+	MyTaskScheduler* m_taskScheduler = nullptr;
+#endif
+	btDiscreteDynamicsWorld* m_btWorld = nullptr; ///< Points to m_world or m_worldMt.
 	mutable Mutex m_btWorldMtx;
 
 	Array<IntrusiveList<PhysicsObject>, U(PhysicsObjectType::COUNT)> m_objectLists;
 	mutable Mutex m_objectListsMtx;
+
+	/// @name Async update
+	/// @{
+	Second m_asyncDt = 0.0;
+	Bool m_asyncUpdateInFlight = false;
+	Bool m_asyncStepDone = false; ///< Protected by m_asyncMtx.
+	Mutex m_asyncMtx;
+	ConditionVariable m_asyncCondVar;
+	/// @}
+
+	void step(Second dt);
+
+	/// Process the results of the last step.
+	void publishUpdate();
+
+	void runQuery(const PhysicsWorldQuery& q, PhysicsWorldQueryResult& result) const;
 };
 /// @}
 
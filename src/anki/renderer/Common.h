@@ -40,6 +40,7 @@ class Ssr;
 class VolumetricLightingAccumulation;
 class GlobalIllumination;
 class GenericCompute;
+class ProbeBakeCache;
 
 class RenderingContext;
 class DebugDrawer;
@@ -111,8 +112,16 @@ constexpr Format SHADOW_DEPTH_PIXEL_FORMAT = Format::D32_SFLOAT;
 constexpr Format SHADOW_COLOR_PIXEL_FORMAT = Format::R16_UNORM;
 
 /// A convenience function to find empty cache entries. Used for various probes.
-template<typename THashMap, typename TCacheEntryArray, typename TAlloc>
-U32 findBestCacheEntry(U64 uuid, Timestamp crntTimestamp, const TCacheEntryArray& entries, THashMap& map, TAlloc alloc)
+/// @param kickScore A functor that accepts a cache entry index and returns how much the entry deserves to be kicked.
+///                  The entry with the highest score will be re-used. Entries used in the current frame are never
+///                  kicked.
+template<typename THashMap, typename TCacheEntryArray, typename TAlloc, typename TKickScoreFunc>
+U32 findBestCacheEntry(U64 uuid,
+	Timestamp crntTimestamp,
+	const TCacheEntryArray& entries,
+	THashMap& map,
+	TAlloc alloc,
+	TKickScoreFunc kickScore)
 {
 	ANKI_ASSERT(uuid > 0);
 
@@ -136,7 +145,7 @@ U32 findBestCacheEntry(U64 uuid, Timestamp crntTimestamp, const TCacheEntryArray
 	// 2nd and 3rd choice, find an empty entry or some entry to re-use
 	U32 emptyCacheEntryIdx = MAX_U32;
 	U32 cacheEntryIdxToKick = MAX_U32;
-	Timestamp cacheEntryIdxToKickMinTimestamp = MAX_TIMESTAMP;
+	F32 cacheEntryIdxToKickMaxScore = -MAX_F32;
 	for(U32 cacheEntryIdx = 0; cacheEntryIdx < entries.getSize(); ++cacheEntryIdx)
 	{
 		if(entries[cacheEntryIdx].m_uuid == 0)
@@ -145,12 +154,15 @@ U32 findBestCacheEntry(U64 uuid, Timestamp crntTimestamp, const TCacheEntryArray
 			emptyCacheEntryIdx = cacheEntryIdx;
 			break;
 		}
-		else if(entries[cacheEntryIdx].m_lastUsedTimestamp != crntTimestamp
-				&& entries[cacheEntryIdx].m_lastUsedTimestamp < cacheEntryIdxToKickMinTimestamp)
+		else if(entries[cacheEntryIdx].m_lastUsedTimestamp != crntTimestamp)
 		{
-			// Found some with low timestamp
-			cacheEntryIdxToKick = cacheEntryIdx;
-			cacheEntryIdxToKickMinTimestamp = entries[cacheEntryIdx].m_lastUsedTimestamp;
+			const F32 score = kickScore(cacheEntryIdx);
+			if(score > cacheEntryIdxToKickMaxScore)
+			{
+				// Found some that is less useful
+				cacheEntryIdxToKick = cacheEntryIdx;
+				cacheEntryIdxToKickMaxScore = score;
+			}
 		}
 	}
 
@@ -171,6 +183,15 @@ U32 findBestCacheEntry(U64 uuid, Timestamp crntTimestamp, const TCacheEntryArray
 
 	return outCacheEntryIdx;
 }
+
+/// Same as above but it kicks the least recently used cache entry.
+template<typename THashMap, typename TCacheEntryArray, typename TAlloc>
+U32 findBestCacheEntry(U64 uuid, Timestamp crntTimestamp, const TCacheEntryArray& entries, THashMap& map, TAlloc alloc)
+{
+	return findBestCacheEntry(uuid, crntTimestamp, entries, map, alloc, [&](U32 cacheEntryIdx) {
+		return F32(crntTimestamp - entries[cacheEntryIdx].m_lastUsedTimestamp);
+	});
+}
 /// @}
 
 } // end namespace anki
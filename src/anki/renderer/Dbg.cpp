@@ -88,8 +88,9 @@ void Dbg::run(RenderPassWorkContext& rgraphCtx, const RenderingContext& ctx)
 	const U32 threadId = rgraphCtx.m_currentSecondLevelCommandBufferIndex;
 	const U32 threadCount = rgraphCtx.m_secondLevelCommandBufferCount;
 	const U32 problemSize = ctx.m_renderQueue->m_renderables.getSize();
+	ANKI_ASSERT(problemSize == m_runCtx.m_costPrefixSums.getSize());
 	U32 start, end;
-	splitThreadedProblem(threadId, threadCount, problemSize, start, end);
+	splitThreadedProblem(threadId, threadCount, problemSize, m_runCtx.m_costPrefixSums.getBegin(), start, end);
 
 	for(U32 i = start; i < end; ++i)
 	{
@@ -174,6 +175,8 @@ void Dbg::populateRenderGraph(RenderingContext& ctx)
 	// Create RT
 	m_runCtx.m_rt = rgraph.newRenderTarget(m_rtDescr);
 
+	m_runCtx.m_costPrefixSums = computeRenderableCostPrefixSums(ctx, ctx.m_renderQueue->m_renderables);
+
 	// Create pass
 	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("DBG");
 
@@ -183,7 +186,7 @@ void Dbg::populateRenderGraph(RenderingContext& ctx)
 			self->run(rgraphCtx, *self->m_runCtx.m_ctx);
 		},
 		this,
-		computeNumberOfSecondLevelCommandBuffers(ctx.m_renderQueue->m_renderables.getSize()));
+		computeNumberOfSecondLevelCommandBuffers(m_runCtx.m_costPrefixSums));
 
 	pass.setFramebufferInfo(m_fbDescr, {m_runCtx.m_rt}, m_r->getGBuffer().getDepthRt());
 
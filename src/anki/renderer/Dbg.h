@@ -87,6 +87,7 @@ private:
 	public:
 		RenderTargetHandle m_rt;
 		RenderingContext* m_ctx = nullptr;
+		WeakArray<F32> m_costPrefixSums;
 	} m_runCtx;
 
 	ANKI_USE_RESULT Error lazyInit();
@@ -12,9 +12,12 @@ namespace anki
 
 DepthDownscale::~DepthDownscale()
 {
-	if(m_copyToBuff.m_buffAddr)
+	for(ClientBuffer& buff : m_copyToBuff.m_buffs)
 	{
-		m_copyToBuff.m_buff->unmap();
+		if(buff.m_addr)
+		{
+			buff.m_buff->unmap();
+		}
 	}
 }
 
@@ -55,19 +58,22 @@ Error DepthDownscale::initInternal(const ConfigSet&)
 		m_copyToBuff.m_lastMipWidth = lastMipWidth;
 		m_copyToBuff.m_lastMipHeight = lastMipHeight;
 
-		// Create buffer
-		BufferInitInfo buffInit("HiZ Client");
-		buffInit.m_access = BufferMapAccessBit::READ;
-		buffInit.m_size = lastMipHeight * lastMipWidth * sizeof(F32);
-		buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE;
-		m_copyToBuff.m_buff = getGrManager().newBuffer(buffInit);
-
-		m_copyToBuff.m_buffAddr = m_copyToBuff.m_buff->map(0, buffInit.m_size, BufferMapAccessBit::READ);
-
-		// Fill the buffer with 1.0f
-		for(U32 i = 0; i < lastMipHeight * lastMipWidth; ++i)
+		for(ClientBuffer& buff : m_copyToBuff.m_buffs)
 		{
-			static_cast<F32*>(m_copyToBuff.m_buffAddr)[i] = 1.0f;
+			// Create buffer
+			BufferInitInfo buffInit("HiZ Client");
+			buffInit.m_access = BufferMapAccessBit::READ;
+			buffInit.m_size = lastMipHeight * lastMipWidth * sizeof(F32);
+			buffInit.m_usage = BufferUsageBit::STORAGE_COMPUTE_WRITE;
+			buff.m_buff = getGrManager().newBuffer(buffInit);
+
+			buff.m_addr = buff.m_buff->map(0, buffInit.m_size, BufferMapAccessBit::READ);
+
+			// Fill the buffer with 1.0f
+			for(U32 i = 0; i < lastMipHeight * lastMipWidth; ++i)
+			{
+				static_cast<F32*>(buff.m_addr)[i] = 1.0f;
+			}
 		}
 	}
 
@@ -108,6 +114,10 @@ void DepthDownscale::populateRenderGraph(RenderingContext& ctx)
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
 	m_runCtx.m_mip = 0;
 
+	// Pick the client buffer of this frame and remember what rendered to it
+	m_copyToBuff.m_crntBuffIdx = U32(m_r->getFrameCount() % m_copyToBuff.m_buffs.getSize());
+	m_copyToBuff.m_buffs[m_copyToBuff.m_crntBuffIdx].m_viewProjMat = ctx.m_matrices.m_viewProjectionJitter;
+
 	static const Array<CString, 5> passNames = {{"HiZ #0", "HiZ #1", "HiZ #2", "HiZ #3", "HiZ #4"}};
 
 	// Every pass can do MIPS_WRITTEN_PER_PASS mips
@@ -207,7 +217,8 @@ void DepthDownscale::run(RenderPassWorkContext& rgraphCtx)
 	rgraphCtx.bindImage(0, 3, m_runCtx.m_hizRt, subresource);
 
 	// Client buffer
-	cmdb->bindStorageBuffer(0, 4, m_copyToBuff.m_buff, 0, m_copyToBuff.m_buff->getSize());
+	const BufferPtr& clientBuff = m_copyToBuff.m_buffs[m_copyToBuff.m_crntBuffIdx].m_buff;
+	cmdb->bindStorageBuffer(0, 4, clientBuff, 0, clientBuff->getSize());
 
 	// Done
 	dispatchPPCompute(cmdb, 8, 8, level0Width, level0Height);
@@ -45,12 +45,18 @@ anki_internal:
 		return m_mipCount;
 	}
 
-	void getClientDepthMapInfo(F32*& depthValues, U32& width, U32& height) const
+	/// Get the last mip of the HiZ of the newest frame that the GPU is done with. It's a few frames old.
+	/// @param[out] viewProjMat The view projection matrix that was used to render the depth values.
+	void getClientDepthMapInfo(F32*& depthValues, U32& width, U32& height, Mat4& viewProjMat) const
 	{
 		width = m_copyToBuff.m_lastMipWidth;
 		height = m_copyToBuff.m_lastMipHeight;
-		ANKI_ASSERT(m_copyToBuff.m_buffAddr);
-		depthValues = static_cast<F32*>(m_copyToBuff.m_buffAddr);
+
+		// The buffers are written in a round robin fashion so the next is the oldest
+		const U32 idx = (m_copyToBuff.m_crntBuffIdx + 1) % m_copyToBuff.m_buffs.getSize();
+		ANKI_ASSERT(m_copyToBuff.m_buffs[idx].m_addr);
+		depthValues = static_cast<F32*>(m_copyToBuff.m_buffs[idx].m_addr);
+		viewProjMat = m_copyToBuff.m_buffs[idx].m_viewProjMat;
 	}
 
 private:
@@ -69,11 +75,20 @@ private:
 		U32 m_mip;
 	} m_runCtx; ///< Run context.
 
-	class
+	class ClientBuffer
 	{
 	public:
 		BufferPtr m_buff;
-		void* m_buffAddr = nullptr;
+		void* m_addr = nullptr;
+		Mat4 m_viewProjMat = Mat4::getIdentity(); ///< The matrix of the frame that wrote to the buffer.
+	};
+
+	class
+	{
+	public:
+		/// One more than the frames in flight so the CPU can read the oldest without waiting for the GPU.
+		Array<ClientBuffer, MAX_FRAMES_IN_FLIGHT + 1> m_buffs;
+		U32 m_crntBuffIdx = 0; ///< The buffer the GPU writes to in this frame.
 		U32 m_lastMipWidth = MAX_U32, m_lastMipHeight = MAX_U32;
 	} m_copyToBuff; ///< Copy to buffer members.
 
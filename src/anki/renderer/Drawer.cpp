@@ -39,6 +39,24 @@ RenderableDrawer::~RenderableDrawer()
 {
 }
 
+void RenderableDrawer::computeCostPrefixSums(
+	ConstWeakArray<RenderableQueueElement> renderables, F32 costSoFar, WeakArray<F32> costPrefixSums)
+{
+	ANKI_ASSERT(renderables.getSize() == costPrefixSums.getSize());
+
+	// Merged elements only cost a few copies
+	const F32 MERGED_ELEMENT_COST_FACTOR = 0.25f;
+
+	for(U32 i = 0; i < renderables.getSize(); ++i)
+	{
+		const RenderableQueueElement& el = renderables[i];
+		ANKI_ASSERT(el.m_cost > 0.0f);
+		const Bool merged = i > 0 && canMergeRenderableQueueElements(renderables[i - 1], el);
+		costSoFar += (merged) ? el.m_cost * MERGED_ELEMENT_COST_FACTOR : el.m_cost;
+		costPrefixSums[i] = costSoFar;
+	}
+}
+
 void RenderableDrawer::drawRange(Pass pass,
 	const Mat4& viewMat,
 	const Mat4& viewProjMat,
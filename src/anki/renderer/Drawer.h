@@ -42,6 +42,14 @@ public:
 		const RenderableQueueElement* end,
 		U32 minLod = 0);
 
+	/// Compute the inclusive prefix sums of the recording costs of some renderables. Elements that will be merged with
+	/// the previous element are cheaper.
+	/// @param[in] renderables The renderables.
+	/// @param[in] costSoFar The cost to add to all the sums. Useful if the renderables are part of a bigger problem.
+	/// @param[out] costPrefixSums The sums. Same size as renderables.
+	static void computeCostPrefixSums(
+		ConstWeakArray<RenderableQueueElement> renderables, F32 costSoFar, WeakArray<F32> costPrefixSums);
+
 private:
 	Renderer* m_r;
 
@@ -26,14 +26,21 @@ Error ForwardShading::init(const ConfigSet& cfg)
 	return Error::NONE;
 }
 
+void ForwardShading::prepareThreadedWork(RenderingContext& ctx)
+{
+	m_costPrefixSums = computeRenderableCostPrefixSums(ctx, ctx.m_renderQueue->m_forwardShadingRenderables);
+	m_secondLevelCommandBufferCount = computeNumberOfSecondLevelCommandBuffers(m_costPrefixSums);
+}
+
 void ForwardShading::run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx)
 {
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
 	const U32 threadId = rgraphCtx.m_currentSecondLevelCommandBufferIndex;
 	const U32 threadCount = rgraphCtx.m_secondLevelCommandBufferCount;
 	const U32 problemSize = ctx.m_renderQueue->m_forwardShadingRenderables.getSize();
+	ANKI_ASSERT(problemSize == m_costPrefixSums.getSize());
 	U32 start, end;
-	splitThreadedProblem(threadId, threadCount, problemSize, start, end);
+	splitThreadedProblem(threadId, threadCount, problemSize, m_costPrefixSums.getBegin(), start, end);
 
 	if(start != end)
 	{
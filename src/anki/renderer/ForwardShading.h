@@ -28,7 +28,21 @@ anki_internal:
 
 	void setDependencies(const RenderingContext& ctx, GraphicsRenderPassDescription& pass);
 
+	/// Prepare the split of the renderables between the second level command buffers. Call it before the light
+	/// shading populates the render graph since the forward shading is recorded in the light shading pass.
+	void prepareThreadedWork(RenderingContext& ctx);
+
+	/// The number of second level command buffers that prepareThreadedWork() computed.
+	U32 getSecondLevelCommandBufferCount() const
+	{
+		return m_secondLevelCommandBufferCount;
+	}
+
 	void run(const RenderingContext& ctx, RenderPassWorkContext& rgraphCtx);
+
+private:
+	WeakArray<F32> m_costPrefixSums;
+	U32 m_secondLevelCommandBufferCount = 0;
 };
 /// @}
 
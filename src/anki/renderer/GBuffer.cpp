@@ -78,8 +78,9 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 	// Get some stuff
 	const U32 earlyZCount = ctx.m_renderQueue->m_earlyZRenderables.getSize();
 	const U32 problemSize = ctx.m_renderQueue->m_renderables.getSize() + earlyZCount;
+	ANKI_ASSERT(problemSize == m_costPrefixSums.getSize());
 	U32 start, end;
-	splitThreadedProblem(threadId, threadCount, problemSize, start, end);
+	splitThreadedProblem(threadId, threadCount, problemSize, m_costPrefixSums.getBegin(), start, end);
 	ANKI_ASSERT(end != start);
 
 	// Set some state, leave the rest to default
@@ -153,6 +154,10 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 	}
 	m_depthRt = rgraph.newRenderTarget(m_depthRtDescr);
 
+	// Split the work by the cost of the renderables
+	m_costPrefixSums = computeRenderableCostPrefixSums(
+		ctx, ctx.m_renderQueue->m_earlyZRenderables, ctx.m_renderQueue->m_renderables);
+
 	// Create pass
 	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GBuffer");
 
@@ -164,8 +169,7 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 			self->runInThread(*self->m_ctx, rgraphCtx);
 		},
 		this,
-		computeNumberOfSecondLevelCommandBuffers(
-			ctx.m_renderQueue->m_earlyZRenderables.getSize() + ctx.m_renderQueue->m_renderables.getSize()));
+		computeNumberOfSecondLevelCommandBuffers(m_costPrefixSums));
 
 	for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 	{
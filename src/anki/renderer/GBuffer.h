@@ -48,6 +48,7 @@ private:
 	RenderingContext* m_ctx = nullptr;
 	Array<RenderTargetHandle, GBUFFER_COLOR_ATTACHMENT_COUNT> m_colorRts;
 	RenderTargetHandle m_depthRt;
+	WeakArray<F32> m_costPrefixSums; ///< Of the early Z and then the color renderables.
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& initializer);
 
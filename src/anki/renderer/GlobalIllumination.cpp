@@ -6,6 +6,7 @@
 #include <anki/renderer/GlobalIllumination.h>
 #include <anki/renderer/Renderer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/ProbeBakeCache.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 #include <anki/collision/Aabb.h>
@@ -18,6 +19,11 @@ ANKI_REGISTER_CONFIG_OPTION(r_giTileResolution, 32, 4, 2048)
 ANKI_REGISTER_CONFIG_OPTION(r_giShadowMapResolution, 128, 4, 2048)
 ANKI_REGISTER_CONFIG_OPTION(r_giMaxCachedProbes, 16, 4, 2048)
 ANKI_REGISTER_CONFIG_OPTION(r_giMaxVisibleProbes, 8, 1, 256)
+ANKI_REGISTER_CONFIG_OPTION(r_giMaxCellUpdatesPerFrame,
+	1,
+	1,
+	8,
+	"Max number of probe cells to render every frame. Every cell belongs to a different probe")
 
 /// Given a cell index compute its world position.
 static Vec3 computeProbeCellPosition(U32 cellIdx, const GlobalIlluminationProbeQueueElement& probe)
@@ -49,6 +55,7 @@ public:
 	GlobalIlluminationProbeQueueElement* m_probeToUpdateThisFrame ANKI_DEBUG_CODE(
 		= numberToPtr<GlobalIlluminationProbeQueueElement*>(1));
 	UVec3 m_cellOfTheProbeToUpdateThisFrame ANKI_DEBUG_CODE(= UVec3(MAX_U32));
+	Bool m_probeToUpdateThisFrameDone ANKI_DEBUG_CODE(= false); ///< All the cells are rendered at least once.
 
 	Array<RenderTargetHandle, GBUFFER_COLOR_ATTACHMENT_COUNT> m_gbufferColorRts;
 	RenderTargetHandle m_gbufferDepthRt;
@@ -67,7 +74,13 @@ public:
 
 GlobalIllumination::~GlobalIllumination()
 {
+	for(CacheEntry& entry : m_cacheEntries)
+	{
+		entry.m_cellStates.destroy(getAllocator());
+	}
+
 	m_cacheEntries.destroy(getAllocator());
+	m_lightStates.destroy(getAllocator());
 	m_probeUuidToCacheEntryIdx.destroy(getAllocator());
 }
 
@@ -126,6 +139,8 @@ Error GlobalIllumination::initInternal(const ConfigSet& cfg)
 	m_cacheEntries.create(getAllocator(), cfg.getNumberU32("r_giMaxCachedProbes"));
 	m_maxVisibleProbes = cfg.getNumberU32("r_giMaxVisibleProbes");
 	ANKI_ASSERT(m_maxVisibleProbes <= MAX_VISIBLE_GLOBAL_ILLUMINATION_PROBES);
+	m_maxCellUpdatesPerFrame = cfg.getNumberU32("r_giMaxCellUpdatesPerFrame");
+	ANKI_ASSERT(m_maxCellUpdatesPerFrame <= MAX_VISIBLE_GLOBAL_ILLUMINATION_PROBES);
 	ANKI_ASSERT(m_cacheEntries.getSize() >= m_maxVisibleProbes);
 
 	ANKI_CHECK(initGBuffer(cfg));
@@ -256,36 +271,42 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 	InternalContext* giCtx = rctx.m_tempAllocator.newInstance<InternalContext>();
 	giCtx->m_gi = this;
 	giCtx->m_ctx = &rctx;
-	RenderGraphDescription& rgraph = rctx.m_renderGraphDescr;
 	m_giCtx = giCtx;
 
 	// Prepare the probes
-	prepareProbes(*giCtx);
-	const Bool haveProbeToRender = giCtx->m_probeToUpdateThisFrame != nullptr;
-	if(!haveProbeToRender)
+	WeakArray<InternalContext> cellUpdates;
+	prepareProbes(*giCtx, cellUpdates);
+
+	// Render the cells
+	for(InternalContext& cellUpdate : cellUpdates)
 	{
-		// Early exit
-		return;
+		populateRenderGraphCellUpdate(cellUpdate);
 	}
+}
+
+void GlobalIllumination::populateRenderGraphCellUpdate(InternalContext& giCtx)
+{
+	ANKI_ASSERT(giCtx.m_probeToUpdateThisFrame);
+	RenderGraphDescription& rgraph = giCtx.m_ctx->m_renderGraphDescr;
 
 	// Compute task counts for some of the passes
 	U32 gbufferTaskCount, smTaskCount;
 	{
-		giCtx->m_gbufferDrawcallCount = 0;
-		giCtx->m_smDrawcallCount = 0;
-		for(const RenderQueue* rq : giCtx->m_probeToUpdateThisFrame->m_renderQueues)
+		giCtx.m_gbufferDrawcallCount = 0;
+		giCtx.m_smDrawcallCount = 0;
+		for(const RenderQueue* rq : giCtx.m_probeToUpdateThisFrame->m_renderQueues)
 		{
 			ANKI_ASSERT(rq);
-			giCtx->m_gbufferDrawcallCount += rq->m_renderables.getSize();
+			giCtx.m_gbufferDrawcallCount += rq->m_renderables.getSize();
 
 			if(rq->m_directionalLight.hasShadow())
 			{
-				giCtx->m_smDrawcallCount += rq->m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
+				giCtx.m_smDrawcallCount += rq->m_directionalLight.m_shadowRenderQueues[0]->m_renderables.getSize();
 			}
 		}
 
-		gbufferTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx->m_gbufferDrawcallCount);
-		smTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx->m_smDrawcallCount);
+		gbufferTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx.m_gbufferDrawcallCount);
+		smTaskCount = computeNumberOfSecondLevelCommandBuffers(giCtx.m_smDrawcallCount);
 	}
 
 	// GBuffer
@@ -293,40 +314,40 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 		// RTs
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
-			giCtx->m_gbufferColorRts[i] = rgraph.newRenderTarget(m_gbuffer.m_colorRtDescrs[i]);
+			giCtx.m_gbufferColorRts[i] = rgraph.newRenderTarget(m_gbuffer.m_colorRtDescrs[i]);
 		}
-		giCtx->m_gbufferDepthRt = rgraph.newRenderTarget(m_gbuffer.m_depthRtDescr);
+		giCtx.m_gbufferDepthRt = rgraph.newRenderTarget(m_gbuffer.m_depthRtDescr);
 
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GI gbuff");
-		pass.setFramebufferInfo(m_gbuffer.m_fbDescr, giCtx->m_gbufferColorRts, giCtx->m_gbufferDepthRt);
+		pass.setFramebufferInfo(m_gbuffer.m_fbDescr, giCtx.m_gbufferColorRts, giCtx.m_gbufferDepthRt);
 		pass.setWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
 				giCtx->m_gi->runGBufferInThread(rgraphCtx, *giCtx);
 			},
-			giCtx,
+			&giCtx,
 			gbufferTaskCount);
 
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
-			pass.newDependency({giCtx->m_gbufferColorRts[i], TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+			pass.newDependency({giCtx.m_gbufferColorRts[i], TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
 		}
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
-		pass.newDependency({giCtx->m_gbufferDepthRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+		pass.newDependency({giCtx.m_gbufferDepthRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
 	}
 
 	// Shadow pass. Optional
-	if(giCtx->m_probeToUpdateThisFrame->m_renderQueues[0]->m_directionalLight.m_uuid
-		&& giCtx->m_probeToUpdateThisFrame->m_renderQueues[0]->m_directionalLight.m_shadowCascadeCount > 0)
+	if(giCtx.m_probeToUpdateThisFrame->m_renderQueues[0]->m_directionalLight.m_uuid
+		&& giCtx.m_probeToUpdateThisFrame->m_renderQueues[0]->m_directionalLight.m_shadowCascadeCount > 0)
 	{
 		// Update light matrices
 		for(U i = 0; i < 6; ++i)
 		{
 			ANKI_ASSERT(
-				giCtx->m_probeToUpdateThisFrame->m_renderQueues[i]->m_directionalLight.m_uuid
-				&& giCtx->m_probeToUpdateThisFrame->m_renderQueues[i]->m_directionalLight.m_shadowCascadeCount == 1);
+				giCtx.m_probeToUpdateThisFrame->m_renderQueues[i]->m_directionalLight.m_uuid
+				&& giCtx.m_probeToUpdateThisFrame->m_renderQueues[i]->m_directionalLight.m_shadowCascadeCount == 1);
 
 			const F32 xScale = 1.0f / 6.0f;
 			const F32 yScale = 1.0f;
@@ -350,61 +371,61 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 				1.0f);
 
 			Mat4& lightMat =
-				giCtx->m_probeToUpdateThisFrame->m_renderQueues[i]->m_directionalLight.m_textureMatrices[0];
+				giCtx.m_probeToUpdateThisFrame->m_renderQueues[i]->m_directionalLight.m_textureMatrices[0];
 			lightMat = atlasMtx * lightMat;
 		}
 
 		// RT
-		giCtx->m_shadowsRt = rgraph.newRenderTarget(m_shadowMapping.m_rtDescr);
+		giCtx.m_shadowsRt = rgraph.newRenderTarget(m_shadowMapping.m_rtDescr);
 
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GI SM");
-		pass.setFramebufferInfo(m_shadowMapping.m_fbDescr, {}, giCtx->m_shadowsRt);
+		pass.setFramebufferInfo(m_shadowMapping.m_fbDescr, {}, giCtx.m_shadowsRt);
 		pass.setWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
 				giCtx->m_gi->runShadowmappingInThread(rgraphCtx, *giCtx);
 			},
-			giCtx,
+			&giCtx,
 			smTaskCount);
 
 		TextureSubresourceInfo subresource(DepthStencilAspectBit::DEPTH);
-		pass.newDependency({giCtx->m_shadowsRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+		pass.newDependency({giCtx.m_shadowsRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
 	}
 	else
 	{
-		giCtx->m_shadowsRt = {};
+		giCtx.m_shadowsRt = {};
 	}
 
 	// Light shading pass
 	{
 		// RT
-		giCtx->m_lightShadingRt = rgraph.newRenderTarget(m_lightShading.m_rtDescr);
+		giCtx.m_lightShadingRt = rgraph.newRenderTarget(m_lightShading.m_rtDescr);
 
 		// Pass
 		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GI LS");
-		pass.setFramebufferInfo(m_lightShading.m_fbDescr, {{giCtx->m_lightShadingRt}}, {});
+		pass.setFramebufferInfo(m_lightShading.m_fbDescr, {{giCtx.m_lightShadingRt}}, {});
 		pass.setWork(
 			[](RenderPassWorkContext& rgraphCtx) {
 				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
 				giCtx->m_gi->runLightShading(rgraphCtx, *giCtx);
 			},
-			giCtx,
+			&giCtx,
 			1);
 
-		pass.newDependency({giCtx->m_lightShadingRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+		pass.newDependency({giCtx.m_lightShadingRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
 
 		for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 		{
-			pass.newDependency({giCtx->m_gbufferColorRts[i], TextureUsageBit::SAMPLED_FRAGMENT});
+			pass.newDependency({giCtx.m_gbufferColorRts[i], TextureUsageBit::SAMPLED_FRAGMENT});
 		}
-		pass.newDependency({giCtx->m_gbufferDepthRt,
+		pass.newDependency({giCtx.m_gbufferDepthRt,
 			TextureUsageBit::SAMPLED_FRAGMENT,
 			TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
 
-		if(giCtx->m_shadowsRt.isValid())
+		if(giCtx.m_shadowsRt.isValid())
 		{
-			pass.newDependency({giCtx->m_shadowsRt, TextureUsageBit::SAMPLED_FRAGMENT});
+			pass.newDependency({giCtx.m_shadowsRt, TextureUsageBit::SAMPLED_FRAGMENT});
 		}
 	}
 
@@ -417,41 +438,68 @@ void GlobalIllumination::populateRenderGraph(RenderingContext& rctx)
 				InternalContext* giCtx = static_cast<InternalContext*>(rgraphCtx.m_userData);
 				giCtx->m_gi->runIrradiance(rgraphCtx, *giCtx);
 			},
-			giCtx,
+			&giCtx,
 			0);
 
-		pass.newDependency({giCtx->m_lightShadingRt, TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({giCtx.m_lightShadingRt, TextureUsageBit::SAMPLED_COMPUTE});
 
 		for(U32 i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT - 1; ++i)
 		{
-			pass.newDependency({giCtx->m_gbufferColorRts[i], TextureUsageBit::SAMPLED_COMPUTE});
+			pass.newDependency({giCtx.m_gbufferColorRts[i], TextureUsageBit::SAMPLED_COMPUTE});
 		}
 
-		const U32 probeIdx = U32(giCtx->m_probeToUpdateThisFrame - &giCtx->m_ctx->m_renderQueue->m_giProbes.getFront());
-		pass.newDependency({giCtx->m_irradianceProbeRts[probeIdx], TextureUsageBit::IMAGE_COMPUTE_WRITE});
+		const U32 probeIdx = U32(giCtx.m_probeToUpdateThisFrame - &giCtx.m_ctx->m_renderQueue->m_giProbes.getFront());
+		pass.newDependency({giCtx.m_irradianceProbeRts[probeIdx], TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	}
+
+	// Store the result to the disk when the last cell is rendered
+	if(giCtx.m_probeToUpdateThisFrameDone)
+	{
+		const GlobalIlluminationProbeQueueElement& probe = *giCtx.m_probeToUpdateThisFrame;
+		const U32 probeIdx = U32(&probe - &giCtx.m_ctx->m_renderQueue->m_giProbes.getFront());
+		m_r->getProbeBakeCache().addReadbackPass(*giCtx.m_ctx,
+			probe.m_contentHash,
+			giCtx.m_irradianceProbeRts[probeIdx],
+			TextureSubresourceInfo(),
+			UVec3(probe.m_cellCounts.x() * 6, probe.m_cellCounts.y(), probe.m_cellCounts.z()));
 	}
 }
 
-void GlobalIllumination::prepareProbes(InternalContext& giCtx)
+void GlobalIllumination::prepareProbes(InternalContext& giCtx, WeakArray<InternalContext>& cellUpdates)
 {
 	RenderingContext& ctx = *giCtx.m_ctx;
-	giCtx.m_probeToUpdateThisFrame = nullptr;
+	cellUpdates = WeakArray<InternalContext>();
+
+	// Lights change even if there are no visible probes
+	detectLightChanges(ctx);
 
 	if(ANKI_UNLIKELY(ctx.m_renderQueue->m_giProbes.getSize() == 0))
 	{
 		return;
 	}
 
+	const Timestamp crntTimestamp = m_r->getGlobalTimestamp();
+	const Vec3 cameraPos = ctx.m_renderQueue->m_cameraTransform.getTranslationPart().xyz();
+
 	// Iterate the probes and:
-	// - Find a probe to update this frame
-	// - Find a probe to update next frame
 	// - Find the cache entries for each probe
+	// - Find the cells that will be updated this frame
 	DynamicArray<GlobalIlluminationProbeQueueElement> newListOfProbes;
 	newListOfProbes.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_giProbes.getSize());
 	DynamicArray<RenderTargetHandle> volumeRts;
 	volumeRts.create(ctx.m_tempAllocator, ctx.m_renderQueue->m_giProbes.getSize());
 	U32 newListOfProbeCount = 0;
-	Bool foundProbeToUpdateNextFrame = false;
+
+	class CellUpdate
+	{
+	public:
+		U32 m_probeIdx; ///< Index in the new list of probes.
+		U32 m_cellIdx;
+		Bool m_probeDone; ///< It's the last cell that was never rendered.
+	};
+	Array<CellUpdate, MAX_VISIBLE_GLOBAL_ILLUMINATION_PROBES> cellUpdateInfos;
+	U32 cellUpdateCount = 0;
+
 	for(U32 probeIdx = 0; probeIdx < ctx.m_renderQueue->m_giProbes.getSize(); ++probeIdx)
 	{
 		if(newListOfProbeCount + 1 >= m_maxVisibleProbes)
@@ -464,9 +512,18 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 
 		GlobalIlluminationProbeQueueElement& probe = ctx.m_renderQueue->m_giProbes[probeIdx];
 
-		// Find cache entry
-		const U32 cacheEntryIdx = findBestCacheEntry(
-			probe.m_uuid, m_r->getGlobalTimestamp(), m_cacheEntries, m_probeUuidToCacheEntryIdx, getAllocator());
+		// Find cache entry. Prefer to kick the entries that were not seen for long and are far from the camera
+		const U32 cacheEntryIdx = findBestCacheEntry(probe.m_uuid,
+			crntTimestamp,
+			m_cacheEntries,
+			m_probeUuidToCacheEntryIdx,
+			getAllocator(),
+			[&](U32 idx) {
+				const CacheEntry& entry = m_cacheEntries[idx];
+				const Vec3 closestPoint = cameraPos.max(entry.m_probeAabbMin).min(entry.m_probeAabbMax);
+				const F32 age = F32(crntTimestamp - entry.m_lastUsedTimestamp);
+				return age * (1.0f + (closestPoint - cameraPos).getLength());
+			});
 		if(ANKI_UNLIKELY(cacheEntryIdx == MAX_U32))
 		{
 			// Failed
@@ -479,124 +536,446 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 
 		const Bool cacheEntryDirty = entry.m_uuid != probe.m_uuid || entry.m_volumeSize != probe.m_cellCounts
 									 || entry.m_probeAabbMin != probe.m_aabbMin
-									 || entry.m_probeAabbMax != probe.m_aabbMax;
-		const Bool needsUpdate = cacheEntryDirty || entry.m_renderedCells < probe.m_totalCellCount;
+									 || entry.m_probeAabbMax != probe.m_aabbMax
+									 || entry.m_contentHash != probe.m_contentHash;
 
-		if(ANKI_LIKELY(!needsUpdate))
+		if(cacheEntryDirty)
 		{
-			// It's updated, early exit
+			// First try to load it from the disk
+			const ProbeBakeCache::LoadStatus status =
+				tryLoadBakedProbe(giCtx, probe, cacheEntryIdx, volumeRts[newListOfProbeCount]);
+			if(status == ProbeBakeCache::LoadStatus::LOADED)
+			{
+				newListOfProbes[newListOfProbeCount++] = probe;
+				continue;
+			}
+			else if(status == ProbeBakeCache::LoadStatus::PENDING)
+			{
+				// Still reading the file, skip the probe till it's done
+				continue;
+			}
 
-			entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
-			volumeRts[newListOfProbeCount] =
-				ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
-			newListOfProbes[newListOfProbeCount++] = probe;
-			continue;
+			resetCacheEntry(entry, cacheEntryIdx, probe);
 		}
 
-		// It needs update
+		entry.m_lastUsedTimestamp = crntTimestamp;
 
-		const Bool canUpdateThisFrame = giCtx.m_probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
-		const Bool canUpdateNextFrame = !foundProbeToUpdateNextFrame;
+		// If the probe gathered the renderables of the scheduled cell then render that cell this frame
+		if(entry.m_scheduledCell != MAX_U32 && probe.m_renderQueues[0] != nullptr
+			&& cellUpdateCount < m_maxCellUpdatesPerFrame)
+		{
+			const U32 cellIdx = entry.m_scheduledCell;
+			const Bool wasUnrendered = entry.m_cellStates[cellIdx] == CellState::UNRENDERED;
+			setCellState(entry, cellIdx, CellState::UP_TO_DATE);
+			entry.m_scheduledCell = MAX_U32;
+
+			CellUpdate& update = cellUpdateInfos[cellUpdateCount++];
+			update.m_probeIdx = newListOfProbeCount;
+			update.m_cellIdx = cellIdx;
+			update.m_probeDone = wasUnrendered && entry.m_unrenderedCellCount == 0;
+		}
+
+		// Push the probe to the new list
+		newListOfProbes[newListOfProbeCount] = probe;
+		volumeRts[newListOfProbeCount] =
+			ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
+		++newListOfProbeCount;
+	}
+
+	// Replace the probe list in the queue
+	if(newListOfProbeCount > 0)
+	{
+		GlobalIlluminationProbeQueueElement* firstProbe;
+		U32 probeCount, storage;
+		newListOfProbes.moveAndReset(firstProbe, probeCount, storage);
+		ctx.m_renderQueue->m_giProbes = WeakArray<GlobalIlluminationProbeQueueElement>(firstProbe, newListOfProbeCount);
 
-		if(!canUpdateThisFrame && canUpdateNextFrame)
+		RenderTargetHandle* firstRt;
+		volumeRts.moveAndReset(firstRt, probeCount, storage);
+		giCtx.m_irradianceProbeRts = WeakArray<RenderTargetHandle>(firstRt, newListOfProbeCount);
+	}
+	else
+	{
+		ctx.m_renderQueue->m_giProbes = WeakArray<GlobalIlluminationProbeQueueElement>();
+		newListOfProbes.destroy(ctx.m_tempAllocator);
+		volumeRts.destroy(ctx.m_tempAllocator);
+	}
+
+	// Create a context for every cell that will be updated
+	if(cellUpdateCount > 0)
+	{
+		InternalContext* updates = ctx.m_tempAllocator.newArray<InternalContext>(cellUpdateCount);
+		for(U32 i = 0; i < cellUpdateCount; ++i)
 		{
-			// Probe will (possibly) be updated next frame, inform the probe
+			const CellUpdate& info = cellUpdateInfos[i];
+			const GlobalIlluminationProbeQueueElement& probe = ctx.m_renderQueue->m_giProbes[info.m_probeIdx];
+
+			InternalContext& update = updates[i];
+			update = giCtx;
+			update.m_probeToUpdateThisFrame = &ctx.m_renderQueue->m_giProbes[info.m_probeIdx];
+			update.m_probeToUpdateThisFrameDone = info.m_probeDone;
+			unflatten3dArrayIndex(probe.m_cellCounts.z(),
+				probe.m_cellCounts.y(),
+				probe.m_cellCounts.x(),
+				info.m_cellIdx,
+				update.m_cellOfTheProbeToUpdateThisFrame.z(),
+				update.m_cellOfTheProbeToUpdateThisFrame.y(),
+				update.m_cellOfTheProbeToUpdateThisFrame.x());
+		}
 
-			foundProbeToUpdateNextFrame = true;
+		cellUpdates = WeakArray<InternalContext>(updates, cellUpdateCount);
+	}
 
-			const U32 cellToRender = (cacheEntryDirty) ? 0 : entry.m_renderedCells;
-			const Vec3 cellPos = computeProbeCellPosition(cellToRender, probe);
-			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
+	// Decide what will be rendered next frame
+	scheduleCellUpdates(ctx);
+}
+
+void GlobalIllumination::scheduleCellUpdates(const RenderingContext& ctx)
+{
+	// Cells that were never rendered are more important than the dirty ones
+	constexpr F32 UNRENDERED_CELL_PRIORITY = 4.0f;
+	constexpr F32 DIRTY_CELL_PRIORITY = 1.0f;
+	constexpr F32 BEHIND_CAMERA_PRIORITY_SCALE = 0.25f;
+
+	const Vec3 cameraPos = ctx.m_renderQueue->m_cameraTransform.getTranslationPart().xyz();
+	const Vec3 cameraDir = -ctx.m_renderQueue->m_cameraTransform.getColumn(2).xyz();
+
+	class Candidate
+	{
+	public:
+		F32 m_priority;
+		U32 m_probeIdx;
+		U32 m_cellIdx;
+	};
+	Array<Candidate, MAX_VISIBLE_GLOBAL_ILLUMINATION_PROBES> candidates;
+	U32 candidateCount = 0;
+
+	// Find the cell with the highest priority of each probe
+	const WeakArray<GlobalIlluminationProbeQueueElement>& probes = ctx.m_renderQueue->m_giProbes;
+	for(U32 probeIdx = 0; probeIdx < probes.getSize(); ++probeIdx)
+	{
+		const GlobalIlluminationProbeQueueElement& probe = probes[probeIdx];
+		auto it = m_probeUuidToCacheEntryIdx.find(probe.m_uuid);
+		ANKI_ASSERT(it != m_probeUuidToCacheEntryIdx.getEnd());
+		CacheEntry& entry = m_cacheEntries[*it];
+		ANKI_ASSERT(entry.m_uuid == probe.m_uuid);
+		entry.m_scheduledCell = MAX_U32;
+
+		if(entry.m_unrenderedCellCount + entry.m_dirtyCellCount == 0)
+		{
+			// Nothing to do, stop gathering renderables
+			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
 			continue;
 		}
-		else if(!canUpdateThisFrame)
+
+		Candidate& candidate = candidates[candidateCount++];
+		candidate.m_priority = -1.0f;
+		candidate.m_probeIdx = probeIdx;
+		candidate.m_cellIdx = MAX_U32;
+
+		const Vec3 halfCellSize = probe.m_cellSizes / 2.0f;
+		U32 cellIdx = 0;
+		for(U32 z = 0; z < probe.m_cellCounts.z(); ++z)
 		{
-			// Can't be updated this frame so remove it from the list
-			continue;
+			for(U32 y = 0; y < probe.m_cellCounts.y(); ++y)
+			{
+				for(U32 x = 0; x < probe.m_cellCounts.x(); ++x, ++cellIdx)
+				{
+					const CellState state = entry.m_cellStates[cellIdx];
+					if(state == CellState::UP_TO_DATE)
+					{
+						continue;
+					}
+
+					const Vec3 cellPos =
+						Vec3(F32(x), F32(y), F32(z)) * probe.m_cellSizes + halfCellSize + probe.m_aabbMin;
+					const Vec3 cameraToCell = cellPos - cameraPos;
+
+					F32 priority = (state == CellState::UNRENDERED) ? UNRENDERED_CELL_PRIORITY : DIRTY_CELL_PRIORITY;
+					priority /= 1.0f + cameraToCell.getLength();
+					if(cameraToCell.dot(cameraDir) < 0.0f)
+					{
+						priority *= BEHIND_CAMERA_PRIORITY_SCALE;
+					}
+
+					if(priority > candidate.m_priority)
+					{
+						candidate.m_priority = priority;
+						candidate.m_cellIdx = cellIdx;
+					}
+				}
+			}
 		}
 
-		// All good, can use this probe in this frame
+		ANKI_ASSERT(candidate.m_cellIdx != MAX_U32);
+	}
 
-		if(cacheEntryDirty)
+	// Spend the budget on the best candidates and stop the rest from gathering renderables
+	std::sort(candidates.getBegin(),
+		candidates.getBegin() + candidateCount,
+		[](const Candidate& a, const Candidate& b) { return a.m_priority > b.m_priority; });
+
+	for(U32 i = 0; i < candidateCount; ++i)
+	{
+		const GlobalIlluminationProbeQueueElement& probe = probes[candidates[i].m_probeIdx];
+
+		if(i < m_maxCellUpdatesPerFrame)
+		{
+			CacheEntry& entry = m_cacheEntries[*m_probeUuidToCacheEntryIdx.find(probe.m_uuid)];
+			entry.m_scheduledCell = candidates[i].m_cellIdx;
+
+			const Vec3 cellPos = computeProbeCellPosition(candidates[i].m_cellIdx, probe);
+			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
+		}
+		else
 		{
-			entry.m_renderedCells = 0;
-			entry.m_uuid = probe.m_uuid;
-			entry.m_probeAabbMin = probe.m_aabbMin;
-			entry.m_probeAabbMax = probe.m_aabbMax;
-			entry.m_volumeSize = probe.m_cellCounts;
-			m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
 		}
+	}
+}
+
+void GlobalIllumination::detectLightChanges(const RenderingContext& ctx)
+{
+	// Forget the lights that were not seen for that many frames
+	constexpr Timestamp MAX_LIGHT_STATE_AGE = 600;
+
+	const Timestamp crntTimestamp = m_r->getGlobalTimestamp();
+	const RenderQueue& rqueue = *ctx.m_renderQueue;
 
-		// Update the cache entry
-		entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+	// Gather the state of the visible lights
+	DynamicArrayAuto<LightState> visibleLights(
+		ctx.m_tempAllocator, rqueue.m_pointLights.getSize() + rqueue.m_spotLights.getSize());
+	U32 visibleLightCount = 0;
 
-		// Init the cache entry textures
-		const Bool shouldInitTextures = !entry.m_volumeTex.isCreated() || entry.m_volumeSize != probe.m_cellCounts;
-		if(shouldInitTextures)
+	for(const PointLightQueueElement& light : rqueue.m_pointLights)
+	{
+		LightState& state = visibleLights[visibleLightCount++];
+		state.m_uuid = light.m_uuid;
+		state.m_hash = computeHash(&light.m_worldPosition, sizeof(light.m_worldPosition));
+		state.m_hash = appendHash(&light.m_radius, sizeof(light.m_radius), state.m_hash);
+		state.m_hash = appendHash(&light.m_diffuseColor, sizeof(light.m_diffuseColor), state.m_hash);
+		state.m_boundingSphere = Vec4(light.m_worldPosition, light.m_radius);
+		state.m_lastSeenTimestamp = crntTimestamp;
+	}
+
+	for(const SpotLightQueueElement& light : rqueue.m_spotLights)
+	{
+		LightState& state = visibleLights[visibleLightCount++];
+		state.m_uuid = light.m_uuid;
+		state.m_hash = computeHash(&light.m_worldTransform, sizeof(light.m_worldTransform));
+		state.m_hash = appendHash(&light.m_distance, sizeof(light.m_distance), state.m_hash);
+		state.m_hash = appendHash(&light.m_outerAngle, sizeof(light.m_outerAngle), state.m_hash);
+		state.m_hash = appendHash(&light.m_diffuseColor, sizeof(light.m_diffuseColor), state.m_hash);
+		state.m_boundingSphere = Vec4(light.m_worldTransform.getTranslationPart().xyz(), light.m_distance);
+		state.m_lastSeenTimestamp = crntTimestamp;
+	}
+
+	std::sort(visibleLights.getBegin(), visibleLights.getEnd());
+
+	// Merge the visible lights with the old states. A light that changed affects the cells of its old and new place.
+	// A light that wasn't seen before might have been just outside the view so it doesn't dirty anything
+	DynamicArrayAuto<LightState> mergedStates(ctx.m_tempAllocator, m_lightStates.getSize() + visibleLightCount);
+	U32 mergedStateCount = 0;
+	U32 oldIdx = 0;
+	U32 newIdx = 0;
+	while(oldIdx < m_lightStates.getSize() || newIdx < visibleLightCount)
+	{
+		const LightState* oldState = (oldIdx < m_lightStates.getSize()) ? &m_lightStates[oldIdx] : nullptr;
+		const LightState* newState = (newIdx < visibleLightCount) ? &visibleLights[newIdx] : nullptr;
+
+		if(oldState && newState && oldState->m_uuid == newState->m_uuid)
+		{
+			if(oldState->m_hash != newState->m_hash)
+			{
+				markCellsDirty(oldState->m_boundingSphere);
+				markCellsDirty(newState->m_boundingSphere);
+			}
+
+			mergedStates[mergedStateCount++] = *newState;
+			++oldIdx;
+			++newIdx;
+		}
+		else if(newState && (!oldState || newState->m_uuid < oldState->m_uuid))
+		{
+			mergedStates[mergedStateCount++] = *newState;
+			++newIdx;
+		}
+		else
+		{
+			if(crntTimestamp - oldState->m_lastSeenTimestamp < MAX_LIGHT_STATE_AGE)
+			{
+				mergedStates[mergedStateCount++] = *oldState;
+			}
+			++oldIdx;
+		}
+	}
+
+	m_lightStates.resize(getAllocator(), mergedStateCount);
+	for(U32 i = 0; i < mergedStateCount; ++i)
+	{
+		m_lightStates[i] = mergedStates[i];
+	}
+
+	// The directional light affects all cells
+	U64 dirLightHash = 0;
+	if(rqueue.m_directionalLight.isEnabled())
+	{
+		const DirectionalLightQueueElement& light = rqueue.m_directionalLight;
+		dirLightHash = computeHash(&light.m_uuid, sizeof(light.m_uuid));
+		dirLightHash = appendHash(&light.m_direction, sizeof(light.m_direction), dirLightHash);
+		dirLightHash = appendHash(&light.m_diffuseColor, sizeof(light.m_diffuseColor), dirLightHash);
+	}
+
+	if(dirLightHash != m_dirLightHash)
+	{
+		m_dirLightHash = dirLightHash;
+		markCellsDirty(Vec4(0.0f, 0.0f, 0.0f, MAX_F32));
+	}
+}
+
+void GlobalIllumination::markCellsDirty(const Vec4& sphere)
+{
+	for(CacheEntry& entry : m_cacheEntries)
+	{
+		if(entry.m_uuid == 0 || entry.m_unrenderedCellCount + entry.m_dirtyCellCount == entry.m_cellStates.getSize())
 		{
-			TextureInitInfo texInit;
-			texInit.m_type = TextureType::_3D;
-			texInit.m_format = Format::B10G11R11_UFLOAT_PACK32;
-			texInit.m_width = probe.m_cellCounts.x() * 6;
-			texInit.m_height = probe.m_cellCounts.y();
-			texInit.m_depth = probe.m_cellCounts.z();
-			texInit.m_usage = TextureUsageBit::ALL_COMPUTE | TextureUsageBit::SAMPLED_ALL;
-			texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
-
-			entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+			// Empty or nothing to mark
+			continue;
 		}
 
-		// Compute the render position
-		const U32 cellToRender = entry.m_renderedCells++;
-		ANKI_ASSERT(cellToRender < probe.m_totalCellCount);
-		unflatten3dArrayIndex(probe.m_cellCounts.z(),
-			probe.m_cellCounts.y(),
-			probe.m_cellCounts.x(),
-			cellToRender,
-			giCtx.m_cellOfTheProbeToUpdateThisFrame.z(),
-			giCtx.m_cellOfTheProbeToUpdateThisFrame.y(),
-			giCtx.m_cellOfTheProbeToUpdateThisFrame.x());
-
-		// Inform probe about its next frame
-		if(entry.m_renderedCells == probe.m_totalCellCount)
+		// Find the range of cells that the AABB of the sphere touches
+		const Vec3 cellSize = (entry.m_probeAabbMax - entry.m_probeAabbMin) / Vec3(entry.m_volumeSize);
+		UVec3 firstCell, lastCell;
+		Bool overlaps = true;
+		for(U32 i = 0; i < 3 && overlaps; ++i)
 		{
-			// Don't gather renderables next frame if it's done
-			probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
+			const F32 first = (sphere[i] - sphere.w() - entry.m_probeAabbMin[i]) / cellSize[i];
+			const F32 last = (sphere[i] + sphere.w() - entry.m_probeAabbMin[i]) / cellSize[i];
+			overlaps = last >= 0.0f && first < F32(entry.m_volumeSize[i]);
+			firstCell[i] = U32(max(first, 0.0f));
+			lastCell[i] = U32(min(last, F32(entry.m_volumeSize[i] - 1)));
 		}
-		else if(!foundProbeToUpdateNextFrame)
+
+		if(!overlaps)
 		{
-			// Gather rendederables from the same probe next frame
-			foundProbeToUpdateNextFrame = true;
-			const Vec3 cellPos = computeProbeCellPosition(entry.m_renderedCells, probe);
-			probe.m_feedbackCallback(true, probe.m_feedbackCallbackUserData, cellPos.xyz0());
+			continue;
 		}
 
-		// Push the probe to the new list
-		giCtx.m_probeToUpdateThisFrame = &newListOfProbes[newListOfProbeCount];
-		newListOfProbes[newListOfProbeCount] = probe;
-		volumeRts[newListOfProbeCount] =
-			ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
-		++newListOfProbeCount;
+		for(U32 z = firstCell.z(); z <= lastCell.z(); ++z)
+		{
+			for(U32 y = firstCell.y(); y <= lastCell.y(); ++y)
+			{
+				for(U32 x = firstCell.x(); x <= lastCell.x(); ++x)
+				{
+					const U32 cellIdx = (z * entry.m_volumeSize.y() + y) * entry.m_volumeSize.x() + x;
+					if(entry.m_cellStates[cellIdx] == CellState::UP_TO_DATE)
+					{
+						setCellState(entry, cellIdx, CellState::DIRTY);
+					}
+				}
+			}
+		}
 	}
+}
 
-	// Replace the probe list in the queue
-	if(newListOfProbeCount > 0)
+void GlobalIllumination::setCellState(CacheEntry& entry, U32 cellIdx, CellState state)
+{
+	CellState& crntState = entry.m_cellStates[cellIdx];
+
+	if(crntState == CellState::UNRENDERED)
 	{
-		GlobalIlluminationProbeQueueElement* firstProbe;
-		U32 probeCount, storage;
-		newListOfProbes.moveAndReset(firstProbe, probeCount, storage);
-		ctx.m_renderQueue->m_giProbes = WeakArray<GlobalIlluminationProbeQueueElement>(firstProbe, newListOfProbeCount);
+		ANKI_ASSERT(entry.m_unrenderedCellCount > 0);
+		--entry.m_unrenderedCellCount;
+	}
+	else if(crntState == CellState::DIRTY)
+	{
+		ANKI_ASSERT(entry.m_dirtyCellCount > 0);
+		--entry.m_dirtyCellCount;
+	}
 
-		RenderTargetHandle* firstRt;
-		volumeRts.moveAndReset(firstRt, probeCount, storage);
-		m_giCtx->m_irradianceProbeRts = WeakArray<RenderTargetHandle>(firstRt, newListOfProbeCount);
+	if(state == CellState::UNRENDERED)
+	{
+		++entry.m_unrenderedCellCount;
 	}
-	else
+	else if(state == CellState::DIRTY)
 	{
-		ctx.m_renderQueue->m_giProbes = WeakArray<GlobalIlluminationProbeQueueElement>();
-		newListOfProbes.destroy(ctx.m_tempAllocator);
-		volumeRts.destroy(ctx.m_tempAllocator);
+		++entry.m_dirtyCellCount;
+	}
+
+	crntState = state;
+}
+
+void GlobalIllumination::resetCacheEntry(
+	CacheEntry& entry, U32 cacheEntryIdx, const GlobalIlluminationProbeQueueElement& probe)
+{
+	// Init the cache entry textures
+	const Bool shouldInitTextures = !entry.m_volumeTex.isCreated() || entry.m_volumeSize != probe.m_cellCounts;
+	if(shouldInitTextures)
+	{
+		TextureInitInfo texInit;
+		texInit.m_type = TextureType::_3D;
+		texInit.m_format = Format::B10G11R11_UFLOAT_PACK32;
+		texInit.m_width = probe.m_cellCounts.x() * 6;
+		texInit.m_height = probe.m_cellCounts.y();
+		texInit.m_depth = probe.m_cellCounts.z();
+		texInit.m_usage = TextureUsageBit::ALL_COMPUTE | TextureUsageBit::SAMPLED_ALL;
+		texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
+
+		entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+	}
+
+	if(entry.m_uuid != probe.m_uuid)
+	{
+		m_probeUuidToCacheEntryIdx.emplace(getAllocator(), probe.m_uuid, cacheEntryIdx);
+	}
+
+	entry.m_cellStates.resize(getAllocator(), probe.m_totalCellCount);
+	for(CellState& state : entry.m_cellStates)
+	{
+		state = CellState::UNRENDERED;
+	}
+	entry.m_unrenderedCellCount = probe.m_totalCellCount;
+	entry.m_dirtyCellCount = 0;
+	entry.m_scheduledCell = MAX_U32;
+
+	entry.m_uuid = probe.m_uuid;
+	entry.m_contentHash = probe.m_contentHash;
+	entry.m_probeAabbMin = probe.m_aabbMin;
+	entry.m_probeAabbMax = probe.m_aabbMax;
+	entry.m_volumeSize = probe.m_cellCounts;
+}
+
+ProbeBakeCache::LoadStatus GlobalIllumination::tryLoadBakedProbe(InternalContext& giCtx,
+	const GlobalIlluminationProbeQueueElement& probe,
+	U32 cacheEntryIdx,
+	RenderTargetHandle& volumeRt)
+{
+	RenderingContext& ctx = *giCtx.m_ctx;
+
+	BufferPtr buff;
+	const UVec3 volumeSize(probe.m_cellCounts.x() * 6, probe.m_cellCounts.y(), probe.m_cellCounts.z());
+	const ProbeBakeCache::LoadStatus status = m_r->getProbeBakeCache().loadProbe(probe.m_contentHash, volumeSize, buff);
+	if(status != ProbeBakeCache::LoadStatus::LOADED)
+	{
+		return status;
 	}
+
+	CacheEntry& entry = m_cacheEntries[cacheEntryIdx];
+	resetCacheEntry(entry, cacheEntryIdx, probe);
+	for(CellState& state : entry.m_cellStates)
+	{
+		state = CellState::UP_TO_DATE;
+	}
+	entry.m_unrenderedCellCount = 0;
+	entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+
+	volumeRt = ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
+	m_r->getProbeBakeCache().addUploadPass(ctx, buff, volumeRt, TextureSubresourceInfo());
+
+	// Stop gathering renderables in case it was asked before
+	probe.m_feedbackCallback(false, probe.m_feedbackCallbackUserData, Vec4(0.0f));
+
+	return status;
 }
 
 void GlobalIllumination::runGBufferInThread(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx) const
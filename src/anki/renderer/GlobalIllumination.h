@@ -8,6 +8,7 @@
 #include <anki/renderer/RendererObject.h>
 #include <anki/renderer/TraditionalDeferredShading.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/ProbeBakeCache.h>
 #include <anki/collision/Forward.h>
 
 namespace anki
@@ -18,7 +19,9 @@ namespace anki
 
 /// Ambient global illumination passes.
 ///
-/// It builds a volume clipmap with ambient GI information.
+/// It builds a volume clipmap with ambient GI information. The cells of the probes are rendered over many frames. Every
+/// frame the scheduler picks the cells with the highest priority. Cells that were never rendered come first, then
+/// cells that were affected by a change of a light. Cells close to the camera and in front of it are preferred.
 class GlobalIllumination : public RendererObject
 {
 anki_internal:
@@ -48,16 +51,42 @@ anki_internal:
 private:
 	class InternalContext;
 
+	enum class CellState : U8
+	{
+		UNRENDERED,
+		DIRTY, ///< Rendered but something changed since then.
+		UP_TO_DATE
+	};
+
 	class CacheEntry
 	{
 	public:
 		U64 m_uuid; ///< Probe UUID.
+		U64 m_contentHash = 0; ///< The content hash of the probe when it was rendered.
 		Timestamp m_lastUsedTimestamp = 0; ///< When it was last seen by the renderer.
 		TexturePtr m_volumeTex; ///< Contains the 6 directions.
 		UVec3 m_volumeSize = UVec3(0u);
 		Vec3 m_probeAabbMin = Vec3(0.0f);
 		Vec3 m_probeAabbMax = Vec3(0.0f);
-		U32 m_renderedCells = 0;
+		DynamicArray<CellState> m_cellStates;
+		U32 m_unrenderedCellCount = 0;
+		U32 m_dirtyCellCount = 0; ///< It doesn't include the unrendered cells.
+		U32 m_scheduledCell = MAX_U32; ///< The cell that the probe gathers renderables for.
+	};
+
+	/// The state of a light when it was last seen. Used to find the cells that are affected when the light changes.
+	class LightState
+	{
+	public:
+		U64 m_uuid;
+		U64 m_hash; ///< Hash of the properties that affect the GI.
+		Vec4 m_boundingSphere; ///< The xyz is the center and the w the radius.
+		Timestamp m_lastSeenTimestamp;
+
+		Bool operator<(const LightState& b) const
+		{
+			return m_uuid < b.m_uuid;
+		}
 	};
 
 	class
@@ -101,6 +130,10 @@ private:
 	HashMap<U64, U32> m_probeUuidToCacheEntryIdx;
 	U32 m_tileSize = 0;
 	U32 m_maxVisibleProbes = 0;
+	U32 m_maxCellUpdatesPerFrame = 0;
+
+	DynamicArray<LightState> m_lightStates; ///< Sorted by UUID.
+	U64 m_dirLightHash = 0;
 
 	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
 	ANKI_USE_RESULT Error initGBuffer(const ConfigSet& cfg);
@@ -113,7 +146,32 @@ private:
 	void runLightShading(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx);
 	void runIrradiance(RenderPassWorkContext& rgraphCtx, InternalContext& giCtx);
 
-	void prepareProbes(InternalContext& giCtx);
+	/// Find the cache entries of the probes and the cells that will be rendered this frame. It also schedules the
+	/// cells of the next frame.
+	void prepareProbes(InternalContext& giCtx, WeakArray<InternalContext>& cellUpdates);
+
+	/// Add the passes that render a single cell.
+	void populateRenderGraphCellUpdate(InternalContext& giCtx);
+
+	/// Reset the cache entry to hold a new probe.
+	void resetCacheEntry(CacheEntry& entry, U32 cacheEntryIdx, const GlobalIlluminationProbeQueueElement& probe);
+
+	/// Compare the visible lights with the ones of the previous frames and mark the affected cells as dirty.
+	void detectLightChanges(const RenderingContext& ctx);
+
+	/// Mark the rendered cells that a sphere touches as dirty.
+	void markCellsDirty(const Vec4& sphere);
+
+	/// Pick the cells with the highest priority and inform the probes to gather renderables for them next frame.
+	void scheduleCellUpdates(const RenderingContext& ctx);
+
+	static void setCellState(CacheEntry& entry, U32 cellIdx, CellState state);
+
+	/// Try to load a probe from the ProbeBakeCache. If it's loaded it will add the pass that uploads it.
+	ProbeBakeCache::LoadStatus tryLoadBakedProbe(InternalContext& giCtx,
+		const GlobalIlluminationProbeQueueElement& probe,
+		U32 cacheEntryIdx,
+		RenderTargetHandle& volumeRt);
 };
 /// @}
 
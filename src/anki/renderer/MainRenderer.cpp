@@ -195,6 +195,8 @@ Error MainRenderer::render(RenderQueue& rqueue, TexturePtr presentTex)
 		m_rgraph->getStatistics(rgraphStats);
 		m_stats.m_renderingGpuTime = rgraphStats.m_gpuTime;
 		m_stats.m_renderingGpuSubmitTimestamp = rgraphStats.m_cpuStartTime;
+		m_stats.m_renderTargetMemory = rgraphStats.m_transientRenderTargetMemory;
+		m_stats.m_renderTargetMemoryWithoutAliasing = rgraphStats.m_transientRenderTargetMemoryWithoutAliasing;
 	}
 
 	return Error::NONE;
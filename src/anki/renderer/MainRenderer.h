@@ -28,6 +28,8 @@ public:
 	Second m_renderingCpuTime ANKI_DEBUG_CODE(= -1.0);
 	Second m_renderingGpuTime ANKI_DEBUG_CODE(= -1.0);
 	Second m_renderingGpuSubmitTimestamp ANKI_DEBUG_CODE(= -1.0);
+	PtrSize m_renderTargetMemory ANKI_DEBUG_CODE(= 0);
+	PtrSize m_renderTargetMemoryWithoutAliasing ANKI_DEBUG_CODE(= 0);
 };
 
 /// Main onscreen renderer
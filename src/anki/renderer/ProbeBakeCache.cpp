@@ -0,0 +1,463 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/ProbeBakeCache.h>
+#include <anki/renderer/Renderer.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/AsyncLoader.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+#include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+ANKI_REGISTER_CONFIG_OPTION(r_probeBakeCache, 1, 0, 1, "Store the rendered probes on disk and load them next time")
+ANKI_REGISTER_CONFIG_OPTION(
+	r_probeBakeCacheMaxUploadsPerFrame, 4, 1, 64, "Max number of probes that will be loaded from disk every frame")
+
+/// Reads a probe file in the async loader.
+class ProbeBakeCache::LoadTask : public AsyncLoaderTask
+{
+public:
+	Request* m_req;
+
+	LoadTask(Request* req)
+		: m_req(req)
+	{
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		Bool found;
+		const Error err = m_req->m_self->loadProbeFile(*m_req, found);
+		m_req->setState((!err && found) ? RequestState::DONE : RequestState::FAILED);
+
+		// Don't stop the async loader, the probe will be rendered
+		return Error::NONE;
+	}
+};
+
+/// Writes a probe file in the async loader.
+class ProbeBakeCache::StoreTask : public AsyncLoaderTask
+{
+public:
+	Request* m_req;
+
+	StoreTask(Request* req)
+		: m_req(req)
+	{
+	}
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		const Error err = m_req->m_self->storeProbe(*m_req);
+		if(err)
+		{
+			ANKI_R_LOGW("Failed to store a baked probe");
+		}
+
+		m_req->setState((err) ? RequestState::FAILED : RequestState::DONE);
+		return Error::NONE;
+	}
+};
+
+ProbeBakeCache::~ProbeBakeCache()
+{
+	// Wait for the async loader to finish with the requests
+	const Array<DynamicArray<Request*>*, 3> allRequests = {{&m_loads, &m_stores, &m_readbacks}};
+	for(DynamicArray<Request*>* requests : allRequests)
+	{
+		while(requests->getSize())
+		{
+			Request& req = *requests->getBack();
+			while(requests != &m_readbacks && req.getState() == RequestState::PENDING)
+			{
+				HighRezTimer::sleep(0.001);
+			}
+
+			if(req.m_buffAddr)
+			{
+				req.m_buff->unmap();
+			}
+
+			deleteRequest(*requests, requests->getSize() - 1);
+		}
+
+		requests->destroy(getAllocator());
+	}
+
+	m_dir.destroy(getAllocator());
+}
+
+Error ProbeBakeCache::init(const ConfigSet& cfg)
+{
+	const Error err = initInternal(cfg);
+	if(err)
+	{
+		ANKI_R_LOGE("Failed to initialize the probe bake cache");
+	}
+
+	return err;
+}
+
+Error ProbeBakeCache::initInternal(const ConfigSet& cfg)
+{
+	m_enabled = cfg.getBool("r_probeBakeCache");
+	m_maxUploadsPerFrame = cfg.getNumberU32("r_probeBakeCacheMaxUploadsPerFrame");
+
+	if(!m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	m_dir.sprintf(getAllocator(), "%s/probes", getResourceManager().getCacheDirectory().cstr());
+	if(!directoryExists(m_dir.toCString()))
+	{
+		ANKI_CHECK(createDirectory(m_dir.toCString()));
+	}
+
+	ANKI_CHECK(getResourceManager().loadResource("shaders/ProbeBakeCacheCopy.glslp", m_prog));
+
+	for(U32 imageToBuffer = 0; imageToBuffer < 2; ++imageToBuffer)
+	{
+		for(U32 isCube = 0; isCube < 2; ++isCube)
+		{
+			ShaderProgramResourceMutationInitList<2> mutations(m_prog);
+			mutations.add("IMAGE_TO_BUFFER", imageToBuffer);
+			mutations.add("IS_CUBE", isCube);
+
+			const ShaderProgramResourceVariant* variant;
+			m_prog->getOrCreateVariant(mutations.get(), variant);
+			m_grProgs[imageToBuffer][isCube] = variant->getProgram();
+		}
+	}
+
+	// The files are not valid when the engine or the shaders that render the probes change. The shaders of the
+	// materials are part of the content hash of the scene
+	StringAuto version(getAllocator());
+	version.sprintf("%u.%u %s %s", ANKI_VERSION_MAJOR, ANKI_VERSION_MINOR, ANKI_REVISION, MAGIC);
+	m_versionHash = computeHash(version.cstr(), version.getLength());
+
+	static const Array<CString, 4> programs = {{"shaders/TraditionalDeferredShading.glslp",
+		"shaders/IrradianceDice.glslp",
+		"shaders/ApplyIrradianceToReflection.glslp",
+		"shaders/ProbeBakeCacheCopy.glslp"}};
+	for(CString fname : programs)
+	{
+		ShaderProgramResourcePtr prog;
+		ANKI_CHECK(getResourceManager().loadResource(fname, prog));
+		const U64 progHash = prog->getContentHash();
+		m_versionHash = appendHash(&progHash, sizeof(progHash), m_versionHash);
+	}
+
+	return Error::NONE;
+}
+
+void ProbeBakeCache::getFilename(U64 key, StringAuto& filename) const
+{
+	filename.sprintf("%s/%016" PRIx64 ".ankiprobe", m_dir.cstr(), key);
+}
+
+void ProbeBakeCache::deleteRequest(DynamicArray<Request*>& requests, U32 idx)
+{
+	getAllocator().deleteInstance(requests[idx]);
+	requests[idx] = requests.getBack();
+	requests.popBack(getAllocator());
+}
+
+void ProbeBakeCache::beginFrame()
+{
+	m_uploadsThisFrame = 0;
+	const U64 frame = m_r->getFrameCount();
+
+	// Store the readbacks that the GPU is done with
+	U32 i = 0;
+	while(i < m_readbacks.getSize())
+	{
+		Request* req = m_readbacks[i];
+		if(frame - req->m_frame <= MAX_FRAMES_IN_FLIGHT)
+		{
+			++i;
+			continue;
+		}
+
+		m_stores.emplaceBack(getAllocator(), req);
+		getResourceManager().getAsyncLoader().submitNewTask<StoreTask>(req);
+
+		m_readbacks[i] = m_readbacks.getBack();
+		m_readbacks.popBack(getAllocator());
+	}
+
+	// Release the buffers of the stores that are done
+	i = 0;
+	while(i < m_stores.getSize())
+	{
+		Request& req = *m_stores[i];
+		if(req.getState() == RequestState::PENDING)
+		{
+			++i;
+			continue;
+		}
+
+		req.m_buff->unmap();
+		deleteRequest(m_stores, i);
+	}
+
+	// Forget the loads that were not asked for a while. Their probes are not visible anymore or they were rendered
+	i = 0;
+	while(i < m_loads.getSize())
+	{
+		const Request& req = *m_loads[i];
+		if(req.getState() == RequestState::PENDING || frame - req.m_frame <= MAX_FRAMES_IN_FLIGHT)
+		{
+			++i;
+			continue;
+		}
+
+		deleteRequest(m_loads, i);
+	}
+}
+
+Error ProbeBakeCache::storeProbe(const Request& req)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_PROBE_BAKE_CACHE);
+
+	FileHeader header = {};
+	memcpy(&header.m_magic[0], MAGIC, sizeof(header.m_magic));
+	header.m_key = req.m_key;
+	header.m_width = req.m_size.x();
+	header.m_height = req.m_size.y();
+	header.m_depth = req.m_size.z();
+
+	StringAuto filename(getAllocator());
+	getFilename(req.m_key, filename);
+
+	// Write to a temporary file and rename it so a crash won't leave a half written probe behind
+	StringAuto tmpFilename(getAllocator());
+	tmpFilename.sprintf("%s.%" PRIx64 ".tmp", filename.cstr(), Thread::getCurrentThreadId());
+
+	Error err = Error::NONE;
+	{
+		File file;
+		err = file.open(tmpFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::WRITE);
+		if(!err)
+		{
+			err = file.write(&header, sizeof(header));
+		}
+
+		if(!err)
+		{
+			err = file.write(req.m_buffAddr, computeDataSize(req.m_size));
+		}
+	}
+
+	if(!err)
+	{
+		err = renameFile(tmpFilename.toCString(), filename.toCString());
+	}
+
+	// Don't leave the temporary file behind if something failed
+	if(err && fileExists(tmpFilename.toCString()))
+	{
+		const Error removeErr = removeFile(tmpFilename.toCString());
+		(void)removeErr;
+	}
+
+	return err;
+}
+
+ProbeBakeCache::LoadStatus ProbeBakeCache::loadProbe(U64 contentHash, const UVec3& size, BufferPtr& buff)
+{
+	if(!m_enabled || contentHash == 0)
+	{
+		return LoadStatus::MISSING;
+	}
+
+	const U64 key = computeKey(contentHash);
+	U32 idx = 0;
+	while(idx < m_loads.getSize() && (m_loads[idx]->m_key != key || m_loads[idx]->m_size != size))
+	{
+		++idx;
+	}
+
+	if(idx == m_loads.getSize())
+	{
+		// First time it's asked, start reading the file
+		Request* req = getAllocator().newInstance<Request>();
+		req->m_self = this;
+		req->m_key = key;
+		req->m_size = size;
+		req->m_frame = m_r->getFrameCount();
+		m_loads.emplaceBack(getAllocator(), req);
+
+		getResourceManager().getAsyncLoader().submitNewTask<LoadTask>(req);
+		return LoadStatus::PENDING;
+	}
+
+	Request& req = *m_loads[idx];
+	req.m_frame = m_r->getFrameCount();
+
+	LoadStatus status;
+	switch(req.getState())
+	{
+	case RequestState::PENDING:
+		status = LoadStatus::PENDING;
+		break;
+	case RequestState::FAILED:
+		status = LoadStatus::MISSING;
+		break;
+	default:
+		ANKI_ASSERT(req.getState() == RequestState::DONE);
+		if(m_uploadsThisFrame < m_maxUploadsPerFrame)
+		{
+			++m_uploadsThisFrame;
+			buff = req.m_buff;
+			deleteRequest(m_loads, idx);
+			status = LoadStatus::LOADED;
+		}
+		else
+		{
+			status = LoadStatus::PENDING;
+		}
+	}
+
+	return status;
+}
+
+Error ProbeBakeCache::loadProbeFile(Request& req, Bool& found)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_PROBE_BAKE_CACHE);
+	found = false;
+
+	StringAuto filename(getAllocator());
+	getFilename(req.m_key, filename);
+	if(!fileExists(filename.toCString()))
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	FileHeader header;
+	const PtrSize dataSize = computeDataSize(req.m_size);
+	if(file.open(filename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::READ)
+		|| file.getSize() != sizeof(header) + dataSize || file.read(&header, sizeof(header))
+		|| memcmp(&header.m_magic[0], MAGIC, sizeof(header.m_magic)) != 0 || header.m_key != req.m_key
+		|| header.m_width != req.m_size.x() || header.m_height != req.m_size.y() || header.m_depth != req.m_size.z())
+	{
+		ANKI_R_LOGW("Baked probe is not compatible. Will ignore it: %s", filename.cstr());
+		return Error::NONE;
+	}
+
+	req.m_buff = getGrManager().newBuffer(
+		BufferInitInfo(dataSize, BufferUsageBit::STORAGE_COMPUTE_READ, BufferMapAccessBit::WRITE, "ProbeBakeUpload"));
+	void* mapped = req.m_buff->map(0, dataSize, BufferMapAccessBit::WRITE);
+	const Error err = file.read(mapped, dataSize);
+	req.m_buff->unmap();
+
+	if(err)
+	{
+		req.m_buff.reset(nullptr);
+		return err;
+	}
+
+	found = true;
+	return Error::NONE;
+}
+
+void ProbeBakeCache::addUploadPass(
+	RenderingContext& ctx, BufferPtr buff, RenderTargetHandle rt, const TextureSubresourceInfo& subresource)
+{
+	ANKI_ASSERT(m_enabled && buff.isCreated());
+
+	PassContext* pctx = ctx.m_tempAllocator.newInstance<PassContext>();
+	pctx->m_self = this;
+	pctx->m_rt = rt;
+	pctx->m_subresource = subresource;
+	pctx->m_imageToBuffer = false;
+	addPass(ctx, buff, pctx);
+}
+
+void ProbeBakeCache::addReadbackPass(RenderingContext& ctx,
+	U64 contentHash,
+	RenderTargetHandle rt,
+	const TextureSubresourceInfo& subresource,
+	const UVec3& size)
+{
+	if(!m_enabled || contentHash == 0)
+	{
+		return;
+	}
+
+	// Create the buffer that will hold the results. It stays mapped till it's written to the disk
+	const PtrSize dataSize = computeDataSize(size);
+
+	Request* readback = getAllocator().newInstance<Request>();
+	readback->m_self = this;
+	readback->m_buff = getGrManager().newBuffer(
+		BufferInitInfo(dataSize, BufferUsageBit::STORAGE_COMPUTE_WRITE, BufferMapAccessBit::READ, "ProbeBakeReadback"));
+	readback->m_buffAddr = readback->m_buff->map(0, dataSize, BufferMapAccessBit::READ);
+	readback->m_key = computeKey(contentHash);
+	readback->m_size = size;
+	readback->m_frame = m_r->getFrameCount();
+	m_readbacks.emplaceBack(getAllocator(), readback);
+
+	// Add the pass
+	PassContext* pctx = ctx.m_tempAllocator.newInstance<PassContext>();
+	pctx->m_self = this;
+	pctx->m_rt = rt;
+	pctx->m_subresource = subresource;
+	pctx->m_imageToBuffer = true;
+	addPass(ctx, readback->m_buff, pctx);
+}
+
+void ProbeBakeCache::addPass(RenderingContext& ctx, BufferPtr buff, PassContext* pctx)
+{
+	static_assert(std::is_trivially_destructible<PassContext>::value, "See file");
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+
+	// The render graph will hold a reference to the buffer
+	pctx->m_buffHandle = rgraph.importBuffer(buff, BufferUsageBit::NONE);
+
+	ComputeRenderPassDescription& pass =
+		rgraph.newComputeRenderPass((pctx->m_imageToBuffer) ? "Probe bake readback" : "Probe bake upload");
+	pass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			const PassContext& pctx = *static_cast<const PassContext*>(rgraphCtx.m_userData);
+			pctx.m_self->run(rgraphCtx, pctx);
+		},
+		pctx,
+		0);
+
+	pass.newDependency({pctx->m_rt,
+		(pctx->m_imageToBuffer) ? TextureUsageBit::IMAGE_COMPUTE_READ : TextureUsageBit::IMAGE_COMPUTE_WRITE,
+		pctx->m_subresource});
+	pass.newDependency({pctx->m_buffHandle,
+		(pctx->m_imageToBuffer) ? BufferUsageBit::STORAGE_COMPUTE_WRITE : BufferUsageBit::STORAGE_COMPUTE_READ});
+}
+
+void ProbeBakeCache::run(RenderPassWorkContext& rgraphCtx, const PassContext& pctx)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_PROBE_BAKE_CACHE);
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+	const Bool isCube = pctx.m_subresource.m_faceCount == 6;
+
+	cmdb->bindShaderProgram(m_grProgs[pctx.m_imageToBuffer][isCube]);
+
+	rgraphCtx.bindImage(0, 0, pctx.m_rt, pctx.m_subresource);
+	rgraphCtx.bindStorageBuffer(0, 1, pctx.m_buffHandle);
+
+	TexturePtr tex;
+	TextureUsageBit usage;
+	rgraphCtx.getRenderTargetState(pctx.m_rt, pctx.m_subresource, tex, usage);
+	const U32 depth = (isCube) ? 6 : tex->getDepth();
+	dispatchPPCompute(cmdb, 8, 8, 1, tex->getWidth(), tex->getHeight(), depth);
+}
+
+} // end namespace anki
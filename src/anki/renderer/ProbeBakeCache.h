@@ -0,0 +1,165 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/RendererObject.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Hash.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// Stores the results of the reflection and GI probes on disk so the next runs won't have to render them again. The
+/// results are keyed by the content hash of the probes, the version of the engine and the shaders that render them.
+/// They are read back from the GPU with a compute pass and they are stored a few frames later when the GPU is done
+/// with them. The files are read and written by the async loader of the ResourceManager so the render thread never
+/// touches the disk.
+/// @note The probes are loaded on demand when the renderer first needs them and not when the scene is loaded. The
+///       renderer skips a probe for a few frames while its file is read and at most
+///       r_probeBakeCacheMaxUploadsPerFrame probes are uploaded every frame.
+class ProbeBakeCache : public RendererObject
+{
+anki_internal:
+	enum class LoadStatus : U8
+	{
+		LOADED,
+		PENDING, ///< The file is being read. Ask again next frame.
+		MISSING ///< Not on disk or it's not compatible. The probe should be rendered.
+	};
+
+	ProbeBakeCache(Renderer* r)
+		: RendererObject(r)
+	{
+	}
+
+	~ProbeBakeCache();
+
+	ANKI_USE_RESULT Error init(const ConfigSet& cfg);
+
+	/// Finish the file operations that are done and reset the limits of the frame. Call it once per frame.
+	void beginFrame();
+
+	/// Try to load the results of a probe from the disk. The first call starts reading the file in the background.
+	/// @param contentHash The content hash of the probe. Zero means that the probe can't be cached.
+	/// @param size The size of the image in texels. For cubes the Z should be 6.
+	/// @param[out] buff A buffer with the results that should be passed to addUploadPass(). It's set if the result is
+	///                  LoadStatus::LOADED.
+	LoadStatus loadProbe(U64 contentHash, const UVec3& size, BufferPtr& buff);
+
+	/// Add a pass that copies the results that loadProbe() returned to an image. The image should be a cube (6 faces
+	/// subresource) or a 3D texture.
+	void addUploadPass(
+		RenderingContext& ctx, BufferPtr buff, RenderTargetHandle rt, const TextureSubresourceInfo& subresource);
+
+	/// Add a pass that reads back the results of a probe. They will be stored to disk a few frames later.
+	void addReadbackPass(RenderingContext& ctx,
+		U64 contentHash,
+		RenderTargetHandle rt,
+		const TextureSubresourceInfo& subresource,
+		const UVec3& size);
+
+private:
+	static constexpr const char* MAGIC = "ANKIPRB2";
+
+	class FileHeader
+	{
+	public:
+		char m_magic[8];
+		U64 m_key;
+		U32 m_width;
+		U32 m_height;
+		U32 m_depth;
+		U32 m_padding;
+	};
+
+	/// The state of a file operation of the async loader.
+	enum class RequestState : U32
+	{
+		PENDING,
+		DONE,
+		FAILED
+	};
+
+	/// A file read or write. The async loader works on it while its state is pending.
+	class Request
+	{
+	public:
+		ProbeBakeCache* m_self = nullptr;
+		BufferPtr m_buff;
+		void* m_buffAddr = nullptr; ///< Only for stores.
+		U64 m_key = 0;
+		UVec3 m_size = UVec3(0u);
+		U64 m_frame = 0; ///< For loads it's the frame it was last asked. For stores the frame the readback was issued.
+		Atomic<U32> m_state = {U32(RequestState::PENDING)};
+
+		RequestState getState() const
+		{
+			return RequestState(m_state.load(AtomicMemoryOrder::ACQUIRE));
+		}
+
+		void setState(RequestState state)
+		{
+			m_state.store(U32(state), AtomicMemoryOrder::RELEASE);
+		}
+	};
+
+	class LoadTask;
+	class StoreTask;
+
+	/// Info for the passes. It's allocated in the temp memory so it should be trivially destructible.
+	class PassContext
+	{
+	public:
+		ProbeBakeCache* m_self;
+		RenderPassBufferHandle m_buffHandle;
+		RenderTargetHandle m_rt;
+		TextureSubresourceInfo m_subresource;
+		Bool m_imageToBuffer;
+	};
+
+	ShaderProgramResourcePtr m_prog;
+	Array2d<ShaderProgramPtr, 2, 2> m_grProgs; ///< Indexed by the IMAGE_TO_BUFFER and the IS_CUBE mutators.
+
+	String m_dir;
+	U64 m_versionHash = 0; ///< The engine version and the shaders. It's part of the key of the files.
+	DynamicArray<Request*> m_readbacks; ///< Waiting for the GPU.
+	DynamicArray<Request*> m_stores; ///< Waiting for the async loader.
+	DynamicArray<Request*> m_loads;
+	U32 m_maxUploadsPerFrame = 0;
+	U32 m_uploadsThisFrame = 0;
+	Bool m_enabled = false;
+
+	ANKI_USE_RESULT Error initInternal(const ConfigSet& cfg);
+
+	void addPass(RenderingContext& ctx, BufferPtr buff, PassContext* pctx);
+	void run(RenderPassWorkContext& rgraphCtx, const PassContext& pctx);
+
+	/// @name Running in the async loader
+	/// @{
+	ANKI_USE_RESULT Error storeProbe(const Request& req);
+	ANKI_USE_RESULT Error loadProbeFile(Request& req, Bool& found);
+	/// @}
+
+	U64 computeKey(U64 contentHash) const
+	{
+		return appendHash(&contentHash, sizeof(contentHash), m_versionHash);
+	}
+
+	void getFilename(U64 key, StringAuto& filename) const;
+
+	void deleteRequest(DynamicArray<Request*>& requests, U32 idx);
+
+	static PtrSize computeDataSize(const UVec3& size)
+	{
+		return PtrSize(size.x()) * size.y() * size.z() * sizeof(U16) * 4;
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -8,6 +8,7 @@
 #include <anki/renderer/FinalComposite.h>
 #include <anki/renderer/GBuffer.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/renderer/ProbeBakeCache.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/Tracer.h>
 #include <anki/resource/MeshResource.h>
@@ -276,8 +277,24 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx,
 		const Bool probeFoundInCache = m_cacheEntries[cacheEntryIdx].m_uuid == probe.m_uuid;
 
 		// Check if we _should_ and _can_ update the probe
-		const Bool needsUpdate = !probeFoundInCache;
+		const Bool needsUpdate =
+			!probeFoundInCache || m_cacheEntries[cacheEntryIdx].m_contentHash != probe.m_contentHash;
+		ProbeBakeCache::LoadStatus bakeStatus = ProbeBakeCache::LoadStatus::MISSING;
 		if(ANKI_UNLIKELY(needsUpdate))
+		{
+			bakeStatus = tryLoadBakedProbe(ctx, probe, cacheEntryIdx);
+		}
+
+		if(bakeStatus == ProbeBakeCache::LoadStatus::LOADED)
+		{
+			// Loaded from the disk, no need to render it
+		}
+		else if(bakeStatus == ProbeBakeCache::LoadStatus::PENDING)
+		{
+			// Still reading the file, skip the probe till it's done
+			continue;
+		}
+		else if(ANKI_UNLIKELY(needsUpdate))
 		{
 			const Bool canUpdateThisFrame = probeToUpdateThisFrame == nullptr && probe.m_renderQueues[0] != nullptr;
 			const Bool canUpdateNextFrame = !foundProbeToUpdateNextFrame;
@@ -306,6 +323,7 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx,
 
 		// Update the cache entry
 		m_cacheEntries[cacheEntryIdx].m_uuid = probe.m_uuid;
+		m_cacheEntries[cacheEntryIdx].m_contentHash = probe.m_contentHash;
 		m_cacheEntries[cacheEntryIdx].m_lastUsedTimestamp = m_r->getGlobalTimestamp();
 
 		// Update the probe
@@ -342,6 +360,55 @@ void ProbeReflections::prepareProbes(RenderingContext& ctx,
 	}
 }
 
+ProbeBakeCache::LoadStatus ProbeReflections::tryLoadBakedProbe(
+	RenderingContext& ctx, const ReflectionProbeQueueElement& probe, U32 cacheEntryIdx)
+{
+	BufferPtr buff;
+	const ProbeBakeCache::LoadStatus status = m_r->getProbeBakeCache().loadProbe(
+		probe.m_contentHash, UVec3(m_lightShading.m_tileSize, m_lightShading.m_tileSize, 6), buff);
+	if(status != ProbeBakeCache::LoadStatus::LOADED)
+	{
+		return status;
+	}
+
+	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
+
+	// Upload
+	TextureSubresourceInfo subresource;
+	subresource.m_faceCount = 6;
+	subresource.m_firstLayer = cacheEntryIdx;
+	m_r->getProbeBakeCache().addUploadPass(ctx, buff, m_ctx.m_lightShadingRt, subresource);
+
+	// Mipmapping of all faces in one pass
+	class MipmapInfo
+	{
+	public:
+		ProbeReflections* m_self;
+		U32 m_cacheEntryIdx;
+	};
+
+	MipmapInfo* info = ctx.m_tempAllocator.newInstance<MipmapInfo>();
+	info->m_self = this;
+	info->m_cacheEntryIdx = cacheEntryIdx;
+
+	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("CubeRefl baked mip");
+	pass.setWork(
+		[](RenderPassWorkContext& rgraphCtx) {
+			const MipmapInfo& info = *static_cast<const MipmapInfo*>(rgraphCtx.m_userData);
+			for(U32 faceIdx = 0; faceIdx < 6; ++faceIdx)
+			{
+				info.m_self->runMipmappingOfLightShading(faceIdx, info.m_cacheEntryIdx, rgraphCtx);
+			}
+		},
+		info,
+		0);
+
+	subresource.m_mipmapCount = m_lightShading.m_mipCount;
+	pass.newDependency({m_ctx.m_lightShadingRt, TextureUsageBit::GENERATE_MIPMAPS, subresource});
+
+	return status;
+}
+
 void ProbeReflections::runGBuffer(RenderPassWorkContext& rgraphCtx)
 {
 	ANKI_ASSERT(m_ctx.m_probe);
@@ -442,14 +509,14 @@ void ProbeReflections::runLightShading(U32 faceIdx, RenderPassWorkContext& rgrap
 	m_lightShading.m_deferred.drawLights(dsInfo);
 }
 
-void ProbeReflections::runMipmappingOfLightShading(U32 faceIdx, RenderPassWorkContext& rgraphCtx)
+void ProbeReflections::runMipmappingOfLightShading(U32 faceIdx, U32 cacheEntryIdx, RenderPassWorkContext& rgraphCtx)
 {
 	ANKI_ASSERT(faceIdx < 6);
-	ANKI_ASSERT(m_ctx.m_cacheEntryIdx < m_cacheEntries.getSize());
+	ANKI_ASSERT(cacheEntryIdx < m_cacheEntries.getSize());
 
 	ANKI_TRACE_SCOPED_EVENT(R_CUBE_REFL);
 
-	TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, m_ctx.m_cacheEntryIdx));
+	TextureSubresourceInfo subresource(TextureSurfaceInfo(0, 0, faceIdx, cacheEntryIdx));
 	subresource.m_mipmapCount = m_lightShading.m_mipCount;
 
 	TexturePtr texToBind;
@@ -524,6 +591,9 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 #endif
 	RenderGraphDescription& rgraph = rctx.m_renderGraphDescr;
 
+	// Import first because the probes that are loaded from the disk will be uploaded while preparing
+	m_ctx.m_lightShadingRt = rgraph.importRenderTarget(m_lightShading.m_cubeArr, TextureUsageBit::SAMPLED_FRAGMENT);
+
 	// Prepare the probes and maybe get one to render this frame
 	ReflectionProbeQueueElement* probeToUpdate;
 	U32 probeToUpdateCacheEntryIdx;
@@ -532,9 +602,6 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 	// Render a probe if needed
 	if(!probeToUpdate)
 	{
-		// Just import and exit
-
-		m_ctx.m_lightShadingRt = rgraph.importRenderTarget(m_lightShading.m_cubeArr, TextureUsageBit::SAMPLED_FRAGMENT);
 		return;
 	}
 
@@ -658,9 +725,6 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 			runLightShadingCallback<4>,
 			runLightShadingCallback<5>}};
 
-		// RT
-		m_ctx.m_lightShadingRt = rgraph.importRenderTarget(m_lightShading.m_cubeArr, TextureUsageBit::SAMPLED_FRAGMENT);
-
 		// Passes
 		static const Array<CString, 6> passNames = {{"CubeRefl LightShad #0",
 			"CubeRefl LightShad #1",
@@ -741,6 +805,18 @@ void ProbeReflections::populateRenderGraph(RenderingContext& rctx)
 		pass.newDependency({m_ctx.m_irradianceDiceValuesBuffHandle, BufferUsageBit::STORAGE_COMPUTE_READ});
 	}
 
+	// Store the result to the disk
+	{
+		TextureSubresourceInfo subresource;
+		subresource.m_faceCount = 6;
+		subresource.m_firstLayer = probeToUpdateCacheEntryIdx;
+		m_r->getProbeBakeCache().addReadbackPass(rctx,
+			probeToUpdate->m_contentHash,
+			m_ctx.m_lightShadingRt,
+			subresource,
+			UVec3(m_lightShading.m_tileSize, m_lightShading.m_tileSize, 6));
+	}
+
 	// Mipmapping "passes"
 	{
 		static const Array<RenderPassWorkCallback, 6> callbacks = {{runMipmappingOfLightShadingCallback<0>,
@@ -9,6 +9,7 @@
 #include <anki/renderer/RendererObject.h>
 #include <anki/renderer/TraditionalDeferredShading.h>
 #include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/ProbeBakeCache.h>
 #include <anki/resource/TextureResource.h>
 
 namespace anki
@@ -105,6 +106,7 @@ private:
 	{
 	public:
 		U64 m_uuid; ///< Probe UUID.
+		U64 m_contentHash = 0; ///< The content hash of the probe when it was rendered.
 		Timestamp m_lastUsedTimestamp = 0; ///< When it was last seen by the renderer.
 
 		Array<FramebufferDescription, 6> m_lightShadingFbDescrs;
@@ -146,10 +148,14 @@ private:
 	void prepareProbes(
 		RenderingContext& ctx, ReflectionProbeQueueElement*& probeToUpdate, U32& probeToUpdateCacheEntryIdx);
 
+	/// Try to load a probe from the ProbeBakeCache. If it's loaded it will add the passes that upload it.
+	ProbeBakeCache::LoadStatus tryLoadBakedProbe(
+		RenderingContext& ctx, const ReflectionProbeQueueElement& probe, U32 cacheEntryIdx);
+
 	void runGBuffer(RenderPassWorkContext& rgraphCtx);
 	void runShadowMapping(RenderPassWorkContext& rgraphCtx);
 	void runLightShading(U32 faceIdx, RenderPassWorkContext& rgraphCtx);
-	void runMipmappingOfLightShading(U32 faceIdx, RenderPassWorkContext& rgraphCtx);
+	void runMipmappingOfLightShading(U32 faceIdx, U32 cacheEntryIdx, RenderPassWorkContext& rgraphCtx);
 	void runIrradiance(RenderPassWorkContext& rgraphCtx);
 	void runIrradianceToRefl(RenderPassWorkContext& rgraphCtx);
 
@@ -166,7 +172,7 @@ private:
 	static void runMipmappingOfLightShadingCallback(RenderPassWorkContext& rgraphCtx)
 	{
 		ProbeReflections* const self = static_cast<ProbeReflections*>(rgraphCtx.m_userData);
-		self->runMipmappingOfLightShading(faceIdx, rgraphCtx);
+		self->runMipmappingOfLightShading(faceIdx, self->m_ctx.m_cacheEntryIdx, rgraphCtx);
 	}
 };
 /// @}
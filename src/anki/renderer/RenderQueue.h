@@ -63,6 +63,10 @@ public:
 
 	F32 m_distanceFromCamera; ///< Don't set this
 
+	/// A rough estimation of the CPU cost to record the element. 1.0 is the cost of a simple drawcall. Used to split
+	/// the work between threads.
+	F32 m_cost = 1.0f;
+
 	RenderableQueueElement()
 	{
 	}
@@ -194,6 +198,7 @@ class ReflectionProbeQueueElement final
 {
 public:
 	U64 m_uuid;
+	U64 m_contentHash; ///< Hash of the probe's placement and the scene's content. Zero if the content is unknown.
 	ReflectionProbeQueueElementFeedbackCallback m_feedbackCallback;
 	void* m_feedbackCallbackUserData;
 	RenderQueueDrawCallback m_debugDrawCallback;
@@ -221,6 +226,7 @@ class GlobalIlluminationProbeQueueElement final
 {
 public:
 	U64 m_uuid;
+	U64 m_contentHash; ///< Hash of the probe's placement and the scene's content. Zero if the content is unknown.
 	GlobalIlluminationProbeQueueElementFeedbackCallback m_feedbackCallback;
 	void* m_feedbackCallbackUserData;
 	RenderQueueDrawCallback m_debugDrawCallback;
@@ -343,7 +349,10 @@ static_assert(
 	std::is_trivially_destructible<FogDensityQueueElement>::value == true, "Should be trivially destructible");
 
 /// A callback to fill a coverage buffer.
-using FillCoverageBufferCallback = void (*)(void* userData, F32* depthValues, U32 width, U32 height);
+/// @param viewProjMat The view projection matrix that was used to render the depthValues. It might be of an older
+///                    frame.
+using FillCoverageBufferCallback =
+	void (*)(void* userData, F32* depthValues, U32 width, U32 height, const Mat4& viewProjMat);
 
 /// The render queue. This is what the renderer is fed to render.
 class RenderQueue : public RenderingMatrices
@@ -365,9 +374,14 @@ public:
 	WeakArray<UiQueueElement> m_uis;
 	WeakArray<GenericGpuComputeJobQueueElement> m_genericGpuComputeJobs;
 
-	/// Applies only if the RenderQueue holds shadow casters. It's the max timesamp of all shadow casters
+	/// Applies only if the RenderQueue holds shadow casters. It's the max timesamp of the light and the static shadow
+	/// casters.
 	Timestamp m_shadowRenderablesLastUpdateTimestamp = 0;
 
+	/// Applies only if the RenderQueue holds shadow casters. The first m_staticShadowRenderableCount elements of
+	/// m_renderables are the static shadow casters and the rest are the dynamic ones (they changed recently).
+	U32 m_staticShadowRenderableCount = 0;
+
 	F32 m_cameraNear;
 	F32 m_cameraFar;
 	F32 m_cameraFovX;
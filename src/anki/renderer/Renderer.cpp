@@ -31,6 +31,7 @@
 #include <anki/renderer/VolumetricLightingAccumulation.h>
 #include <anki/renderer/GlobalIllumination.h>
 #include <anki/renderer/GenericCompute.h>
+#include <anki/renderer/ProbeBakeCache.h>
 #include <shaders/glsl_cpp_common/ClusteredShading.h>
 
 namespace anki
@@ -136,6 +137,9 @@ Error Renderer::initInternal(const ConfigSet& config)
 	m_volLighting.reset(m_alloc.newInstance<VolumetricLightingAccumulation>(this));
 	ANKI_CHECK(m_volLighting->init(config));
 
+	m_probeBakeCache.reset(m_alloc.newInstance<ProbeBakeCache>(this));
+	ANKI_CHECK(m_probeBakeCache->init(config));
+
 	m_gi.reset(m_alloc.newInstance<GlobalIllumination>(this));
 	ANKI_CHECK(m_gi->init(config));
 
@@ -308,6 +312,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_depth->importRenderTargets(ctx);
 
 	// Populate render graph. WARNING Watch the order
+	m_probeBakeCache->beginFrame();
 	m_genericCompute->populateRenderGraph(ctx);
 	m_shadowMapping->populateRenderGraph(ctx);
 	m_gi->populateRenderGraph(ctx);
@@ -320,6 +325,7 @@ Error Renderer::populateRenderGraph(RenderingContext& ctx)
 	m_ssao->populateRenderGraph(ctx);
 	m_lensFlare->populateRenderGraph(ctx);
 	m_ssr->populateRenderGraph(ctx);
+	m_forwardShading->prepareThreadedWork(ctx);
 	m_lightShading->populateRenderGraph(ctx);
 	m_temporalAA->populateRenderGraph(ctx);
 	m_downscale->populateRenderGraph(ctx);
@@ -365,9 +371,10 @@ void Renderer::finalize(const RenderingContext& ctx)
 		F32* depthValues;
 		U32 width;
 		U32 height;
-		m_depth->getClientDepthMapInfo(depthValues, width, height);
+		Mat4 viewProjMat;
+		m_depth->getClientDepthMapInfo(depthValues, width, height, viewProjMat);
 		ctx.m_renderQueue->m_fillCoverageBufferCallback(
-			ctx.m_renderQueue->m_fillCoverageBufferCallbackUserData, depthValues, width, height);
+			ctx.m_renderQueue->m_fillCoverageBufferCallbackUserData, depthValues, width, height, viewProjMat);
 	}
 }
 
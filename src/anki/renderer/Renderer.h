@@ -185,6 +185,11 @@ public:
 		return *m_gi;
 	}
 
+	ProbeBakeCache& getProbeBakeCache()
+	{
+		return *m_probeBakeCache;
+	}
+
 	UiStage& getUiStage()
 	{
 		return *m_uiStage;
@@ -392,6 +397,7 @@ private:
 	UniquePtr<Dbg> m_dbg; ///< Debug stage.
 	UniquePtr<UiStage> m_uiStage;
 	UniquePtr<GenericCompute> m_genericCompute;
+	UniquePtr<ProbeBakeCache> m_probeBakeCache;
 	/// @}
 
 	Array<U32, 4> m_clusterCount;
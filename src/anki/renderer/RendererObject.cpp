@@ -5,6 +5,8 @@
 
 #include <anki/renderer/RendererObject.h>
 #include <anki/renderer/Renderer.h>
+#include <anki/renderer/Drawer.h>
+#include <anki/renderer/RenderQueue.h>
 #include <anki/util/Enum.h>
 #include <anki/util/ThreadHive.h>
 
@@ -77,4 +79,46 @@ U32 RendererObject::computeNumberOfSecondLevelCommandBuffers(U32 drawcallCount)
 	return secondLevelCmdbCount;
 }
 
+WeakArray<F32> RendererObject::computeRenderableCostPrefixSums(RenderingContext& ctx,
+	ConstWeakArray<RenderableQueueElement> first,
+	ConstWeakArray<RenderableQueueElement> second)
+{
+	const U32 count = first.getSize() + second.getSize();
+	if(count == 0)
+	{
+		return WeakArray<F32>();
+	}
+
+	WeakArray<F32> prefixSums(ctx.m_tempAllocator.newArray<F32>(count), count);
+
+	if(first.getSize())
+	{
+		RenderableDrawer::computeCostPrefixSums(first, 0.0f, WeakArray<F32>(&prefixSums[0], first.getSize()));
+	}
+
+	if(second.getSize())
+	{
+		const F32 costSoFar = (first.getSize()) ? prefixSums[first.getSize() - 1] : 0.0f;
+		RenderableDrawer::computeCostPrefixSums(
+			second, costSoFar, WeakArray<F32>(&prefixSums[first.getSize()], second.getSize()));
+	}
+
+	return prefixSums;
+}
+
+U32 RendererObject::computeNumberOfSecondLevelCommandBuffers(ConstWeakArray<F32> costPrefixSums) const
+{
+	const U32 drawcallCount = costPrefixSums.getSize();
+	if(drawcallCount == 0)
+	{
+		return 1;
+	}
+
+	// Every command buffer should have enough work to be worth it
+	const F32 totalCost = costPrefixSums.getBack();
+	const U32 secondLevelCmdbCount = U32(totalCost / F32(MIN_DRAWCALLS_PER_2ND_LEVEL_COMMAND_BUFFER));
+
+	return clamp(secondLevelCmdbCount, 1u, min(m_r->getThreadHive().getThreadCount(), drawcallCount));
+}
+
 } // end namespace anki
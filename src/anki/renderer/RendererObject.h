@@ -19,6 +19,8 @@ namespace anki
 class Renderer;
 class ResourceManager;
 class ConfigSet;
+class RenderingContext;
+class RenderableQueueElement;
 
 /// @addtogroup renderer
 /// @{
@@ -50,6 +52,16 @@ protected:
 
 	U32 computeNumberOfSecondLevelCommandBuffers(U32 drawcallCount) const;
 
+	/// Same as computeNumberOfSecondLevelCommandBuffers but it takes into account the cost of the drawcalls.
+	/// @param costPrefixSums The inclusive prefix sums of the drawcall costs. See RenderableDrawer::computeCostPrefixSums.
+	U32 computeNumberOfSecondLevelCommandBuffers(ConstWeakArray<F32> costPrefixSums) const;
+
+	/// Compute the cost prefix sums of one or two arrays of renderables. The second array is considered to follow the
+	/// first. The result is allocated in the frame's temp memory.
+	static WeakArray<F32> computeRenderableCostPrefixSums(RenderingContext& ctx,
+		ConstWeakArray<RenderableQueueElement> first,
+		ConstWeakArray<RenderableQueueElement> second = ConstWeakArray<RenderableQueueElement>());
+
 	/// Used in fullscreen quad draws.
 	static void drawQuad(CommandBufferPtr& cmdb)
 	{
@@ -39,6 +39,7 @@ class ShadowMapping::Scratch::LightToRenderToScratchInfo
 public:
 	Array<U32, 4> m_viewport;
 	RenderQueue* m_renderQueue;
+	U32 m_firstDrawcall; ///< The first renderable of the m_renderQueue.
 	U32 m_drawcallCount;
 };
 
@@ -51,6 +52,8 @@ public:
 	F32 m_cameraFar;
 	Bool m_blur;
 	Bool m_perspectiveProjection;
+	Bool m_hasInput; ///< If false nothing was rendered to the scratch buffer.
+	Bool m_mergeStatic; ///< Merge with the static atlas.
 };
 
 ShadowMapping::~ShadowMapping()
@@ -121,6 +124,11 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 		ClearValue clearVal;
 		clearVal.m_colorf[0] = 1.0f;
 		m_atlas.m_tex = m_r->createAndClearRenderTarget(texinit, clearVal);
+
+		texinit.setName("SM static atlas");
+		texinit.m_usage = TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::SAMPLED_COMPUTE;
+		texinit.m_initialUsage = TextureUsageBit::SAMPLED_COMPUTE;
+		m_atlas.m_staticTex = m_r->createAndClearRenderTarget(texinit, clearVal);
 	}
 
 	// Tiles
@@ -137,9 +145,15 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 			UVec2(m_scratch.m_tileCountX * m_scratch.m_tileResolution,
 				m_scratch.m_tileCountY * m_scratch.m_tileResolution));
 
-		const ShaderProgramResourceVariant* variant;
-		m_atlas.m_resolveProg->getOrCreateVariant(consts.get(), variant);
-		m_atlas.m_resolveGrProg = variant->getProgram();
+		for(U32 mergeStatic = 0; mergeStatic < 2; ++mergeStatic)
+		{
+			ShaderProgramResourceMutationInitList<1> mutations(m_atlas.m_resolveProg);
+			mutations.add("MERGE_STATIC", mergeStatic);
+
+			const ShaderProgramResourceVariant* variant;
+			m_atlas.m_resolveProg->getOrCreateVariant(mutations.get(), consts.get(), variant);
+			m_atlas.m_resolveGrProgs[mergeStatic] = variant->getProgram();
+		}
 	}
 
 	return Error::NONE;
@@ -156,23 +170,49 @@ Error ShadowMapping::initInternal(const ConfigSet& cfg)
 	return Error::NONE;
 }
 
-void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
+void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx, Bool staticAtlas)
 {
-	ANKI_ASSERT(m_atlas.m_resolveWorkItems.getSize());
+	const WeakArray<Atlas::ResolveWorkItem>& workItems =
+		(staticAtlas) ? m_atlas.m_staticResolveWorkItems : m_atlas.m_resolveWorkItems;
+	ANKI_ASSERT(workItems.getSize());
 	ANKI_TRACE_SCOPED_EVENT(R_SM);
 
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
 
-	cmdb->bindShaderProgram(m_atlas.m_resolveGrProg);
-
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
-	rgraphCtx.bindTexture(0, 1, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
-	rgraphCtx.bindImage(0, 2, m_atlas.m_rt, {});
 
-	for(const Atlas::ResolveWorkItem& workItem : m_atlas.m_resolveWorkItems)
+	if(m_scratch.m_workItems.getSize())
+	{
+		rgraphCtx.bindTexture(0, 1, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+	}
+	else
+	{
+		// Nothing was rendered this frame, the work items don't have input
+		cmdb->bindTexture(0, 1, m_r->getDummyTextureView2d(), TextureUsageBit::SAMPLED_COMPUTE);
+	}
+
+	if(staticAtlas)
+	{
+		rgraphCtx.bindImage(0, 2, m_atlas.m_staticRt, {});
+	}
+	else
+	{
+		rgraphCtx.bindImage(0, 2, m_atlas.m_rt, {});
+		rgraphCtx.bindColorTexture(0, 3, m_atlas.m_staticRt);
+	}
+
+	U32 boundProg = MAX_U32;
+	for(const Atlas::ResolveWorkItem& workItem : workItems)
 	{
 		ANKI_TRACE_INC_COUNTER(R_SHADOW_PASSES, 1);
 
+		ANKI_ASSERT(!staticAtlas || !workItem.m_mergeStatic);
+		if(boundProg != U32(workItem.m_mergeStatic))
+		{
+			boundProg = U32(workItem.m_mergeStatic);
+			cmdb->bindShaderProgram(m_atlas.m_resolveGrProgs[boundProg]);
+		}
+
 		struct Uniforms
 		{
 			Vec2 m_uvScale;
@@ -190,7 +230,11 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 		unis.m_viewport = UVec4(
 			workItem.m_viewportOut[0], workItem.m_viewportOut[1], workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
 
-		if(workItem.m_perspectiveProjection)
+		if(!workItem.m_hasInput)
+		{
+			unis.m_renderingTechnique = 4;
+		}
+		else if(workItem.m_perspectiveProjection)
 		{
 			unis.m_renderingTechnique = (workItem.m_blur) ? 0 : 1;
 		}
@@ -247,56 +291,74 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 	// Build the render graph
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
-	if(m_scratch.m_workItems.getSize())
+	m_atlas.m_rt = rgraph.importRenderTarget(m_atlas.m_tex, TextureUsageBit::SAMPLED_FRAGMENT);
+	m_atlas.m_staticRt = rgraph.importRenderTarget(m_atlas.m_staticTex, TextureUsageBit::SAMPLED_COMPUTE);
+
+	const Bool hasScratchWork = m_scratch.m_workItems.getSize() > 0;
+	if(hasScratchWork)
 	{
-		// Will have to create render passes
+		// Compute render area
+		const U32 minx = 0, miny = 0;
+		const U32 height = m_scratch.m_maxViewportHeight;
+		const U32 width = m_scratch.m_maxViewportWidth;
+
+		GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("SM scratch");
+
+		m_scratch.m_rt = rgraph.newRenderTarget(m_scratch.m_rtDescr);
+		pass.setFramebufferInfo(m_scratch.m_fbDescr, {}, m_scratch.m_rt, minx, miny, width, height);
+		ANKI_ASSERT(threadCountForScratchPass && threadCountForScratchPass <= m_r->getThreadHive().getThreadCount());
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runShadowMapping(rgraphCtx);
+			},
+			this,
+			threadCountForScratchPass);
+
+		TextureSubresourceInfo subresource = TextureSubresourceInfo(DepthStencilAspectBit::DEPTH);
+		pass.newDependency({m_scratch.m_rt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+	}
+
+	// Static atlas pass
+	if(m_atlas.m_staticResolveWorkItems.getSize())
+	{
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM static atlas");
+
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runAtlas(rgraphCtx, true);
+			},
+			this,
+			0);
 
-		// Scratch pass
+		if(hasScratchWork)
 		{
-			// Compute render area
-			const U32 minx = 0, miny = 0;
-			const U32 height = m_scratch.m_maxViewportHeight;
-			const U32 width = m_scratch.m_maxViewportWidth;
-
-			GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("SM scratch");
-
-			m_scratch.m_rt = rgraph.newRenderTarget(m_scratch.m_rtDescr);
-			pass.setFramebufferInfo(m_scratch.m_fbDescr, {}, m_scratch.m_rt, minx, miny, width, height);
-			ANKI_ASSERT(
-				threadCountForScratchPass && threadCountForScratchPass <= m_r->getThreadHive().getThreadCount());
-			pass.setWork(
-				[](RenderPassWorkContext& rgraphCtx) {
-					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runShadowMapping(rgraphCtx);
-				},
-				this,
-				threadCountForScratchPass);
-
-			TextureSubresourceInfo subresource = TextureSubresourceInfo(DepthStencilAspectBit::DEPTH);
-			pass.newDependency({m_scratch.m_rt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
+			pass.newDependency({m_scratch.m_rt,
+				TextureUsageBit::SAMPLED_COMPUTE,
+				TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
 		}
+		pass.newDependency({m_atlas.m_staticRt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+	}
 
-		// Atlas pass
-		{
-			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM atlas");
+	// Atlas pass
+	if(m_atlas.m_resolveWorkItems.getSize())
+	{
+		ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM atlas");
 
-			m_atlas.m_rt = rgraph.importRenderTarget(m_atlas.m_tex, TextureUsageBit::SAMPLED_FRAGMENT);
-			pass.setWork(
-				[](RenderPassWorkContext& rgraphCtx) {
-					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runAtlas(rgraphCtx);
-				},
-				this,
-				0);
+		pass.setWork(
+			[](RenderPassWorkContext& rgraphCtx) {
+				static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runAtlas(rgraphCtx, false);
+			},
+			this,
+			0);
 
+		if(hasScratchWork)
+		{
 			pass.newDependency({m_scratch.m_rt,
 				TextureUsageBit::SAMPLED_COMPUTE,
 				TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
-			pass.newDependency({m_atlas.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
 		}
-	}
-	else
-	{
-		// No need for shadowmapping passes, just import the atlas
-		m_atlas.m_rt = rgraph.importRenderTarget(m_atlas.m_tex, TextureUsageBit::SAMPLED_FRAGMENT);
+		pass.newDependency({m_atlas.m_staticRt, TextureUsageBit::SAMPLED_COMPUTE});
+		pass.newDependency({m_atlas.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
 	}
 }
 
@@ -388,9 +450,11 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	const U64* faceTimestamps,
 	const U32* faceIndices,
 	const U32* drawcallsCount,
+	const U32* dynamicDrawcallsCount,
 	const U32* lods,
 	Viewport* atlasTileViewports,
 	Viewport* scratchTileViewports,
+	Viewport* dynamicScratchTileViewports,
 	TileAllocatorResult* subResults)
 {
 	ANKI_ASSERT(lightUuid > 0);
@@ -398,6 +462,7 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	ANKI_ASSERT(faceTimestamps);
 	ANKI_ASSERT(faceIndices);
 	ANKI_ASSERT(drawcallsCount);
+	ANKI_ASSERT(dynamicDrawcallsCount);
 	ANKI_ASSERT(lods);
 
 	TileAllocatorResult res = TileAllocatorResult::ALLOCATION_FAILED;
@@ -436,51 +501,71 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 		atlasTileViewports[i][3] *= m_atlas.m_tileResolution;
 	}
 
-	// Allocate scratch tiles
+	// Allocate scratch tiles. The static shadow casters need a tile only if the atlas tile is not cached, the dynamic
+	// ones need a tile every frame
 	for(U i = 0; i < faceCount; ++i)
 	{
-		if(subResults[i] == TileAllocatorResult::CACHED)
+		ANKI_ASSERT(subResults[i] == TileAllocatorResult::CACHED
+					|| subResults[i] == TileAllocatorResult::ALLOCATION_SUCCEEDED);
+
+		if(subResults[i] != TileAllocatorResult::CACHED && drawcallsCount[i] > 0)
 		{
-			continue;
+			res = allocateScratchTile(lightUuid, faceTimestamps[i], faceIndices[i], lods[i], scratchTileViewports[i]);
+			if(res == TileAllocatorResult::ALLOCATION_FAILED)
+			{
+				break;
+			}
 		}
 
-		ANKI_ASSERT(subResults[i] == TileAllocatorResult::ALLOCATION_SUCCEEDED);
-
-		res = m_scratch.m_tileAlloc.allocate(m_r->getGlobalTimestamp(),
-			faceTimestamps[i],
-			lightUuid,
-			faceIndices[i],
-			drawcallsCount[i],
-			lods[i],
-			scratchTileViewports[i]);
-
-		if(res == TileAllocatorResult::ALLOCATION_FAILED)
+		if(dynamicDrawcallsCount[i] > 0)
 		{
-			ANKI_R_LOGW("Don't have enough space in the scratch shadow mapping buffer. "
-						"If you see this message too often increase r_shadowMappingScratchTileCountX/Y");
-
-			// Invalidate atlas tiles
-			for(U j = 0; j < faceCount; ++j)
+			res = allocateScratchTile(
+				lightUuid, faceTimestamps[i], faceIndices[i], lods[i], dynamicScratchTileViewports[i]);
+			if(res == TileAllocatorResult::ALLOCATION_FAILED)
 			{
-				m_atlas.m_tileAlloc.invalidateCache(lightUuid, faceIndices[j]);
+				break;
 			}
+		}
+	}
 
-			return res;
+	if(res == TileAllocatorResult::ALLOCATION_FAILED)
+	{
+		ANKI_R_LOGW("Don't have enough space in the scratch shadow mapping buffer. "
+					"If you see this message too often increase r_shadowMappingScratchTileCountX/Y");
+
+		// Invalidate atlas tiles
+		for(U j = 0; j < faceCount; ++j)
+		{
+			m_atlas.m_tileAlloc.invalidateCache(lightUuid, faceIndices[j]);
 		}
+	}
 
-		// Fix viewport
-		scratchTileViewports[i][0] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][1] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][2] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][3] *= m_scratch.m_tileResolution;
+	return res;
+}
+
+TileAllocatorResult ShadowMapping::allocateScratchTile(
+	U64 lightUuid, U64 faceTimestamp, U32 faceIdx, U32 lod, Viewport& scratchTileViewport)
+{
+	// The scratch allocator doesn't cache so the drawcall count doesn't matter
+	const TileAllocatorResult res = m_scratch.m_tileAlloc.allocate(
+		m_r->getGlobalTimestamp(), faceTimestamp, lightUuid, faceIdx, 1, lod, scratchTileViewport);
 
-		// Update the max view width
-		m_scratch.m_maxViewportWidth =
-			max(m_scratch.m_maxViewportWidth, scratchTileViewports[i][0] + scratchTileViewports[i][2]);
-		m_scratch.m_maxViewportHeight =
-			max(m_scratch.m_maxViewportHeight, scratchTileViewports[i][1] + scratchTileViewports[i][3]);
+	if(res == TileAllocatorResult::ALLOCATION_FAILED)
+	{
+		return res;
 	}
 
+	// Fix viewport
+	scratchTileViewport[0] *= m_scratch.m_tileResolution;
+	scratchTileViewport[1] *= m_scratch.m_tileResolution;
+	scratchTileViewport[2] *= m_scratch.m_tileResolution;
+	scratchTileViewport[3] *= m_scratch.m_tileResolution;
+
+	// Update the max view width
+	m_scratch.m_maxViewportWidth = max(m_scratch.m_maxViewportWidth, scratchTileViewport[0] + scratchTileViewport[2]);
+	m_scratch.m_maxViewportHeight =
+		max(m_scratch.m_maxViewportHeight, scratchTileViewport[1] + scratchTileViewport[3]);
+
 	return res;
 }
 
@@ -495,6 +580,7 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo> lightsToRender(ctx.m_tempAllocator);
 	U32 drawcallCount = 0;
 	DynamicArrayAuto<Atlas::ResolveWorkItem> atlasWorkItems(ctx.m_tempAllocator);
+	DynamicArrayAuto<Atlas::ResolveWorkItem> staticAtlasWorkItems(ctx.m_tempAllocator);
 
 	// First thing, allocate an empty tile for empty faces of point lights
 	Viewport emptyTileViewport;
@@ -525,8 +611,10 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		Array<U64, MAX_SHADOW_CASCADES> timestamps;
 		Array<U32, MAX_SHADOW_CASCADES> cascadeIndices;
 		Array<U32, MAX_SHADOW_CASCADES> drawcallCounts;
+		Array<U32, MAX_SHADOW_CASCADES> dynamicDrawcallCounts;
 		Array<Viewport, MAX_SHADOW_CASCADES> atlasViewports;
 		Array<Viewport, MAX_SHADOW_CASCADES> scratchViewports;
+		Array<Viewport, MAX_SHADOW_CASCADES> dynamicScratchViewports;
 		Array<TileAllocatorResult, MAX_SHADOW_CASCADES> subResults;
 		Array<U32, MAX_SHADOW_CASCADES> lods;
 		Array<Bool, MAX_SHADOW_CASCADES> blurAtlass;
@@ -543,6 +631,7 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				timestamps[activeCascades] = m_r->getGlobalTimestamp(); // This light is always updated
 				cascadeIndices[activeCascades] = cascade;
 				drawcallCounts[activeCascades] = 1; // Doesn't matter
+				dynamicDrawcallCounts[activeCascades] = 0; // The light is never cached so all casters are static
 
 				// Change the quality per cascade
 				blurAtlass[activeCascades] = (cascade <= 1);
@@ -558,9 +647,11 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 											 &timestamps[0],
 											 &cascadeIndices[0],
 											 &drawcallCounts[0],
+											 &dynamicDrawcallCounts[0],
 											 &lods[0],
 											 &atlasViewports[0],
 											 &scratchViewports[0],
+											 &dynamicScratchViewports[0],
 											 &subResults[0])
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -614,8 +705,10 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		Array<U64, 6> timestamps;
 		Array<U32, 6> faceIndices;
 		Array<U32, 6> drawcallCounts;
+		Array<U32, 6> dynamicDrawcallCounts;
 		Array<Viewport, 6> atlasViewports;
 		Array<Viewport, 6> scratchViewports;
+		Array<Viewport, 6> dynamicScratchViewports;
 		Array<TileAllocatorResult, 6> subResults;
 		Array<U32, 6> lods;
 		U32 numOfFacesThatHaveDrawcalls = 0;
@@ -634,8 +727,10 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				timestamps[numOfFacesThatHaveDrawcalls] =
 					light->m_shadowRenderQueues[face]->m_shadowRenderablesLastUpdateTimestamp;
 
-				drawcallCounts[numOfFacesThatHaveDrawcalls] =
-					light->m_shadowRenderQueues[face]->m_renderables.getSize();
+				const RenderQueue& faceQueue = *light->m_shadowRenderQueues[face];
+				drawcallCounts[numOfFacesThatHaveDrawcalls] = faceQueue.m_staticShadowRenderableCount;
+				dynamicDrawcallCounts[numOfFacesThatHaveDrawcalls] =
+					faceQueue.m_renderables.getSize() - faceQueue.m_staticShadowRenderableCount;
 
 				lods[numOfFacesThatHaveDrawcalls] = lod;
 
@@ -649,9 +744,11 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 											 &timestamps[0],
 											 &faceIndices[0],
 											 &drawcallCounts[0],
+											 &dynamicDrawcallCounts[0],
 											 &lods[0],
 											 &atlasViewports[0],
 											 &scratchViewports[0],
+											 &dynamicScratchViewports[0],
 											 &subResults[0])
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -673,23 +770,23 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 					// Has drawcalls, asigned it to a tile
 
 					const Viewport& atlasViewport = atlasViewports[numOfFacesThatHaveDrawcalls];
-					const Viewport& scratchViewport = scratchViewports[numOfFacesThatHaveDrawcalls];
 
 					// Add a half texel to the viewport's start to avoid bilinear filtering bleeding
 					light->m_shadowAtlasTileOffsets[face].x() = (F32(atlasViewport[0]) + 0.5f) / atlasResolution;
 					light->m_shadowAtlasTileOffsets[face].y() = (F32(atlasViewport[1]) + 0.5f) / atlasResolution;
 
-					if(subResults[numOfFacesThatHaveDrawcalls] != TileAllocatorResult::CACHED)
-					{
-						newScratchAndAtlasResloveRenderWorkItems(atlasViewport,
-							scratchViewport,
-							blurAtlas,
-							true,
-							light->m_shadowRenderQueues[face],
-							lightsToRender,
-							atlasWorkItems,
-							drawcallCount);
-					}
+					newStaticAndDynamicRenderWorkItems(light->m_uuid,
+						face,
+						subResults[numOfFacesThatHaveDrawcalls],
+						atlasViewport,
+						scratchViewports[numOfFacesThatHaveDrawcalls],
+						dynamicScratchViewports[numOfFacesThatHaveDrawcalls],
+						blurAtlas,
+						light->m_shadowRenderQueues[face],
+						lightsToRender,
+						staticAtlasWorkItems,
+						atlasWorkItems,
+						drawcallCount);
 
 					++numOfFacesThatHaveDrawcalls;
 				}
@@ -723,7 +820,10 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		TileAllocatorResult subResult;
 		Viewport atlasViewport;
 		Viewport scratchViewport;
+		Viewport dynamicScratchViewport;
 		const U32 localDrawcallCount = light->m_shadowRenderQueue->m_renderables.getSize();
+		const U32 staticDrawcallCount = light->m_shadowRenderQueue->m_staticShadowRenderableCount;
+		const U32 dynamicDrawcallCount = localDrawcallCount - staticDrawcallCount;
 
 		Bool blurAtlas;
 		const U32 lod = choseLod(cameraOrigin, *light, blurAtlas);
@@ -732,10 +832,12 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 											 1,
 											 &light->m_shadowRenderQueue->m_shadowRenderablesLastUpdateTimestamp,
 											 &faceIdx,
-											 &localDrawcallCount,
+											 &staticDrawcallCount,
+											 &dynamicDrawcallCount,
 											 &lod,
 											 &atlasViewport,
 											 &scratchViewport,
+											 &dynamicScratchViewport,
 											 &subResult)
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -746,17 +848,18 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 			// Update the texture matrix to point to the correct region in the atlas
 			light->m_textureMatrix = createSpotLightTextureMatrix(atlasViewport) * light->m_textureMatrix;
 
-			if(subResult != TileAllocatorResult::CACHED)
-			{
-				newScratchAndAtlasResloveRenderWorkItems(atlasViewport,
-					scratchViewport,
-					blurAtlas,
-					true,
-					light->m_shadowRenderQueue,
-					lightsToRender,
-					atlasWorkItems,
-					drawcallCount);
-			}
+			newStaticAndDynamicRenderWorkItems(light->m_uuid,
+				faceIdx,
+				subResult,
+				atlasViewport,
+				scratchViewport,
+				dynamicScratchViewport,
+				blurAtlas,
+				light->m_shadowRenderQueue,
+				lightsToRender,
+				staticAtlasWorkItems,
+				atlasWorkItems,
+				drawcallCount);
 		}
 		else
 		{
@@ -773,12 +876,33 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		U32 lightToRenderDrawcallCount = lightToRender->m_drawcallCount;
 		const Scratch::LightToRenderToScratchInfo* lightToRenderEnd = lightsToRender.getEnd();
 
-		const U32 threadCount = computeNumberOfSecondLevelCommandBuffers(drawcallCount);
+		// Compute the costs of the drawcalls of all lights to split them between tasks
+		DynamicArrayAuto<F32> costPrefixSums(ctx.m_tempAllocator);
+		costPrefixSums.create(drawcallCount);
+		U32 drawcallsSoFar = 0;
+		for(const Scratch::LightToRenderToScratchInfo& info : lightsToRender)
+		{
+			if(info.m_drawcallCount == 0)
+			{
+				continue;
+			}
+
+			const F32 costSoFar = (drawcallsSoFar) ? costPrefixSums[drawcallsSoFar - 1] : 0.0f;
+			RenderableDrawer::computeCostPrefixSums(
+				ConstWeakArray<RenderableQueueElement>(
+					&info.m_renderQueue->m_renderables[info.m_firstDrawcall], info.m_drawcallCount),
+				costSoFar,
+				WeakArray<F32>(&costPrefixSums[drawcallsSoFar], info.m_drawcallCount));
+			drawcallsSoFar += info.m_drawcallCount;
+		}
+		ANKI_ASSERT(drawcallsSoFar == drawcallCount);
+
+		const U32 threadCount = computeNumberOfSecondLevelCommandBuffers(costPrefixSums);
 		threadCountForScratchPass = threadCount;
 		for(U32 taskId = 0; taskId < threadCount; ++taskId)
 		{
 			U32 start, end;
-			splitThreadedProblem(taskId, threadCount, drawcallCount, start, end);
+			splitThreadedProblem(taskId, threadCount, drawcallCount, &costPrefixSums[0], start, end);
 
 			// While there are drawcalls in this task emit new work items
 			U32 taskDrawcallCount = end - start;
@@ -792,7 +916,8 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				Scratch::WorkItem workItem;
 				workItem.m_viewport = lightToRender->m_viewport;
 				workItem.m_renderQueue = lightToRender->m_renderQueue;
-				workItem.m_firstRenderableElement = lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
+				workItem.m_firstRenderableElement =
+					lightToRender->m_firstDrawcall + lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
 				workItem.m_renderableElementCount = workItemDrawcallCount;
 				workItem.m_threadPoolTaskIdx = taskId;
 				workItems.emplaceBack(workItem);
@@ -817,25 +942,30 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		ANKI_ASSERT(lightsToRender.getSize() <= workItems.getSize());
 
 		// All good, store the work items for the threads to pick up
-		{
-			Scratch::WorkItem* items;
-			U32 itemSize;
-			U32 itemStorageSize;
-			workItems.moveAndReset(items, itemSize, itemStorageSize);
-
-			ANKI_ASSERT(items && itemSize && itemStorageSize);
-			m_scratch.m_workItems = WeakArray<Scratch::WorkItem>(items, itemSize);
-
-			Atlas::ResolveWorkItem* atlasItems;
-			atlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
-			ANKI_ASSERT(atlasItems && itemSize && itemStorageSize);
-			m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
-		}
+		Scratch::WorkItem* items;
+		U32 itemSize;
+		U32 itemStorageSize;
+		workItems.moveAndReset(items, itemSize, itemStorageSize);
+
+		ANKI_ASSERT(items && itemSize && itemStorageSize);
+		m_scratch.m_workItems = WeakArray<Scratch::WorkItem>(items, itemSize);
 	}
 	else
 	{
 		m_scratch.m_workItems = WeakArray<Scratch::WorkItem>();
-		m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>();
+	}
+
+	// Store the atlas work items. There might be some even if nothing was rendered to the scratch buffer (eg when
+	// dynamic casters stopped casting to a tile and the static shadows need to be restored)
+	{
+		Atlas::ResolveWorkItem* atlasItems;
+		U32 itemSize;
+		U32 itemStorageSize;
+		atlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
+		m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
+
+		staticAtlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
+		m_atlas.m_staticResolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
 	}
 }
 
@@ -851,32 +981,107 @@ void ShadowMapping::newScratchAndAtlasResloveRenderWorkItems(const Viewport& atl
 	// Scratch work item
 	{
 		Scratch::LightToRenderToScratchInfo toRender = {
-			scratchVewport, lightRenderQueue, lightRenderQueue->m_renderables.getSize()};
+			scratchVewport, lightRenderQueue, 0, lightRenderQueue->m_renderables.getSize()};
 		scratchWorkItem.emplaceBack(toRender);
 		drawcallCount += lightRenderQueue->m_renderables.getSize();
 	}
 
 	// Atlas resolve work item
+	atlasResolveWorkItem.emplaceBack(
+		newResolveWorkItem(atlasViewport, &scratchVewport, blurAtlas, perspectiveProjection, false, *lightRenderQueue));
+}
+
+void ShadowMapping::newStaticAndDynamicRenderWorkItems(U64 lightUuid,
+	U32 face,
+	TileAllocatorResult atlasTileResult,
+	const Viewport& atlasViewport,
+	const Viewport& scratchViewport,
+	const Viewport& dynamicScratchViewport,
+	Bool blurAtlas,
+	RenderQueue* lightRenderQueue,
+	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItems,
+	DynamicArrayAuto<Atlas::ResolveWorkItem>& staticAtlasResolveWorkItems,
+	DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItems,
+	U32& drawcallCount)
+{
+	const U32 staticCount = lightRenderQueue->m_staticShadowRenderableCount;
+	const U32 dynamicCount = lightRenderQueue->m_renderables.getSize() - staticCount;
+	const Bool renderStatic = atlasTileResult != TileAllocatorResult::CACHED;
+	const Bool hasDynamic = dynamicCount > 0;
+
+	// If the previous frame had dynamic casters in that tile then it needs to be restored even if there are none now
+	const Bool hadDynamic = m_atlas.m_tileAlloc.exchangeUncachedContent(lightUuid, face, hasDynamic);
+
+	// Static casters
+	if(renderStatic)
+	{
+		if(staticCount > 0)
+		{
+			Scratch::LightToRenderToScratchInfo toRender = {scratchViewport, lightRenderQueue, 0, staticCount};
+			scratchWorkItems.emplaceBack(toRender);
+			drawcallCount += staticCount;
+		}
+
+		staticAtlasResolveWorkItems.emplaceBack(newResolveWorkItem(
+			atlasViewport, (staticCount > 0) ? &scratchViewport : nullptr, blurAtlas, true, false, *lightRenderQueue));
+	}
+
+	// Dynamic casters
+	if(hasDynamic)
+	{
+		Scratch::LightToRenderToScratchInfo toRender = {
+			dynamicScratchViewport, lightRenderQueue, staticCount, dynamicCount};
+		scratchWorkItems.emplaceBack(toRender);
+		drawcallCount += dynamicCount;
+	}
+
+	// Merge them to the final atlas
+	if(renderStatic || hasDynamic || hadDynamic)
+	{
+		atlasResolveWorkItems.emplaceBack(newResolveWorkItem(atlasViewport,
+			(hasDynamic) ? &dynamicScratchViewport : nullptr,
+			blurAtlas,
+			true,
+			true,
+			*lightRenderQueue));
+	}
+}
+
+ShadowMapping::Atlas::ResolveWorkItem ShadowMapping::newResolveWorkItem(const Viewport& atlasViewport,
+	const Viewport* scratchViewport,
+	Bool blurAtlas,
+	Bool perspectiveProjection,
+	Bool mergeStatic,
+	const RenderQueue& lightRenderQueue) const
+{
+	Atlas::ResolveWorkItem atlasItem;
+
+	if(scratchViewport)
 	{
 		const F32 scratchAtlasWidth = F32(m_scratch.m_tileCountX * m_scratch.m_tileResolution);
 		const F32 scratchAtlasHeight = F32(m_scratch.m_tileCountY * m_scratch.m_tileResolution);
 
-		Atlas::ResolveWorkItem atlasItem;
-		atlasItem.m_uvIn[0] = F32(scratchVewport[0]) / scratchAtlasWidth;
-		atlasItem.m_uvIn[1] = F32(scratchVewport[1]) / scratchAtlasHeight;
-		atlasItem.m_uvIn[2] = F32(scratchVewport[2]) / scratchAtlasWidth;
-		atlasItem.m_uvIn[3] = F32(scratchVewport[3]) / scratchAtlasHeight;
+		atlasItem.m_uvIn[0] = F32((*scratchViewport)[0]) / scratchAtlasWidth;
+		atlasItem.m_uvIn[1] = F32((*scratchViewport)[1]) / scratchAtlasHeight;
+		atlasItem.m_uvIn[2] = F32((*scratchViewport)[2]) / scratchAtlasWidth;
+		atlasItem.m_uvIn[3] = F32((*scratchViewport)[3]) / scratchAtlasHeight;
+	}
+	else
+	{
+		atlasItem.m_uvIn = Vec4(0.0f);
+	}
 
-		atlasItem.m_viewportOut = atlasViewport;
+	atlasItem.m_viewportOut = atlasViewport;
 
-		atlasItem.m_cameraFar = lightRenderQueue->m_cameraFar;
-		atlasItem.m_cameraNear = lightRenderQueue->m_cameraNear;
+	atlasItem.m_cameraFar = lightRenderQueue.m_cameraFar;
+	atlasItem.m_cameraNear = lightRenderQueue.m_cameraNear;
 
-		atlasItem.m_blur = blurAtlas;
-		atlasItem.m_perspectiveProjection = perspectiveProjection;
+	atlasItem.m_blur = blurAtlas;
+	atlasItem.m_perspectiveProjection = perspectiveProjection;
+	atlasItem.m_hasInput = scratchViewport != nullptr;
+	atlasItem.m_mergeStatic = mergeStatic;
 
-		atlasResolveWorkItem.emplaceBack(atlasItem);
-	}
+	return atlasItem;
 }
 
 } // end namespace anki
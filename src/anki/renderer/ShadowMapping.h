@@ -16,7 +16,10 @@ namespace anki
 /// @addtogroup renderer
 /// @{
 
-/// Shadowmapping pass
+/// Shadowmapping pass.
+///
+/// The static shadow casters of the point and spot lights are cached in a separate atlas and they are re-rendered only
+/// when they change. The dynamic casters are rendered every frame and they are merged on top of the static ones.
 class ShadowMapping : public RendererObject
 {
 anki_internal:
@@ -53,20 +56,24 @@ private:
 		TexturePtr m_tex; ///<  Size (m_tileResolution*m_tileCountBothAxis)^2
 		RenderTargetHandle m_rt;
 
+		TexturePtr m_staticTex; ///< Same as m_tex but it holds only the static shadow casters.
+		RenderTargetHandle m_staticRt;
+
 		U32 m_tileResolution = 0; ///< Tile resolution.
 		U32 m_tileCountBothAxis = 0;
 
 		ShaderProgramResourcePtr m_resolveProg;
-		ShaderProgramPtr m_resolveGrProg;
+		Array<ShaderProgramPtr, 2> m_resolveGrProgs; ///< Indexed by the MERGE_STATIC mutator.
 
 		WeakArray<ResolveWorkItem> m_resolveWorkItems;
+		WeakArray<ResolveWorkItem> m_staticResolveWorkItems; ///< Work items that write to m_staticTex.
 	} m_atlas;
 
 	ANKI_USE_RESULT Error initAtlas(const ConfigSet& cfg);
 
 	inline Mat4 createSpotLightTextureMatrix(const Viewport& viewport) const;
 
-	void runAtlas(RenderPassWorkContext& rgraphCtx);
+	void runAtlas(RenderPassWorkContext& rgraphCtx, Bool staticAtlas);
 	/// @}
 
 	/// @name Scratch buffer stuff
@@ -111,17 +118,24 @@ private:
 	/// Find the lod of the light
 	U32 choseLod(const Vec4& cameraOrigin, const SpotLightQueueElement& light, Bool& blurAtlas) const;
 
-	/// Try to allocate a number of scratch tiles and regular tiles.
+	/// Try to allocate a number of scratch tiles and regular tiles. The regular tiles are cached using the static
+	/// shadow casters. The dynamic shadow casters get their own scratch tiles.
 	TileAllocatorResult allocateTilesAndScratchTiles(U64 lightUuid,
 		U32 faceCount,
 		const U64* faceTimestamps,
 		const U32* faceIndices,
 		const U32* drawcallsCount,
+		const U32* dynamicDrawcallsCount,
 		const U32* lods,
 		Viewport* atlasTileViewports,
 		Viewport* scratchTileViewports,
+		Viewport* dynamicScratchTileViewports,
 		TileAllocatorResult* subResults);
 
+	/// Allocate a tile in the scratch buffer.
+	TileAllocatorResult allocateScratchTile(
+		U64 lightUuid, U64 faceTimestamp, U32 faceIdx, U32 lod, Viewport& scratchTileViewport);
+
 	/// Add new work to render to scratch buffer and atlas buffer.
 	void newScratchAndAtlasResloveRenderWorkItems(const Viewport& atlasViewport,
 		const Viewport& scratchVewport,
@@ -132,6 +146,30 @@ private:
 		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
 		U32& drawcallCount) const;
 
+	/// Add new work for a face of a point or spot light. The static shadow casters are rendered only if their tile is
+	/// not cached. The dynamic ones are rendered every frame and they are merged with the static ones.
+	void newStaticAndDynamicRenderWorkItems(U64 lightUuid,
+		U32 face,
+		TileAllocatorResult atlasTileResult,
+		const Viewport& atlasViewport,
+		const Viewport& scratchViewport,
+		const Viewport& dynamicScratchViewport,
+		Bool blurAtlas,
+		RenderQueue* lightRenderQueue,
+		DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItems,
+		DynamicArrayAuto<Atlas::ResolveWorkItem>& staticAtlasResolveWorkItems,
+		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItems,
+		U32& drawcallCount);
+
+	/// Create a work item that resolves a scratch tile to the atlas.
+	/// @param scratchViewport The scratch tile. If nullptr the resolve will write the far value.
+	Atlas::ResolveWorkItem newResolveWorkItem(const Viewport& atlasViewport,
+		const Viewport* scratchViewport,
+		Bool blurAtlas,
+		Bool perspectiveProjection,
+		Bool mergeStatic,
+		const RenderQueue& lightRenderQueue) const;
+
 	/// Iterate lights and create work items.
 	void processLights(RenderingContext& ctx, U32& threadCountForScratchPass);
 
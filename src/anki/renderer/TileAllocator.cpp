@@ -20,6 +20,7 @@ public:
 	U32 m_superTile = MAX_U32;
 	U8 m_lightLod = 0;
 	U8 m_lightFace = 0;
+	Bool m_hasUncachedContent = false;
 };
 
 class TileAllocator::HashMapKey
@@ -349,6 +350,7 @@ TileAllocatorResult TileAllocator::allocate(Timestamp crntTimestamp,
 	allocatedTile.m_lightDrawcallCount = drawcallCount;
 	allocatedTile.m_lightLod = U8(lod);
 	allocatedTile.m_lightFace = U8(lightFace);
+	allocatedTile.m_hasUncachedContent = false;
 
 	updateTileHierarchy(allocatedTile);
 
@@ -383,4 +385,31 @@ void TileAllocator::invalidateCache(U64 lightUuid, U32 lightFace)
 	}
 }
 
+Bool TileAllocator::exchangeUncachedContent(U64 lightUuid, U32 lightFace, Bool hasUncachedContent)
+{
+	ANKI_ASSERT(m_cachingEnabled);
+	ANKI_ASSERT(lightUuid > 0);
+
+	HashMapKey key;
+	key.m_lightUuid = lightUuid;
+	key.m_face = lightFace;
+
+	auto it = m_lightInfoToTileIdx.find(key);
+	if(it == m_lightInfoToTileIdx.getEnd())
+	{
+		return false;
+	}
+
+	Tile& tile = m_allTiles[*it];
+	if(tile.m_lightUuid != lightUuid || tile.m_lightFace != lightFace)
+	{
+		// Stale cache entry
+		return false;
+	}
+
+	const Bool prev = tile.m_hasUncachedContent;
+	tile.m_hasUncachedContent = hasUncachedContent;
+	return prev;
+}
+
 } // end namespace anki
@@ -42,6 +42,11 @@ public:
 	/// Remove an light from the cache.
 	void invalidateCache(U64 lightUuid, U32 lightFace);
 
+	/// Set if the tile of a light holds content that is not covered by the cache. For example dynamic shadow casters
+	/// that were rendered on top of the cached ones. A new allocation of the tile clears it.
+	/// @return The previous value.
+	Bool exchangeUncachedContent(U64 lightUuid, U32 lightFace, Bool hasUncachedContent);
+
 private:
 	class Tile;
 
@@ -8,10 +8,113 @@
 #include <anki/resource/MeshLoader.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/util/Xml.h>
+#include <anki/util/File.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/Hash.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
 
+/// The header of the files that hold cached triangle mesh BVHs.
+class CollisionBvhCacheHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U64 m_hash; ///< Hash of the triangles.
+	U64 m_bvhHash; ///< Hash of the BVH that follows. To catch corrupted files.
+	U32 m_version; ///< BVH_CACHE_VERSION.
+	U32 m_bulletVersion;
+	U32 m_pointerSize; ///< Bullet stores pointers in the BVH.
+	U32 m_bvhSize;
+};
+
+static const Array<U8, 8> BVH_CACHE_MAGIC = {{'A', 'N', 'K', 'I', 'B', 'V', 'H', '_'}};
+static const U32 BVH_CACHE_VERSION = 2;
+
+/// Read a BVH from the cache. Leave the output empty on failure.
+static void readCachedBvh(CString filename, U64 hash, DynamicArrayAuto<U8>& bvh)
+{
+	if(!fileExists(filename))
+	{
+		return;
+	}
+
+	File file;
+	CollisionBvhCacheHeader header;
+	if(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY) || file.getSize() < sizeof(header)
+		|| file.read(&header, sizeof(header)))
+	{
+		ANKI_RESOURCE_LOGW("Ignoring unreadable BVH cache file: %s", filename.cstr());
+		return;
+	}
+
+	if(memcmp(&header.m_magic[0], &BVH_CACHE_MAGIC[0], sizeof(BVH_CACHE_MAGIC)) != 0
+		|| header.m_version != BVH_CACHE_VERSION || header.m_bulletVersion != BT_BULLET_VERSION
+		|| header.m_pointerSize != sizeof(void*) || header.m_hash != hash || header.m_bvhSize == 0
+		|| file.getSize() != sizeof(header) + header.m_bvhSize)
+	{
+		ANKI_RESOURCE_LOGW("Ignoring stale or corrupted BVH cache file: %s", filename.cstr());
+		return;
+	}
+
+	bvh.create(header.m_bvhSize);
+	if(file.read(&bvh[0], header.m_bvhSize) || computeHash(&bvh[0], bvh.getSize()) != header.m_bvhHash)
+	{
+		ANKI_RESOURCE_LOGW("Ignoring corrupted BVH cache file: %s", filename.cstr());
+		bvh.destroy();
+	}
+}
+
+/// Write a BVH to the cache. It writes to a temporary file first and then renames it so a reader never sees a
+/// partially written file.
+static ANKI_USE_RESULT Error writeCachedBvh(
+	CString filename, U64 hash, ConstWeakArray<U8> bvh, TempResourceAllocator<U8> alloc)
+{
+	CollisionBvhCacheHeader header;
+	zeroMemory(header);
+	header.m_magic = BVH_CACHE_MAGIC;
+	header.m_hash = hash;
+	header.m_bvhHash = computeHash(&bvh[0], bvh.getSize());
+	header.m_version = BVH_CACHE_VERSION;
+	header.m_bulletVersion = BT_BULLET_VERSION;
+	header.m_pointerSize = sizeof(void*);
+	header.m_bvhSize = U32(bvh.getSize());
+
+	// Other threads might be loading the same mesh so make the name unique
+	StringAuto tmpFilename(alloc);
+	tmpFilename.sprintf("%s.%" PRIx64 ".tmp", filename.cstr(), Thread::getCurrentThreadId());
+
+	Error err = Error::NONE;
+	{
+		File file;
+		err = file.open(tmpFilename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY);
+		if(!err)
+		{
+			err = file.write(&header, sizeof(header));
+		}
+
+		if(!err)
+		{
+			err = file.write(&bvh[0], bvh.getSize());
+		}
+	}
+
+	if(!err)
+	{
+		err = renameFile(tmpFilename.toCString(), filename);
+	}
+
+	// Don't leave the temporary file behind if something failed
+	if(err && fileExists(tmpFilename.toCString()))
+	{
+		const Error removeErr = removeFile(tmpFilename.toCString());
+		(void)removeErr;
+	}
+
+	return err;
+}
+
 Error CollisionResource::load(const ResourceFilename& filename, Bool async)
 {
 	XmlElement el;
@@ -56,7 +159,35 @@ Error CollisionResource::load(const ResourceFilename& filename, Bool async)
 
 		const Bool convex = !!(loader.getHeader().m_flags & MeshBinaryFile::Flag::CONVEX);
 
-		m_physicsShape = physics.newInstance<PhysicsTriangleSoup>(positions, indices, convex);
+		if(convex)
+		{
+			m_physicsShape = physics.newInstance<PhysicsTriangleSoup>(positions, indices, convex);
+		}
+		else
+		{
+			// Building the BVH is expensive. Try to load it from the cache that is keyed by the triangles
+			const U64 hash = computeHash(
+				&indices[0], indices.getSizeInBytes(), computeHash(&positions[0], positions.getSizeInBytes()));
+
+			StringAuto cacheFilename(getTempAllocator());
+			cacheFilename.sprintf("%s/%016" PRIx64 ".bvh", getManager().getCacheDirectory().cstr(), hash);
+
+			DynamicArrayAuto<U8> bvh(getTempAllocator());
+			readCachedBvh(cacheFilename.toCString(), hash, bvh);
+
+			PhysicsPtr<PhysicsTriangleSoup> soup =
+				physics.newInstance<PhysicsTriangleSoup>(positions, indices, convex, bvh);
+			m_physicsShape = soup;
+
+			if(!soup->isBvhDeserialized())
+			{
+				soup->serializeBvh(bvh);
+				if(writeCachedBvh(cacheFilename.toCString(), hash, bvh, getTempAllocator()))
+				{
+					ANKI_RESOURCE_LOGW("Failed to write the BVH cache file: %s", cacheFilename.cstr());
+				}
+			}
+		}
 	}
 	else
 	{
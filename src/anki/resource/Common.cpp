@@ -14,7 +14,13 @@ namespace anki
 template<typename T>
 void ResourcePtrDeleter<T>::operator()(T* ptr)
 {
-	ptr->getManager().unregisterResource(ptr);
+	ResourceManager& manager = ptr->getManager();
+	{
+		LockGuard<Mutex> lock(manager.m_registryMtx);
+		manager.unregisterResource(ptr);
+	}
+
+	// Delete it outside the lock because the resource will release the resources it references
 	auto alloc = ptr->getAllocator();
 	alloc.deleteInstance(ptr);
 }
@@ -5,7 +5,9 @@
 
 #include <anki/resource/MaterialResource.h>
 #include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceBinary.h>
 #include <anki/util/Xml.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -30,6 +32,30 @@ static const Array<BuiltinVarInfo, U(BuiltinMaterialVariableId::COUNT) - 1> BUIL
 		{"PREVIOUS_MODEL_VIEW_PROJECTION_MATRIX", ShaderVariableDataType::MAT4, true},
 		{"GLOBAL_SAMPLER", ShaderVariableDataType::SAMPLER, false}}};
 
+static const Array<U8, 8> MATERIAL_BINARY_MAGIC = {{'A', 'N', 'K', 'I', 'M', 'T', 'L', '1'}};
+
+/// The baked materials refer to the mutators and the inputs of the program by index. They are valid as long as the
+/// hash of the program's interface doesn't change.
+static U64 computeProgramInterfaceHash(const ShaderProgramResource& prog)
+{
+	U64 hash = 1;
+
+	for(const ShaderProgramResourceMutator& mutator : prog.getMutators())
+	{
+		hash = appendHash(mutator.getName().cstr(), mutator.getName().getLength(), hash);
+		hash = appendHash(&mutator.getValues()[0], mutator.getValues().getSizeInBytes(), hash);
+	}
+
+	for(const ShaderProgramResourceInputVariable& in : prog.getInputVariables())
+	{
+		const Array<U32, 3> info = {{U32(in.getShaderVariableDataType()), in.isConstant(), in.isInstanced()}};
+		hash = appendHash(in.getName().cstr(), in.getName().getLength(), hash);
+		hash = appendHash(&info[0], sizeof(info), hash);
+	}
+
+	return hash;
+}
+
 MaterialVariable::MaterialVariable()
 {
 	m_mat4 = Mat4::getZero();
@@ -53,10 +79,105 @@ MaterialResource::~MaterialResource()
 
 Error MaterialResource::load(const ResourceFilename& filename, Bool async)
 {
+	StringAuto xmlText(getTempAllocator());
+	ANKI_CHECK(openFileReadAllText(filename, xmlText));
+
+	// Try the baked form first
+	const Bool bake = getManager().getBakeXmlResources();
+	StringAuto bakedFilename(getTempAllocator());
+	if(bake)
+	{
+		computeBakedFilename(xmlText.toCString(), "ankimtlbin", bakedFilename);
+
+		MaterialBinary* bakedBin;
+		readBakedResource(bakedFilename.toCString(), MATERIAL_BINARY_MAGIC, bakedBin);
+		if(bakedBin)
+		{
+			Bool stale;
+			const Error err = loadBinary(*bakedBin, async, stale);
+			freeBakedResource(bakedBin);
+
+			if(err)
+			{
+				ANKI_RESOURCE_LOGW("Failed to load the baked material, will re-bake it: %s", filename.cstr());
+				removeBakedResource(bakedFilename.toCString());
+				resetBinary();
+			}
+			else if(!stale)
+			{
+				appendDependencyContentHashes();
+				return Error::NONE;
+			}
+			else
+			{
+				ANKI_RESOURCE_LOGI("The shader program changed, will re-bake the material: %s", filename.cstr());
+			}
+		}
+	}
+
+	// Parse the XML
 	XmlDocument doc;
+	ANKI_CHECK(doc.parse(xmlText.toCString(), getTempAllocator()));
+
+	MaterialBinary bin;
+	DynamicArrayAuto<MaterialBinaryMutation> mutations(getTempAllocator());
+	DynamicArrayAuto<MaterialBinaryInput> inputs(getTempAllocator());
+	ANKI_CHECK(parseXml(doc, async, bin, mutations, inputs));
+
+	Bool stale;
+	ANKI_CHECK(loadBinary(bin, async, stale));
+	ANKI_ASSERT(!stale);
+
+	// Bake it for the next time
+	if(bake && writeBakedResource(bakedFilename.toCString(), bin))
+	{
+		ANKI_RESOURCE_LOGW("Failed to write the baked material: %s", bakedFilename.cstr());
+	}
+
+	appendDependencyContentHashes();
+	return Error::NONE;
+}
+
+void MaterialResource::appendDependencyContentHashes()
+{
+	appendContentHash(m_prog->getContentHash());
+
+	for(const MaterialVariable& var : m_vars)
+	{
+		if(var.m_tex.isCreated())
+		{
+			appendContentHash(var.m_tex->getContentHash());
+		}
+	}
+}
+
+Error MaterialResource::loadProgram(CString fname, Bool async)
+{
+	// A stale baked material already loaded a program. Re-use it if it's the same one
+	if(m_prog.isCreated() && m_prog->getFilename() != fname)
+	{
+		m_prog.reset(nullptr);
+	}
+
+	if(!m_prog.isCreated())
+	{
+		ANKI_CHECK(getManager().loadResource(fname, m_prog, async));
+	}
+
+	return Error::NONE;
+}
+
+Error MaterialResource::parseXml(const XmlDocument& doc,
+	Bool async,
+	MaterialBinary& bin,
+	DynamicArrayAuto<MaterialBinaryMutation>& mutations,
+	DynamicArrayAuto<MaterialBinaryInput>& inputs)
+{
+	zeroMemory(bin);
+	bin.m_magic = MATERIAL_BINARY_MAGIC;
+
 	XmlElement el;
 	Bool present = false;
-	ANKI_CHECK(openFileParseXml(filename, doc));
 
 	// <material>
 	XmlElement rootEl;
@@ -65,50 +186,48 @@ Error MaterialResource::load(const ResourceFilename& filename, Bool async)
 	// shaderProgram
 	CString fname;
 	ANKI_CHECK(rootEl.getAttributeText("shaderProgram", fname));
-	ANKI_CHECK(getManager().loadResource(fname, m_prog, async));
-	m_descriptorSetIdx = U8(m_prog->getDescriptorSetIndex());
+	ANKI_CHECK(loadProgram(fname, async));
+	bin.m_shaderProgram = toBakedString(fname);
+	bin.m_programInterfaceHash = computeProgramInterfaceHash(*m_prog);
 
 	// shadow
-	ANKI_CHECK(rootEl.getAttributeNumberOptional("shadow", m_shadow, present));
-	m_shadow = m_shadow != 0;
+	bin.m_shadow = true;
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("shadow", bin.m_shadow, present));
+	bin.m_shadow = bin.m_shadow != 0;
 
 	// forwardShading
-	ANKI_CHECK(rootEl.getAttributeNumberOptional("forwardShading", m_forwardShading, present));
-	m_forwardShading = m_forwardShading != 0;
+	bin.m_forwardShading = false;
+	ANKI_CHECK(rootEl.getAttributeNumberOptional("forwardShading", bin.m_forwardShading, present));
+	bin.m_forwardShading = bin.m_forwardShading != 0;
 
 	// <mutators>
 	XmlElement mutatorsEl;
 	ANKI_CHECK(rootEl.getChildElementOptional("mutators", mutatorsEl));
 	if(mutatorsEl)
 	{
-		ANKI_CHECK(parseMutators(mutatorsEl));
+		ANKI_CHECK(parseMutators(mutatorsEl, mutations));
+		bin.m_mutations = WeakArray<MaterialBinaryMutation>(mutations);
 	}
 
 	// <inputs>
 	ANKI_CHECK(rootEl.getChildElementOptional("inputs", el));
 	if(el)
 	{
-		ANKI_CHECK(parseInputs(el, async));
+		ANKI_CHECK(parseInputs(el, inputs));
+		bin.m_inputs = WeakArray<MaterialBinaryInput>(inputs);
 	}
 
 	return Error::NONE;
 }
 
-Error MaterialResource::parseMutators(XmlElement mutatorsEl)
+Error MaterialResource::parseMutators(XmlElement mutatorsEl, DynamicArrayAuto<MaterialBinaryMutation>& mutations)
 {
 	XmlElement mutatorEl;
 	ANKI_CHECK(mutatorsEl.getChildElement("mutator", mutatorEl));
 
-	U32 mutatorCount = 0;
-	ANKI_CHECK(mutatorEl.getSiblingElementsCount(mutatorCount));
-	++mutatorCount;
-	ANKI_ASSERT(mutatorCount > 0);
-	m_mutations.create(getAllocator(), mutatorCount);
-	mutatorCount = 0;
-
 	do
 	{
-		ShaderProgramResourceMutation& mutation = m_mutations[mutatorCount];
+		MaterialBinaryMutation& mutation = *mutations.emplaceBack();
 
 		// name
 		CString mutatorName;
@@ -130,24 +249,228 @@ Error MaterialResource::parseMutators(XmlElement mutatorsEl)
 		ANKI_CHECK(mutatorEl.getAttributeNumber("value", mutation.m_value));
 
 		// Find mutator
-		mutation.m_mutator = m_prog->tryFindMutator(mutatorName);
-
-		if(!mutation.m_mutator)
+		const ShaderProgramResourceMutator* mutator = m_prog->tryFindMutator(mutatorName);
+		if(!mutator)
 		{
 			ANKI_RESOURCE_LOGE("Mutator not found in program %s", &mutatorName[0]);
 			return Error::USER_DATA;
 		}
 
-		if(!mutation.m_mutator->valueExists(mutation.m_value))
+		mutation.m_mutatorIndex = U32(mutator - &m_prog->getMutators()[0]);
+
+		// Advance
+		ANKI_CHECK(mutatorEl.getNextSiblingElement("mutator", mutatorEl));
+	} while(mutatorEl);
+
+	return Error::NONE;
+}
+
+Error MaterialResource::parseInputs(XmlElement inputsEl, DynamicArrayAuto<MaterialBinaryInput>& inputs)
+{
+	XmlElement inputEl;
+	ANKI_CHECK(inputsEl.getChildElementOptional("input", inputEl));
+	while(inputEl)
+	{
+		MaterialBinaryInput& in = *inputs.emplaceBack();
+		zeroMemory(in);
+
+		// Get var name
+		CString varName;
+		ANKI_CHECK(inputEl.getAttributeText("shaderInput", varName));
+
+		// Try find var
+		const ShaderProgramResourceInputVariable* foundVar = m_prog->tryFindInputVariable(varName);
+		if(foundVar == nullptr)
 		{
-			ANKI_RESOURCE_LOGE("Value %d is not part of the mutator %s", mutation.m_value, &mutatorName[0]);
+			ANKI_RESOURCE_LOGE("Variable \"%s\" not found", &varName[0]);
 			return Error::USER_DATA;
 		}
 
+		in.m_inputVariableIndex = U32(foundVar - &m_prog->getInputVariables()[0]);
+
+		// Builtin or not
+		Bool builtinPresent = false;
+		CString builtinStr;
+		if(!foundVar->isConstant())
+		{
+			ANKI_CHECK(inputEl.getAttributeTextOptional("builtin", builtinStr, builtinPresent));
+		}
+
+		if(builtinPresent)
+		{
+			U32 i;
+			for(i = 0; i < BUILTIN_INFOS.getSize(); ++i)
+			{
+				if(builtinStr == BUILTIN_INFOS[i].m_name)
+				{
+					break;
+				}
+			}
+
+			if(i == BUILTIN_INFOS.getSize())
+			{
+				ANKI_RESOURCE_LOGE("Incorrect builtin variable: %s", &builtinStr[0]);
+				return Error::USER_DATA;
+			}
+
+			in.m_builtin = i + 1;
+		}
+		else
+		{
+			ANKI_CHECK(parseInputValue(inputEl, foundVar->getShaderVariableDataType(), in));
+		}
+
 		// Advance
-		++mutatorCount;
-		ANKI_CHECK(mutatorEl.getNextSiblingElement("mutator", mutatorEl));
-	} while(mutatorEl);
+		ANKI_CHECK(inputEl.getNextSiblingElement("input", inputEl));
+	}
+
+	return Error::NONE;
+}
+
+Error MaterialResource::parseInputValue(XmlElement inputEl, ShaderVariableDataType type, MaterialBinaryInput& in)
+{
+	// Use the union of the MaterialVariable as a scratch
+	MaterialVariable val;
+	static_assert(sizeof(val.m_mat4) == sizeof(in.m_value), "The binary should be able to hold all values");
+
+	switch(type)
+	{
+	case ShaderVariableDataType::INT:
+		ANKI_CHECK(inputEl.getAttributeNumber("value", val.m_int));
+		break;
+	case ShaderVariableDataType::IVEC2:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_ivec2));
+		break;
+	case ShaderVariableDataType::IVEC3:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_ivec3));
+		break;
+	case ShaderVariableDataType::IVEC4:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_ivec4));
+		break;
+	case ShaderVariableDataType::UINT:
+		ANKI_CHECK(inputEl.getAttributeNumber("value", val.m_uint));
+		break;
+	case ShaderVariableDataType::UVEC2:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_uvec2));
+		break;
+	case ShaderVariableDataType::UVEC3:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_uvec3));
+		break;
+	case ShaderVariableDataType::UVEC4:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_uvec4));
+		break;
+	case ShaderVariableDataType::FLOAT:
+		ANKI_CHECK(inputEl.getAttributeNumber("value", val.m_float));
+		break;
+	case ShaderVariableDataType::VEC2:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_vec2));
+		break;
+	case ShaderVariableDataType::VEC3:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_vec3));
+		break;
+	case ShaderVariableDataType::VEC4:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_vec4));
+		break;
+	case ShaderVariableDataType::MAT3:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_mat3));
+		break;
+	case ShaderVariableDataType::MAT4:
+		ANKI_CHECK(inputEl.getAttributeNumbers("value", val.m_mat4));
+		break;
+	case ShaderVariableDataType::TEXTURE_2D:
+	case ShaderVariableDataType::TEXTURE_2D_ARRAY:
+	case ShaderVariableDataType::TEXTURE_3D:
+	case ShaderVariableDataType::TEXTURE_CUBE:
+	{
+		CString texfname;
+		ANKI_CHECK(inputEl.getAttributeText("value", texfname));
+		in.m_texture = toBakedString(texfname);
+		break;
+	}
+
+	default:
+		ANKI_ASSERT(0);
+		break;
+	}
+
+	memcpy(&in.m_value[0], &val.m_mat4, sizeof(in.m_value));
+
+	return Error::NONE;
+}
+
+Error MaterialResource::loadBinary(const MaterialBinary& bin, Bool async, Bool& stale)
+{
+	stale = false;
+
+	// shaderProgram
+	if(!isValidBakedString(bin.m_shaderProgram))
+	{
+		ANKI_RESOURCE_LOGE("Corrupted baked material");
+		return Error::USER_DATA;
+	}
+
+	ANKI_CHECK(loadProgram(CString(&bin.m_shaderProgram[0]), async));
+	if(computeProgramInterfaceHash(*m_prog) != bin.m_programInterfaceHash)
+	{
+		stale = true;
+		return Error::NONE;
+	}
+
+	m_descriptorSetIdx = U8(m_prog->getDescriptorSetIndex());
+	m_shadow = bin.m_shadow;
+	m_forwardShading = bin.m_forwardShading;
+
+	if(bin.m_mutations.getSize())
+	{
+		ANKI_CHECK(initMutators(bin.m_mutations));
+	}
+
+	ANKI_CHECK(initInputs(bin.m_inputs, async));
+
+	return Error::NONE;
+}
+
+void MaterialResource::resetBinary()
+{
+	m_vars.destroy(getAllocator());
+	m_constValues.destroy(getAllocator());
+	m_mutations.destroy(getAllocator());
+
+	m_lodMutator = nullptr;
+	m_passMutator = nullptr;
+	m_instanceMutator = nullptr;
+	m_bonesMutator = nullptr;
+	m_velocityMutator = nullptr;
+	m_lodCount = 1;
+}
+
+Error MaterialResource::initMutators(ConstWeakArray<MaterialBinaryMutation> binMutations)
+{
+	ANKI_ASSERT(binMutations.getSize() > 0);
+	m_mutations.create(getAllocator(), binMutations.getSize());
+
+	for(U32 i = 0; i < binMutations.getSize(); ++i)
+	{
+		const MaterialBinaryMutation& binMutation = binMutations[i];
+		ShaderProgramResourceMutation& mutation = m_mutations[i];
+
+		if(binMutation.m_mutatorIndex >= m_prog->getMutators().getSize())
+		{
+			ANKI_RESOURCE_LOGE("Corrupted baked material");
+			return Error::USER_DATA;
+		}
+
+		mutation.m_mutator = &m_prog->getMutators()[binMutation.m_mutatorIndex];
+		mutation.m_value = binMutation.m_value;
+
+		if(!mutation.m_mutator->valueExists(mutation.m_value))
+		{
+			ANKI_RESOURCE_LOGE("Value %d is not part of the mutator %s",
+				mutation.m_value,
+				mutation.m_mutator->getName().cstr());
+			return Error::USER_DATA;
+		}
+	}
 
 	// Find the builtin mutators
 	U builtinMutatorCount = 0;
@@ -279,7 +602,7 @@ Error MaterialResource::parseMutators(XmlElement mutatorsEl)
 	return Error::NONE;
 }
 
-Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
+Error MaterialResource::initInputs(ConstWeakArray<MaterialBinaryInput> binInputs, Bool async)
 {
 	// Iterate the program's variables and get counts
 	U32 constInputCount = 0;
@@ -306,25 +629,25 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 	m_constValues.create(getAllocator(), constInputCount);
 
 	// Connect the input variables
-	XmlElement inputEl;
-	ANKI_CHECK(inputsEl.getChildElementOptional("input", inputEl));
-	while(inputEl)
+	for(const MaterialBinaryInput& in : binInputs)
 	{
-		// Get var name
-		CString varName;
-		ANKI_CHECK(inputEl.getAttributeText("shaderInput", varName));
-
-		// Try find var
-		const ShaderProgramResourceInputVariable* foundVar = m_prog->tryFindInputVariable(varName);
-		if(foundVar == nullptr)
+		if(in.m_inputVariableIndex >= m_prog->getInputVariables().getSize())
 		{
-			ANKI_RESOURCE_LOGE("Variable \"%s\" not found", &varName[0]);
+			ANKI_RESOURCE_LOGE("Corrupted baked material");
 			return Error::USER_DATA;
 		}
 
+		const ShaderProgramResourceInputVariable* foundVar = &m_prog->getInputVariables()[in.m_inputVariableIndex];
+
 		if(!foundVar->acceptAllMutations(m_mutations))
 		{
-			ANKI_RESOURCE_LOGE("Variable \"%s\" is not needed by the material's mutations");
+			ANKI_RESOURCE_LOGE("Variable \"%s\" is not needed by the material's mutations", &foundVar->getName()[0]);
+			return Error::USER_DATA;
+		}
+
+		if((foundVar->isConstant() && constInputCount == 0) || (!foundVar->isConstant() && nonConstInputCount == 0))
+		{
+			ANKI_RESOURCE_LOGE("Variable \"%s\" is listed more than once", &foundVar->getName()[0]);
 			return Error::USER_DATA;
 		}
 
@@ -335,171 +658,68 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 
 			ShaderProgramResourceConstantValue& constVal = m_constValues[--constInputCount];
 			constVal.m_variable = foundVar;
+			memcpy(&constVal.m_ivec4, &in.m_value[0], sizeof(constVal.m_ivec4));
+		}
+		else if(in.m_builtin != U32(BuiltinMaterialVariableId::NONE))
+		{
+			// Builtin
 
-			switch(foundVar->getShaderVariableDataType())
+			const U32 i = in.m_builtin - 1;
+			if(i >= BUILTIN_INFOS.getSize())
 			{
-			case ShaderVariableDataType::INT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", constVal.m_int));
-				break;
-			case ShaderVariableDataType::IVEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_ivec2));
-				break;
-			case ShaderVariableDataType::IVEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_ivec3));
-				break;
-			case ShaderVariableDataType::IVEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_ivec4));
-				break;
-			case ShaderVariableDataType::UINT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", constVal.m_uint));
-				break;
-			case ShaderVariableDataType::UVEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_uvec2));
-				break;
-			case ShaderVariableDataType::UVEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_uvec3));
-				break;
-			case ShaderVariableDataType::UVEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_uvec4));
-				break;
-			case ShaderVariableDataType::FLOAT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", constVal.m_float));
-				break;
-			case ShaderVariableDataType::VEC2:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_vec2));
-				break;
-			case ShaderVariableDataType::VEC3:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_vec3));
-				break;
-			case ShaderVariableDataType::VEC4:
-				ANKI_CHECK(inputEl.getAttributeNumbers("value", constVal.m_vec4));
-				break;
-			default:
-				ANKI_ASSERT(0);
-				break;
+				ANKI_RESOURCE_LOGE("Corrupted baked material");
+				return Error::USER_DATA;
 			}
-		}
-		else
-		{
-			// Builtin or not
 
-			Bool builtinPresent = false;
-			CString builtinStr;
-			ANKI_CHECK(inputEl.getAttributeTextOptional("builtin", builtinStr, builtinPresent));
-			if(builtinPresent)
+			if(BUILTIN_INFOS[i].m_type != foundVar->getShaderVariableDataType())
 			{
-				// Builtin
+				ANKI_RESOURCE_LOGE("The type of the builtin variable in the shader program is not the correct one: %s",
+					BUILTIN_INFOS[i].m_name);
+				return Error::USER_DATA;
+			}
 
-				U i;
-				for(i = 0; i < BUILTIN_INFOS.getSize(); ++i)
-				{
-					if(builtinStr == BUILTIN_INFOS[i].m_name)
-					{
-						break;
-					}
-				}
+			if(foundVar->isInstanced() && !BUILTIN_INFOS[i].m_instanced)
+			{
+				ANKI_RESOURCE_LOGE("Builtin variable %s cannot be instanced", BUILTIN_INFOS[i].m_name);
+				return Error::USER_DATA;
+			}
 
-				if(i == BUILTIN_INFOS.getSize())
-				{
-					ANKI_RESOURCE_LOGE("Incorrect builtin variable: %s", &builtinStr[0]);
-					return Error::USER_DATA;
-				}
+			MaterialVariable& mtlVar = m_vars[--nonConstInputCount];
+			mtlVar.m_input = foundVar;
+			mtlVar.m_builtin = BuiltinMaterialVariableId(in.m_builtin);
+		}
+		else
+		{
+			// Not built-in
 
-				if(BUILTIN_INFOS[i].m_type != foundVar->getShaderVariableDataType())
-				{
-					ANKI_RESOURCE_LOGE(
-						"The type of the builtin variable in the shader program is not the correct one: %s",
-						&builtinStr[0]);
-					return Error::USER_DATA;
-				}
+			if(foundVar->isInstanced())
+			{
+				ANKI_RESOURCE_LOGE("Only some builtin variables can be instanced: %s", &foundVar->getName()[0]);
+				return Error::USER_DATA;
+			}
 
-				if(foundVar->isInstanced() && !BUILTIN_INFOS[i].m_instanced)
-				{
-					ANKI_RESOURCE_LOGE("Builtin variable %s cannot be instanced", BUILTIN_INFOS[i].m_name);
-					return Error::USER_DATA;
-				}
+			MaterialVariable& mtlVar = m_vars[--nonConstInputCount];
+			mtlVar.m_input = foundVar;
 
-				MaterialVariable& mtlVar = m_vars[--nonConstInputCount];
-				mtlVar.m_input = foundVar;
-				mtlVar.m_builtin = BuiltinMaterialVariableId(i + 1);
-			}
-			else
+			switch(foundVar->getShaderVariableDataType())
 			{
-				// Not built-in
-
-				if(foundVar->isInstanced())
+			case ShaderVariableDataType::TEXTURE_2D:
+			case ShaderVariableDataType::TEXTURE_2D_ARRAY:
+			case ShaderVariableDataType::TEXTURE_3D:
+			case ShaderVariableDataType::TEXTURE_CUBE:
+				if(!isValidBakedString(in.m_texture))
 				{
-					ANKI_RESOURCE_LOGE("Only some builtin variables can be instanced: %s", &foundVar->getName()[0]);
+					ANKI_RESOURCE_LOGE("Corrupted baked material");
 					return Error::USER_DATA;
 				}
 
-				MaterialVariable& mtlVar = m_vars[--nonConstInputCount];
-				mtlVar.m_input = foundVar;
-
-				switch(foundVar->getShaderVariableDataType())
-				{
-				case ShaderVariableDataType::INT:
-					ANKI_CHECK(inputEl.getAttributeNumber("value", mtlVar.m_int));
-					break;
-				case ShaderVariableDataType::IVEC2:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_ivec2));
-					break;
-				case ShaderVariableDataType::IVEC3:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_ivec3));
-					break;
-				case ShaderVariableDataType::IVEC4:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_ivec4));
-					break;
-				case ShaderVariableDataType::UINT:
-					ANKI_CHECK(inputEl.getAttributeNumber("value", mtlVar.m_uint));
-					break;
-				case ShaderVariableDataType::UVEC2:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_uvec2));
-					break;
-				case ShaderVariableDataType::UVEC3:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_uvec3));
-					break;
-				case ShaderVariableDataType::UVEC4:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_uvec4));
-					break;
-				case ShaderVariableDataType::FLOAT:
-					ANKI_CHECK(inputEl.getAttributeNumber("value", mtlVar.m_float));
-					break;
-				case ShaderVariableDataType::VEC2:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_vec2));
-					break;
-				case ShaderVariableDataType::VEC3:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_vec3));
-					break;
-				case ShaderVariableDataType::VEC4:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_vec4));
-					break;
-				case ShaderVariableDataType::MAT3:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_mat3));
-					break;
-				case ShaderVariableDataType::MAT4:
-					ANKI_CHECK(inputEl.getAttributeNumbers("value", mtlVar.m_mat4));
-					break;
-				case ShaderVariableDataType::TEXTURE_2D:
-				case ShaderVariableDataType::TEXTURE_2D_ARRAY:
-				case ShaderVariableDataType::TEXTURE_3D:
-				case ShaderVariableDataType::TEXTURE_CUBE:
-				{
-					CString texfname;
-					ANKI_CHECK(inputEl.getAttributeText("value", texfname));
-					ANKI_CHECK(getManager().loadResource(texfname, mtlVar.m_tex, async));
-					break;
-				}
-
-				default:
-					ANKI_ASSERT(0);
-					break;
-				}
+				ANKI_CHECK(getManager().loadResource(CString(&in.m_texture[0]), mtlVar.m_tex, async));
+				break;
+			default:
+				memcpy(&mtlVar.m_mat4, &in.m_value[0], sizeof(mtlVar.m_mat4));
+				break;
 			}
 		}
-
-		// Advance
-		ANKI_CHECK(inputEl.getNextSiblingElement("input", inputEl));
 	}
 
 	if(nonConstInputCount != 0)
@@ -18,6 +18,10 @@ namespace anki
 
 // Forward
 class XmlElement;
+class XmlDocument;
+class MaterialBinary;
+class MaterialBinaryMutation;
+class MaterialBinaryInput;
 class MaterialResource;
 template<typename T>
 class MaterialVariableTemplate;
@@ -285,10 +289,37 @@ private:
 
 	static U32 getInstanceGroupIdx(U32 instanceCount);
 
+	/// Load the shader program or re-use the one that is already loaded if it has the same name.
+	ANKI_USE_RESULT Error loadProgram(CString fname, Bool async);
+
+	/// Parse the XML into its baked form.
+	ANKI_USE_RESULT Error parseXml(const XmlDocument& doc,
+		Bool async,
+		MaterialBinary& bin,
+		DynamicArrayAuto<MaterialBinaryMutation>& mutations,
+		DynamicArrayAuto<MaterialBinaryInput>& inputs);
+
 	/// Parse whatever is inside the <inputs> tag.
-	ANKI_USE_RESULT Error parseInputs(XmlElement inputsEl, Bool async);
+	ANKI_USE_RESULT Error parseInputs(XmlElement inputsEl, DynamicArrayAuto<MaterialBinaryInput>& inputs);
+
+	ANKI_USE_RESULT Error parseMutators(XmlElement mutatorsEl, DynamicArrayAuto<MaterialBinaryMutation>& mutations);
+
+	static ANKI_USE_RESULT Error parseInputValue(
+		XmlElement inputEl, ShaderVariableDataType type, MaterialBinaryInput& in);
+
+	/// Initialize the material from its baked form.
+	/// @param[out] stale True if the baked material doesn't match the shader program.
+	ANKI_USE_RESULT Error loadBinary(const MaterialBinary& bin, Bool async, Bool& stale);
+
+	/// Undo a loadBinary() that failed half way.
+	void resetBinary();
+
+	/// Fold the content hashes of the program and the textures.
+	void appendDependencyContentHashes();
+
+	ANKI_USE_RESULT Error initMutators(ConstWeakArray<MaterialBinaryMutation> binMutations);
 
-	ANKI_USE_RESULT Error parseMutators(XmlElement mutatorsEl);
+	ANKI_USE_RESULT Error initInputs(ConstWeakArray<MaterialBinaryInput> binInputs, Bool async);
 };
 /// @}
 
@@ -18,6 +18,7 @@ MeshLoader::MeshLoader(ResourceManager* manager)
 MeshLoader::~MeshLoader()
 {
 	m_subMeshes.destroy(m_alloc);
+	m_meshlets.destroy(m_alloc);
 }
 
 Error MeshLoader::load(const ResourceFilename& filename)
@@ -65,6 +66,12 @@ Error MeshLoader::load(const ResourceFilename& filename)
 		}
 	}
 
+	// Read the meshlets
+	if(!!(m_header.m_flags & MeshBinaryFile::Flag::MESHLETS))
+	{
+		ANKI_CHECK(loadMeshlets());
+	}
+
 	// Read vert buffer info
 	{
 		U32 vertBufferMask = 0;
@@ -98,6 +105,10 @@ Error MeshLoader::load(const ResourceFilename& filename)
 		U32 totalSize = sizeof(m_header);
 
 		totalSize += sizeof(MeshBinaryFile::SubMesh) * m_header.m_subMeshCount;
+		if(!!(m_header.m_flags & MeshBinaryFile::Flag::MESHLETS))
+		{
+			totalSize += sizeof(U32) + sizeof(MeshBinaryFile::Meshlet) * m_meshlets.getSize();
+		}
 		totalSize += U32(getIndexBufferSize());
 
 		for(U i = 0; i < m_header.m_vertexBufferCount; ++i)
@@ -115,6 +126,80 @@ Error MeshLoader::load(const ResourceFilename& filename)
 	return Error::NONE;
 }
 
+Error MeshLoader::loadMeshlets()
+{
+	U32 meshletCount;
+	ANKI_CHECK(m_file->read(&meshletCount, sizeof(meshletCount)));
+	if(meshletCount == 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong meshlet count");
+		return Error::USER_DATA;
+	}
+
+	m_meshlets.create(m_alloc, meshletCount);
+	ANKI_CHECK(m_file->read(&m_meshlets[0], m_meshlets.getSizeInBytes()));
+
+	// The meshlets should cover all the indices in order and they shouldn't cross sub-mesh boundaries
+	U32 idxSum = 0;
+	U32 subMeshIdx = 0;
+	for(const MeshBinaryFile::Meshlet& meshlet : m_meshlets)
+	{
+		if(meshlet.m_firstIndex != idxSum || meshlet.m_indexCount == 0 || (meshlet.m_indexCount % 3) != 0
+			|| meshlet.m_indexCount / 3 > MeshBinaryFile::MAX_MESHLET_TRIANGLES)
+		{
+			ANKI_RESOURCE_LOGE("Incorrect meshlet info");
+			return Error::USER_DATA;
+		}
+
+		while(subMeshIdx < m_subMeshes.getSize()
+			  && meshlet.m_firstIndex >= m_subMeshes[subMeshIdx].m_firstIndex + m_subMeshes[subMeshIdx].m_indexCount)
+		{
+			++subMeshIdx;
+		}
+
+		if(subMeshIdx == m_subMeshes.getSize()
+			|| meshlet.m_firstIndex + meshlet.m_indexCount
+				   > m_subMeshes[subMeshIdx].m_firstIndex + m_subMeshes[subMeshIdx].m_indexCount)
+		{
+			ANKI_RESOURCE_LOGE("Meshlet crosses sub mesh boundaries");
+			return Error::USER_DATA;
+		}
+
+		// The sphere is centered at the bounding box of the meshlet and the axis of the cone is normalized unless the
+		// cone is not in use
+		const MeshBinaryFile::SubMesh& sm = m_subMeshes[subMeshIdx];
+		Bool wrongBounds = !(meshlet.m_sphereRadius > 0.0f) || !(meshlet.m_coneCutoff >= 0.0f)
+						   || !(meshlet.m_coneCutoff <= 1.0f);
+		for(U32 d = 0; d < 3; ++d)
+		{
+			const F32 margin = max((sm.m_aabbMax[d] - sm.m_aabbMin[d]) * 0.01f, EPSILON);
+			wrongBounds = wrongBounds || !(meshlet.m_sphereCenter[d] >= sm.m_aabbMin[d] - margin)
+						  || !(meshlet.m_sphereCenter[d] <= sm.m_aabbMax[d] + margin);
+		}
+
+		if(meshlet.m_coneCutoff < 1.0f && absolute(meshlet.m_coneAxis.getLengthSquared() - 1.0f) > 0.01f)
+		{
+			wrongBounds = true;
+		}
+
+		if(wrongBounds)
+		{
+			ANKI_RESOURCE_LOGE("Wrong meshlet bounds");
+			return Error::USER_DATA;
+		}
+
+		idxSum += meshlet.m_indexCount;
+	}
+
+	if(idxSum != m_header.m_totalIndexCount)
+	{
+		ANKI_RESOURCE_LOGE("Incorrect meshlet info");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
 Error MeshLoader::checkFormat(VertexAttributeLocation type, ConstWeakArray<Format> supportedFormats) const
 {
 	const MeshBinaryFile::VertexAttribute& attrib = m_header.m_vertexAttributes[type];
@@ -171,6 +256,13 @@ Error MeshLoader::checkHeader() const
 		return Error::USER_DATA;
 	}
 
+	// Meshlets are made of triangles
+	if(!!(h.m_flags & MeshBinaryFile::Flag::MESHLETS) && !!(h.m_flags & MeshBinaryFile::Flag::QUAD))
+	{
+		ANKI_RESOURCE_LOGE("Meshlets can't be combined with quads");
+		return Error::USER_DATA;
+	}
+
 	// Attributes
 	ANKI_CHECK(checkFormat(
 		VertexAttributeLocation::POSITION, Array<Format, 2>{{Format::R16G16B16A16_SFLOAT, Format::R32G32B32_SFLOAT}}));
@@ -18,18 +18,24 @@ namespace anki
 /// @{
 
 /// Information to decode mesh binary files.
+/// The file layout is: Header, SubMesh array, optional meshlet chunk (if Flag::MESHLETS is set), index buffer and then
+/// the vertex buffers. The meshlet chunk is a U32 with the meshlet count followed by an array of Meshlet.
 class MeshBinaryFile
 {
 public:
 	static constexpr const char* MAGIC = "ANKIMES4";
 
+	static constexpr U32 MAX_MESHLET_VERTICES = 64;
+	static constexpr U32 MAX_MESHLET_TRIANGLES = 124;
+
 	enum class Flag : U32
 	{
 		NONE = 0,
 		QUAD = 1 << 0,
 		CONVEX = 1 << 1,
+		MESHLETS = 1 << 2, ///< The file contains the meshlet chunk. Can't be used with QUAD, meshlets are triangles.
 
-		ALL = QUAD | CONVEX,
+		ALL = QUAD | CONVEX | MESHLETS,
 	};
 	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(Flag, friend)
 
@@ -54,6 +60,18 @@ public:
 		Vec3 m_aabbMax; ///< Bounding box max.
 	};
 
+	/// A small cluster of triangles that can be culled on its own. The triangles of a meshlet are a contiguous range of
+	/// the index buffer and that range never crosses sub-mesh boundaries.
+	struct Meshlet
+	{
+		U32 m_firstIndex;
+		U32 m_indexCount;
+		Vec3 m_sphereCenter; ///< Bounding sphere center.
+		F32 m_sphereRadius; ///< Bounding sphere radius.
+		Vec3 m_coneAxis; ///< The average direction of the triangle normals.
+		F32 m_coneCutoff; ///< Sine of the half angle of the normal cone. If it's 1.0 the cone can't be used for culling.
+	};
+
 	struct Header
 	{
 		char m_magic[8]; ///< Magic word.
@@ -116,6 +134,12 @@ public:
 		return ConstWeakArray<MeshBinaryFile::SubMesh>(m_subMeshes);
 	}
 
+	/// Get the meshlets. It will be empty if the file doesn't contain meshlets.
+	ConstWeakArray<MeshBinaryFile::Meshlet> getMeshlets() const
+	{
+		return ConstWeakArray<MeshBinaryFile::Meshlet>(m_meshlets);
+	}
+
 private:
 	ResourceManager* m_manager;
 	GenericMemoryPoolAllocator<U8> m_alloc;
@@ -125,6 +149,7 @@ private:
 	MeshBinaryFile::Header m_header;
 
 	DynamicArray<MeshBinaryFile::SubMesh> m_subMeshes;
+	DynamicArray<MeshBinaryFile::Meshlet> m_meshlets;
 
 	U32 m_loadedChunk = 0; ///< Because the store methods need to be called in sequence.
 
@@ -139,6 +164,7 @@ private:
 	}
 
 	ANKI_USE_RESULT Error checkHeader() const;
+	ANKI_USE_RESULT Error loadMeshlets();
 	ANKI_USE_RESULT Error checkFormat(VertexAttributeLocation type, ConstWeakArray<Format> supportedFormats) const;
 };
 /// @}
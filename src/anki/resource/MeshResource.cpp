@@ -9,6 +9,8 @@
 #include <anki/resource/AsyncLoader.h>
 #include <anki/util/Functions.h>
 #include <anki/util/Xml.h>
+#include <anki/collision/Functions.h>
+#include <anki/collision/Sphere.h>
 
 namespace anki
 {
@@ -51,6 +53,7 @@ MeshResource::MeshResource(ResourceManager* manager)
 MeshResource::~MeshResource()
 {
 	m_subMeshes.destroy(getAllocator());
+	m_meshlets.destroy(getAllocator());
 	m_vertBufferInfos.destroy(getAllocator());
 }
 
@@ -80,6 +83,12 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	// Open file
 	MeshLoader& loader = ctx->m_loader;
 	ANKI_CHECK(loader.load(filename));
+
+	{
+		ResourceFilePtr file;
+		ANKI_CHECK(openFile(filename, file));
+		ANKI_CHECK(appendFileContentHash(*file));
+	}
 	const MeshBinaryFile::Header& header = loader.getHeader();
 
 	// Get submeshes
@@ -92,6 +101,41 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 		const Vec3 obbCenter = (loader.getSubMeshes()[i].m_aabbMax + loader.getSubMeshes()[i].m_aabbMin) / 2.0f;
 		const Vec3 obbExtend = loader.getSubMeshes()[i].m_aabbMax - obbCenter;
 		m_subMeshes[i].m_obb = Obb(obbCenter.xyz0(), Mat3x4::getIdentity(), obbExtend.xyz0());
+
+		m_subMeshes[i].m_firstMeshlet = 0;
+		m_subMeshes[i].m_meshletCount = 0;
+	}
+
+	// Get meshlets. The loader has already checked that they are sorted and they don't cross sub-mesh boundaries
+	if(loader.getMeshlets().getSize() > 0)
+	{
+		m_meshlets.create(getAllocator(), loader.getMeshlets().getSize());
+
+		U32 subMeshIdx = 0;
+		for(U32 i = 0; i < m_meshlets.getSize(); ++i)
+		{
+			const MeshBinaryFile::Meshlet& in = loader.getMeshlets()[i];
+			Meshlet& out = m_meshlets[i];
+
+			out.m_sphereCenter = in.m_sphereCenter.xyz0();
+			out.m_coneAxis = in.m_coneAxis.xyz0();
+			out.m_sphereRadius = in.m_sphereRadius;
+			out.m_coneCutoff = in.m_coneCutoff;
+			out.m_firstIndex = in.m_firstIndex;
+			out.m_indexCount = in.m_indexCount;
+
+			while(in.m_firstIndex >= m_subMeshes[subMeshIdx].m_firstIndex + m_subMeshes[subMeshIdx].m_indexCount)
+			{
+				++subMeshIdx;
+			}
+
+			SubMesh& sm = m_subMeshes[subMeshIdx];
+			if(sm.m_meshletCount == 0)
+			{
+				sm.m_firstMeshlet = i;
+			}
+			++sm.m_meshletCount;
+		}
 	}
 
 	// Index stuff
@@ -148,22 +192,23 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	const Vec3 obbExtend = header.m_aabbMax - obbCenter;
 	m_obb = Obb(obbCenter.xyz0(), Mat3x4::getIdentity(), obbExtend.xyz0());
 
-	// Clear the buffers
-	CommandBufferInitInfo cmdbinit;
-	cmdbinit.m_flags = CommandBufferFlag::SMALL_BATCH;
-	CommandBufferPtr cmdb = getManager().getGrManager().newCommandBuffer(cmdbinit);
+	// Submit the loading task
+	if(async)
+	{
+		// Clear the buffers so they can be used until the upload is done. Do that on the transfer queue as well
+		CommandBufferInitInfo cmdbinit;
+		cmdbinit.m_flags =
+			CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::TRANSFER_QUEUE;
+		CommandBufferPtr cmdb = getManager().getGrManager().newCommandBuffer(cmdbinit);
 
-	cmdb->fillBuffer(m_vertBuff, 0, MAX_PTR_SIZE, 0);
-	cmdb->fillBuffer(m_indexBuff, 0, MAX_PTR_SIZE, 0);
+		cmdb->fillBuffer(m_vertBuff, 0, MAX_PTR_SIZE, 0);
+		cmdb->fillBuffer(m_indexBuff, 0, MAX_PTR_SIZE, 0);
 
-	cmdb->setBufferBarrier(m_vertBuff, BufferUsageBit::FILL, BufferUsageBit::VERTEX, 0, MAX_PTR_SIZE);
-	cmdb->setBufferBarrier(m_indexBuff, BufferUsageBit::FILL, BufferUsageBit::INDEX, 0, MAX_PTR_SIZE);
+		cmdb->setBufferBarrier(m_vertBuff, BufferUsageBit::FILL, BufferUsageBit::VERTEX, 0, MAX_PTR_SIZE);
+		cmdb->setBufferBarrier(m_indexBuff, BufferUsageBit::FILL, BufferUsageBit::INDEX, 0, MAX_PTR_SIZE);
 
-	cmdb->flush();
+		cmdb->flush();
 
-	// Submit the loading task
-	if(async)
-	{
 		getManager().getAsyncLoader().submitTask(task);
 	}
 	else
@@ -174,6 +219,52 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	return Error::NONE;
 }
 
+void MeshResource::cullMeshlets(U32 subMeshId,
+	const Transform& worldTransform,
+	const Vec4& cameraOrigin,
+	ConstWeakArray<Plane> planes,
+	DynamicArrayAuto<U32>& visibleMeshlets) const
+{
+	ANKI_ASSERT(cameraOrigin.w() == 0.0f);
+	const ConstWeakArray<Meshlet> meshlets = getMeshlets(subMeshId);
+
+	for(U32 i = 0; i < meshlets.getSize(); ++i)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		const Sphere sphere = Sphere(meshlet.m_sphereCenter, meshlet.m_sphereRadius).getTransformed(worldTransform);
+
+		// Frustum test
+		Bool inside = true;
+		for(const Plane& plane : planes)
+		{
+			if(testPlane(plane, sphere) < 0.0f)
+			{
+				inside = false;
+				break;
+			}
+		}
+
+		if(!inside)
+		{
+			continue;
+		}
+
+		// Cone test. If all the normals of the meshlet point away from the camera then it's back-facing
+		if(meshlet.m_coneCutoff < 1.0f)
+		{
+			const Vec4 axis = (worldTransform.getRotation() * meshlet.m_coneAxis).xyz0();
+			const Vec4 camToCenter = sphere.getCenter() - cameraOrigin;
+
+			if(camToCenter.dot(axis) >= meshlet.m_coneCutoff * camToCenter.getLength() + sphere.getRadius())
+			{
+				continue;
+			}
+		}
+
+		visibleMeshlets.emplaceBack(i);
+	}
+}
+
 Error MeshResource::loadAsync(MeshLoader& loader) const
 {
 	GrManager& gr = getManager().getGrManager();
@@ -181,14 +272,16 @@ Error MeshResource::loadAsync(MeshLoader& loader) const
 	Array<TransferGpuAllocatorHandle, 2> handles;
 
 	CommandBufferInitInfo cmdbinit;
-	cmdbinit.m_flags = CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::TRANSFER_WORK;
+	cmdbinit.m_flags =
+		CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::TRANSFER_QUEUE;
 	CommandBufferPtr cmdb = gr.newCommandBuffer(cmdbinit);
 
-	// Set barriers
+	// Set barriers. The buffers were cleared on this queue. The graphics queue might read the cleared buffers while
+	// they are overwritten but that's fine for placeholders, so don't wait for it
 	cmdb->setBufferBarrier(
-		m_vertBuff, BufferUsageBit::VERTEX, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, 0, MAX_PTR_SIZE);
+		m_vertBuff, BufferUsageBit::FILL, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, 0, MAX_PTR_SIZE);
 	cmdb->setBufferBarrier(
-		m_indexBuff, BufferUsageBit::INDEX, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, 0, MAX_PTR_SIZE);
+		m_indexBuff, BufferUsageBit::FILL, BufferUsageBit::BUFFER_UPLOAD_DESTINATION, 0, MAX_PTR_SIZE);
 
 	// Write index buffer
 	{
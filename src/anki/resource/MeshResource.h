@@ -9,6 +9,8 @@
 #include <anki/Math.h>
 #include <anki/Gr.h>
 #include <anki/collision/Obb.h>
+#include <anki/collision/Plane.h>
+#include <anki/util/WeakArray.h>
 
 namespace anki
 {
@@ -23,6 +25,18 @@ class MeshLoader;
 class MeshResource : public ResourceObject
 {
 public:
+	/// A cluster of triangles of a sub-mesh. See MeshBinaryFile::Meshlet.
+	class Meshlet
+	{
+	public:
+		Vec4 m_sphereCenter; ///< Bounding sphere center. The w is zero.
+		Vec4 m_coneAxis; ///< Normal cone axis. The w is zero.
+		F32 m_sphereRadius;
+		F32 m_coneCutoff;
+		U32 m_firstIndex;
+		U32 m_indexCount;
+	};
+
 	/// Default constructor
 	MeshResource(ResourceManager* manager);
 
@@ -54,6 +68,33 @@ public:
 		return m_subMeshes.getSize();
 	}
 
+	/// Return true if the mesh file contained meshlets.
+	Bool hasMeshlets() const
+	{
+		return m_meshlets.getSize() > 0;
+	}
+
+	/// Get the meshlets of a sub-mesh.
+	ConstWeakArray<Meshlet> getMeshlets(U32 subMeshId) const
+	{
+		const SubMesh& sm = m_subMeshes[subMeshId];
+		return (sm.m_meshletCount) ? ConstWeakArray<Meshlet>(&m_meshlets[sm.m_firstMeshlet], sm.m_meshletCount)
+								   : ConstWeakArray<Meshlet>();
+	}
+
+	/// Cull the meshlets of a sub-mesh against some planes and reject the back-facing ones using the normal cones.
+	/// @param subMeshId The sub-mesh.
+	/// @param worldTransform The world transform of the mesh.
+	/// @param cameraOrigin The origin of the camera in world space.
+	/// @param planes The planes of the frustum in world space.
+	/// @param[out] visibleMeshlets It will be populated with the indices (relative to getMeshlets()) of the visible
+	///                             meshlets.
+	void cullMeshlets(U32 subMeshId,
+		const Transform& worldTransform,
+		const Vec4& cameraOrigin,
+		ConstWeakArray<Plane> planes,
+		DynamicArrayAuto<U32>& visibleMeshlets) const;
+
 	/// Get all info around vertex indices.
 	void getIndexBufferInfo(BufferPtr& buff, PtrSize& buffOffset, U32& indexCount, IndexType& indexType) const
 	{
@@ -116,9 +157,12 @@ protected:
 	{
 		U32 m_firstIndex;
 		U32 m_indexCount;
+		U32 m_firstMeshlet;
+		U32 m_meshletCount;
 		Obb m_obb;
 	};
 	DynamicArray<SubMesh> m_subMeshes;
+	DynamicArray<Meshlet> m_meshlets;
 
 	// Index stuff
 	U32 m_indexCount = 0;
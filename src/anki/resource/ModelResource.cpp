@@ -8,12 +8,15 @@
 #include <anki/resource/MaterialResource.h>
 #include <anki/resource/MeshResource.h>
 #include <anki/resource/MeshLoader.h>
+#include <anki/resource/ResourceBinary.h>
 #include <anki/util/Xml.h>
 #include <anki/util/Logger.h>
 
 namespace anki
 {
 
+static const Array<U8, 8> MODEL_BINARY_MAGIC = {{'A', 'N', 'K', 'I', 'M', 'D', 'L', '1'}};
+
 static Bool attributeIsRequired(VertexAttributeLocation loc, Pass pass, Bool hasSkin)
 {
 	if(pass == Pass::GB || pass == Pass::FS)
@@ -104,6 +107,56 @@ void ModelPatch::getRenderingDataSub(
 	inf.m_indicesCountArray[0] = indexCount;
 }
 
+void ModelPatch::getRenderingDataMeshlets(const RenderingKey& key,
+	const Transform& worldTransform,
+	const Vec4& cameraOrigin,
+	ConstWeakArray<Plane> planes,
+	StackAllocator<U8> alloc,
+	ModelRenderingInfo& inf) const
+{
+	getRenderingDataSub(key, WeakArray<U8>(), inf);
+
+	RenderingKey meshKey = key;
+	meshKey.setLod(min<U32>(key.getLod(), m_meshCount - 1));
+	const MeshResource& mesh = getMesh(meshKey);
+	if(!mesh.hasMeshlets())
+	{
+		return;
+	}
+
+	DynamicArrayAuto<U32> visibleMeshlets(alloc);
+	mesh.cullMeshlets(0, worldTransform, cameraOrigin, planes, visibleMeshlets);
+
+	// The meshlets are sorted and they are contiguous in the index buffer so the neighbours can be drawn at once
+	const ConstWeakArray<MeshResource::Meshlet> meshlets = mesh.getMeshlets(0);
+	const PtrSize indexSize = (inf.m_indexType == IndexType::U32) ? sizeof(U32) : sizeof(U16);
+	inf.m_drawcallCount = 0;
+	for(U32 idx : visibleMeshlets)
+	{
+		const MeshResource::Meshlet& meshlet = meshlets[idx];
+		const PtrSize offset = meshlet.m_firstIndex * indexSize;
+		const U32 last = inf.m_drawcallCount - 1;
+
+		if(inf.m_drawcallCount > 0
+			&& inf.m_indicesOffsetArray[last] + inf.m_indicesCountArray[last] * indexSize == offset)
+		{
+			inf.m_indicesCountArray[last] += meshlet.m_indexCount;
+		}
+		else if(inf.m_drawcallCount < MAX_SUB_DRAWCALLS)
+		{
+			inf.m_indicesOffsetArray[inf.m_drawcallCount] = offset;
+			inf.m_indicesCountArray[inf.m_drawcallCount] = meshlet.m_indexCount;
+			++inf.m_drawcallCount;
+		}
+		else
+		{
+			// Out of drawcalls. Grow the last one, it will draw some of the culled meshlets as well
+			inf.m_indicesCountArray[last] =
+				U32((offset - inf.m_indicesOffsetArray[last]) / indexSize) + meshlet.m_indexCount;
+		}
+	}
+}
+
 U32 ModelPatch::getLodCount() const
 {
 	return max<U32>(m_meshCount, getMaterial()->getLodCount());
@@ -153,13 +206,63 @@ ModelResource::~ModelResource()
 
 Error ModelResource::load(const ResourceFilename& filename, Bool async)
 {
-	auto alloc = getAllocator();
+	StringAuto xmlText(getTempAllocator());
+	ANKI_CHECK(openFileReadAllText(filename, xmlText));
+
+	// Try the baked form first
+	const Bool bake = getManager().getBakeXmlResources();
+	StringAuto bakedFilename(getTempAllocator());
+	if(bake)
+	{
+		computeBakedFilename(xmlText.toCString(), "ankimdlbin", bakedFilename);
+
+		ModelBinary* bakedBin;
+		readBakedResource(bakedFilename.toCString(), MODEL_BINARY_MAGIC, bakedBin);
+		if(bakedBin)
+		{
+			const Error err = loadBinary(*bakedBin, async);
+			freeBakedResource(bakedBin);
+			if(!err)
+			{
+				appendDependencyContentHashes();
+				return Error::NONE;
+			}
+
+			ANKI_RESOURCE_LOGW("Failed to load the baked model, will re-bake it: %s", filename.cstr());
+			removeBakedResource(bakedFilename.toCString());
+			resetBinary();
+		}
+	}
 
-	// Load
-	//
-	XmlElement el;
+	// Parse the XML
 	XmlDocument doc;
-	ANKI_CHECK(openFileParseXml(filename, doc));
+	ANKI_CHECK(doc.parse(xmlText.toCString(), getTempAllocator()));
+
+	ModelBinary bin;
+	DynamicArrayAuto<ModelBinaryPatch> patches(getTempAllocator());
+	DynamicArrayAuto<ResourceBinaryFilename> meshes(getTempAllocator());
+	ANKI_CHECK(parseXml(doc, bin, patches, meshes));
+
+	ANKI_CHECK(loadBinary(bin, async));
+
+	// Bake it for the next time
+	if(bake && writeBakedResource(bakedFilename.toCString(), bin))
+	{
+		ANKI_RESOURCE_LOGW("Failed to write the baked model: %s", bakedFilename.cstr());
+	}
+
+	appendDependencyContentHashes();
+
+	return Error::NONE;
+}
+
+Error ModelResource::parseXml(const XmlDocument& doc,
+	ModelBinary& bin,
+	DynamicArrayAuto<ModelBinaryPatch>& patches,
+	DynamicArrayAuto<ResourceBinaryFilename>& meshes)
+{
+	zeroMemory(bin);
+	bin.m_magic = MODEL_BINARY_MAGIC;
 
 	XmlElement rootEl;
 	ANKI_CHECK(doc.getChildElement("model", rootEl));
@@ -187,16 +290,21 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 		return Error::USER_DATA;
 	}
 
-	m_modelPatches.create(alloc, count);
+	patches.create(count);
+	meshes.create(count * MAX_LOD_COUNT);
 
 	count = 0;
 	ANKI_CHECK(modelPatchesEl.getChildElement("modelPatch", modelPatchEl));
 	do
 	{
+		ModelBinaryPatch& patch = patches[count];
+		zeroMemory(patch);
+
 		XmlElement materialEl;
 		ANKI_CHECK(modelPatchEl.getChildElement("material", materialEl));
 
-		Array<CString, 3> meshesFnames;
+		ResourceBinaryFilename* meshFnames = &meshes[count * MAX_LOD_COUNT];
+		zeroMemory(meshFnames[0]);
 		U32 meshesCount = 1;
 
 		// Get mesh
@@ -209,30 +317,36 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 		XmlElement meshEl2;
 		ANKI_CHECK(modelPatchEl.getChildElementOptional("mesh2", meshEl2));
 
-		ANKI_CHECK(meshEl.getText(meshesFnames[0]));
+		CString cstr;
+		ANKI_CHECK(meshEl.getText(cstr));
+		meshFnames[0].m_filename = toBakedString(cstr);
 
 		if(meshEl1)
 		{
-			++meshesCount;
-			ANKI_CHECK(meshEl1.getText(meshesFnames[1]));
+			ANKI_CHECK(meshEl1.getText(cstr));
+			zeroMemory(meshFnames[meshesCount]);
+			meshFnames[meshesCount++].m_filename = toBakedString(cstr);
 		}
 
 		if(meshEl2)
 		{
-			++meshesCount;
-			ANKI_CHECK(meshEl2.getText(meshesFnames[2]));
+			ANKI_CHECK(meshEl2.getText(cstr));
+			zeroMemory(meshFnames[meshesCount]);
+			meshFnames[meshesCount++].m_filename = toBakedString(cstr);
 		}
 
-		CString cstr;
-		ANKI_CHECK(materialEl.getText(cstr));
+		patch.m_meshes = WeakArray<ResourceBinaryFilename>(meshFnames, meshesCount);
 
-		ANKI_CHECK(m_modelPatches[count].init(
-			this, ConstWeakArray<CString>(&meshesFnames[0], meshesCount), cstr, async, &getManager()));
+		ANKI_CHECK(materialEl.getText(cstr));
+		patch.m_material = toBakedString(cstr);
 
 		// Move to next
+		++count;
 		ANKI_CHECK(modelPatchEl.getNextSiblingElement("modelPatch", modelPatchEl));
 	} while(modelPatchEl);
 
+	bin.m_modelPatches = WeakArray<ModelBinaryPatch>(patches);
+
 	// <skeleton>
 	XmlElement skeletonEl;
 	ANKI_CHECK(rootEl.getChildElementOptional("skeleton", skeletonEl));
@@ -240,7 +354,58 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 	{
 		CString fname;
 		ANKI_CHECK(skeletonEl.getText(fname));
-		ANKI_CHECK(getManager().loadResource(fname, m_skeleton));
+		bin.m_skeleton = toBakedString(fname);
+	}
+
+	return Error::NONE;
+}
+
+Error ModelResource::loadBinary(const ModelBinary& bin, Bool async)
+{
+	if(bin.m_modelPatches.getSize() == 0)
+	{
+		ANKI_RESOURCE_LOGE("Zero number of model patches");
+		return Error::USER_DATA;
+	}
+
+	m_modelPatches.create(getAllocator(), bin.m_modelPatches.getSize());
+
+	for(U32 i = 0; i < bin.m_modelPatches.getSize(); ++i)
+	{
+		const ModelBinaryPatch& patch = bin.m_modelPatches[i];
+
+		Array<CString, MAX_LOD_COUNT> meshesFnames;
+		Bool valid = isValidBakedString(patch.m_material) && patch.m_meshes.getSize() > 0
+					 && patch.m_meshes.getSize() <= MAX_LOD_COUNT;
+		for(U32 j = 0; j < patch.m_meshes.getSize() && valid; ++j)
+		{
+			valid = isValidBakedString(patch.m_meshes[j].m_filename);
+			meshesFnames[j] = (valid) ? CString(&patch.m_meshes[j].m_filename[0]) : CString();
+		}
+
+		if(!valid)
+		{
+			ANKI_RESOURCE_LOGE("Corrupted baked model");
+			return Error::USER_DATA;
+		}
+
+		ANKI_CHECK(m_modelPatches[i].init(this,
+			ConstWeakArray<CString>(&meshesFnames[0], patch.m_meshes.getSize()),
+			CString(&patch.m_material[0]),
+			async,
+			&getManager()));
+	}
+
+	// Skeleton
+	if(bin.m_skeleton.getSize())
+	{
+		if(!isValidBakedString(bin.m_skeleton))
+		{
+			ANKI_RESOURCE_LOGE("Corrupted baked model");
+			return Error::USER_DATA;
+		}
+
+		ANKI_CHECK(getManager().loadResource(CString(&bin.m_skeleton[0]), m_skeleton));
 	}
 
 	// Calculate compound bounding volume
@@ -256,4 +421,28 @@ Error ModelResource::load(const ResourceFilename& filename, Bool async)
 	return Error::NONE;
 }
 
+void ModelResource::resetBinary()
+{
+	m_modelPatches.destroy(getAllocator());
+	m_skeleton.reset(nullptr);
+}
+
+void ModelResource::appendDependencyContentHashes()
+{
+	for(const ModelPatch& patch : m_modelPatches)
+	{
+		for(U32 i = 0; i < patch.m_meshCount; ++i)
+		{
+			appendContentHash(patch.m_meshes[i]->getContentHash());
+		}
+
+		appendContentHash(patch.m_mtl->getContentHash());
+	}
+
+	if(m_skeleton.isCreated())
+	{
+		appendContentHash(m_skeleton->getContentHash());
+	}
+}
+
 } // end namespace anki
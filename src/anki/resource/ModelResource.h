@@ -19,6 +19,10 @@ namespace anki
 
 // Forward
 class PhysicsCollisionShape;
+class XmlDocument;
+class ModelBinary;
+class ModelBinaryPatch;
+class ResourceBinaryFilename;
 
 /// @addtogroup resource
 /// @{
@@ -126,6 +130,21 @@ public:
 	/// offsets and counts.
 	void getRenderingDataSub(const RenderingKey& key, WeakArray<U8> subMeshIndicesArray, ModelRenderingInfo& inf) const;
 
+	/// Same as getRenderingDataSub but draw only the meshlets that are visible. The neighbouring visible meshlets are
+	/// merged into one drawcall. If the mesh doesn't have meshlets the whole mesh is drawn.
+	/// @param key The rendering key.
+	/// @param worldTransform The world transform of the model.
+	/// @param cameraOrigin The origin of the camera in world space.
+	/// @param planes The planes of the frustum in world space.
+	/// @param alloc Used for temporary allocations.
+	/// @param[out] inf The rendering info.
+	void getRenderingDataMeshlets(const RenderingKey& key,
+		const Transform& worldTransform,
+		const Vec4& cameraOrigin,
+		ConstWeakArray<Plane> planes,
+		StackAllocator<U8> alloc,
+		ModelRenderingInfo& inf) const;
+
 private:
 	ModelResource* m_model ANKI_DEBUG_CODE(= nullptr);
 
@@ -199,6 +218,21 @@ private:
 	Obb m_visibilityShape;
 	SkeletonResourcePtr m_skeleton;
 	DynamicArray<AnimationResourcePtr> m_animations;
+
+	/// Parse the XML into its baked form.
+	ANKI_USE_RESULT Error parseXml(const XmlDocument& doc,
+		ModelBinary& bin,
+		DynamicArrayAuto<ModelBinaryPatch>& patches,
+		DynamicArrayAuto<ResourceBinaryFilename>& meshes);
+
+	/// Initialize the model from its baked form.
+	ANKI_USE_RESULT Error loadBinary(const ModelBinary& bin, Bool async);
+
+	/// Undo a loadBinary() that failed half way.
+	void resetBinary();
+
+	/// Fold the content hashes of the meshes, the materials and the skeleton.
+	void appendDependencyContentHashes();
 };
 /// @}
 
@@ -84,6 +84,7 @@ Error ParticleEmitterResource::load(const ResourceFilename& filename, Bool async
 	ANKI_CHECK(rootEl.getChildElement("material", el));
 	ANKI_CHECK(el.getAttributeText("value", cstr));
 	ANKI_CHECK(getManager().loadResource(cstr, m_material, async));
+	appendContentHash(m_material->getContentHash());
 
 	return Error::NONE;
 }
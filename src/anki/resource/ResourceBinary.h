@@ -0,0 +1,194 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// WARNING: This file is auto generated.
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// A null terminated resource filename.
+class ResourceBinaryFilename
+{
+public:
+	WeakArray<char> m_filename;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_filename", offsetof(ResourceBinaryFilename, m_filename), self.m_filename);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ResourceBinaryFilename&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ResourceBinaryFilename&>(serializer, *this);
+	}
+};
+
+/// A mutation of a baked material.
+class MaterialBinaryMutation
+{
+public:
+	U32 m_mutatorIndex; ///< Index in ShaderProgramResource::getMutators().
+	I32 m_value;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_mutatorIndex", offsetof(MaterialBinaryMutation, m_mutatorIndex), self.m_mutatorIndex);
+		s.doValue("m_value", offsetof(MaterialBinaryMutation, m_value), self.m_value);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialBinaryMutation&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialBinaryMutation&>(serializer, *this);
+	}
+};
+
+/// An input of a baked material.
+class MaterialBinaryInput
+{
+public:
+	U32 m_inputVariableIndex; ///< Index in ShaderProgramResource::getInputVariables().
+	U32 m_builtin; ///< It's a BuiltinMaterialVariableId.
+	Array<U8, 64> m_value; ///< The raw value if it's not a texture or a builtin. Big enough for a Mat4.
+	WeakArray<char> m_texture; ///< Texture filename. Empty if it's not a texture.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue(
+			"m_inputVariableIndex", offsetof(MaterialBinaryInput, m_inputVariableIndex), self.m_inputVariableIndex);
+		s.doValue("m_builtin", offsetof(MaterialBinaryInput, m_builtin), self.m_builtin);
+		s.doArray("m_value", offsetof(MaterialBinaryInput, m_value), &self.m_value[0], 64);
+		s.doValue("m_texture", offsetof(MaterialBinaryInput, m_texture), self.m_texture);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialBinaryInput&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialBinaryInput&>(serializer, *this);
+	}
+};
+
+/// The baked form of the material XML files.
+class MaterialBinary
+{
+public:
+	Array<U8, 8> m_magic;
+	U64 m_programInterfaceHash; ///< Hash of the mutators and inputs of the program at bake time.
+	WeakArray<char> m_shaderProgram;
+	Bool m_shadow;
+	Bool m_forwardShading;
+	WeakArray<MaterialBinaryMutation> m_mutations;
+	WeakArray<MaterialBinaryInput> m_inputs;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(MaterialBinary, m_magic), &self.m_magic[0], 8);
+		s.doValue(
+			"m_programInterfaceHash", offsetof(MaterialBinary, m_programInterfaceHash), self.m_programInterfaceHash);
+		s.doValue("m_shaderProgram", offsetof(MaterialBinary, m_shaderProgram), self.m_shaderProgram);
+		s.doValue("m_shadow", offsetof(MaterialBinary, m_shadow), self.m_shadow);
+		s.doValue("m_forwardShading", offsetof(MaterialBinary, m_forwardShading), self.m_forwardShading);
+		s.doValue("m_mutations", offsetof(MaterialBinary, m_mutations), self.m_mutations);
+		s.doValue("m_inputs", offsetof(MaterialBinary, m_inputs), self.m_inputs);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, MaterialBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const MaterialBinary&>(serializer, *this);
+	}
+};
+
+/// A model patch of a baked model.
+class ModelBinaryPatch
+{
+public:
+	WeakArray<char> m_material;
+	WeakArray<ResourceBinaryFilename> m_meshes; ///< One mesh per LOD.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_material", offsetof(ModelBinaryPatch, m_material), self.m_material);
+		s.doValue("m_meshes", offsetof(ModelBinaryPatch, m_meshes), self.m_meshes);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ModelBinaryPatch&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ModelBinaryPatch&>(serializer, *this);
+	}
+};
+
+/// The baked form of the model XML files.
+class ModelBinary
+{
+public:
+	Array<U8, 8> m_magic;
+	WeakArray<ModelBinaryPatch> m_modelPatches;
+	WeakArray<char> m_skeleton; ///< Skeleton filename. Empty if there is no skeleton.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_magic", offsetof(ModelBinary, m_magic), &self.m_magic[0], 8);
+		s.doValue("m_modelPatches", offsetof(ModelBinary, m_modelPatches), self.m_modelPatches);
+		s.doValue("m_skeleton", offsetof(ModelBinary, m_skeleton), self.m_skeleton);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ModelBinary&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ModelBinary&>(serializer, *this);
+	}
+};
+
+} // end namespace anki
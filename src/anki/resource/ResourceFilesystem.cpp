@@ -413,4 +413,33 @@ Error ResourceFilesystem::openFile(const ResourceFilename& filename, ResourceFil
 	return Error::NONE;
 }
 
+Bool ResourceFilesystem::fileExists(const ResourceFilename& filename) const
+{
+	for(const Path& p : m_paths)
+	{
+		if(p.m_isCache)
+		{
+			StringAuto newFname(m_alloc);
+			newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
+
+			if(anki::fileExists(newFname.toCString()))
+			{
+				return true;
+			}
+		}
+		else
+		{
+			for(const String& pfname : p.m_files)
+			{
+				if(pfname == filename)
+				{
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
 } // end namespace anki
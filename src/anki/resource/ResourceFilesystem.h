@@ -87,6 +87,10 @@ public:
 	/// Search the path list to find the file. Then open the file for reading. It's thread-safe.
 	ANKI_USE_RESULT Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
+	/// Search the path list to find the file. Unlike openFile() it doesn't complain if the file is missing. It's
+	/// thread-safe.
+	Bool fileExists(const ResourceFilename& filename) const;
+
 #if !ANKI_TESTS
 private:
 #endif
@@ -28,6 +28,7 @@ ANKI_REGISTER_CONFIG_OPTION(rsrc_dumpShaderSources, 0, 0, 1)
 ANKI_REGISTER_CONFIG_OPTION(
 	rsrc_dataPaths, ".", "The engine loads assets only in from these paths. Separate them with :")
 ANKI_REGISTER_CONFIG_OPTION(rsrc_transferScratchMemorySize, 256_MB, 1_MB, 4_GB)
+ANKI_REGISTER_CONFIG_OPTION(rsrc_bakeXmlResources, 1, 0, 1, "Cache a binary form of the material and model XML files")
 
 ResourceManager::ResourceManager()
 {
@@ -35,6 +36,8 @@ ResourceManager::ResourceManager()
 
 ResourceManager::~ResourceManager()
 {
+	ANKI_ASSERT(m_loadingResources.getSize() == 0);
+	m_loadingResources.destroy(m_alloc);
 	m_cacheDir.destroy(m_alloc);
 	m_alloc.deleteInstance(m_asyncLoader);
 	m_alloc.deleteInstance(m_transferGpuAlloc);
@@ -55,6 +58,7 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	// Init some constants
 	m_maxTextureSize = init.m_config->getNumberU32("rsrc_maxTextureSize");
 	m_dumpShaderSource = init.m_config->getBool("rsrc_dumpShaderSources");
+	m_bakeXmlResources = init.m_config->getBool("rsrc_bakeXmlResources");
 
 	// Init type resource managers
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) TypeResourceManager<rsrc_>::init(m_alloc);
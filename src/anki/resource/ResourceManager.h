@@ -9,6 +9,7 @@
 #include <anki/util/List.h>
 #include <anki/util/Functions.h>
 #include <anki/util/String.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -40,23 +41,38 @@ protected:
 		m_ptrs.destroy(m_alloc);
 	}
 
+	/// Find a resource. It skips the resources that lost their last reference because some other thread is about to
+	/// delete them.
 	Type* findLoadedResource(const CString& filename)
 	{
-		auto it = find(filename);
-		return (it != m_ptrs.end()) ? *it : nullptr;
+		for(Type* ptr : m_ptrs)
+		{
+			if(ptr->getFilename() == filename && ptr->getRefcount().load(AtomicMemoryOrder::ACQUIRE) > 0)
+			{
+				return ptr;
+			}
+		}
+
+		return nullptr;
 	}
 
 	void registerResource(Type* ptr)
 	{
 		ANKI_ASSERT(ptr->getRefcount().load() == 0);
-		ANKI_ASSERT(find(ptr->getFilename()) == m_ptrs.getEnd());
+		ANKI_ASSERT(findLoadedResource(ptr->getFilename()) == nullptr);
 		m_ptrs.pushBack(m_alloc, ptr);
 	}
 
 	void unregisterResource(Type* ptr)
 	{
-		auto it = find(ptr->getFilename());
-		ANKI_ASSERT(it != m_ptrs.end());
+		// Search by pointer. A new resource with the same filename might be registered while this one is dying
+		auto it = m_ptrs.getBegin();
+		while(it != m_ptrs.getEnd() && *it != ptr)
+		{
+			++it;
+		}
+
+		ANKI_ASSERT(it != m_ptrs.getEnd());
 		m_ptrs.erase(m_alloc, it);
 	}
 
@@ -70,21 +86,6 @@ private:
 
 	ResourceAllocator<U8> m_alloc;
 	Container m_ptrs;
-
-	typename Container::Iterator find(const CString& filename)
-	{
-		typename Container::Iterator it;
-
-		for(it = m_ptrs.getBegin(); it != m_ptrs.getEnd(); ++it)
-		{
-			if((*it)->getFilename() == filename)
-			{
-				break;
-			}
-		}
-
-		return it;
-	}
 };
 
 class ResourceManagerInitInfo
@@ -123,7 +124,7 @@ public:
 
 	ANKI_USE_RESULT Error init(ResourceManagerInitInfo& init);
 
-	/// Load a resource.
+	/// Load a resource. It's thread-safe.
 	template<typename T>
 	ANKI_USE_RESULT Error loadResource(const CString& filename, ResourcePtr<T>& out, Bool async = true);
 
@@ -138,6 +139,11 @@ anki_internal:
 		return m_dumpShaderSource;
 	}
 
+	Bool getBakeXmlResources() const
+	{
+		return m_bakeXmlResources;
+	}
+
 	ResourceAllocator<U8>& getAllocator()
 	{
 		return m_alloc;
@@ -228,6 +234,31 @@ private:
 	TransferGpuAllocator* m_transferGpuAlloc = nullptr;
 	ShaderCompilerCache* m_shaderCompiler = nullptr;
 	Bool m_dumpShaderSource = false;
+	Bool m_bakeXmlResources = true;
+
+	/// A resource that some thread is loading.
+	class LoadingResource
+	{
+	public:
+		CString m_filename; ///< Points to the string of the thread that loads it.
+		const void* m_type; ///< The TypeResourceManager of the resource.
+	};
+
+	/// @name Registry. Protects the registered resources of all types and the resources that are being loaded
+	/// @{
+	Mutex m_registryMtx;
+	ConditionVariable m_registryCondVar;
+	DynamicArray<LoadingResource> m_loadingResources;
+	/// @}
+
+	/// Get a reference to a registered resource.
+	/// @note The caller should hold the registry lock.
+	template<typename T>
+	Bool tryGetLoadedResource(const CString& filename, ResourcePtr<T>& out);
+
+	/// @note The caller should hold the registry lock.
+	template<typename T>
+	Bool isResourceLoading(const CString& filename) const;
 };
 /// @}
 
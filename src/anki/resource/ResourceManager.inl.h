@@ -12,57 +12,118 @@ template<typename T>
 Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out, Bool async)
 {
 	ANKI_ASSERT(!out.isCreated() && "Already loaded");
+	const void* type = static_cast<TypeResourceManager<T>*>(this);
 
-	Error err = Error::NONE;
-	++m_loadRequestCount;
-
-	T* const other = findLoadedResource<T>(filename);
-
-	if(other)
-	{
-		// Found
-		out.reset(other);
-	}
-	else
+	// Find it or mark it as loading. Hold the lock only for that because resources load other resources
 	{
-		// Allocate ptr
-		T* ptr = m_alloc.newInstance<T>(this);
-		ANKI_ASSERT(ptr->getRefcount().load() == 0);
-
-		// Populate the ptr. Use a block to cleanup temp_pool allocations
-		auto& pool = m_tmpAlloc.getMemoryPool();
+		LockGuard<Mutex> lock(m_registryMtx);
+		++m_loadRequestCount;
 
+		while(!tryGetLoadedResource(filename, out))
 		{
-			U allocsCountBefore = pool.getAllocationsCount();
-			(void)allocsCountBefore;
-
-			err = ptr->load(filename, async);
-			if(err)
+			if(!isResourceLoading<T>(filename))
 			{
-				ANKI_RESOURCE_LOGE("Failed to load resource: %s", &filename[0]);
-				m_alloc.deleteInstance(ptr);
-				return err;
+				m_loadingResources.emplaceBack(m_alloc, LoadingResource{filename, type});
+				break;
 			}
 
-			ANKI_ASSERT(pool.getAllocationsCount() == allocsCountBefore && "Forgot to deallocate");
+			// Some other thread loads the same resource, wait for it to finish and check again
+			m_registryCondVar.wait(m_registryMtx);
+		}
+
+		if(out.isCreated())
+		{
+			return Error::NONE;
 		}
+	}
+
+	// Allocate and load
+	T* ptr = m_alloc.newInstance<T>(this);
+	ANKI_ASSERT(ptr->getRefcount().load() == 0);
 
+	Error err = ptr->load(filename, async);
+	if(!err)
+	{
 		ptr->setFilename(filename);
-		ptr->setUuid(++m_uuid);
+	}
+
+	// Register it and wake the threads that wait for it
+	{
+		LockGuard<Mutex> lock(m_registryMtx);
 
-		// Reset the memory pool if no-one is using it.
-		// NOTE: Check because resources load other resources
-		if(pool.getAllocationsCount() == 0)
+		U32 i = 0;
+		while(m_loadingResources[i].m_type != type || m_loadingResources[i].m_filename != filename)
+		{
+			++i;
+		}
+		m_loadingResources[i] = m_loadingResources.getBack();
+		m_loadingResources.popBack(m_alloc);
+
+		if(!err)
+		{
+			ptr->setUuid(++m_uuid);
+			registerResource(ptr);
+			out.reset(ptr);
+		}
+
+		// Reset the memory pool if no-one is using it. Only the threads that load resources use it
+		auto& pool = m_tmpAlloc.getMemoryPool();
+		if(m_loadingResources.getSize() == 0 && pool.getAllocationsCount() == 0)
 		{
 			pool.reset();
 		}
 
-		// Register resource
-		registerResource(ptr);
-		out.reset(ptr);
+		m_registryCondVar.notifyAll();
+	}
+
+	if(err)
+	{
+		ANKI_RESOURCE_LOGE("Failed to load resource: %s", &filename[0]);
+		m_alloc.deleteInstance(ptr);
 	}
 
 	return err;
 }
 
+template<typename T>
+Bool ResourceManager::tryGetLoadedResource(const CString& filename, ResourcePtr<T>& out)
+{
+	T* ptr = findLoadedResource<T>(filename);
+	if(!ptr)
+	{
+		return false;
+	}
+
+	// Don't bring back to life a resource that lost its last reference in the meantime. The thread that dropped it
+	// waits for the lock to delete it
+	Atomic<I32>& refcount = ptr->getRefcount();
+	I32 count = refcount.load(AtomicMemoryOrder::ACQUIRE);
+	do
+	{
+		if(count == 0)
+		{
+			return false;
+		}
+	} while(!refcount.compareExchange(count, count + 1, AtomicMemoryOrder::ACQUIRE));
+
+	out.reset(ptr);
+	refcount.fetchSub(1, AtomicMemoryOrder::RELEASE);
+	return true;
+}
+
+template<typename T>
+Bool ResourceManager::isResourceLoading(const CString& filename) const
+{
+	const void* type = static_cast<const TypeResourceManager<T>*>(this);
+	for(const LoadingResource& l : m_loadingResources)
+	{
+		if(l.m_type == type && l.m_filename == filename)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
 } // end namespace anki
@@ -6,6 +6,9 @@
 #include <anki/resource/ResourceObject.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/util/Xml.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/Hash.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -46,6 +49,33 @@ Error ResourceObject::openFileReadAllText(const CString& filename, StringAuto& t
 	text = StringAuto(getTempAllocator());
 	ANKI_CHECK(file->readAllText(getTempAllocator(), text));
 
+	if(!text.isEmpty())
+	{
+		appendContentHash(computeHash(text.cstr(), text.getLength()));
+	}
+
+	return Error::NONE;
+}
+
+Error ResourceObject::appendFileContentHash(ResourceFile& file)
+{
+	const PtrSize chunkSize = 64_KB;
+	DynamicArrayAuto<U8> chunk(getTempAllocator());
+	chunk.create(chunkSize);
+
+	U64 hash = 0;
+	PtrSize remaining = file.getSize();
+	while(remaining > 0)
+	{
+		const PtrSize size = min(remaining, chunkSize);
+		ANKI_CHECK(file.read(&chunk[0], size));
+		hash = appendHash(&chunk[0], size, hash);
+		remaining -= size;
+	}
+
+	ANKI_CHECK(file.seek(0, FileSeekOrigin::BEGINNING));
+	appendContentHash(hash);
+
 	return Error::NONE;
 }
 
@@ -59,4 +89,72 @@ Error ResourceObject::openFileParseXml(const CString& filename, XmlDocument& xml
 	return Error::NONE;
 }
 
+void ResourceObject::computeBakedFilename(CString text, CString extension, StringAuto& bakedFilename) const
+{
+	const U64 hash = computeHash(text.cstr(), text.getLength());
+	bakedFilename.sprintf("baked/%016" PRIx64 ".%s", hash, extension.cstr());
+}
+
+Bool ResourceObject::openBakedFile(CString bakedFilename, ResourceFilePtr& file)
+{
+	if(!m_manager->getFilesystem().fileExists(bakedFilename))
+	{
+		return false;
+	}
+
+	return !m_manager->getFilesystem().openFile(bakedFilename, file);
+}
+
+Error ResourceObject::createBakedFile(CString bakedFilename, File& file, StringAuto& tmpFilename)
+{
+	StringAuto dir(getTempAllocator());
+	dir.sprintf("%s/baked", m_manager->getCacheDirectory().cstr());
+	if(!directoryExists(dir.toCString()))
+	{
+		// Another thread might create it at the same time so ignore the error and let the open() fail
+		const Error err = createDirectory(dir.toCString());
+		(void)err;
+	}
+
+	// Other threads might be baking the same resource so make the name unique
+	tmpFilename.sprintf("%s/%s.%" PRIx64 ".tmp",
+		m_manager->getCacheDirectory().cstr(),
+		bakedFilename.cstr(),
+		Thread::getCurrentThreadId());
+	ANKI_CHECK(file.open(tmpFilename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+	return Error::NONE;
+}
+
+Error ResourceObject::finalizeBakedFile(CString bakedFilename, CString tmpFilename, Error writeErr)
+{
+	Error err = writeErr;
+	if(!err)
+	{
+		StringAuto fname(getTempAllocator());
+		fname.sprintf("%s/%s", m_manager->getCacheDirectory().cstr(), bakedFilename.cstr());
+		err = renameFile(tmpFilename, fname.toCString());
+	}
+
+	// Don't leave the temporary file behind if something failed
+	if(err && !tmpFilename.isEmpty() && fileExists(tmpFilename))
+	{
+		const Error removeErr = removeFile(tmpFilename);
+		(void)removeErr;
+	}
+
+	return err;
+}
+
+void ResourceObject::removeBakedResource(CString bakedFilename)
+{
+	// Only the baked resources of the cache directory are removed. The ones in the data paths are not ours
+	StringAuto fname(getTempAllocator());
+	fname.sprintf("%s/%s", m_manager->getCacheDirectory().cstr(), bakedFilename.cstr());
+	if(fileExists(fname.toCString()) && removeFile(fname.toCString()))
+	{
+		ANKI_RESOURCE_LOGW("Failed to remove the baked resource: %s", fname.cstr());
+	}
+}
+
 } // end namespace anki
@@ -9,6 +9,8 @@
 #include <anki/resource/ResourceFilesystem.h>
 #include <anki/util/Atomic.h>
 #include <anki/util/String.h>
+#include <anki/util/Serializer.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -74,18 +76,124 @@ anki_internal:
 		return m_uuid;
 	}
 
+	/// A hash of the contents of the resource files and the contents of the resources it references. Data that are
+	/// baked from the resource can use it to find out if they are stale.
+	U64 getContentHash() const
+	{
+		return m_contentHash;
+	}
+
+	/// Fold a hash to the content hash.
+	void appendContentHash(U64 hash)
+	{
+		m_contentHash = appendHash(&hash, sizeof(hash), m_contentHash);
+	}
+
+	/// Fold the contents of a file to the content hash. The file is rewound.
+	ANKI_USE_RESULT Error appendFileContentHash(ResourceFile& file);
+
 	ANKI_USE_RESULT Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
 	ANKI_USE_RESULT Error openFileReadAllText(const ResourceFilename& filename, StringAuto& file);
 
 	ANKI_USE_RESULT Error openFileParseXml(const ResourceFilename& filename, XmlDocument& xml);
 
+	/// @name Baked resources
+	/// The baked resources are the binary form of XML resources. They are keyed by the XML text and they are searched
+	/// in the "baked" directory of the resource filesystem. New ones are written in the cache directory but offline
+	/// baked ones can also be shipped in the data paths.
+	/// @{
+
+	/// Compute the filename of the baked form of a text resource.
+	void computeBakedFilename(CString text, CString extension, StringAuto& bakedFilename) const;
+
+	/// Read a baked resource. Leave the output to nullptr if it's missing, corrupted or it doesn't have the correct
+	/// magic. The output should be freed with freeBakedResource().
+	template<typename T>
+	void readBakedResource(CString bakedFilename, const Array<U8, 8>& magic, T*& bin);
+
+	/// Write a baked resource to the cache directory. It writes a temporary file first and then it renames it so no one
+	/// will read a half written baked resource.
+	template<typename T>
+	ANKI_USE_RESULT Error writeBakedResource(CString bakedFilename, const T& bin);
+
+	/// Remove a baked resource from the cache directory. Call it when a baked resource failed to load.
+	void removeBakedResource(CString bakedFilename);
+
+	template<typename T>
+	void freeBakedResource(T*& bin)
+	{
+		getAllocator().getMemoryPool().free(bin);
+		bin = nullptr;
+	}
+
+	/// Point a baked string to a string. The null terminator is included.
+	static WeakArray<char> toBakedString(CString str)
+	{
+		return WeakArray<char>(const_cast<char*>(str.cstr()), str.getLength() + 1);
+	}
+
+	/// Check if a string that was read from a baked resource can be used as a CString.
+	static Bool isValidBakedString(ConstWeakArray<char> str)
+	{
+		return str.getSize() > 1 && str[str.getSize() - 1] == '\0';
+	}
+	/// @}
+
 private:
 	ResourceManager* m_manager;
 	Atomic<I32> m_refcount;
 	String m_fname; ///< Unique resource name.
 	U64 m_uuid = 0;
+	U64 m_contentHash = 0;
+
+	Bool openBakedFile(CString bakedFilename, ResourceFilePtr& file);
+	ANKI_USE_RESULT Error createBakedFile(CString bakedFilename, File& file, StringAuto& tmpFilename);
+
+	/// Rename the temporary file of a baked resource or remove it if the writing failed.
+	ANKI_USE_RESULT Error finalizeBakedFile(CString bakedFilename, CString tmpFilename, Error writeErr);
 };
+
+template<typename T>
+void ResourceObject::readBakedResource(CString bakedFilename, const Array<U8, 8>& magic, T*& bin)
+{
+	bin = nullptr;
+
+	ResourceFilePtr file;
+	if(!openBakedFile(bakedFilename, file))
+	{
+		return;
+	}
+
+	if(BinaryDeserializer::deserialize(bin, getAllocator(), *file))
+	{
+		ANKI_RESOURCE_LOGW("Ignoring corrupted baked resource: %s", bakedFilename.cstr());
+		bin = nullptr;
+	}
+	else if(memcmp(&bin->m_magic[0], &magic[0], sizeof(magic)) != 0)
+	{
+		ANKI_RESOURCE_LOGW("Ignoring baked resource of wrong version: %s", bakedFilename.cstr());
+		freeBakedResource(bin);
+	}
+}
+
+template<typename T>
+Error ResourceObject::writeBakedResource(CString bakedFilename, const T& bin)
+{
+	StringAuto tmpFilename(getTempAllocator());
+	Error err = Error::NONE;
+	{
+		File file;
+		err = createBakedFile(bakedFilename, file, tmpFilename);
+		if(!err)
+		{
+			BinarySerializer serializer;
+			err = serializer.serialize(bin, getTempAllocator(), file);
+		}
+	}
+
+	return finalizeBakedFile(bakedFilename, tmpFilename.toCString(), err);
+}
 /// @}
 
 } // end namespace anki
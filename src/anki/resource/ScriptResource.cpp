@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/resource/ScriptResource.h>
+#include <anki/script/LuaBinder.h>
 #include <anki/util/File.h>
 
 namespace anki
@@ -12,6 +13,7 @@ namespace anki
 ScriptResource::~ScriptResource()
 {
 	m_source.destroy(getAllocator());
+	m_bytecode.destroy(getAllocator());
 }
 
 Error ScriptResource::load(const ResourceFilename& filename, Bool async)
@@ -21,6 +23,11 @@ Error ScriptResource::load(const ResourceFilename& filename, Bool async)
 
 	ANKI_CHECK(file->readAllText(getAllocator(), m_source));
 
+	// Prefix with @ so that LUA treats the chunk name as a filename in the error messages
+	StringAuto chunkName(getTempAllocator());
+	chunkName.sprintf("@%s", filename.cstr());
+	ANKI_CHECK(LuaBinder::compileString(getAllocator(), m_source.toCString(), chunkName.toCString(), m_bytecode));
+
 	return Error::NONE;
 }
 
@@ -13,7 +13,8 @@ namespace anki
 /// @addtogroup resource
 /// @{
 
-/// Script resource.
+/// Script resource. The source is compiled to LUA bytecode once at load time so the scripts that use it don't have to
+/// parse it again.
 class ScriptResource : public ResourceObject
 {
 public:
@@ -31,8 +32,15 @@ public:
 		return m_source.toCString();
 	}
 
+	/// Get the precompiled source. Evaluate it with LuaBinder::evalBytecode() or similar.
+	ConstWeakArray<U8> getBytecode() const
+	{
+		return ConstWeakArray<U8>(m_bytecode);
+	}
+
 private:
 	String m_source;
+	DynamicArray<U8> m_bytecode;
 };
 /// @}
 
@@ -177,8 +177,9 @@ Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 	ShaderProgramPreprocessor pp(filename, &getManager().getFilesystem(), getTempAllocator());
 	ANKI_CHECK(pp.parse());
 
-	// Create the source
+	// Create the source. It has all the includes so its hash is the content hash
 	m_source.create(getAllocator(), pp.getSource());
+	appendContentHash(computeHash(m_source.cstr(), m_source.getLength()));
 
 	// Create the mutators
 	U32 instancedMutatorIdx = MAX_U32;
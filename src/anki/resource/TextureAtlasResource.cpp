@@ -40,6 +40,7 @@ Error TextureAtlasResource::load(const ResourceFilename& filename, Bool async)
 	CString texFname;
 	ANKI_CHECK(el.getText(texFname));
 	ANKI_CHECK(getManager().loadResource<TextureResource>(texFname, m_tex, async));
+	appendContentHash(m_tex->getContentHash());
 
 	m_size[0] = m_tex->getWidth();
 	m_size[1] = m_tex->getHeight();
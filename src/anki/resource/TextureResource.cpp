@@ -69,11 +69,13 @@ Error TextureResource::load(const ResourceFilename& filename, Bool async)
 
 	TextureInitInfo init("RsrcTex");
 	init.m_usage = TextureUsageBit::SAMPLED_ALL | TextureUsageBit::TRANSFER_DESTINATION;
-	init.m_initialUsage = TextureUsageBit::SAMPLED_ALL;
+	// No initial usage. The upload transitions the texture on the transfer queue without involving the graphics queue
+	init.m_initialUsage = TextureUsageBit::NONE;
 	U32 faces = 0;
 
 	ResourceFilePtr file;
 	ANKI_CHECK(openFile(filename, file));
+	ANKI_CHECK(appendFileContentHash(*file));
 
 	ANKI_CHECK(loader.load(file, filename, getManager().getMaxTextureSize()));
 
@@ -189,7 +191,8 @@ Error TextureResource::load(LoadingContext& ctx)
 		const U32 end = min(copyCount, b + MAX_COPIES_BEFORE_FLUSH);
 
 		CommandBufferInitInfo ci;
-		ci.m_flags = CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::SMALL_BATCH;
+		ci.m_flags =
+			CommandBufferFlag::TRANSFER_WORK | CommandBufferFlag::SMALL_BATCH | CommandBufferFlag::TRANSFER_QUEUE;
 		CommandBufferPtr cmdb = ctx.m_gr->newCommandBuffer(ci);
 
 		// Set the barriers of the batch
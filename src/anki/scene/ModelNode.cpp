@@ -13,6 +13,7 @@
 #include <anki/resource/ResourceManager.h>
 #include <anki/resource/SkeletonResource.h>
 #include <anki/physics/PhysicsWorld.h>
+#include <anki/collision/Functions.h>
 
 namespace anki
 {
@@ -82,6 +83,12 @@ Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
 		this,
 		m_mergeKey);
 
+	// Estimate the cost of the drawcall. Skinned meshes upload their bones and every material variable is a uniform
+	// write
+	const U32 boneCount = (m_model->getSkeleton()) ? m_model->getSkeleton()->getBones().getSize() : 0;
+	const U32 variableCount = U32(rcomp->getVariablesEnd() - rcomp->getVariablesBegin());
+	rcomp->setCost(1.0f + F32(boneCount) / 32.0f + F32(variableCount) / 8.0f);
+
 	return Error::NONE;
 }
 
@@ -148,7 +155,24 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 
 		ctx.m_key.setVelocity(moved && ctx.m_key.getPass() == Pass::GB);
 		ModelRenderingInfo modelInf;
-		patch.getRenderingDataSub(ctx.m_key, WeakArray<U8>(), modelInf);
+		if(userData.getSize() == 1 && ctx.m_key.getPass() == Pass::GB && !m_model->getSkeleton().isCreated())
+		{
+			// Not instanced so skip the meshlets that are outside the frustum or back-facing. The bounds of the
+			// meshlets don't follow the bones so skinned models draw everything
+			Array<Plane, 6> planes;
+			extractClipPlanes(ctx.m_viewProjectionMatrix, planes);
+
+			patch.getRenderingDataMeshlets(ctx.m_key,
+				movec.getWorldTransform(),
+				ctx.m_cameraTransform.getTranslationPart().xyz0(),
+				planes,
+				ctx.m_frameAllocator,
+				modelInf);
+		}
+		else
+		{
+			patch.getRenderingDataSub(ctx.m_key, WeakArray<U8>(), modelInf);
+		}
 
 		// Bones storage
 		if(m_model->getSkeleton())
@@ -193,12 +217,15 @@ void ModelNode::draw(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData
 		cmdb->bindIndexBuffer(modelInf.m_indexBuffer, 0, IndexType::U16);
 
 		// Draw
-		cmdb->drawElements(PrimitiveTopology::TRIANGLES,
-			modelInf.m_indicesCountArray[0],
-			userData.getSize(),
-			U32(modelInf.m_indicesOffsetArray[0] / sizeof(U16)),
-			0,
-			0);
+		for(U32 i = 0; i < modelInf.m_drawcallCount; ++i)
+		{
+			cmdb->drawElements(PrimitiveTopology::TRIANGLES,
+				modelInf.m_indicesCountArray[i],
+				userData.getSize(),
+				U32(modelInf.m_indicesOffsetArray[i] / sizeof(U16)),
+				0,
+				0);
+		}
 	}
 	else
 	{
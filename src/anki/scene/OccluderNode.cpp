@@ -7,6 +7,7 @@
 #include <anki/scene/SceneGraph.h>
 #include <anki/scene/components/MoveComponent.h>
 #include <anki/scene/components/OccluderComponent.h>
+#include <anki/scene/components/SpatialComponent.h>
 #include <anki/resource/MeshLoader.h>
 
 namespace anki
@@ -64,7 +65,8 @@ Error OccluderNode::init(const CString& meshFname)
 	// Create the components
 	newComponent<MoveComponent>();
 	newComponent<MoveFeedbackComponent>();
-	newComponent<OccluderComponent>();
+	OccluderComponent* occluderc = newComponent<OccluderComponent>();
+	newComponent<SpatialComponent>(this, &occluderc->getBoundingVolume());
 
 	return Error::NONE;
 }
@@ -80,6 +82,11 @@ void OccluderNode::onMoveComponentUpdate(MoveComponent& movec)
 	}
 
 	getComponent<OccluderComponent>().setVertices(&m_vertsW[0], m_vertsW.getSize(), sizeof(m_vertsW[0]));
+
+	// Place it in the octree so the visibility tests can find it
+	SpatialComponent& spatialc = getComponent<SpatialComponent>();
+	spatialc.setSpatialOrigin(trf.getOrigin());
+	spatialc.markForUpdate();
 }
 
 } // end namespace anki
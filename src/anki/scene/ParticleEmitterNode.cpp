@@ -11,6 +11,7 @@
 #include <anki/resource/ModelResource.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/util/Functions.h>
+#include <anki/util/ThreadHive.h>
 #include <anki/physics/PhysicsBody.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/physics/PhysicsCollisionShape.h>
@@ -90,43 +91,6 @@ public:
 	}
 };
 
-/// Simple particle for simple simulation
-class ParticleEmitterNode::ParticleSimple : public ParticleEmitterNode::ParticleBase
-{
-public:
-	Vec4 m_velocity = Vec4(0.0);
-	Vec4 m_acceleration = Vec4(0.0);
-
-	void revive(
-		const ParticleEmitterProperties& props, const Transform& trf, Second prevUpdateTime, Second crntTime) override
-	{
-		ParticleBase::revive(props, trf, prevUpdateTime, crntTime);
-		m_velocity = Vec4(0.0);
-
-		m_acceleration = getRandom(props.m_particle.m_minGravity, props.m_particle.m_maxGravity).xyz0();
-
-		// Set the initial position
-		m_crntPosition =
-			getRandom(props.m_particle.m_minStartingPosition, props.m_particle.m_maxStartingPosition).xyz0();
-
-		m_crntPosition += trf.getOrigin();
-	}
-
-	void simulate(Second prevUpdateTime, Second crntTime) override
-	{
-		ParticleBase::simulate(prevUpdateTime, crntTime);
-
-		F32 dt = F32(crntTime - prevUpdateTime);
-
-		Vec4 xp = m_crntPosition;
-		Vec4 xc = m_acceleration * (dt * dt) + m_velocity * dt + xp;
-
-		m_crntPosition = xc;
-
-		m_velocity += m_acceleration * dt;
-	}
-};
-
 /// Particle for bullet simulations
 class ParticleEmitterNode::PhysParticle : public ParticleEmitterNode::ParticleBase
 {
@@ -199,6 +163,40 @@ public:
 	}
 };
 
+/// Simulates a range of the particles of the simple simulation.
+class ParticleEmitterNode::SimpleSimulationTask
+{
+public:
+	ParticleEmitterNode* m_node;
+	U32 m_firstPacket;
+	U32 m_packetCount;
+	F32 m_dt;
+	SimpleSimulationResult m_result;
+};
+
+/// Combines the results of the SimpleSimulationTask tasks and finalizes the update.
+class ParticleEmitterNode::SimpleSimulationCombineTask
+{
+public:
+	ParticleEmitterNode* m_node;
+	WeakArray<SimpleSimulationTask> m_tasks;
+	Second m_prevUpdateTime;
+	Second m_crntTime;
+
+	void combine()
+	{
+		SimpleSimulationResult result;
+		for(const SimpleSimulationTask& task : m_tasks)
+		{
+			result.m_aabbMin = result.m_aabbMin.min(task.m_result.m_aabbMin);
+			result.m_aabbMax = result.m_aabbMax.max(task.m_result.m_aabbMax);
+			result.m_maxParticleSize = max(result.m_maxParticleSize, task.m_result.m_maxParticleSize);
+		}
+
+		m_node->finalizeUpdate(m_prevUpdateTime, m_crntTime, result);
+	}
+};
+
 /// Feedback component
 class ParticleEmitterNode::MoveFeedbackComponent : public SceneComponent
 {
@@ -236,6 +234,7 @@ ParticleEmitterNode::~ParticleEmitterNode()
 	}
 
 	m_particles.destroy(getAllocator());
+	m_simpleParticles.destroy(getAllocator());
 }
 
 Error ParticleEmitterNode::init(const CString& filename)
@@ -368,34 +367,48 @@ void ParticleEmitterNode::createParticlesPhysicsSimulation(SceneGraph* scene)
 
 void ParticleEmitterNode::createParticlesSimpleSimulation()
 {
-	m_particles.create(getAllocator(), m_maxNumOfParticles);
+	m_simplePacketCount = (m_maxNumOfParticles + 3) / 4;
+	m_simpleParticles.create(getAllocator(), m_simplePacketCount * U32(SimpleAttribute::COUNT), Vec4(0.0f));
 
-	for(U32 i = 0; i < m_maxNumOfParticles; i++)
+	// The unused lanes of the last packet are simulated as well, give them a sane lifetime
+	Vec4* lifetimes = getSimpleAttributePackets(SimpleAttribute::LIFETIME);
+	for(U32 i = 0; i < m_simplePacketCount; ++i)
 	{
-		ParticleSimple* part = getAllocator().newInstance<ParticleSimple>();
-
-		m_particles[i] = part;
+		lifetimes[i] = Vec4(1.0f);
 	}
 }
 
 Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
+{
+	m_verts = getFrameAllocator().allocate(m_vertBuffSize);
+
+	if(m_simulationType == SimulationType::SIMPLE)
+	{
+		simpleSimulationUpdate(prevUpdateTime, crntTime);
+	}
+	else
+	{
+		SimpleSimulationResult result;
+		physicsSimulationUpdate(prevUpdateTime, crntTime, result);
+		finalizeUpdate(prevUpdateTime, crntTime, result);
+	}
+
+	return Error::NONE;
+}
+
+void ParticleEmitterNode::physicsSimulationUpdate(
+	Second prevUpdateTime, Second crntTime, SimpleSimulationResult& result)
 {
 	// - Deactivate the dead particles
 	// - Calc the AABB
 	// - Calc the instancing stuff
 	//
-	Vec4 aabbmin(MAX_F32, MAX_F32, MAX_F32, 0.0f);
-	Vec4 aabbmax(MIN_F32, MIN_F32, MIN_F32, 0.0f);
 	m_aliveParticlesCount = 0;
 
-	F32* verts = reinterpret_cast<F32*>(getFrameAllocator().allocate(m_vertBuffSize));
-	m_verts = verts;
-
+	F32* verts = static_cast<F32*>(m_verts);
 	const F32* verts_base = verts;
 	(void)verts_base;
 
-	F32 maxParticleSize = -1.0f;
-
 	for(ParticleBase* p : m_particles)
 	{
 		if(p->isDead())
@@ -421,15 +434,15 @@ Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
 
 			const Vec4& origin = p->m_crntPosition;
 
-			aabbmin = aabbmin.min(origin);
-			aabbmax = aabbmax.max(origin);
+			result.m_aabbMin = result.m_aabbMin.min(origin);
+			result.m_aabbMax = result.m_aabbMax.max(origin);
 
 			verts[0] = origin.x();
 			verts[1] = origin.y();
 			verts[2] = origin.z();
 
 			verts[3] = p->m_crntSize;
-			maxParticleSize = max(maxParticleSize, p->m_crntSize);
+			result.m_maxParticleSize = max(result.m_maxParticleSize, p->m_crntSize);
 
 			verts[4] = clamp(p->m_crntAlpha, 0.0f, 1.0f);
 
@@ -437,12 +450,162 @@ Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
 			verts += 5;
 		}
 	}
+}
+
+void ParticleEmitterNode::simpleSimulationUpdate(Second prevUpdateTime, Second crntTime)
+{
+	const F32 dt = F32(crntTime - prevUpdateTime);
+
+	killSimpleParticles(dt);
+	m_aliveParticlesCount = m_simpleParticleCount;
+
+	const U32 packetCount = (m_simpleParticleCount + 3) / 4;
+	const U32 packetsPerTask = SIMPLE_PARTICLES_PER_TASK / 4;
+	const U32 taskCount = (packetCount + packetsPerTask - 1) / packetsPerTask;
+
+	if(taskCount <= 1)
+	{
+		SimpleSimulationResult result;
+		simulateSimpleParticles(0, packetCount, dt, result);
+		finalizeUpdate(prevUpdateTime, crntTime, result);
+		return;
+	}
+
+	// Large emitter, split the simulation to tasks and finalize the update when all of them are done. It's OK for this
+	// function to return before that because the scene update waits for all tasks
+	ThreadHive& hive = getSceneGraph().getThreadHive();
+	SceneFrameAllocator<U8> alloc = getFrameAllocator();
+
+	SimpleSimulationCombineTask* combineCtx = alloc.newInstance<SimpleSimulationCombineTask>();
+	combineCtx->m_node = this;
+	combineCtx->m_tasks = WeakArray<SimpleSimulationTask>(alloc.newArray<SimpleSimulationTask>(taskCount), taskCount);
+	combineCtx->m_prevUpdateTime = prevUpdateTime;
+	combineCtx->m_crntTime = crntTime;
+
+	ThreadHiveSemaphore* sem = hive.newSemaphore(taskCount);
+	ThreadHiveTask* tasks = alloc.newArray<ThreadHiveTask>(taskCount);
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		SimpleSimulationTask& ctx = combineCtx->m_tasks[i];
+		ctx.m_node = this;
+		ctx.m_firstPacket = i * packetsPerTask;
+		ctx.m_packetCount = min(packetsPerTask, packetCount - ctx.m_firstPacket);
+		ctx.m_dt = dt;
+
+		tasks[i] = ANKI_THREAD_HIVE_TASK(
+			{
+				self->m_node->simulateSimpleParticles(
+					self->m_firstPacket, self->m_packetCount, self->m_dt, self->m_result);
+			},
+			&ctx,
+			nullptr,
+			sem);
+	}
+	hive.submitTasks(tasks, taskCount);
+
+	ThreadHiveTask combineTask = ANKI_THREAD_HIVE_TASK({ self->combine(); }, combineCtx, sem, nullptr);
+	hive.submitTasks(&combineTask, 1);
+}
+
+void ParticleEmitterNode::killSimpleParticles(F32 dt)
+{
+	U32 i = 0;
+	while(i < m_simpleParticleCount)
+	{
+		F32& age = getSimpleAttribute(SimpleAttribute::AGE, i);
+		age += dt;
+
+		if(age <= getSimpleAttribute(SimpleAttribute::LIFETIME, i))
+		{
+			++i;
+			continue;
+		}
+
+		// Dead, move the last particle here. Don't advance because the moved particle hasn't been aged yet
+		const U32 last = --m_simpleParticleCount;
+		if(i != last)
+		{
+			for(SimpleAttribute attrib = SimpleAttribute(0); attrib < SimpleAttribute::COUNT;
+				attrib = SimpleAttribute(U32(attrib) + 1))
+			{
+				getSimpleAttribute(attrib, i) = getSimpleAttribute(attrib, last);
+			}
+		}
+	}
+}
+
+void ParticleEmitterNode::simulateSimpleParticles(
+	U32 firstPacket, U32 packetCount, F32 dt, SimpleSimulationResult& result)
+{
+	ANKI_ASSERT(firstPacket + packetCount <= m_simplePacketCount);
+
+	Array<Vec4*, 3> positions;
+	Array<Vec4*, 3> velocities;
+	Array<const Vec4*, 3> accelerations;
+	for(U32 c = 0; c < 3; ++c)
+	{
+		positions[c] = getSimpleAttributePackets(SimpleAttribute(U32(SimpleAttribute::POSITION_X) + c));
+		velocities[c] = getSimpleAttributePackets(SimpleAttribute(U32(SimpleAttribute::VELOCITY_X) + c));
+		accelerations[c] = getSimpleAttributePackets(SimpleAttribute(U32(SimpleAttribute::ACCELERATION_X) + c));
+	}
+	const Vec4* ages = getSimpleAttributePackets(SimpleAttribute::AGE);
+	const Vec4* lifetimes = getSimpleAttributePackets(SimpleAttribute::LIFETIME);
+	const Vec4* initialSizes = getSimpleAttributePackets(SimpleAttribute::INITIAL_SIZE);
+	const Vec4* finalSizes = getSimpleAttributePackets(SimpleAttribute::FINAL_SIZE);
+	const Vec4* initialAlphas = getSimpleAttributePackets(SimpleAttribute::INITIAL_ALPHA);
+	const Vec4* finalAlphas = getSimpleAttributePackets(SimpleAttribute::FINAL_ALPHA);
+
+	const Vec4 dtv(dt);
+	const Vec4 dt2v(dt * dt);
+	Vec4 aabbMin = result.m_aabbMin;
+	Vec4 aabbMax = result.m_aabbMax;
+	F32 maxParticleSize = result.m_maxParticleSize;
+
+	for(U32 p = firstPacket; p < firstPacket + packetCount; ++p)
+	{
+		// Integrate 4 particles at once
+		const Vec4 lifeFactor = ages[p] / lifetimes[p];
+		const Vec4 size = initialSizes[p] + (finalSizes[p] - initialSizes[p]) * lifeFactor;
+		const Vec4 alpha = (initialAlphas[p] + (finalAlphas[p] - initialAlphas[p]) * lifeFactor).clamp(0.0f, 1.0f);
+
+		for(U32 c = 0; c < 3; ++c)
+		{
+			positions[c][p] += accelerations[c][p] * dt2v + velocities[c][p] * dtv;
+			velocities[c][p] += accelerations[c][p] * dtv;
+		}
+
+		// Write the vertices of the alive particles
+		const U32 laneCount = min(4u, m_simpleParticleCount - p * 4);
+		F32* verts = static_cast<F32*>(m_verts) + p * 4 * 5;
+		for(U32 lane = 0; lane < laneCount; ++lane)
+		{
+			const Vec4 origin(positions[0][p][lane], positions[1][p][lane], positions[2][p][lane], 0.0f);
+
+			aabbMin = aabbMin.min(origin);
+			aabbMax = aabbMax.max(origin);
+			maxParticleSize = max(maxParticleSize, size[lane]);
+
+			verts[0] = origin.x();
+			verts[1] = origin.y();
+			verts[2] = origin.z();
+			verts[3] = size[lane];
+			verts[4] = alpha[lane];
+			verts += 5;
+		}
+	}
 
+	result.m_aabbMin = aabbMin;
+	result.m_aabbMax = aabbMax;
+	result.m_maxParticleSize = maxParticleSize;
+}
+
+void ParticleEmitterNode::finalizeUpdate(Second prevUpdateTime, Second crntTime, const SimpleSimulationResult& result)
+{
 	if(m_aliveParticlesCount != 0)
 	{
-		ANKI_ASSERT(maxParticleSize > 0.0f);
-		Vec4 min = aabbmin - maxParticleSize;
-		Vec4 max = aabbmax + maxParticleSize;
+		ANKI_ASSERT(result.m_maxParticleSize > 0.0f);
+		Vec4 min = result.m_aabbMin - result.m_maxParticleSize;
+		Vec4 max = result.m_aabbMax + result.m_maxParticleSize;
 		Vec4 center = (min + max) / 2.0;
 
 		m_obb = Obb(center.xyz0(), Mat3x4::getIdentity(), (max - center).xyz0());
@@ -460,9 +623,55 @@ Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
 	//
 	if(m_timeLeftForNextEmission <= 0.0)
 	{
-		MoveComponent& move = getComponent<MoveComponent>();
+		emitParticles(prevUpdateTime, crntTime);
+		m_timeLeftForNextEmission = m_emissionPeriod;
+	}
+	else
+	{
+		m_timeLeftForNextEmission -= crntTime - prevUpdateTime;
+	}
+}
+
+void ParticleEmitterNode::emitParticles(Second prevUpdateTime, Second crntTime)
+{
+	const Transform& trf = getComponent<MoveComponent>().getWorldTransform();
 
-		U particlesCount = 0; // How many particles I am allowed to emmit
+	if(m_simulationType == SimulationType::SIMPLE)
+	{
+		// Append to the alive particles
+		const U32 count = min(m_particlesPerEmission, m_maxNumOfParticles - m_simpleParticleCount);
+		for(U32 i = m_simpleParticleCount; i < m_simpleParticleCount + count; ++i)
+		{
+			getSimpleAttribute(SimpleAttribute::AGE, i) = 0.0f;
+			getSimpleAttribute(SimpleAttribute::LIFETIME, i) =
+				F32(getRandomRange(m_particle.m_minLife, m_particle.m_maxLife));
+
+			getSimpleAttribute(SimpleAttribute::INITIAL_SIZE, i) =
+				getRandomRange(m_particle.m_minInitialSize, m_particle.m_maxInitialSize);
+			getSimpleAttribute(SimpleAttribute::FINAL_SIZE, i) =
+				getRandomRange(m_particle.m_minFinalSize, m_particle.m_maxFinalSize);
+
+			getSimpleAttribute(SimpleAttribute::INITIAL_ALPHA, i) =
+				getRandomRange(m_particle.m_minInitialAlpha, m_particle.m_maxInitialAlpha);
+			getSimpleAttribute(SimpleAttribute::FINAL_ALPHA, i) =
+				getRandomRange(m_particle.m_minFinalAlpha, m_particle.m_maxFinalAlpha);
+
+			const Vec3 acceleration = getRandom(m_particle.m_minGravity, m_particle.m_maxGravity);
+			const Vec3 position =
+				getRandom(m_particle.m_minStartingPosition, m_particle.m_maxStartingPosition) + trf.getOrigin().xyz();
+			for(U32 c = 0; c < 3; ++c)
+			{
+				getSimpleAttribute(SimpleAttribute(U32(SimpleAttribute::POSITION_X) + c), i) = position[c];
+				getSimpleAttribute(SimpleAttribute(U32(SimpleAttribute::VELOCITY_X) + c), i) = 0.0f;
+				getSimpleAttribute(SimpleAttribute(U32(SimpleAttribute::ACCELERATION_X) + c), i) = acceleration[c];
+			}
+		}
+
+		m_simpleParticleCount += count;
+	}
+	else
+	{
+		U32 particlesCount = 0; // How many particles I am allowed to emmit
 		for(ParticleBase* pp : m_particles)
 		{
 			ParticleBase& p = *pp;
@@ -472,7 +681,7 @@ Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
 				continue;
 			}
 
-			p.revive(*this, move.getWorldTransform(), prevUpdateTime, crntTime);
+			p.revive(*this, trf, prevUpdateTime, crntTime);
 
 			// do the rest
 			++particlesCount;
@@ -481,15 +690,7 @@ Error ParticleEmitterNode::frameUpdate(Second prevUpdateTime, Second crntTime)
 				break;
 			}
 		} // end for all particles
-
-		m_timeLeftForNextEmission = m_emissionPeriod;
-	} // end if can emit
-	else
-	{
-		m_timeLeftForNextEmission -= crntTime - prevUpdateTime;
 	}
-
-	return Error::NONE;
 }
 
 } // end namespace anki
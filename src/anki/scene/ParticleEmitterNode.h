@@ -35,8 +35,9 @@ public:
 private:
 	class MoveFeedbackComponent;
 	class ParticleBase;
-	class ParticleSimple;
 	class PhysParticle;
+	class SimpleSimulationTask;
+	class SimpleSimulationCombineTask;
 
 	enum class SimulationType : U8
 	{
@@ -45,18 +46,58 @@ private:
 		PHYSICS_ENGINE
 	};
 
+	/// The attributes of the particles of the simple simulation.
+	enum class SimpleAttribute : U8
+	{
+		POSITION_X,
+		POSITION_Y,
+		POSITION_Z,
+		VELOCITY_X,
+		VELOCITY_Y,
+		VELOCITY_Z,
+		ACCELERATION_X,
+		ACCELERATION_Y,
+		ACCELERATION_Z,
+		AGE,
+		LIFETIME,
+		INITIAL_SIZE,
+		FINAL_SIZE,
+		INITIAL_ALPHA,
+		FINAL_ALPHA,
+
+		COUNT
+	};
+
+	/// The part of the bounding volume a number of particles contribute.
+	class SimpleSimulationResult
+	{
+	public:
+		Vec4 m_aabbMin = Vec4(MAX_F32, MAX_F32, MAX_F32, 0.0f);
+		Vec4 m_aabbMax = Vec4(MIN_F32, MIN_F32, MIN_F32, 0.0f);
+		F32 m_maxParticleSize = -1.0f;
+	};
+
 	/// Size of a single vertex.
 	static const U32 VERTEX_SIZE = 5 * sizeof(F32);
 
+	/// Emitters with more alive particles than that split the simple simulation to ThreadHive tasks.
+	static const U32 SIMPLE_PARTICLES_PER_TASK = 4 * 1024;
+
 	ParticleEmitterResourcePtr m_particleEmitterResource;
-	DynamicArray<ParticleBase*> m_particles;
+	DynamicArray<ParticleBase*> m_particles; ///< The particles of the physics engine simulation.
 	Second m_timeLeftForNextEmission = 0.0;
 	Obb m_obb;
 
+	/// The particles of the simple simulation in SoA form. Every attribute is an array of m_simplePacketCount Vec4s and
+	/// every Vec4 holds the attribute of 4 particles. The alive particles are packed at the start of the arrays.
+	DynamicArray<Vec4> m_simpleParticles;
+	U32 m_simplePacketCount = 0;
+	U32 m_simpleParticleCount = 0; ///< The alive particles of the simple simulation.
+
 	// Opt: We dont have to make extra calculations if the ParticleEmitterNode's rotation is the identity
 	Bool m_identityRotation = true;
 
-	U32 m_aliveParticlesCount = 0;
+	U32 m_aliveParticlesCount = 0; ///< The particles that have vertices in m_verts.
 
 	/// @name Graphics
 	/// @{
@@ -69,6 +110,32 @@ private:
 	void createParticlesPhysicsSimulation(SceneGraph* scene);
 	void createParticlesSimpleSimulation();
 
+	void physicsSimulationUpdate(Second prevUpdateTime, Second crntTime, SimpleSimulationResult& result);
+
+	void simpleSimulationUpdate(Second prevUpdateTime, Second crntTime);
+
+	/// Remove the dead particles of the simple simulation by moving the last alive particle to their place.
+	void killSimpleParticles(F32 dt);
+
+	/// Integrate a range of the particles of the simple simulation and write their vertices.
+	void simulateSimpleParticles(U32 firstPacket, U32 packetCount, F32 dt, SimpleSimulationResult& result);
+
+	/// Compute the bounding volume and emit new particles. It's the last step of the update.
+	void finalizeUpdate(Second prevUpdateTime, Second crntTime, const SimpleSimulationResult& result);
+
+	void emitParticles(Second prevUpdateTime, Second crntTime);
+
+	F32& getSimpleAttribute(SimpleAttribute attrib, U32 particleIdx)
+	{
+		ANKI_ASSERT(particleIdx < m_simplePacketCount * 4);
+		return m_simpleParticles[U32(attrib) * m_simplePacketCount + particleIdx / 4][particleIdx % 4];
+	}
+
+	Vec4* getSimpleAttributePackets(SimpleAttribute attrib)
+	{
+		return &m_simpleParticles[U32(attrib) * m_simplePacketCount];
+	}
+
 	void onMoveComponentUpdate(MoveComponent& move);
 
 	static void drawCallback(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData);
@@ -0,0 +1,557 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/scene/SceneBinaryLoader.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/ModelNode.h>
+#include <anki/scene/StaticCollisionNode.h>
+#include <anki/scene/ParticleEmitterNode.h>
+#include <anki/scene/GpuParticleEmitterNode.h>
+#include <anki/scene/LightNode.h>
+#include <anki/scene/CameraNode.h>
+#include <anki/scene/ReflectionProbeNode.h>
+#include <anki/scene/GlobalIlluminationProbeNode.h>
+#include <anki/scene/DecalNode.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/scene/components/LightComponent.h>
+#include <anki/scene/components/LensFlareComponent.h>
+#include <anki/scene/components/FrustumComponent.h>
+#include <anki/scene/components/GlobalIlluminationProbeComponent.h>
+#include <anki/scene/components/DecalComponent.h>
+#include <anki/scene/events/EventManager.h>
+#include <anki/scene/events/LightEvent.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ModelResource.h>
+#include <anki/resource/CollisionResource.h>
+#include <anki/resource/ParticleEmitterResource.h>
+#include <anki/resource/TextureResource.h>
+#include <anki/resource/TextureAtlasResource.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+SceneBinaryLoader::SceneBinaryLoader(SceneGraph* scene)
+	: m_scene(scene)
+	, m_resourceInfos(scene->getAllocator())
+	, m_nodeInfos(scene->getAllocator())
+	, m_strings(scene->getAllocator())
+	, m_resources(scene->getAllocator())
+	, m_nodes(scene->getAllocator())
+{
+	ANKI_ASSERT(scene);
+}
+
+SceneBinaryLoader::~SceneBinaryLoader()
+{
+}
+
+Error SceneBinaryLoader::load(const CString& filename, F32 cameraAspectRatio)
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_BINARY_LOAD);
+	ANKI_ASSERT(cameraAspectRatio > 0.0f);
+	m_cameraAspectRatio = cameraAspectRatio;
+
+	const Second begin = HighRezTimer::getCurrentTime();
+
+	ANKI_CHECK(loadFile(filename));
+	ANKI_CHECK(validate());
+	ANKI_CHECK(loadResources());
+	ANKI_CHECK(newNodes());
+
+	// The file and its resources describe the static content of the scene so use them to identify the baked probes
+	U64 contentHash = computeHash(&m_strings[0], m_strings.getSizeInBytes());
+	if(m_resourceInfos.getSize())
+	{
+		contentHash = appendHash(&m_resourceInfos[0], m_resourceInfos.getSizeInBytes(), contentHash);
+	}
+	if(m_nodeInfos.getSize())
+	{
+		contentHash = appendHash(&m_nodeInfos[0], m_nodeInfos.getSizeInBytes(), contentHash);
+	}
+	for(const Resource& rsrc : m_resources)
+	{
+		const U64 rsrcHash = getResourceContentHash(rsrc);
+		contentHash = appendHash(&rsrcHash, sizeof(rsrcHash), contentHash);
+	}
+	m_scene->setContentHash(contentHash);
+
+	// Set the active camera. Do that serially and in the order of the file so the last camera wins like in the scripts
+	for(U32 i = 0; i < m_nodeInfos.getSize(); ++i)
+	{
+		if(m_nodeInfos[i].m_type == SceneBinaryFile::NodeType::PERSPECTIVE_CAMERA)
+		{
+			m_scene->setActiveCameraNode(m_nodes[i]);
+		}
+	}
+
+	ANKI_SCENE_LOGI("Loaded scene %s. %u resources and %u nodes in %f sec",
+		filename.cstr(),
+		m_resourceInfos.getSize(),
+		m_nodeInfos.getSize(),
+		HighRezTimer::getCurrentTime() - begin);
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::loadFile(const CString& filename)
+{
+	ResourceFilePtr file;
+	ANKI_CHECK(m_scene->getResourceManager().getFilesystem().openFile(filename, file));
+
+	SceneBinaryFile::Header header;
+	if(file->getSize() < sizeof(header))
+	{
+		ANKI_SCENE_LOGE("The file is too small: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+	ANKI_CHECK(file->read(&header, sizeof(header)));
+
+	if(memcmp(&header.m_magic[0], SceneBinaryFile::MAGIC, 8) != 0)
+	{
+		ANKI_SCENE_LOGE("Wrong magic word: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	// Check the size of the sections before allocating anything for them
+	const PtrSize expectedSize = sizeof(header) + PtrSize(header.m_resourceCount) * sizeof(SceneBinaryFile::Resource)
+								 + PtrSize(header.m_nodeCount) * sizeof(SceneBinaryFile::Node)
+								 + header.m_stringTableSize;
+	if(file->getSize() != expectedSize)
+	{
+		ANKI_SCENE_LOGE("The file size doesn't match the size of its sections: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	if(header.m_stringTableSize == 0)
+	{
+		ANKI_SCENE_LOGE("The string table is empty: %s", filename.cstr());
+		return Error::USER_DATA;
+	}
+
+	if(header.m_resourceCount)
+	{
+		m_resourceInfos.create(header.m_resourceCount);
+		ANKI_CHECK(file->read(&m_resourceInfos[0], m_resourceInfos.getSizeInBytes()));
+	}
+
+	if(header.m_nodeCount)
+	{
+		m_nodeInfos.create(header.m_nodeCount);
+		ANKI_CHECK(file->read(&m_nodeInfos[0], m_nodeInfos.getSizeInBytes()));
+	}
+
+	m_strings.create(header.m_stringTableSize);
+	ANKI_CHECK(file->read(&m_strings[0], m_strings.getSizeInBytes()));
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::validate() const
+{
+	if(m_strings.getBack() != '\0')
+	{
+		ANKI_SCENE_LOGE("The string table is not null terminated");
+		return Error::USER_DATA;
+	}
+
+	const U32 stringTableSize = m_strings.getSize();
+	const U32 resourceCount = m_resourceInfos.getSize();
+
+	for(const SceneBinaryFile::Resource& rsrc : m_resourceInfos)
+	{
+		if(rsrc.m_type >= SceneBinaryFile::ResourceType::COUNT || rsrc.m_filename >= stringTableSize)
+		{
+			ANKI_SCENE_LOGE("Incorrect resource info");
+			return Error::USER_DATA;
+		}
+	}
+
+	auto checkResource = [&](U32 idx, SceneBinaryFile::ResourceType type, Bool optional) -> Bool {
+		if(idx == SceneBinaryFile::NONE)
+		{
+			return optional;
+		}
+
+		return idx < resourceCount && m_resourceInfos[idx].m_type == type;
+	};
+
+	for(const SceneBinaryFile::Node& node : m_nodeInfos)
+	{
+		Bool ok = node.m_name < stringTableSize && !(node.m_flags & ~SceneBinaryFile::NodeFlag::ALL);
+
+		switch(node.m_type)
+		{
+		case SceneBinaryFile::NodeType::MODEL:
+			ok = ok && checkResource(node.m_resource, SceneBinaryFile::ResourceType::MODEL, false);
+			break;
+		case SceneBinaryFile::NodeType::STATIC_COLLISION:
+			ok = ok && checkResource(node.m_resource, SceneBinaryFile::ResourceType::COLLISION, false);
+			break;
+		case SceneBinaryFile::NodeType::PARTICLE_EMITTER:
+		case SceneBinaryFile::NodeType::GPU_PARTICLE_EMITTER:
+			ok = ok && checkResource(node.m_resource, SceneBinaryFile::ResourceType::PARTICLE_EMITTER, false);
+			break;
+		case SceneBinaryFile::NodeType::POINT_LIGHT:
+		case SceneBinaryFile::NodeType::SPOT_LIGHT:
+			ok = ok && checkResource(node.m_light.m_lensFlare, SceneBinaryFile::ResourceType::TEXTURE, true);
+			break;
+		case SceneBinaryFile::NodeType::DIRECTIONAL_LIGHT:
+			ok = ok && node.m_light.m_lensFlare == SceneBinaryFile::NONE;
+			break;
+		case SceneBinaryFile::NodeType::PERSPECTIVE_CAMERA:
+		case SceneBinaryFile::NodeType::REFLECTION_PROBE:
+		case SceneBinaryFile::NodeType::GLOBAL_ILLUMINATION_PROBE:
+			break;
+		case SceneBinaryFile::NodeType::DECAL:
+			for(U32 i = 0; i < 2; ++i)
+			{
+				ok = ok && checkResource(node.m_decal.m_atlases[i], SceneBinaryFile::ResourceType::TEXTURE_ATLAS, true)
+					 && (node.m_decal.m_atlases[i] == SceneBinaryFile::NONE
+							|| node.m_decal.m_subTextures[i] < stringTableSize);
+			}
+			break;
+		default:
+			ok = false;
+		}
+
+		if(!ok)
+		{
+			ANKI_SCENE_LOGE("Incorrect node info");
+			return Error::USER_DATA;
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::loadResources()
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_BINARY_LOAD_RESOURCES);
+
+	// Load everything before creating the nodes. The resources will stream their GPU data in the background and the
+	// nodes will find them already loaded
+	ResourceManager& resources = m_scene->getResourceManager();
+	m_resources.create(m_resourceInfos.getSize());
+	for(U32 i = 0; i < m_resourceInfos.getSize(); ++i)
+	{
+		const CString fname = getResourceFilename(i);
+		Resource& rsrc = m_resources[i];
+
+		switch(m_resourceInfos[i].m_type)
+		{
+		case SceneBinaryFile::ResourceType::MODEL:
+			ANKI_CHECK(resources.loadResource(fname, rsrc.m_model));
+			break;
+		case SceneBinaryFile::ResourceType::COLLISION:
+			ANKI_CHECK(resources.loadResource(fname, rsrc.m_collision));
+			break;
+		case SceneBinaryFile::ResourceType::PARTICLE_EMITTER:
+			ANKI_CHECK(resources.loadResource(fname, rsrc.m_particleEmitter));
+			break;
+		case SceneBinaryFile::ResourceType::TEXTURE:
+			ANKI_CHECK(resources.loadResource(fname, rsrc.m_texture));
+			break;
+		case SceneBinaryFile::ResourceType::TEXTURE_ATLAS:
+			ANKI_CHECK(resources.loadResource(fname, rsrc.m_textureAtlas));
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+	}
+
+	return Error::NONE;
+}
+
+U64 SceneBinaryLoader::getResourceContentHash(const Resource& rsrc)
+{
+	if(rsrc.m_model.isCreated())
+	{
+		return rsrc.m_model->getContentHash();
+	}
+	else if(rsrc.m_collision.isCreated())
+	{
+		return rsrc.m_collision->getContentHash();
+	}
+	else if(rsrc.m_particleEmitter.isCreated())
+	{
+		return rsrc.m_particleEmitter->getContentHash();
+	}
+	else if(rsrc.m_texture.isCreated())
+	{
+		return rsrc.m_texture->getContentHash();
+	}
+	else
+	{
+		ANKI_ASSERT(rsrc.m_textureAtlas.isCreated());
+		return rsrc.m_textureAtlas->getContentHash();
+	}
+}
+
+Error SceneBinaryLoader::newNodes()
+{
+	ANKI_TRACE_SCOPED_EVENT(SCENE_BINARY_LOAD_NODES);
+
+	m_nodes.create(m_nodeInfos.getSize(), nullptr);
+
+	ThreadHive& hive = m_scene->getThreadHive();
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+	for(U i = 0; i < hive.getThreadCount(); ++i)
+	{
+		tasks[i] = ANKI_THREAD_HIVE_TASK({ self->newNodesTask(); }, this, nullptr, nullptr);
+	}
+
+	hive.submitTasks(&tasks[0], hive.getThreadCount());
+	hive.waitAllTasks();
+
+	const Error err = m_errorInThread.load();
+	if(err)
+	{
+		ANKI_SCENE_LOGE("Failed to create the scene nodes");
+	}
+
+	return err;
+}
+
+void SceneBinaryLoader::newNodesTask()
+{
+	while(m_errorInThread.load() == 0)
+	{
+		const U32 idx = m_crntNode.fetchAdd(1);
+		if(idx >= m_nodeInfos.getSize())
+		{
+			break;
+		}
+
+		const Error err = newNode(m_nodeInfos[idx], m_nodes[idx]);
+		if(err)
+		{
+			m_errorInThread.store(err._getCode());
+		}
+	}
+}
+
+Error SceneBinaryLoader::newNode(const SceneBinaryFile::Node& info, SceneNode*& node)
+{
+	const CString name = getString(info.m_name);
+	const Transform trf = getTransform(info);
+
+	switch(info.m_type)
+	{
+	case SceneBinaryFile::NodeType::MODEL:
+	{
+		ModelNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, getResourceFilename(info.m_resource)));
+		node = n;
+		break;
+	}
+	case SceneBinaryFile::NodeType::STATIC_COLLISION:
+	{
+		StaticCollisionNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, getResourceFilename(info.m_resource), trf));
+		node = n;
+		break;
+	}
+	case SceneBinaryFile::NodeType::PARTICLE_EMITTER:
+	{
+		ParticleEmitterNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, getResourceFilename(info.m_resource)));
+		node = n;
+		break;
+	}
+	case SceneBinaryFile::NodeType::GPU_PARTICLE_EMITTER:
+	{
+		GpuParticleEmitterNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n, getResourceFilename(info.m_resource)));
+		node = n;
+		break;
+	}
+	case SceneBinaryFile::NodeType::POINT_LIGHT:
+	{
+		PointLightNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		ANKI_CHECK(setupLight(info, *node));
+		break;
+	}
+	case SceneBinaryFile::NodeType::SPOT_LIGHT:
+	{
+		SpotLightNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		ANKI_CHECK(setupLight(info, *node));
+		break;
+	}
+	case SceneBinaryFile::NodeType::DIRECTIONAL_LIGHT:
+	{
+		DirectionalLightNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		ANKI_CHECK(setupLight(info, *node));
+		break;
+	}
+	case SceneBinaryFile::NodeType::PERSPECTIVE_CAMERA:
+	{
+		PerspectiveCameraNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+
+		const SceneBinaryFile::Camera& cam = info.m_camera;
+		node->getComponent<FrustumComponent>().setPerspective(
+			cam.m_near, cam.m_far, m_cameraAspectRatio * cam.m_fovY, cam.m_fovY);
+		break;
+	}
+	case SceneBinaryFile::NodeType::REFLECTION_PROBE:
+	{
+		const SceneBinaryFile::Probe& probe = info.m_probe;
+		ReflectionProbeNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name,
+			n,
+			Vec4(probe.m_aabbMin[0], probe.m_aabbMin[1], probe.m_aabbMin[2], 0.0f),
+			Vec4(probe.m_aabbMax[0], probe.m_aabbMax[1], probe.m_aabbMax[2], 0.0f)));
+		node = n;
+		break;
+	}
+	case SceneBinaryFile::NodeType::GLOBAL_ILLUMINATION_PROBE:
+	{
+		GlobalIlluminationProbeNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+
+		const SceneBinaryFile::Probe& probe = info.m_probe;
+		GlobalIlluminationProbeComponent& comp = node->getComponent<GlobalIlluminationProbeComponent>();
+		comp.setBoundingBox(Vec4(probe.m_aabbMin[0], probe.m_aabbMin[1], probe.m_aabbMin[2], 0.0f),
+			Vec4(probe.m_aabbMax[0], probe.m_aabbMax[1], probe.m_aabbMax[2], 0.0f));
+
+		if(probe.m_fadeDistance > 0.0f)
+		{
+			comp.setFadeDistance(probe.m_fadeDistance);
+		}
+
+		if(probe.m_cellSize > 0.0f)
+		{
+			comp.setCellSize(probe.m_cellSize);
+		}
+		break;
+	}
+	case SceneBinaryFile::NodeType::DECAL:
+	{
+		DecalNode* n;
+		ANKI_CHECK(m_scene->newSceneNode(name, n));
+		node = n;
+		ANKI_CHECK(setupDecal(info, *node));
+		break;
+	}
+	default:
+		ANKI_ASSERT(0);
+	}
+
+	// Place the nodes that can move. The rest (eg static collision nodes) got their transform on creation
+	MoveComponent* move = node->tryGetComponent<MoveComponent>();
+	if(move)
+	{
+		move->setLocalTransform(trf);
+	}
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::setupLight(const SceneBinaryFile::Node& info, SceneNode& node)
+{
+	const SceneBinaryFile::Light& light = info.m_light;
+	LightComponent& lcomp = node.getComponent<LightComponent>();
+
+	lcomp.setDiffuseColor(Vec4(light.m_diffuseColor[0], light.m_diffuseColor[1], light.m_diffuseColor[2], 1.0f));
+
+	if(!!(info.m_flags & SceneBinaryFile::NodeFlag::SHADOW_ENABLED))
+	{
+		lcomp.setShadowEnabled(true);
+	}
+	else if(!!(info.m_flags & SceneBinaryFile::NodeFlag::SHADOW_DISABLED))
+	{
+		lcomp.setShadowEnabled(false);
+	}
+
+	if(info.m_type == SceneBinaryFile::NodeType::POINT_LIGHT)
+	{
+		lcomp.setRadius(light.m_radius);
+	}
+	else if(info.m_type == SceneBinaryFile::NodeType::SPOT_LIGHT)
+	{
+		lcomp.setDistance(light.m_radius);
+		lcomp.setOuterAngle(light.m_outerAngle);
+		lcomp.setInnerAngle(light.m_innerAngle);
+	}
+
+	if(light.m_lensFlare != SceneBinaryFile::NONE)
+	{
+		ANKI_CHECK(static_cast<LightNode&>(node).loadLensFlare(getResourceFilename(light.m_lensFlare)));
+		LensFlareComponent& lfcomp = node.getComponent<LensFlareComponent>();
+
+		if(!!(info.m_flags & SceneBinaryFile::NodeFlag::LENS_FLARE_FIRST_SPRITE_SIZE))
+		{
+			lfcomp.setFirstFlareSize(Vec2(light.m_lensFlareFirstSpriteSize[0], light.m_lensFlareFirstSpriteSize[1]));
+		}
+
+		if(!!(info.m_flags & SceneBinaryFile::NodeFlag::LENS_FLARE_COLOR))
+		{
+			lfcomp.setColorMultiplier(Vec4(
+				light.m_lensFlareColor[0], light.m_lensFlareColor[1], light.m_lensFlareColor[2], light.m_lensFlareColor[3]));
+		}
+	}
+
+	if(!!(info.m_flags & SceneBinaryFile::NodeFlag::LIGHT_EVENT))
+	{
+		LightEvent* event;
+		ANKI_CHECK(m_scene->getEventManager().newEvent(event, 0.0, -1.0, &node));
+
+		if(!!(info.m_flags & SceneBinaryFile::NodeFlag::LIGHT_EVENT_INTENSITY))
+		{
+			event->setIntensityMultiplier(Vec4(light.m_eventIntensityMultiplier[0],
+				light.m_eventIntensityMultiplier[1],
+				light.m_eventIntensityMultiplier[2],
+				light.m_eventIntensityMultiplier[3]));
+		}
+
+		if(!!(info.m_flags & SceneBinaryFile::NodeFlag::LIGHT_EVENT_FREQUENCY))
+		{
+			event->setFrequency(light.m_eventFrequency[0], light.m_eventFrequency[1]);
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error SceneBinaryLoader::setupDecal(const SceneBinaryFile::Node& info, SceneNode& node)
+{
+	const SceneBinaryFile::Decal& decal = info.m_decal;
+	DecalComponent& comp = node.getComponent<DecalComponent>();
+
+	if(decal.m_atlases[0] != SceneBinaryFile::NONE)
+	{
+		ANKI_CHECK(comp.setDiffuseDecal(getResourceFilename(decal.m_atlases[0]),
+			getString(decal.m_subTextures[0]),
+			decal.m_blendFactors[0]));
+	}
+
+	if(decal.m_atlases[1] != SceneBinaryFile::NONE)
+	{
+		ANKI_CHECK(comp.setSpecularRoughnessDecal(getResourceFilename(decal.m_atlases[1]),
+			getString(decal.m_subTextures[1]),
+			decal.m_blendFactors[1]));
+	}
+
+	return Error::NONE;
+}
+
+Transform SceneBinaryLoader::getTransform(const SceneBinaryFile::Node& info)
+{
+	return Transform(Vec4(info.m_origin[0], info.m_origin[1], info.m_origin[2], 0.0f),
+		Mat3x4(&info.m_rotation[0]),
+		info.m_scale);
+}
+
+} // end namespace anki
@@ -0,0 +1,211 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/scene/Common.h>
+#include <anki/resource/Common.h>
+#include <anki/Math.h>
+#include <anki/util/Enum.h>
+#include <anki/util/DynamicArray.h>
+
+namespace anki
+{
+
+/// @addtogroup scene
+/// @{
+
+/// Information to decode scene binary files. It's the fast alternative to the scene scripts.
+/// The file layout is: Header, Resource array, Node array and then the string table. The strings are null terminated
+/// and they are referenced by their offset in the string table.
+class SceneBinaryFile
+{
+public:
+	static constexpr const char* MAGIC = "ANKISCN1";
+
+	/// Marks a missing string or resource.
+	static constexpr U32 NONE = MAX_U32;
+
+	enum class ResourceType : U32
+	{
+		MODEL,
+		COLLISION,
+		PARTICLE_EMITTER,
+		TEXTURE,
+		TEXTURE_ATLAS,
+
+		COUNT
+	};
+
+	enum class NodeType : U32
+	{
+		MODEL,
+		STATIC_COLLISION,
+		PARTICLE_EMITTER,
+		GPU_PARTICLE_EMITTER,
+		POINT_LIGHT,
+		SPOT_LIGHT,
+		DIRECTIONAL_LIGHT,
+		PERSPECTIVE_CAMERA,
+		REFLECTION_PROBE,
+		GLOBAL_ILLUMINATION_PROBE,
+		DECAL,
+
+		COUNT
+	};
+
+	enum class NodeFlag : U32
+	{
+		NONE = 0,
+		SHADOW_ENABLED = 1 << 0,
+		SHADOW_DISABLED = 1 << 1,
+		LENS_FLARE_FIRST_SPRITE_SIZE = 1 << 2,
+		LENS_FLARE_COLOR = 1 << 3,
+		LIGHT_EVENT = 1 << 4,
+		LIGHT_EVENT_INTENSITY = 1 << 5,
+		LIGHT_EVENT_FREQUENCY = 1 << 6,
+
+		ALL = SHADOW_ENABLED | SHADOW_DISABLED | LENS_FLARE_FIRST_SPRITE_SIZE | LENS_FLARE_COLOR | LIGHT_EVENT
+			  | LIGHT_EVENT_INTENSITY | LIGHT_EVENT_FREQUENCY
+	};
+	ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(NodeFlag, friend)
+
+	struct Resource
+	{
+		ResourceType m_type;
+		U32 m_filename; ///< Offset in the string table.
+	};
+
+	struct Light
+	{
+		Array<F32, 3> m_diffuseColor;
+		F32 m_radius; ///< The radius of point lights or the distance of spot lights.
+		F32 m_innerAngle;
+		F32 m_outerAngle;
+		U32 m_lensFlare; ///< Index of the lens flare texture or NONE.
+		Array<F32, 2> m_lensFlareFirstSpriteSize;
+		Array<F32, 4> m_lensFlareColor;
+		Array<F32, 4> m_eventIntensityMultiplier;
+		Array<F32, 2> m_eventFrequency; ///< Frequency and deviation.
+	};
+
+	struct Camera
+	{
+		F32 m_near;
+		F32 m_far;
+		F32 m_fovY; ///< The horizontal FOV is this times the aspect ratio.
+	};
+
+	struct Probe
+	{
+		Array<F32, 3> m_aabbMin; ///< In local space.
+		Array<F32, 3> m_aabbMax; ///< In local space.
+		F32 m_fadeDistance; ///< Negative to use the default.
+		F32 m_cellSize; ///< Negative to use the default.
+	};
+
+	struct Decal
+	{
+		Array<U32, 2> m_atlases; ///< Diffuse and specular/roughness atlas. Indices of resources or NONE.
+		Array<U32, 2> m_subTextures; ///< Offsets in the string table.
+		Array<F32, 2> m_blendFactors;
+	};
+
+	struct Node
+	{
+		NodeType m_type;
+		NodeFlag m_flags;
+		U32 m_name; ///< Offset in the string table.
+		U32 m_resource; ///< Index of the main resource of the node or NONE.
+
+		Array<F32, 3> m_origin;
+		Array<F32, 12> m_rotation; ///< A row major 3x4 matrix.
+		F32 m_scale;
+
+		union
+		{
+			Light m_light;
+			Camera m_camera;
+			Probe m_probe;
+			Decal m_decal;
+		};
+	};
+
+	struct Header
+	{
+		char m_magic[8]; ///< Magic word.
+		U32 m_resourceCount;
+		U32 m_nodeCount;
+		U32 m_stringTableSize;
+	};
+};
+
+/// Loads scene binary files. It kicks the loading of all the resources of the scene up front and then it creates the
+/// scene nodes in parallel using the ThreadHive of the SceneGraph.
+class SceneBinaryLoader
+{
+public:
+	SceneBinaryLoader(SceneGraph* scene);
+
+	~SceneBinaryLoader();
+
+	/// Load the file and create the nodes.
+	/// @param filename The filename of the scene.
+	/// @param cameraAspectRatio Used to compute the horizontal FOV of the cameras.
+	ANKI_USE_RESULT Error load(const CString& filename, F32 cameraAspectRatio);
+
+private:
+	/// Holds a reference to a resource of the file until all nodes are created.
+	class Resource
+	{
+	public:
+		ModelResourcePtr m_model;
+		CollisionResourcePtr m_collision;
+		ParticleEmitterResourcePtr m_particleEmitter;
+		TextureResourcePtr m_texture;
+		TextureAtlasResourcePtr m_textureAtlas;
+	};
+
+	SceneGraph* m_scene;
+	F32 m_cameraAspectRatio = 1.0f;
+
+	DynamicArrayAuto<SceneBinaryFile::Resource> m_resourceInfos;
+	DynamicArrayAuto<SceneBinaryFile::Node> m_nodeInfos;
+	DynamicArrayAuto<char> m_strings;
+
+	DynamicArrayAuto<Resource> m_resources;
+	DynamicArrayAuto<SceneNode*> m_nodes; ///< The nodes in the order of the file.
+
+	Atomic<U32> m_crntNode = {0};
+	Atomic<I32> m_errorInThread = {0};
+
+	ANKI_USE_RESULT Error loadFile(const CString& filename);
+	ANKI_USE_RESULT Error validate() const;
+	ANKI_USE_RESULT Error loadResources();
+	static U64 getResourceContentHash(const Resource& rsrc);
+	ANKI_USE_RESULT Error newNodes();
+	ANKI_USE_RESULT Error newNode(const SceneBinaryFile::Node& info, SceneNode*& node);
+	ANKI_USE_RESULT Error setupLight(const SceneBinaryFile::Node& info, SceneNode& node);
+	ANKI_USE_RESULT Error setupDecal(const SceneBinaryFile::Node& info, SceneNode& node);
+
+	/// Create nodes until there are no more. Runs in the ThreadHive.
+	void newNodesTask();
+
+	CString getString(U32 offset) const
+	{
+		ANKI_ASSERT(offset < m_strings.getSize());
+		return CString(&m_strings[offset]);
+	}
+
+	CString getResourceFilename(U32 resourceIdx) const
+	{
+		return getString(m_resourceInfos[resourceIdx].m_filename);
+	}
+
+	static Transform getTransform(const SceneBinaryFile::Node& info);
+};
+/// @}
+
+} // end namespace anki
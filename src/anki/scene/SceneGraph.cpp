@@ -8,10 +8,12 @@
 #include <anki/scene/PhysicsDebugNode.h>
 #include <anki/scene/ModelNode.h>
 #include <anki/scene/Octree.h>
+#include <anki/scene/SceneBinaryLoader.h>
 #include <anki/scene/components/FrustumComponent.h>
 #include <anki/physics/PhysicsWorld.h>
 #include <anki/resource/ResourceManager.h>
 #include <anki/renderer/MainRenderer.h>
+#include <anki/script/ScriptManager.h>
 #include <anki/core/ConfigSet.h>
 #include <anki/util/ThreadHive.h>
 #include <anki/util/Tracer.h>
@@ -25,6 +27,15 @@ ANKI_REGISTER_CONFIG_OPTION(
 	scene_reflectionProbeEffectiveDistance, 256.0, 1.0, MAX_F64, "How far reflection probes can look")
 ANKI_REGISTER_CONFIG_OPTION(
 	scene_reflectionProbeShadowEffectiveDistance, 32.0, 1.0, MAX_F64, "How far to render shadows for reflection probes")
+ANKI_REGISTER_CONFIG_OPTION(scene_dynamicShadowCasterFrameCount,
+	30,
+	0,
+	1000,
+	"Shadow casters that changed in the last N frames are dynamic and they are not cached. 0 disables the caching")
+ANKI_REGISTER_CONFIG_OPTION(
+	scene_asyncPhysics, 0, 0, 1, "Step the physics in parallel to the visibility. Results are visible in the next frame")
+ANKI_REGISTER_CONFIG_OPTION(
+	scene_sharedScriptEnvironments, 0, 0, 1, "Run the script components in shared LUA states, one per thread")
 
 const U NODE_UPDATE_BATCH = 10;
 
@@ -46,6 +57,12 @@ SceneGraph::SceneGraph()
 
 SceneGraph::~SceneGraph()
 {
+	if(m_physics)
+	{
+		const Error err = m_physics->endUpdate();
+		(void)err;
+	}
+
 	Error err = iterateSceneNodes([&](SceneNode& s) -> Error {
 		s.setMarkedForDeletion();
 		return Error::NONE;
@@ -85,6 +102,13 @@ Error SceneGraph::init(AllocAlignedCallback allocCb,
 	m_limits.m_reflectionProbeEffectiveDistance = config.getNumberF32("scene_reflectionProbeEffectiveDistance");
 	m_limits.m_reflectionProbeShadowEffectiveDistance =
 		config.getNumberF32("scene_reflectionProbeShadowEffectiveDistance");
+	m_limits.m_dynamicShadowCasterFrameCount = config.getNumberU32("scene_dynamicShadowCasterFrameCount");
+	m_asyncPhysics = config.getBool("scene_asyncPhysics");
+
+	if(config.getBool("scene_sharedScriptEnvironments") && !m_scriptManager->hasSharedEnvironments())
+	{
+		ANKI_CHECK(m_scriptManager->initSharedEnvironments(m_threadHive->getThreadCount()));
+	}
 
 	ANKI_CHECK(m_events.init(this));
 
@@ -108,6 +132,8 @@ Error SceneGraph::registerNode(SceneNode* node)
 {
 	ANKI_ASSERT(node);
 
+	LockGuard<Mutex> lock(m_nodesMtx);
+
 	// Add to dict if it has a name
 	if(node->getName())
 	{
@@ -147,6 +173,12 @@ void SceneGraph::unregisterNode(SceneNode* node)
 	}
 }
 
+Error SceneGraph::loadBinaryScene(const CString& filename, F32 cameraAspectRatio)
+{
+	SceneBinaryLoader loader(this);
+	return loader.load(filename, cameraAspectRatio);
+}
+
 SceneNode& SceneGraph::findSceneNode(const CString& name)
 {
 	SceneNode* node = tryFindSceneNode(name);
@@ -202,19 +234,31 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 	// Reset the framepool
 	m_frameAlloc.getMemoryPool().reset();
 
+	// Sync with the physics step that was kicked in the previous frame. Do that before deleting the nodes because the
+	// nodes might own physics objects
+	ANKI_CHECK(syncPhysics());
+	m_stats.m_physicsUpdate = m_physicsSyncTime;
+	m_physicsSyncTime = 0.0;
+
 	// Delete stuff
 	{
 		ANKI_TRACE_SCOPED_EVENT(SCENE_MARKED_FOR_DELETION);
+		if(m_objectsMarkedForDeletionCount.load() > 0)
+		{
+			// The events don't check their nodes every frame, tell them before the nodes go away
+			m_events.markEventsOfNodesMarkedForDeletion();
+		}
 		m_events.deleteEventsMarkedForDeletion();
 		deleteNodesMarkedForDeletion();
 	}
 
 	// Update
+	if(!m_asyncPhysics)
 	{
 		ANKI_TRACE_SCOPED_EVENT(SCENE_PHYSICS_UPDATE);
-		m_stats.m_physicsUpdate = HighRezTimer::getCurrentTime();
-		m_physics->update(crntTime - prevUpdateTime);
-		m_stats.m_physicsUpdate = HighRezTimer::getCurrentTime() - m_stats.m_physicsUpdate;
+		const Second startTime = HighRezTimer::getCurrentTime();
+		ANKI_CHECK(m_physics->update(crntTime - prevUpdateTime));
+		m_stats.m_physicsUpdate += HighRezTimer::getCurrentTime() - startTime;
 	}
 
 	{
@@ -247,10 +291,32 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		m_threadHive->waitAllTasks();
 	}
 
+	// Kick the physics step. It will run in parallel to the visibility tests and the nodes will see its results in the
+	// next frame
+	if(m_asyncPhysics)
+	{
+		m_physics->beginUpdate(crntTime - prevUpdateTime, *m_threadHive);
+	}
+
 	m_stats.m_updateTime = HighRezTimer::getCurrentTime() - m_stats.m_updateTime;
 	return Error::NONE;
 }
 
+Error SceneGraph::syncPhysics()
+{
+	if(!m_physics->isUpdateInFlight())
+	{
+		return Error::NONE;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(SCENE_PHYSICS_UPDATE);
+	const Second startTime = HighRezTimer::getCurrentTime();
+	ANKI_CHECK(m_physics->endUpdate());
+	m_physicsSyncTime += HighRezTimer::getCurrentTime() - startTime;
+
+	return Error::NONE;
+}
+
 void SceneGraph::doVisibilityTests(RenderQueue& rqueue)
 {
 	m_stats.m_visibilityTestsTime = HighRezTimer::getCurrentTime();
@@ -46,6 +46,7 @@ public:
 	F32 m_earlyZDistance = -1.0f; ///< Objects with distance lower than that will be used in early Z.
 	F32 m_reflectionProbeEffectiveDistance = -1.0f; ///< How far reflection probes can look.
 	F32 m_reflectionProbeShadowEffectiveDistance = -1.0f; ///< How far to render shadows for reflection probes.
+	U32 m_dynamicShadowCasterFrameCount = 0; ///< Shadow casters that changed that many frames ago are dynamic.
 };
 
 /// The scene graph that  all the scene entities
@@ -125,6 +126,10 @@ public:
 
 	ANKI_USE_RESULT Error update(Second prevUpdateTime, Second crntTime);
 
+	/// Wait for the physics step that the previous update() kicked. The physics objects can't be touched before that.
+	/// update() calls it anyway but call it earlier if something needs to touch the physics objects before update().
+	ANKI_USE_RESULT Error syncPhysics();
+
 	void doVisibilityTests(RenderQueue& rqueue);
 
 	SceneNode& findSceneNode(const CString& name);
@@ -150,10 +155,15 @@ public:
 	template<typename Func>
 	ANKI_USE_RESULT Error iterateSceneNodes(PtrSize begin, PtrSize end, Func func);
 
-	/// Create a new SceneNode
+	/// Create a new SceneNode. It's thread-safe but it shouldn't run in parallel with update().
 	template<typename Node, typename... Args>
 	ANKI_USE_RESULT Error newSceneNode(const CString& name, Node*& node, Args&&... args);
 
+	/// Load a scene binary file. See SceneBinaryLoader.
+	/// @param filename The filename of the scene.
+	/// @param cameraAspectRatio The aspect ratio of the cameras in the scene.
+	ANKI_USE_RESULT Error loadBinaryScene(const CString& filename, F32 cameraAspectRatio);
+
 	/// Delete a scene node. It actualy marks it for deletion
 	void deleteSceneNode(SceneNode* node)
 	{
@@ -222,6 +232,19 @@ public:
 		return m_nodesUuid.fetchAdd(1);
 	}
 
+	/// A hash of the static content of the scene. The renderer uses it to key the probes it stores on disk. Zero means
+	/// that the content is unknown and the probes won't be stored.
+	U64 getContentHash() const
+	{
+		return m_contentHash;
+	}
+
+	/// Set the content hash. Change it when the static content changes to force the probes to be rendered again.
+	void setContentHash(U64 hash)
+	{
+		m_contentHash = hash;
+	}
+
 	Octree& getOctree()
 	{
 		ANKI_ASSERT(m_octree);
@@ -248,6 +271,7 @@ private:
 	IntrusiveList<SceneNode> m_nodes;
 	U32 m_nodesCount = 0;
 	HashMap<CString, SceneNode*> m_nodesDict;
+	Mutex m_nodesMtx; ///< Protects the registration of new nodes. Nodes can be created from multiple threads.
 
 	SceneNode* m_mainCam = nullptr;
 	Timestamp m_activeCameraChangeTimestamp = 0;
@@ -263,10 +287,14 @@ private:
 	Atomic<U32> m_objectsMarkedForDeletionCount = {0};
 
 	Atomic<U64> m_nodesUuid = {1};
+	U64 m_contentHash = 0;
 
 	SceneGraphLimits m_limits;
 	SceneGraphStats m_stats;
 
+	Bool m_asyncPhysics = false;
+	Second m_physicsSyncTime = 0.0; ///< Time spent waiting for the physics step since the last update().
+
 	/// Put a node in the appropriate containers
 	ANKI_USE_RESULT Error registerNode(SceneNode* node);
 	void unregisterNode(SceneNode* node);
@@ -30,6 +30,7 @@ void SoftwareRasterizer::prepare(const Mat4& mv, const Mat4& p, U32 width, U32 h
 		m_zbuffer.destroy(m_alloc);
 		m_zbuffer.create(m_alloc, size);
 	}
+	static_assert(EMPTY_DEPTH == MAX_U32, "Cleared with memset");
 	memset(&m_zbuffer[0], 0xFF, sizeof(m_zbuffer[0]) * size);
 }
 
@@ -283,30 +284,28 @@ void SoftwareRasterizer::rasterizeTriangle(const Vec4* tri)
 				const F32 z1 = ndc[1].z();
 				const F32 z2 = ndc[2].z();
 
-				F32 depth = z0 * bc[0] + z1 * bc[1] + z2 * bc[2];
-				ANKI_ASSERT(depth >= 0.0 && depth <= 1.0);
-
-				// Clamp it to a bit less that 1.0f because 1.0f will produce a 0 depthi
-				depth = min(depth, 1.0f - EPSILON);
+				const F32 depth = z0 * bc[0] + z1 * bc[1] + z2 * bc[2];
 
 				// Store the min of the current value and new one
-				const U32 depthi = U32(depth * F32(MAX_U32));
+				const U32 depthi = packDepth(depth, true);
 				m_zbuffer[U32(y) * m_width + U32(x)].min(depthi);
 			}
 		}
 	}
 }
 
-Bool SoftwareRasterizer::visibilityTest(const Aabb& aabb) const
+Bool SoftwareRasterizer::visibilityTest(const Aabb& aabb, SoftwareRasterizerSourceBit& occludedBy) const
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_RASTERIZER_TEST);
-	Bool inside = visibilityTestInternal(aabb);
+	Bool inside = visibilityTestInternal(aabb, occludedBy);
 
 	return inside;
 }
 
-Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
+Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb, SoftwareRasterizerSourceBit& occludedBy) const
 {
+	occludedBy = SoftwareRasterizerSourceBit::NONE;
+
 	// Set the AABB points
 	const Vec4& minv = aabb.getMin();
 	const Vec4& maxv = aabb.getMax();
@@ -382,8 +381,15 @@ Bool SoftwareRasterizer::visibilityTestInternal(const Aabb& aabb) const
 			const F32 depthf = F32(depthi) / F32(MAX_U32);
 			if(minZ < depthf)
 			{
+				occludedBy = SoftwareRasterizerSourceBit::NONE;
 				return true;
 			}
+
+			if(depthi != EMPTY_DEPTH)
+			{
+				occludedBy |=
+					(depthi & 1u) ? SoftwareRasterizerSourceBit::OCCLUDERS : SoftwareRasterizerSourceBit::DEPTH_BUFFER;
+			}
 		}
 	}
 
@@ -397,13 +403,112 @@ void SoftwareRasterizer::fillDepthBuffer(ConstWeakArray<F32> depthValues)
 	U32 count = depthValues.getSize();
 	while(count--)
 	{
-		F32 depth = depthValues[count];
-		ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
+		m_zbuffer[count].setNonAtomically(packDepth(depthValues[count], false));
+	}
+}
+
+void SoftwareRasterizer::reprojectDepthBuffer(ConstWeakArray<F32> depthValues, const Mat4& prevViewProjMat)
+{
+	ANKI_ASSERT(depthValues.getSize() == m_width * m_height);
+
+	const Mat4 reprojMat = m_mvp * prevViewProjMat.getInverse();
+	const Vec2 windowSize{F32(m_width), F32(m_height)};
 
-		depth = min(depth, 1.0f - EPSILON); // See a few lines above why is that
+	// Negative means that nothing landed to a texel
+	DynamicArrayAuto<F32> reprojected(m_alloc, m_width * m_height, -1.0f);
 
-		const U32 depthi = U32(depth * F32(MAX_U32));
-		m_zbuffer[count].setNonAtomically(depthi);
+	for(U32 y = 0; y < m_height; ++y)
+	{
+		for(U32 x = 0; x < m_width; ++x)
+		{
+			const F32 depth = depthValues[y * m_width + x];
+			ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
+			if(depth >= 1.0f)
+			{
+				// Nothing there, won't occlude anything
+				continue;
+			}
+
+			// Reproject the corners of the texel. The texel's depth is the max depth of its area so use it for all
+			Array<Vec2, 4> window;
+			Vec2 bboxMin(MAX_F32), bboxMax(MIN_F32);
+			F32 maxDepth = 0.0f;
+			Bool behindCamera = false;
+			for(U32 i = 0; i < 4 && !behindCamera; ++i)
+			{
+				const U32 corner = (i == 2) ? 3 : ((i == 3) ? 2 : i); // Walk the corners in order
+				const Vec2 ndc = Vec2(F32(x + (corner & 1)), F32(y + (corner >> 1))) / windowSize * 2.0f - 1.0f;
+				const Vec4 clip = reprojMat * Vec4(ndc, depth, 1.0f);
+
+				behindCamera = clip.w() <= 0.0f;
+				const Vec3 newNdc = clip.xyz() / clip.w();
+
+				window[i] = (newNdc.xy() / 2.0f + 0.5f) * windowSize;
+				bboxMin = bboxMin.min(window[i]);
+				bboxMax = bboxMax.max(window[i]);
+				maxDepth = max(maxDepth, newNdc.z());
+			}
+
+			if(behindCamera || maxDepth <= 0.0f)
+			{
+				// The texel moved behind the camera, skip it
+				continue;
+			}
+
+			maxDepth = min(maxDepth, 1.0f);
+
+			// Iterate the texels whose centers are inside the reprojected texel
+			const U32 minx = U32(clamp(std::floor(bboxMin.x()), 0.0f, windowSize.x()));
+			const U32 maxx = U32(clamp(std::ceil(bboxMax.x()), 0.0f, windowSize.x()));
+			const U32 miny = U32(clamp(std::floor(bboxMin.y()), 0.0f, windowSize.y()));
+			const U32 maxy = U32(clamp(std::ceil(bboxMax.y()), 0.0f, windowSize.y()));
+			for(U32 ny = miny; ny < maxy; ++ny)
+			{
+				for(U32 nx = minx; nx < maxx; ++nx)
+				{
+					const Vec2 p(F32(nx) + 0.5f, F32(ny) + 0.5f);
+					Vec3 bc;
+					if(computeBarycetrinc(window[0], window[1], window[2], p, bc)
+						&& computeBarycetrinc(window[0], window[2], window[3], p, bc))
+					{
+						// Outside both triangles of the quad
+						continue;
+					}
+
+					// Where more than one texels land keep the farthest, it's conservative
+					F32& texel = reprojected[ny * m_width + nx];
+					texel = max(texel, maxDepth);
+				}
+			}
+		}
+	}
+
+	// Store to the z buffer. The texels that didn't get any value are either disocclusions or cracks between the
+	// reprojected texels. Fill the cracks with the farthest of their neighbours and leave the rest empty
+	for(U32 y = 0; y < m_height; ++y)
+	{
+		for(U32 x = 0; x < m_width; ++x)
+		{
+			F32 depth = reprojected[y * m_width + x];
+
+			if(depth < 0.0f && x > 0 && x + 1 < m_width && y > 0 && y + 1 < m_height)
+			{
+				const F32 left = reprojected[y * m_width + x - 1];
+				const F32 right = reprojected[y * m_width + x + 1];
+				const F32 top = reprojected[(y - 1) * m_width + x];
+				const F32 bottom = reprojected[(y + 1) * m_width + x];
+
+				if(left >= 0.0f && right >= 0.0f && top >= 0.0f && bottom >= 0.0f)
+				{
+					depth = max(max(left, right), max(top, bottom));
+				}
+			}
+
+			if(depth >= 0.0f)
+			{
+				m_zbuffer[y * m_width + x].setNonAtomically(packDepth(depth, false));
+			}
+		}
 	}
 }
 
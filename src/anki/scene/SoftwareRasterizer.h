@@ -9,6 +9,7 @@
 #include <anki/Math.h>
 #include <anki/collision/Plane.h>
 #include <anki/util/WeakArray.h>
+#include <anki/util/Enum.h>
 
 namespace anki
 {
@@ -16,6 +17,15 @@ namespace anki
 /// @addtogroup scene
 /// @{
 
+/// The sources of the depth values of the SoftwareRasterizer.
+enum class SoftwareRasterizerSourceBit : U8
+{
+	NONE = 0,
+	DEPTH_BUFFER = 1 << 0, ///< The depth buffer of the renderer.
+	OCCLUDERS = 1 << 1, ///< Triangles of the occluders.
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(SoftwareRasterizerSourceBit, inline)
+
 /// Software rasterizer for visibility tests.
 class SoftwareRasterizer
 {
@@ -49,10 +59,26 @@ public:
 	/// Fill the depth buffer with some values.
 	void fillDepthBuffer(ConstWeakArray<F32> depthValues);
 
+	/// Fill the depth buffer with the depth values of a previous frame. The values are reprojected to the current
+	/// view-projection. The texels that are not covered by any value are left empty unless they are small cracks.
+	/// @param depthValues The depth values. They should have the size that was passed to prepare().
+	/// @param prevViewProjMat The view projection matrix that was used to render the depthValues.
+	void reprojectDepthBuffer(ConstWeakArray<F32> depthValues, const Mat4& prevViewProjMat);
+
+	/// Perform visibility tests.
+	/// @param aabb The Aabb in of the cs in world space.
+	/// @return Return true if it's visible and false otherwise.
+	Bool visibilityTest(const Aabb& aabb) const
+	{
+		SoftwareRasterizerSourceBit occludedBy;
+		return visibilityTest(aabb, occludedBy);
+	}
+
 	/// Perform visibility tests.
 	/// @param aabb The Aabb in of the cs in world space.
+	/// @param[out] occludedBy The sources of the depth values that occluded the aabb. Valid if it's not visible.
 	/// @return Return true if it's visible and false otherwise.
-	Bool visibilityTest(const Aabb& aabb) const;
+	Bool visibilityTest(const Aabb& aabb, SoftwareRasterizerSourceBit& occludedBy) const;
 
 private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
@@ -63,7 +89,25 @@ private:
 	Array<Plane, 6> m_planesW; ///< In world space.
 	U32 m_width;
 	U32 m_height;
-	DynamicArray<Atomic<U32>> m_zbuffer;
+	DynamicArray<Atomic<U32>> m_zbuffer; ///< The LSB of the values is the source. 0 for depth buffers.
+
+	/// The value of the texels that didn't get any depth. It's the far plane and it has no source. packDepth() never
+	/// returns it.
+	static constexpr U32 EMPTY_DEPTH = MAX_U32;
+
+	/// Quantize a depth value and tag it with its source.
+	static U32 packDepth(F32 depth, Bool fromOccluders)
+	{
+		ANKI_ASSERT(depth >= 0.0f && depth <= 1.0f);
+
+		// Clamp it to a bit less that 1.0f because 1.0f will produce a 0 depthi
+		depth = min(depth, 1.0f - EPSILON);
+
+		const U32 depthi = U32(depth * F32(MAX_U32));
+		const U32 packed = (depthi & ~1u) | U32(fromOccluders);
+		ANKI_ASSERT(packed != EMPTY_DEPTH);
+		return packed;
+	}
 
 	/// @param tri In clip space.
 	void rasterizeTriangle(const Vec4* tri);
@@ -74,7 +118,7 @@ private:
 	/// @note Triangles in view space.
 	void clipTriangle(const Vec4* inTriangle, Vec4* outTriangles, U& outTriangleCount) const;
 
-	Bool visibilityTestInternal(const Aabb& aabb) const;
+	Bool visibilityTestInternal(const Aabb& aabb, SoftwareRasterizerSourceBit& occludedBy) const;
 };
 /// @}
 
@@ -149,7 +149,8 @@ void FillRasterizerWithCoverageTask::fill()
 	ConstWeakArray<F32> depthBuff;
 	U32 width;
 	U32 height;
-	m_frcCtx->m_frc->getCoverageBufferInfo(depthBuff, width, height);
+	Mat4 depthBuffViewProjMat;
+	m_frcCtx->m_frc->getCoverageBufferInfo(depthBuff, width, height, depthBuffViewProjMat);
 	ANKI_ASSERT(width > 0 && height > 0 && depthBuff.getSize() > 0);
 
 	// Init the rasterizer
@@ -157,8 +158,27 @@ void FillRasterizerWithCoverageTask::fill()
 	m_frcCtx->m_r->init(alloc);
 	m_frcCtx->m_r->prepare(m_frcCtx->m_frc->getViewMatrix(), m_frcCtx->m_frc->getProjectionMatrix(), width, height);
 
-	// Do the work
-	m_frcCtx->m_r->fillDepthBuffer(depthBuff);
+	// The C-Buffer is a few frames old, reproject it to the current frame
+	m_frcCtx->m_r->reprojectDepthBuffer(depthBuff, depthBuffViewProjMat);
+
+	// Rasterize the occluders on top of it to cover what the C-Buffer missed. Gather them from the octree
+	const U32 testIdx = m_frcCtx->m_visCtx->m_testsCount.fetchAdd(1);
+	m_frcCtx->m_visCtx->m_scene->getOctree().walkTree(testIdx,
+		[&](const Aabb& box) { return m_frcCtx->m_frc->insideFrustum(box); },
+		[&](void* placeableUserData) {
+			ANKI_ASSERT(placeableUserData);
+			const SpatialComponent& scomp = *static_cast<const SpatialComponent*>(placeableUserData);
+
+			const OccluderComponent* occluder = scomp.getSceneNode().tryGetComponent<OccluderComponent>();
+			if(occluder && m_frcCtx->m_frc->insideFrustum(occluder->getBoundingVolume()))
+			{
+				const Vec3* verts;
+				U32 vertCount;
+				U32 stride;
+				occluder->getVertices(verts, vertCount, stride);
+				m_frcCtx->m_r->draw(&verts[0][0], vertCount, stride, true);
+			}
+		});
 }
 
 void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
@@ -364,6 +384,12 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		WeakArray<RenderQueue> nextQueues;
 		WeakArray<FrustumComponent> nextQueueFrustumComponents; // Optional
 
+		// Shadow casters that changed recently are dynamic. They will be rendered on top of the cached static ones
+		const Bool dynamicShadowCaster =
+			wantsShadowCasters && rc && m_frcCtx->m_visCtx->m_dynamicShadowCasterFrameCount > 0
+			&& node.getComponentMaxTimestamp() + m_frcCtx->m_visCtx->m_dynamicShadowCasterFrameCount
+				   > m_frcCtx->m_visCtx->m_scene->getGlobalTimestamp();
+
 		if(rc)
 		{
 			RenderableQueueElement* el;
@@ -371,6 +397,10 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			{
 				el = result.m_forwardShadingRenderables.newElement(alloc);
 			}
+			else if(dynamicShadowCaster)
+			{
+				el = result.m_dynamicShadowRenderables.newElement(alloc);
+			}
 			else
 			{
 				el = result.m_renderables.newElement(alloc);
@@ -537,7 +567,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		if(reflc)
 		{
 			ReflectionProbeQueueElement* el = result.m_reflectionProbes.newElement(alloc);
-			reflc->setupReflectionProbeQueueElement(*el);
+			reflc->setupReflectionProbeQueueElement(*el, m_frcCtx->m_visCtx->m_scene->getContentHash());
 
 			if(reflc->getMarkedForRendering())
 			{
@@ -572,7 +602,7 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		if(giprobec)
 		{
 			GlobalIlluminationProbeQueueElement* el = result.m_giProbes.newElement(alloc);
-			giprobec->setupGlobalIlluminationProbeQueueElement(*el);
+			giprobec->setupGlobalIlluminationProbeQueueElement(*el, m_frcCtx->m_visCtx->m_scene->getContentHash());
 
 			if(giprobec->getMarkedForRendering())
 			{
@@ -620,8 +650,11 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			}
 		}
 
-		// Update timestamp
-		timestamp = max(timestamp, node.getComponentMaxTimestamp());
+		// Update timestamp. The dynamic shadow casters are not cached so skip them
+		if(!dynamicShadowCaster)
+		{
+			timestamp = max(timestamp, node.getComponentMaxTimestamp());
+		}
 	} // end for
 }
 
@@ -674,6 +707,19 @@ void CombineResultsTask::combine()
 	}
 
 	ANKI_VIS_COMBINE(RenderableQueueElement, m_renderables);
+	WeakArray<RenderableQueueElement> dynamicShadowRenderables;
+	{
+		Array<TRenderQueueElementStorage<RenderableQueueElement>, 64> subStorages;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			subStorages[i] = m_frcCtx->m_queueViews[i].m_dynamicShadowRenderables;
+		}
+		combineQueueElements<RenderableQueueElement>(alloc,
+			WeakArray<TRenderQueueElementStorage<RenderableQueueElement>>(&subStorages[0], threadCount),
+			nullptr,
+			dynamicShadowRenderables,
+			nullptr);
+	}
 	ANKI_VIS_COMBINE(RenderableQueueElement, m_earlyZRenderables);
 	ANKI_VIS_COMBINE(RenderableQueueElement, m_forwardShadingRenderables);
 	ANKI_VIS_COMBINE_AND_PTR(PointLightQueueElement, m_pointLights, m_shadowPointLights);
@@ -711,6 +757,28 @@ void CombineResultsTask::combine()
 	// Sort some of the arrays
 	std::sort(results.m_renderables.getBegin(), results.m_renderables.getEnd(), MaterialDistanceSortFunctor(20.0f));
 
+	// Put the dynamic shadow casters after the static ones
+	results.m_staticShadowRenderableCount = results.m_renderables.getSize();
+	if(dynamicShadowRenderables.getSize() > 0)
+	{
+		std::sort(dynamicShadowRenderables.getBegin(),
+			dynamicShadowRenderables.getEnd(),
+			MaterialDistanceSortFunctor(20.0f));
+
+		const U32 staticCount = results.m_renderables.getSize();
+		const U32 totalCount = staticCount + dynamicShadowRenderables.getSize();
+		RenderableQueueElement* renderables = alloc.newArray<RenderableQueueElement>(totalCount);
+		if(staticCount > 0)
+		{
+			memcpy(renderables, results.m_renderables.getBegin(), sizeof(RenderableQueueElement) * staticCount);
+		}
+		memcpy(renderables + staticCount,
+			dynamicShadowRenderables.getBegin(),
+			sizeof(RenderableQueueElement) * dynamicShadowRenderables.getSize());
+
+		results.m_renderables = WeakArray<RenderableQueueElement>(renderables, totalCount);
+	}
+
 	std::sort(results.m_earlyZRenderables.getBegin(),
 		results.m_earlyZRenderables.getEnd(),
 		DistanceSortFunctor<RenderableQueueElement>());
@@ -833,6 +901,7 @@ void SceneGraph::doVisibilityTests(SceneNode& fsn, SceneGraph& scene, RenderQueu
 	VisibilityContext ctx;
 	ctx.m_scene = &scene;
 	ctx.m_earlyZDist = scene.getLimits().m_earlyZDistance;
+	ctx.m_dynamicShadowCasterFrameCount = scene.getLimits().m_dynamicShadowCasterFrameCount;
 	ctx.submitNewWork(fsn.getComponent<FrustumComponent>(), rqueue, hive);
 
 	hive.waitAllTasks();
@@ -104,6 +104,7 @@ class RenderQueueView
 {
 public:
 	TRenderQueueElementStorage<RenderableQueueElement> m_renderables; ///< Deferred shading or shadow renderables.
+	TRenderQueueElementStorage<RenderableQueueElement> m_dynamicShadowRenderables;
 	TRenderQueueElementStorage<RenderableQueueElement> m_forwardShadingRenderables;
 	TRenderQueueElementStorage<RenderableQueueElement> m_earlyZRenderables;
 	TRenderQueueElementStorage<PointLightQueueElement> m_pointLights;
@@ -136,6 +137,7 @@ public:
 	Atomic<U32> m_testsCount = {0};
 
 	F32 m_earlyZDist = -1.0f; ///< Cache this.
+	U32 m_dynamicShadowCasterFrameCount = 0; ///< Cache this.
 
 	List<const FrustumComponent*> m_testedFrcs;
 	Mutex m_mtx;
@@ -225,7 +227,39 @@ public:
 private:
 	ANKI_USE_RESULT Bool testAgainstRasterizer(const Aabb& aabb) const
 	{
-		return (m_frcCtx->m_r) ? m_frcCtx->m_r->visibilityTest(aabb) : true;
+		if(!m_frcCtx->m_r)
+		{
+			return true;
+		}
+
+		SoftwareRasterizerSourceBit occludedBy;
+		const Bool visible = m_frcCtx->m_r->visibilityTest(aabb, occludedBy);
+
+		if(!visible)
+		{
+			// Count who culled it
+			if(occludedBy == SoftwareRasterizerSourceBit::DEPTH_BUFFER)
+			{
+				ANKI_TRACE_INC_COUNTER(SCENE_VIS_CULLED_BY_DEPTH_BUFFER, 1);
+			}
+			else if(occludedBy == SoftwareRasterizerSourceBit::OCCLUDERS)
+			{
+				ANKI_TRACE_INC_COUNTER(SCENE_VIS_CULLED_BY_OCCLUDERS, 1);
+			}
+			else if(occludedBy
+					== (SoftwareRasterizerSourceBit::DEPTH_BUFFER | SoftwareRasterizerSourceBit::OCCLUDERS))
+			{
+				ANKI_TRACE_INC_COUNTER(SCENE_VIS_CULLED_BY_DEPTH_BUFFER_AND_OCCLUDERS, 1);
+			}
+			else
+			{
+				// Culled without touching any texel, it fell outside the window
+				ANKI_ASSERT(occludedBy == SoftwareRasterizerSourceBit::NONE);
+				ANKI_TRACE_INC_COUNTER(SCENE_VIS_CULLED_OUTSIDE_RASTERIZER, 1);
+			}
+		}
+
+		return visible;
 	}
 };
 static_assert(std::is_trivially_destructible<VisibilityTestTask>::value == true, "Should be trivially destructible");
@@ -139,7 +139,8 @@ Bool FrustumComponent::updateInternal()
 	return updated;
 }
 
-void FrustumComponent::fillCoverageBufferCallback(void* userData, F32* depthValues, U32 width, U32 height)
+void FrustumComponent::fillCoverageBufferCallback(
+	void* userData, F32* depthValues, U32 width, U32 height, const Mat4& viewProjMat)
 {
 	ANKI_ASSERT(userData && depthValues && width > 0 && height > 0);
 	FrustumComponent& self = *static_cast<FrustumComponent*>(userData);
@@ -150,6 +151,7 @@ void FrustumComponent::fillCoverageBufferCallback(void* userData, F32* depthValu
 
 	self.m_coverageBuff.m_depthMapWidth = width;
 	self.m_coverageBuff.m_depthMapHeight = height;
+	self.m_coverageBuff.m_viewProjMat = viewProjMat;
 }
 
 void FrustumComponent::setEnabledVisibilityTests(FrustumComponentVisibilityTestFlag bits)
@@ -216,25 +216,29 @@ public:
 	}
 
 	/// The type is FillCoverageBufferCallback.
-	static void fillCoverageBufferCallback(void* userData, F32* depthValues, U32 width, U32 height);
+	static void fillCoverageBufferCallback(
+		void* userData, F32* depthValues, U32 width, U32 height, const Mat4& viewProjMat);
 
 	Bool hasCoverageBuffer() const
 	{
 		return m_coverageBuff.m_depthMap.getSize() > 0;
 	}
 
-	void getCoverageBufferInfo(ConstWeakArray<F32>& depthBuff, U32& width, U32& height) const
+	/// @param[out] viewProjMat The view projection matrix that was used to render the depthBuff.
+	void getCoverageBufferInfo(ConstWeakArray<F32>& depthBuff, U32& width, U32& height, Mat4& viewProjMat) const
 	{
 		if(m_coverageBuff.m_depthMap.getSize() > 0)
 		{
 			depthBuff = ConstWeakArray<F32>(&m_coverageBuff.m_depthMap[0], m_coverageBuff.m_depthMap.getSize());
 			width = m_coverageBuff.m_depthMapWidth;
 			height = m_coverageBuff.m_depthMapHeight;
+			viewProjMat = m_coverageBuff.m_viewProjMat;
 		}
 		else
 		{
 			depthBuff = ConstWeakArray<F32>();
 			width = height = 0;
+			viewProjMat = Mat4::getIdentity();
 		}
 	}
 
@@ -327,6 +331,7 @@ private:
 		DynamicArray<F32> m_depthMap;
 		U32 m_depthMapWidth = 0;
 		U32 m_depthMapHeight = 0;
+		Mat4 m_viewProjMat = Mat4::getIdentity();
 	} m_coverageBuff; ///< Coverage buffer for extra visibility tests.
 
 	FrustumComponentVisibilityTestFlag m_flags = FrustumComponentVisibilityTestFlag::NONE;
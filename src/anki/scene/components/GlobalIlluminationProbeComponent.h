@@ -7,6 +7,7 @@
 
 #include <anki/scene/components/SceneComponent.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -97,9 +98,17 @@ public:
 		m_drawCallbackUserData = userData;
 	}
 
-	void setupGlobalIlluminationProbeQueueElement(GlobalIlluminationProbeQueueElement& el)
+	/// @param sceneContentHash See SceneGraph::getContentHash.
+	void setupGlobalIlluminationProbeQueueElement(GlobalIlluminationProbeQueueElement& el, U64 sceneContentHash)
 	{
 		el.m_uuid = m_uuid;
+		el.m_contentHash = 0;
+		if(sceneContentHash)
+		{
+			const Array<Vec3, 2> placement = {{m_aabbMin, m_aabbMax}};
+			el.m_contentHash = appendHash(&placement[0], sizeof(placement), sceneContentHash);
+			el.m_contentHash = appendHash(&m_cellCounts, sizeof(m_cellCounts), el.m_contentHash);
+		}
 		el.m_feedbackCallback = giProbeQueueElementFeedbackCallback;
 		el.m_feedbackCallbackUserData = this;
 		el.m_debugDrawCallback = m_drawCallback;
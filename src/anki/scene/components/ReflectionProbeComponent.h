@@ -7,6 +7,7 @@
 
 #include <anki/scene/components/SceneComponent.h>
 #include <anki/renderer/RenderQueue.h>
+#include <anki/util/Hash.h>
 
 namespace anki
 {
@@ -63,13 +64,20 @@ public:
 		m_drawCallbackUserData = userData;
 	}
 
-	void setupReflectionProbeQueueElement(ReflectionProbeQueueElement& el) const
+	/// @param sceneContentHash See SceneGraph::getContentHash.
+	void setupReflectionProbeQueueElement(ReflectionProbeQueueElement& el, U64 sceneContentHash) const
 	{
 		ANKI_ASSERT(m_aabbMin < m_aabbMax);
 		ANKI_ASSERT(m_pos > m_aabbMin && m_pos < m_aabbMax);
 		el.m_feedbackCallback = reflectionProbeQueueElementFeedbackCallback;
 		el.m_feedbackCallbackUserData = const_cast<ReflectionProbeComponent*>(this);
 		el.m_uuid = m_uuid;
+		el.m_contentHash = 0;
+		if(sceneContentHash)
+		{
+			const Array<Vec3, 3> placement = {{m_pos, m_aabbMin, m_aabbMax}};
+			el.m_contentHash = appendHash(&placement[0], sizeof(placement), sceneContentHash);
+		}
 		el.m_worldPosition = m_pos;
 		el.m_aabbMin = m_aabbMin;
 		el.m_aabbMax = m_aabbMax;
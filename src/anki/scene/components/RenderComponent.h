@@ -47,6 +47,13 @@ public:
 		m_flags = flags;
 	}
 
+	/// See RenderableQueueElement::m_cost.
+	void setCost(F32 cost)
+	{
+		ANKI_ASSERT(cost > 0.0f);
+		m_cost = cost;
+	}
+
 	void setup(RenderQueueDrawCallback callback, const void* userData, U64 mergeKey)
 	{
 		ANKI_ASSERT(callback != nullptr);
@@ -65,12 +72,14 @@ public:
 		el.m_userData = m_userData;
 		ANKI_ASSERT(el.m_mergeKey != MAX_U64);
 		el.m_mergeKey = m_mergeKey;
+		el.m_cost = m_cost;
 	}
 
 private:
 	RenderQueueDrawCallback m_callback ANKI_DEBUG_CODE(= nullptr);
 	const void* m_userData ANKI_DEBUG_CODE(= nullptr);
 	U64 m_mergeKey ANKI_DEBUG_CODE(= MAX_U64);
+	F32 m_cost = 1.0f;
 	RenderComponentFlag m_flags = RenderComponentFlag::NONE;
 };
 
@@ -22,6 +22,11 @@ ScriptComponent::ScriptComponent(SceneNode* node)
 
 ScriptComponent::~ScriptComponent()
 {
+	if(m_sharedEnv && m_sharedEnvTableRef != LUA_NOREF)
+	{
+		LockGuard<Mutex> lock(m_sharedEnv->getMutex());
+		luaL_unref(&m_sharedEnv->getLuaState(), LUA_REGISTRYINDEX, m_sharedEnvTableRef);
+	}
 }
 
 Error ScriptComponent::load(CString fname)
@@ -29,11 +34,23 @@ Error ScriptComponent::load(CString fname)
 	// Load
 	ANKI_CHECK(m_node->getSceneGraph().getResourceManager().loadResource(fname, m_script));
 
-	// Create the env
-	ANKI_CHECK(m_env.init(&m_node->getSceneGraph().getScriptManager()));
+	ScriptManager& scriptManager = m_node->getSceneGraph().getScriptManager();
+	if(scriptManager.hasSharedEnvironments())
+	{
+		// Exec the script in a new environment table of a shared env
+		m_sharedEnv = &scriptManager.getNextSharedEnvironment();
+		LockGuard<Mutex> lock(m_sharedEnv->getMutex());
+		ANKI_CHECK(LuaBinder::evalBytecodeInNewEnvironment(
+			&m_sharedEnv->getLuaState(), m_script->getBytecode(), fname, m_sharedEnvTableRef));
+	}
+	else
+	{
+		// Create the env
+		ANKI_CHECK(m_env.init(&scriptManager));
 
-	// Exec the script
-	ANKI_CHECK(m_env.evalString(m_script->getSource()));
+		// Exec the script
+		ANKI_CHECK(m_env.evalBytecode(m_script->getBytecode(), fname));
+	}
 
 	return Error::NONE;
 }
@@ -42,11 +59,32 @@ Error ScriptComponent::update(SceneNode& node, Second prevTime, Second crntTime,
 {
 	ANKI_ASSERT(&node == m_node);
 	updated = false;
-	lua_State* lua = &m_env.getLuaState();
 
-	// Push function name
-	lua_getglobal(lua, "update");
+	if(m_sharedEnv)
+	{
+		LockGuard<Mutex> lock(m_sharedEnv->getMutex());
+		lua_State* lua = &m_sharedEnv->getLuaState();
+
+		// Push the function from the environment table of the script
+		lua_rawgeti(lua, LUA_REGISTRYINDEX, m_sharedEnvTableRef);
+		lua_getfield(lua, -1, "update");
+		lua_remove(lua, -2);
 
+		return callUpdate(lua, node, prevTime, crntTime, updated);
+	}
+	else
+	{
+		lua_State* lua = &m_env.getLuaState();
+
+		// Push function name
+		lua_getglobal(lua, "update");
+
+		return callUpdate(lua, node, prevTime, crntTime, updated);
+	}
+}
+
+Error ScriptComponent::callUpdate(lua_State* lua, SceneNode& node, Second prevTime, Second crntTime, Bool& updated)
+{
 	// Push args
 	LuaBinder::pushVariableToTheStack(lua, &node);
 	lua_pushnumber(lua, prevTime);
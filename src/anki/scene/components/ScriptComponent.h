@@ -15,7 +15,8 @@ namespace anki
 /// @addtogroup scene
 /// @{
 
-/// Component of scripts.
+/// Component of scripts. The script either gets its own LUA state or it runs in an environment table of a state that it
+/// shares with other scripts (see ScriptManager::initSharedEnvironments).
 class ScriptComponent : public SceneComponent
 {
 public:
@@ -32,7 +33,13 @@ public:
 private:
 	SceneNode* m_node;
 	ScriptResourcePtr m_script;
-	ScriptEnvironment m_env;
+	ScriptEnvironment m_env; ///< Used if there is no shared environment.
+	SharedScriptEnvironment* m_sharedEnv = nullptr;
+	I32 m_sharedEnvTableRef = LUA_NOREF; ///< The environment table of the script in the shared environment.
+
+	/// Call the "update" function that is at the top of the stack.
+	static ANKI_USE_RESULT Error callUpdate(
+		lua_State* lua, SceneNode& node, Second prevTime, Second crntTime, Bool& updated);
 };
 /// @}
 
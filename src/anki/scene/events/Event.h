@@ -121,6 +121,10 @@ protected:
 	/// Return the u between current time and when the event started
 	/// @return A number [0.0, 1.0]
 	Second getDelta(Second crntTime) const;
+
+private:
+	IntrusiveList<Event>* m_list = nullptr; ///< The list of the EventManager the event is in.
+	U64 m_sequence = 0; ///< Events that start in the same tick are updated in the order they were created.
 };
 /// @}
 
@@ -6,21 +6,43 @@
 #include <anki/scene/events/EventManager.h>
 #include <anki/scene/events/Event.h>
 #include <anki/scene/SceneGraph.h>
+#include <anki/util/ThreadHive.h>
 
 namespace anki
 {
 
+/// Updates the events of one bucket in the ThreadHive.
+class EventManager::UpdateEventsTask
+{
+public:
+	EventManager* m_manager;
+	ConstWeakArray<Event*> m_events;
+	Second m_prevUpdateTime;
+	Second m_crntTime;
+	Atomic<I32>* m_errorInThread;
+
+	void update()
+	{
+		const Error err = m_manager->updateEvents(m_events, m_prevUpdateTime, m_crntTime);
+		if(err)
+		{
+			m_errorInThread->store(err._getCode());
+		}
+	}
+};
+
 EventManager::EventManager()
 {
 }
 
 EventManager::~EventManager()
 {
-	while(!m_events.isEmpty())
-	{
-		Event* event = &m_events.getFront();
-		event->setMarkedForDeletion();
-	}
+	iterateEventLists([&](IntrusiveList<Event>& list) {
+		while(!list.isEmpty())
+		{
+			list.getFront().setMarkedForDeletion();
+		}
+	});
 
 	deleteEventsMarkedForDeletion();
 }
@@ -42,68 +64,293 @@ SceneFrameAllocator<U8> EventManager::getFrameAllocator() const
 	return m_scene->getFrameAllocator();
 }
 
-Error EventManager::updateAllEvents(Second prevUpdateTime, Second crntTime)
+template<typename TFunc>
+void EventManager::iterateEventLists(TFunc func)
 {
-	Error err = Error::NONE;
+	func(m_newEvents);
+	func(m_activeEvents);
 
-	auto it = m_events.getBegin();
-	auto end = m_events.getEnd();
-	for(; it != end && !err; ++it)
+	for(auto& level : m_wheel)
 	{
-		Event& event = *it;
+		for(IntrusiveList<Event>& slot : level)
+		{
+			func(slot);
+		}
+	}
+
+	func(m_farEvents);
+}
 
-		// If event or the node's event is marked for deletion then dont do anything else for that event
-		if(event.getMarkedForDeletion())
+void EventManager::pushBack(IntrusiveList<Event>& list, Event* event)
+{
+	ANKI_ASSERT(event && event->m_list == nullptr);
+	list.pushBack(event);
+	event->m_list = &list;
+}
+
+void EventManager::insertSorted(IntrusiveList<Event>& list, Event* event)
+{
+	ANKI_ASSERT(event && event->m_list == nullptr);
+
+	// Most events are added in creation order so search from the back
+	auto it = list.getEnd();
+	while(it != list.getBegin())
+	{
+		auto prev = it;
+		--prev;
+		if(prev->m_sequence < event->m_sequence)
 		{
-			continue;
+			break;
+		}
+
+		it = prev;
+	}
+
+	list.insert(it, event);
+	event->m_list = &list;
+}
+
+void EventManager::erase(Event* event)
+{
+	ANKI_ASSERT(event && event->m_list);
+	event->m_list->erase(event);
+	event->m_list = nullptr;
+}
+
+void EventManager::schedule(Event* event, Second crntTime)
+{
+	ANKI_ASSERT(event);
+
+	if(event->m_startTime <= crntTime || computeTick(event->m_startTime) <= m_crntTick)
+	{
+		// Starts now or during the current tick
+		pushBack(m_activeEvents, event);
+	}
+	else
+	{
+		scheduleInWheel(event);
+	}
+}
+
+void EventManager::scheduleInWheel(Event* event)
+{
+	ANKI_ASSERT(event);
+
+	const U64 tick = max(computeTick(event->m_startTime), m_crntTick);
+
+	// Find the first level that covers the distance
+	const U64 delta = tick - m_crntTick;
+	for(U32 level = 0; level < WHEEL_LEVEL_COUNT; ++level)
+	{
+		if(delta < (U64(1) << ((level + 1) * WHEEL_SLOT_COUNT_LOG2)))
+		{
+			const U32 slot = U32(tick >> (level * WHEEL_SLOT_COUNT_LOG2)) & (WHEEL_SLOT_COUNT - 1);
+			insertSorted(m_wheel[level][slot], event);
+			return;
 		}
+	}
+
+	pushBack(m_farEvents, event);
+}
 
-		// Check if the associated scene nodes are marked for deletion
-		for(SceneNode* node : event.m_associatedNodes)
+void EventManager::cascade(IntrusiveList<Event>& list)
+{
+	IntrusiveList<Event> events(std::move(list));
+	while(!events.isEmpty())
+	{
+		Event* event = events.popFront();
+		event->m_list = nullptr;
+		scheduleInWheel(event);
+	}
+}
+
+void EventManager::advanceWheel(Second crntTime)
+{
+	const U64 targetTick = computeTick(crntTime);
+	if(!m_wheelStarted)
+	{
+		m_crntTick = targetTick;
+		m_wheelStarted = true;
+		return;
+	}
+
+	while(m_crntTick < targetTick)
+	{
+		++m_crntTick;
+
+		// When the slots of a level wrap around the next slot of the level above comes down. The events of the current
+		// tick end up in the slot of level 0 that is activated below
+		if((m_crntTick & ((U64(1) << (WHEEL_LEVEL_COUNT * WHEEL_SLOT_COUNT_LOG2)) - 1)) == 0)
+		{
+			cascade(m_farEvents);
+		}
+
+		for(U32 level = WHEEL_LEVEL_COUNT - 1; level > 0; --level)
 		{
-			if(node->getMarkedForDeletion())
+			const U32 shift = level * WHEEL_SLOT_COUNT_LOG2;
+			if((m_crntTick & ((U64(1) << shift) - 1)) == 0)
 			{
-				event.setMarkedForDeletion();
+				cascade(m_wheel[level][U32(m_crntTick >> shift) & (WHEEL_SLOT_COUNT - 1)]);
 			}
 		}
 
-		if(event.getMarkedForDeletion())
+		// The events of this tick start. The slot is sorted so they start in the order they were created
+		IntrusiveList<Event>& slot = m_wheel[0][U32(m_crntTick) & (WHEEL_SLOT_COUNT - 1)];
+		while(!slot.isEmpty())
 		{
-			continue;
+			Event* event = slot.popFront();
+			event->m_list = nullptr;
+			pushBack(m_activeEvents, event);
 		}
+	}
+}
+
+Error EventManager::updateAllEvents(Second prevUpdateTime, Second crntTime)
+{
+	// Activate the events that start and schedule the new ones
+	advanceWheel(crntTime);
 
+	while(!m_newEvents.isEmpty())
+	{
+		Event* event = m_newEvents.popFront();
+		event->m_list = nullptr;
+		schedule(event, crntTime);
+	}
+
+	// Gather the events to update. Events with one associated scene node can run in parallel to the events of other
+	// nodes so put them into buckets using the node. The rest run serially
+	ThreadHive& hive = m_scene->getThreadHive();
+	const U32 bucketCount = hive.getThreadCount();
+	SceneFrameAllocator<U8> alloc = getFrameAllocator();
+
+	DynamicArrayAuto<Event*> serialEvents(alloc);
+	DynamicArrayAuto<Event*> parallelEvents(alloc);
+	DynamicArrayAuto<U32> parallelEventBuckets(alloc);
+	Array<U32, ThreadHive::MAX_THREADS> bucketSizes;
+	zeroMemory(bucketSizes);
+
+	for(Event& event : m_activeEvents)
+	{
 		// Audjust starting time
 		if(event.m_startTime < 0.0)
 		{
 			event.m_startTime = crntTime;
 		}
 
-		// Check if dead
-		if(!event.isDead(crntTime))
+		if(event.m_startTime > crntTime)
 		{
-			// If not dead update it
+			// Activated a bit early because of the tick granularity
+			continue;
+		}
 
-			if(event.getStartTime() <= crntTime)
-			{
-				err = event.update(prevUpdateTime, crntTime);
-			}
+		if(event.m_associatedNodes.getSize() == 1)
+		{
+			const U32 bucket = U32((ptrToNumber(event.m_associatedNodes[0]) >> 4) % bucketCount);
+			parallelEvents.emplaceBack(&event);
+			parallelEventBuckets.emplaceBack(bucket);
+			++bucketSizes[bucket];
 		}
 		else
 		{
-			// Dead
+			serialEvents.emplaceBack(&event);
+		}
+	}
 
-			if(event.getReanimate())
-			{
-				event.m_startTime = prevUpdateTime;
-				err = event.update(prevUpdateTime, crntTime);
-			}
-			else
+	// Serial events go first since they may touch the nodes of any bucket
+	ANKI_CHECK(updateEvents(serialEvents, prevUpdateTime, crntTime));
+
+	if(parallelEvents.getSize() < MIN_EVENTS_FOR_PARALLEL_UPDATE || bucketCount == 1)
+	{
+		return updateEvents(parallelEvents, prevUpdateTime, crntTime);
+	}
+
+	// Sort the events by bucket
+	Array<U32, ThreadHive::MAX_THREADS> bucketOffsets;
+	U32 offset = 0;
+	for(U32 bucket = 0; bucket < bucketCount; ++bucket)
+	{
+		bucketOffsets[bucket] = offset;
+		offset += bucketSizes[bucket];
+	}
+
+	DynamicArrayAuto<Event*> sortedEvents(alloc, parallelEvents.getSize());
+	Array<U32, ThreadHive::MAX_THREADS> bucketCursors = bucketOffsets;
+	for(U32 i = 0; i < parallelEvents.getSize(); ++i)
+	{
+		sortedEvents[bucketCursors[parallelEventBuckets[i]]++] = parallelEvents[i];
+	}
+
+	// Update the buckets in parallel
+	Atomic<I32> errorInThread = {0};
+	Array<UpdateEventsTask, ThreadHive::MAX_THREADS> taskCtxs;
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS> tasks;
+	U32 taskCount = 0;
+	for(U32 bucket = 0; bucket < bucketCount; ++bucket)
+	{
+		if(bucketSizes[bucket] == 0)
+		{
+			continue;
+		}
+
+		UpdateEventsTask& ctx = taskCtxs[taskCount];
+		ctx.m_manager = this;
+		ctx.m_events = ConstWeakArray<Event*>(&sortedEvents[bucketOffsets[bucket]], bucketSizes[bucket]);
+		ctx.m_prevUpdateTime = prevUpdateTime;
+		ctx.m_crntTime = crntTime;
+		ctx.m_errorInThread = &errorInThread;
+
+		tasks[taskCount] = ANKI_THREAD_HIVE_TASK({ self->update(); }, &ctx, nullptr, nullptr);
+		++taskCount;
+	}
+
+	hive.submitTasks(&tasks[0], taskCount);
+	hive.waitAllTasks();
+
+	return Error(errorInThread.load());
+}
+
+Error EventManager::updateEvents(ConstWeakArray<Event*> events, Second prevUpdateTime, Second crntTime)
+{
+	Error err = Error::NONE;
+	for(U32 i = 0; i < events.getSize() && !err; ++i)
+	{
+		err = updateEvent(*events[i], prevUpdateTime, crntTime);
+	}
+
+	return err;
+}
+
+Error EventManager::updateEvent(Event& event, Second prevUpdateTime, Second crntTime)
+{
+	ANKI_ASSERT(event.m_startTime >= 0.0 && event.m_startTime <= crntTime);
+
+	// Another event might have marked it for deletion
+	if(event.getMarkedForDeletion())
+	{
+		return Error::NONE;
+	}
+
+	Error err = Error::NONE;
+	if(!event.isDead(crntTime))
+	{
+		// If not dead update it
+		err = event.update(prevUpdateTime, crntTime);
+	}
+	else
+	{
+		// Dead
+
+		if(event.getReanimate())
+		{
+			event.m_startTime = prevUpdateTime;
+			err = event.update(prevUpdateTime, crntTime);
+		}
+		else
+		{
+			err = event.onKilled(prevUpdateTime, crntTime);
+			if(err || !event.getReanimate())
 			{
-				err = event.onKilled(prevUpdateTime, crntTime);
-				if(err || !event.getReanimate())
-				{
-					event.setMarkedForDeletion();
-				}
+				event.setMarkedForDeletion();
 			}
 		}
 	}
@@ -121,8 +368,29 @@ void EventManager::markEventForDeletion(Event* event)
 
 	LockGuard<Mutex> lock(m_mtx);
 	event->m_markedForDeletion = true;
-	m_events.erase(event);
-	m_eventsMarkedForDeletion.pushBack(event);
+	erase(event);
+	pushBack(m_eventsMarkedForDeletion, event);
+}
+
+void EventManager::markEventsOfNodesMarkedForDeletion()
+{
+	iterateEventLists([&](IntrusiveList<Event>& list) {
+		auto it = list.getBegin();
+		while(it != list.getEnd())
+		{
+			Event& event = *it;
+			++it;
+
+			for(SceneNode* node : event.m_associatedNodes)
+			{
+				if(node->getMarkedForDeletion())
+				{
+					event.setMarkedForDeletion();
+					break;
+				}
+			}
+		}
+	});
 }
 
 void EventManager::deleteEventsMarkedForDeletion()
@@ -132,8 +400,8 @@ void EventManager::deleteEventsMarkedForDeletion()
 	// Gather events for deletion
 	while(!m_eventsMarkedForDeletion.isEmpty())
 	{
-		Event* event = &m_eventsMarkedForDeletion.getFront();
-		m_eventsMarkedForDeletion.popFront();
+		Event* event = m_eventsMarkedForDeletion.popFront();
+		event->m_list = nullptr;
 
 		alloc.deleteInstance(event);
 	}
@@ -15,7 +15,9 @@ namespace anki
 /// @addtogroup scene
 /// @{
 
-/// This manager creates the events ands keeps track of them
+/// This manager creates the events ands keeps track of them. The events that haven't started yet are kept in a
+/// hierarchical timing wheel so they cost nothing until their start time comes. The events that run are updated in
+/// parallel when they are associated with different scene nodes.
 class EventManager
 {
 public:
@@ -51,7 +53,8 @@ public:
 		else
 		{
 			LockGuard<Mutex> lock(m_mtx);
-			m_events.pushBack(event);
+			event->m_sequence = m_eventSequence++;
+			pushBack(m_newEvents, event);
 		}
 		return err;
 	}
@@ -65,12 +68,69 @@ public:
 	/// @note It's thread-safe against itself.
 	void markEventForDeletion(Event* event);
 
+	/// Mark for deletion the events that have associated scene nodes that are marked for deletion. Call it before the
+	/// scene nodes get deleted.
+	void markEventsOfNodesMarkedForDeletion();
+
 private:
+	class UpdateEventsTask;
+
+	/// The duration of a tick of the timing wheel.
+	static constexpr Second WHEEL_TICK = 1.0 / 32.0;
+	static const U32 WHEEL_SLOT_COUNT_LOG2 = 6;
+	static const U32 WHEEL_SLOT_COUNT = 1u << WHEEL_SLOT_COUNT_LOG2;
+	static const U32 WHEEL_LEVEL_COUNT = 4;
+
+	/// Update events in the ThreadHive only if there are more than that.
+	static const U32 MIN_EVENTS_FOR_PARALLEL_UPDATE = 64;
+
 	SceneGraph* m_scene = nullptr;
 
-	IntrusiveList<Event> m_events;
+	IntrusiveList<Event> m_newEvents; ///< Events that haven't been scheduled yet.
+	IntrusiveList<Event> m_activeEvents; ///< Events that get updated every frame.
 	IntrusiveList<Event> m_eventsMarkedForDeletion;
+
+	/// The events that will start in the future. The slots of level L are WHEEL_SLOT_COUNT^L ticks long.
+	Array2d<IntrusiveList<Event>, WHEEL_LEVEL_COUNT, WHEEL_SLOT_COUNT> m_wheel;
+	IntrusiveList<Event> m_farEvents; ///< The events that start too far in the future for the wheel.
+	U64 m_crntTick = 0;
+	Bool m_wheelStarted = false;
+	U64 m_eventSequence = 0;
+
 	Mutex m_mtx;
+
+	/// Add the event to a list and remember the list.
+	static void pushBack(IntrusiveList<Event>& list, Event* event);
+
+	/// Add the event to a list and keep the list sorted by creation order.
+	static void insertSorted(IntrusiveList<Event>& list, Event* event);
+
+	/// Remove the event from the list it's in.
+	static void erase(Event* event);
+
+	static U64 computeTick(Second time)
+	{
+		return (time > 0.0) ? U64(time / WHEEL_TICK) : 0;
+	}
+
+	/// Put an event to the active list or to the timing wheel.
+	void schedule(Event* event, Second crntTime);
+
+	/// Put an event that starts in the current tick or later to the timing wheel.
+	void scheduleInWheel(Event* event);
+
+	/// Advance the timing wheel and activate the events that start.
+	void advanceWheel(Second crntTime);
+
+	/// Reschedule the events of a wheel slot to the lower levels.
+	void cascade(IntrusiveList<Event>& list);
+
+	ANKI_USE_RESULT Error updateEvent(Event& event, Second prevUpdateTime, Second crntTime);
+
+	ANKI_USE_RESULT Error updateEvents(ConstWeakArray<Event*> events, Second prevUpdateTime, Second crntTime);
+
+	template<typename TFunc>
+	void iterateEventLists(TFunc func);
 };
 /// @}
 
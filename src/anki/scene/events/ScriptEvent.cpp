@@ -41,7 +41,7 @@ Error ScriptEvent::init(Second startTime, Second duration, CString script)
 		ANKI_CHECK(getSceneGraph().getResourceManager().loadResource(script, m_scriptRsrc));
 
 		// Exec the script
-		ANKI_CHECK(m_env.evalString(m_scriptRsrc->getSource()));
+		ANKI_CHECK(m_env.evalBytecode(m_scriptRsrc->getBytecode(), script));
 	}
 	else
 	{
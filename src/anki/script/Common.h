@@ -15,6 +15,7 @@ namespace anki
 class LuaBinder;
 class ScriptManager;
 class ScriptEnvironment;
+class SharedScriptEnvironment;
 
 #define ANKI_SCRIPT_LOGI(...) ANKI_LOG("SCRI", NORMAL, __VA_ARGS__)
 #define ANKI_SCRIPT_LOGE(...) ANKI_LOG("SCRI", ERROR, __VA_ARGS__)
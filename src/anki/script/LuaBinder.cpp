@@ -65,16 +65,27 @@ Error LuaBinder::init(ScriptAllocator alloc, LuaBinderOtherSystems* otherSystems
 void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrSize nsize)
 {
 	ANKI_ASSERT(userData);
+	LuaBinder& binder = *reinterpret_cast<LuaBinder*>(userData);
+	return luaAllocInternal(binder.m_alloc.getMemoryPool(), ptr, osize, nsize);
+}
+
+void* LuaBinder::luaCompileAllocCallback(void* userData, void* ptr, PtrSize osize, PtrSize nsize)
+{
+	ANKI_ASSERT(userData);
+	ScriptAllocator& alloc = *reinterpret_cast<ScriptAllocator*>(userData);
+	return luaAllocInternal(alloc.getMemoryPool(), ptr, osize, nsize);
+}
 
+void* LuaBinder::luaAllocInternal(BaseMemoryPool& pool, void* ptr, PtrSize osize, PtrSize nsize)
+{
 #if 1
-	LuaBinder& binder = *reinterpret_cast<LuaBinder*>(userData);
 	void* out = nullptr;
 
 	if(nsize == 0)
 	{
 		if(ptr != nullptr)
 		{
-			binder.m_alloc.getMemoryPool().free(ptr);
+			pool.free(ptr);
 		}
 	}
 	else
@@ -83,7 +94,7 @@ void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrS
 
 		if(ptr == nullptr)
 		{
-			out = binder.m_alloc.getMemoryPool().allocate(nsize, 16);
+			out = pool.allocate(nsize, 16);
 		}
 		else if(nsize <= osize)
 		{
@@ -93,9 +104,9 @@ void* LuaBinder::luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrS
 		{
 			// realloc
 
-			out = binder.m_alloc.getMemoryPool().allocate(nsize, 16);
+			out = pool.allocate(nsize, 16);
 			memcpy(out, ptr, osize);
-			binder.m_alloc.getMemoryPool().free(ptr);
+			pool.free(ptr);
 		}
 	}
 #else
@@ -130,6 +141,119 @@ Error LuaBinder::evalString(lua_State* state, const CString& str)
 	return err;
 }
 
+Error LuaBinder::compileString(ScriptAllocator alloc, CString str, CString chunkName, DynamicArray<U8>& bytecode)
+{
+	ANKI_ASSERT(bytecode.getSize() == 0);
+
+	// Compiling doesn't need the libraries or the bindings so use a bare state
+	lua_State* l = lua_newstate(luaCompileAllocCallback, &alloc);
+	if(l == nullptr)
+	{
+		ANKI_SCRIPT_LOGE("lua_newstate() failed");
+		return Error::OUT_OF_MEMORY;
+	}
+
+	Error err = Error::NONE;
+	if(luaL_loadbufferx(l, str.cstr(), str.getLength(), chunkName.cstr(), "t"))
+	{
+		ANKI_SCRIPT_LOGE("Failed to compile %s: %s", chunkName.cstr(), lua_tostring(l, -1));
+		err = Error::USER_DATA;
+	}
+	else
+	{
+		class Ctx
+		{
+		public:
+			ScriptAllocator m_alloc;
+			DynamicArray<U8>* m_bytecode;
+		} ctx = {alloc, &bytecode};
+
+		auto writer = [](lua_State*, const void* data, size_t size, void* ud) -> int {
+			Ctx& ctx = *static_cast<Ctx*>(ud);
+			const U32 offset = ctx.m_bytecode->getSize();
+			ctx.m_bytecode->resize(ctx.m_alloc, offset + U32(size));
+			memcpy(&(*ctx.m_bytecode)[offset], data, size);
+			return 0;
+		};
+
+		// Keep the debug info for the line numbers of the errors
+		lua_dump(l, writer, &ctx, 0);
+	}
+
+	lua_close(l);
+	return err;
+}
+
+Error LuaBinder::loadBytecode(lua_State* state, ConstWeakArray<U8> bytecode, CString chunkName)
+{
+	ANKI_ASSERT(bytecode.getSize() > 0);
+	if(luaL_loadbufferx(state,
+		   reinterpret_cast<const char*>(&bytecode[0]),
+		   bytecode.getSize(),
+		   chunkName.cstr(),
+		   "b"))
+	{
+		ANKI_SCRIPT_LOGE("Failed to load the bytecode of %s: %s", chunkName.cstr(), lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error LuaBinder::evalBytecode(lua_State* state, ConstWeakArray<U8> bytecode, CString chunkName)
+{
+	ANKI_TRACE_SCOPED_EVENT(LUA_EXEC);
+
+	ANKI_CHECK(loadBytecode(state, bytecode, chunkName));
+
+	Error err = Error::NONE;
+	if(lua_pcall(state, 0, LUA_MULTRET, 0))
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		err = Error::USER_DATA;
+	}
+
+	garbageCollect(state);
+	return err;
+}
+
+Error LuaBinder::evalBytecodeInNewEnvironment(
+	lua_State* state, ConstWeakArray<U8> bytecode, CString chunkName, I32& envRef)
+{
+	ANKI_TRACE_SCOPED_EVENT(LUA_EXEC);
+
+	envRef = LUA_NOREF;
+	ANKI_CHECK(loadBytecode(state, bytecode, chunkName));
+
+	// Create the environment table. Whatever it doesn't have is looked up in the globals
+	lua_newtable(state); // push env
+	lua_newtable(state); // push metatable
+	lua_pushglobaltable(state); // push
+	lua_setfield(state, -2, "__index"); // pop: metatable.__index = _G
+	lua_setmetatable(state, -2); // pop metatable
+
+	// The _ENV of a main chunk is its first and only upvalue
+	lua_pushvalue(state, -1); // push copy of env
+	const char* upvalueName = lua_setupvalue(state, -3, 1); // pop copy of env
+	ANKI_ASSERT(upvalueName);
+	(void)upvalueName;
+	envRef = luaL_ref(state, LUA_REGISTRYINDEX); // pop env
+
+	// Run the chunk. Don't do a full garbage collection here since many scripts are evaluated on the same state
+	if(lua_pcall(state, 0, 0, 0))
+	{
+		ANKI_SCRIPT_LOGE("%s", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		luaL_unref(state, LUA_REGISTRYINDEX, envRef);
+		envRef = LUA_NOREF;
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
 void LuaBinder::createClass(lua_State* l, const LuaUserDataTypeInfo* typeInfo)
 {
 	ANKI_ASSERT(typeInfo);
@@ -12,6 +12,8 @@
 #include <anki/util/String.h>
 #include <anki/util/Functions.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/WeakArray.h>
 #include <lua.hpp>
 #ifndef ANKI_LUA_HPP
 #	error "Wrong LUA header included"
@@ -196,6 +198,24 @@ public:
 	/// Evaluate a string
 	static Error evalString(lua_State* state, const CString& str);
 
+	/// Compile a string to LUA bytecode. The bytecode can be evaluated many times without parsing the source again.
+	/// @param alloc The allocator of the bytecode and of the temporary LUA state that does the compilation.
+	/// @param str The source.
+	/// @param chunkName The name of the chunk that will appear in error messages.
+	/// @param[out] bytecode The bytecode. Destroy it using alloc.
+	static ANKI_USE_RESULT Error compileString(
+		ScriptAllocator alloc, CString str, CString chunkName, DynamicArray<U8>& bytecode);
+
+	/// Evaluate bytecode created by compileString().
+	static ANKI_USE_RESULT Error evalBytecode(lua_State* state, ConstWeakArray<U8> bytecode, CString chunkName);
+
+	/// Evaluate bytecode created by compileString() in a new environment table. The global variables the bytecode
+	/// defines go to that table and the rest of the globals are looked up in the state's global table. That way many
+	/// scripts can share the same state without seeing each other's globals.
+	/// @param[out] envRef A reference to the environment table in the registry. Release it with luaL_unref().
+	static ANKI_USE_RESULT Error evalBytecodeInNewEnvironment(
+		lua_State* state, ConstWeakArray<U8> bytecode, CString chunkName, I32& envRef);
+
 	static void garbageCollect(lua_State* state)
 	{
 		lua_gc(state, LUA_GCCOLLECT, 0);
@@ -261,6 +281,13 @@ private:
 
 	static void* luaAllocCallback(void* userData, void* ptr, PtrSize osize, PtrSize nsize);
 
+	/// The allocation callback of the states that only compile.
+	static void* luaCompileAllocCallback(void* userData, void* ptr, PtrSize osize, PtrSize nsize);
+
+	static void* luaAllocInternal(BaseMemoryPool& pool, void* ptr, PtrSize osize, PtrSize nsize);
+
+	static ANKI_USE_RESULT Error loadBytecode(lua_State* state, ConstWeakArray<U8> bytecode, CString chunkName);
+
 	static ANKI_USE_RESULT Error checkNumberInternal(lua_State* l, I32 stackIdx, lua_Number& number);
 };
 /// @}
@@ -17,4 +17,10 @@ Error ScriptEnvironment::init(ScriptManager* manager)
 	return m_thread.init(m_manager->getAllocator(), &m_manager->getOtherSystems());
 }
 
+Error SharedScriptEnvironment::init(ScriptManager* manager)
+{
+	ANKI_ASSERT(manager);
+	return m_lua.init(manager->getAllocator(), &manager->getOtherSystems());
+}
+
 } // end namespace anki
\ No newline at end of file
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/script/LuaBinder.h>
+#include <anki/util/Thread.h>
 
 namespace anki
 {
@@ -42,6 +43,13 @@ public:
 		return LuaBinder::evalString(m_thread.getLuaState(), str);
 	}
 
+	/// Evaluate bytecode created by LuaBinder::compileString().
+	ANKI_USE_RESULT Error evalBytecode(ConstWeakArray<U8> bytecode, CString chunkName)
+	{
+		ANKI_ASSERT(isCreated());
+		return LuaBinder::evalBytecode(m_thread.getLuaState(), bytecode, chunkName);
+	}
+
 	void serializeGlobals(LuaBinderSerializeGlobalsCallback& callback)
 	{
 		ANKI_ASSERT(isCreated());
@@ -69,6 +77,28 @@ private:
 		return m_manager != nullptr;
 	}
 };
+
+/// A LUA state that is shared by many scripts. Every script runs in its own environment table (see
+/// LuaBinder::evalBytecodeInNewEnvironment) so the scripts don't see each other's globals. Lock it before using it.
+class SharedScriptEnvironment
+{
+public:
+	ANKI_USE_RESULT Error init(ScriptManager* manager);
+
+	Mutex& getMutex()
+	{
+		return m_mtx;
+	}
+
+	lua_State& getLuaState()
+	{
+		return *m_lua.getLuaState();
+	}
+
+private:
+	LuaBinder m_lua;
+	Mutex m_mtx;
+};
 /// @}
 
 } // end namespace anki
\ No newline at end of file
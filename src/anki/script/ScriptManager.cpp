@@ -17,6 +17,7 @@ ScriptManager::ScriptManager()
 ScriptManager::~ScriptManager()
 {
 	ANKI_SCRIPT_LOGI("Destroying scripting engine...");
+	m_sharedEnvs.destroy(m_alloc);
 }
 
 Error ScriptManager::init(AllocAlignedCallback allocCb, void* allocCbData)
@@ -30,4 +31,27 @@ Error ScriptManager::init(AllocAlignedCallback allocCb, void* allocCbData)
 	return Error::NONE;
 }
 
+Error ScriptManager::initSharedEnvironments(U32 count)
+{
+	ANKI_ASSERT(count > 0);
+	ANKI_ASSERT(!hasSharedEnvironments() && "Already initialized");
+
+	ANKI_SCRIPT_LOGI("Creating %u shared script environments", count);
+
+	m_sharedEnvs.create(m_alloc, count);
+	for(SharedScriptEnvironment& env : m_sharedEnvs)
+	{
+		ANKI_CHECK(env.init(this));
+	}
+
+	return Error::NONE;
+}
+
+SharedScriptEnvironment& ScriptManager::getNextSharedEnvironment()
+{
+	ANKI_ASSERT(hasSharedEnvironments());
+	const U32 idx = m_crntSharedEnv.fetchAdd(1) % m_sharedEnvs.getSize();
+	return m_sharedEnvs[idx];
+}
+
 } // end namespace anki
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <anki/script/LuaBinder.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Atomic.h>
 
 namespace anki
 {
@@ -57,7 +59,20 @@ public:
 		return LuaBinder::evalString(m_lua.getLuaState(), str);
 	}
 
+	/// Create LUA states that will be shared by many scripts instead of every script having its own state. Scripts
+	/// that use different shared states can run in parallel.
+	/// @param count The number of states. Typically the number of the threads that run scripts.
+	ANKI_USE_RESULT Error initSharedEnvironments(U32 count);
+
+	Bool hasSharedEnvironments() const
+	{
+		return m_sharedEnvs.getSize() > 0;
+	}
+
 anki_internal:
+	/// Get one of the shared environments. They are handed out in a round robin fashion.
+	SharedScriptEnvironment& getNextSharedEnvironment();
+
 	LuaBinder& getLuaBinder()
 	{
 		return m_lua;
@@ -73,6 +88,9 @@ private:
 	ScriptAllocator m_alloc;
 	LuaBinder m_lua;
 	Mutex n_luaMtx;
+
+	DynamicArray<SharedScriptEnvironment> m_sharedEnvs;
+	Atomic<U32> m_crntSharedEnv = {0};
 };
 /// @}
 
@@ -42,6 +42,12 @@ ANKI_USE_RESULT Error removeDirectory(const CString& dir, GenericMemoryPoolAlloc
 /// Equivalent to: mkdir dir
 ANKI_USE_RESULT Error createDirectory(const CString& dir);
 
+/// Equivalent to: mv oldName newName. If @a newName exists it's replaced atomically where the OS allows it.
+ANKI_USE_RESULT Error renameFile(const CString& oldName, const CString& newName);
+
+/// Equivalent to: rm filename
+ANKI_USE_RESULT Error removeFile(const CString& filename);
+
 /// Get the home directory.
 /// Write the home directory to @a buff. The @a buffSize is the size of the @a buff. If the @buffSize is not enough the
 /// function will throw an exception.
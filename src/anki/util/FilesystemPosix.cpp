@@ -18,6 +18,7 @@
 #include <cerrno>
 #include <ftw.h> // For walkDirectoryTree
 #include <cstdlib>
+#include <cstdio>
 
 #ifndef USE_FDS
 #	define USE_FDS 15
@@ -195,6 +196,30 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldName, const CString& newName)
+{
+	Error err = Error::NONE;
+	if(rename(oldName.cstr(), newName.cstr()))
+	{
+		ANKI_UTIL_LOGE("%s : %s -> %s", strerror(errno), oldName.cstr(), newName.cstr());
+		err = Error::FUNCTION_FAILED;
+	}
+
+	return err;
+}
+
+Error removeFile(const CString& filename)
+{
+	Error err = Error::NONE;
+	if(remove(filename.cstr()))
+	{
+		ANKI_UTIL_LOGE("%s : %s", strerror(errno), filename.cstr());
+		err = Error::FUNCTION_FAILED;
+	}
+
+	return err;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	const char* home = getenv("HOME");
@@ -71,6 +71,30 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldName, const CString& newName)
+{
+	Error err = Error::NONE;
+	if(MoveFileExA(oldName.cstr(), newName.cstr(), MOVEFILE_REPLACE_EXISTING) == 0)
+	{
+		ANKI_UTIL_LOGE("Failed to rename file %s to %s", oldName.cstr(), newName.cstr());
+		err = Error::FUNCTION_FAILED;
+	}
+
+	return err;
+}
+
+Error removeFile(const CString& filename)
+{
+	Error err = Error::NONE;
+	if(DeleteFileA(filename.cstr()) == 0)
+	{
+		ANKI_UTIL_LOGE("Failed to remove file %s", filename.cstr());
+		err = Error::FUNCTION_FAILED;
+	}
+
+	return err;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	char path[MAX_PATH];
@@ -30,6 +30,9 @@ class List;
 template<typename T>
 class ListAuto;
 
+template<typename T>
+class IntrusiveList;
+
 template<typename T, typename TIndex>
 class SparseArray;
 
@@ -333,6 +333,51 @@ inline void splitThreadedProblem(U32 threadId, U32 threadCount, U32 problemSize,
 	end = (threadId == threadCount - 1) ? problemSize : (threadId + 1u) * div;
 	ANKI_ASSERT(!(threadId == threadCount - 1 && end != problemSize));
 }
+
+/// Same as splitThreadedProblem but every element of the problem has a different cost. The ranges are chosen so that
+/// the threads get roughly the same cost. Every thread gets at least one element if there are enough elements.
+/// @param threadId The thread index.
+/// @param threadCount The number of threads.
+/// @param problemSize The number of elements.
+/// @param costPrefixSums The inclusive prefix sums of the costs of the elements. It has problemSize elements. The costs
+///                       should be positive.
+/// @param[out] start The first element of the range.
+/// @param[out] end One past the last element of the range.
+inline void splitThreadedProblem(
+	U32 threadId, U32 threadCount, U32 problemSize, const F32* costPrefixSums, U32& start, U32& end)
+{
+	ANKI_ASSERT(threadCount > 0 && threadId < threadCount);
+	ANKI_ASSERT(costPrefixSums || problemSize == 0);
+
+	if(problemSize <= threadCount)
+	{
+		// One element per thread at most
+		start = min(threadId, problemSize);
+		end = min(threadId + 1, problemSize);
+		return;
+	}
+
+	const F32 totalCost = costPrefixSums[problemSize - 1];
+
+	// The range of thread T starts at the first element whose prefix sum is over T/threadCount of the total cost. Then
+	// the starts are pushed forward and clamped so that no range ends up empty
+	auto computeStart = [&](U32 tid) -> U32 {
+		U32 pushedStart = 0;
+		for(U32 t = 0; t <= tid; ++t)
+		{
+			const F32 targetCost = totalCost * F32(t) / F32(threadCount);
+			const U32 idealStart = U32(std::upper_bound(costPrefixSums, costPrefixSums + problemSize, targetCost)
+										- costPrefixSums);
+			pushedStart = (t == 0) ? idealStart : max(idealStart, pushedStart + 1);
+		}
+
+		return min(pushedStart, problemSize - (threadCount - tid));
+	};
+
+	start = (threadId == 0) ? 0 : computeStart(threadId);
+	end = (threadId == threadCount - 1) ? problemSize : computeStart(threadId + 1);
+	ANKI_ASSERT(start < end && end <= problemSize);
+}
 /// @}
 
 } // end namespace anki
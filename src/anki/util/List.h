@@ -57,6 +57,9 @@ class ListIterator
 	template<typename>
 	friend class anki::List;
 
+	template<typename>
+	friend class anki::IntrusiveList;
+
 	template<typename, typename, typename, typename>
 	friend class ListIterator;
 
@@ -6,6 +6,7 @@
 #include <anki/util/File.h>
 #include <anki/util/Logger.h>
 #include <anki/util/System.h>
+#include <anki/util/Memory.h>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -23,13 +24,128 @@ namespace anki
 
 static const Array<const char*, static_cast<U>(LoggerMessageType::COUNT)> MSG_TEXT = {{"I", "E", "W", "F"}};
 
+/// The per thread ring buffer of the async mode. Single producer (the thread) and single consumer (whoever holds
+/// Logger::m_mutex). It's referenced by the Logger and by the thread and it's freed when both of them let it go. The
+/// ring buffer itself is freed as soon as the Logger lets it go.
+class alignas(ANKI_CACHE_LINE_SIZE) Logger::ThreadLocal
+{
+public:
+	ThreadLocal* m_next = nullptr; ///< The next in Logger::m_threadLocalsHead.
+	ThreadLocal* m_nextInThread = nullptr; ///< The next in Logger::m_threadLocalList.
+	U64 m_loggerUuid = 0;
+	ThreadId m_tid = 0;
+	U8* m_buffer = nullptr; ///< The ring buffer. It's ASYNC_RING_BUFFER_SIZE big.
+	Atomic<U32> m_refcount = {2};
+	Atomic<Bool> m_threadExited = {false};
+
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_head = {0}; ///< Written by the producer. It wraps around.
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_tail = {0}; ///< Written by the consumer. It wraps around.
+	Atomic<U32> m_droppedCount = {0}; ///< Dropped since the last drain.
+
+	/// Release a reference.
+	void release()
+	{
+		if(m_refcount.fetchSub(1, AtomicMemoryOrder::ACQ_REL) == 1)
+		{
+			this->~ThreadLocal();
+			freeAligned(this);
+		}
+	}
+};
+
+/// The ThreadLocal a thread is using. On thread exit it lets them go so the Loggers can free them.
+class Logger::ThreadLocalList
+{
+public:
+	ThreadLocal* m_head = nullptr;
+
+	~ThreadLocalList()
+	{
+		ThreadLocal* tlocal = m_head;
+		while(tlocal)
+		{
+			ThreadLocal* next = tlocal->m_nextInThread;
+			tlocal->m_threadExited.store(true, AtomicMemoryOrder::RELEASE);
+			tlocal->release();
+			tlocal = next;
+		}
+
+		m_head = nullptr;
+	}
+};
+
+/// The header of a message in the ring buffer. The message's text follows.
+class Logger::AsyncMessageHeader
+{
+public:
+	const char* m_file;
+	const char* m_func;
+	const char* m_subsystem;
+	ThreadId m_tid;
+	I32 m_line;
+	U32 m_size; ///< The size of the header plus the text, aligned.
+	LoggerMessageType m_type; ///< COUNT if it's padding at the end of the ring buffer.
+};
+
+thread_local Logger::ThreadLocalList Logger::m_threadLocalList;
+
+static Atomic<U64> g_loggerUuid = {0};
+
 Logger::Logger()
+	: m_uuid(g_loggerUuid.fetchAdd(1) + 1)
 {
 	addMessageHandler(this, &defaultSystemMessageHandler);
 }
 
 Logger::~Logger()
 {
+	stopAsync();
+
+	ThreadLocal* tlocal = m_threadLocalsHead.load();
+	while(tlocal)
+	{
+		ThreadLocal* next = tlocal->m_next;
+		releaseThreadLocal(*tlocal);
+		tlocal = next;
+	}
+}
+
+void Logger::startAsync()
+{
+	LockGuard<Mutex> lock(m_mutex);
+	if(!m_async.load())
+	{
+		m_quitDrainThread.store(false);
+		m_drainThread.start(this, drainThreadCallback);
+		m_async.store(true);
+	}
+}
+
+void Logger::stopAsync()
+{
+	{
+		LockGuard<Mutex> lock(m_mutex);
+		if(!m_async.load())
+		{
+			return;
+		}
+
+		m_async.store(false);
+		m_quitDrainThread.store(true);
+		m_drainCondVar.notifyOne();
+	}
+
+	const Error err = m_drainThread.join();
+	(void)err;
+
+	// Some threads might have written after the last drain
+	flush();
+}
+
+void Logger::flush()
+{
+	LockGuard<Mutex> lock(m_mutex);
+	drainAllThreadLocals();
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -61,6 +177,15 @@ void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callb
 	}
 }
 
+void Logger::callHandlers(const LoggerMessageInfo& info)
+{
+	U count = m_handlersCount;
+	while(count-- != 0)
+	{
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
+	}
+}
+
 void Logger::write(const char* file,
 	int line,
 	const char* func,
@@ -69,15 +194,19 @@ void Logger::write(const char* file,
 	ThreadId tid,
 	const char* msg)
 {
+	if(m_async.load() && type != LoggerMessageType::FATAL)
+	{
+		writeAsyncFormated(file, line, func, subsystem, type, tid, "%s", msg);
+		return;
+	}
+
 	m_mutex.lock();
 
-	LoggerMessageInfo inf = {file, line, func, type, msg, subsystem, tid};
+	// Keep the order of the messages
+	drainAllThreadLocals();
 
-	U count = m_handlersCount;
-	while(count-- != 0)
-	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
-	}
+	LoggerMessageInfo inf = {file, line, func, type, msg, subsystem, tid};
+	callHandlers(inf);
 
 	m_mutex.unlock();
 
@@ -96,9 +225,19 @@ void Logger::writeFormated(const char* file,
 	const char* fmt,
 	...)
 {
-	char buffer[1024 * 10];
 	va_list args;
 
+	if(m_async.load() && type != LoggerMessageType::FATAL)
+	{
+		// Format directly into the ring buffer
+		va_start(args, fmt);
+		writeAsync(file, line, func, subsystem, type, tid, fmt, args);
+		va_end(args);
+		return;
+	}
+
+	char buffer[1024 * 10];
+
 	va_start(args, fmt);
 	I len = vsnprintf(buffer, sizeof(buffer), fmt, args);
 	if(len < 0)
@@ -129,6 +268,320 @@ void Logger::writeFormated(const char* file,
 	}
 }
 
+void Logger::writeAsyncFormated(const char* file,
+	int line,
+	const char* func,
+	const char* subsystem,
+	LoggerMessageType type,
+	ThreadId tid,
+	const char* fmt,
+	...)
+{
+	va_list args;
+	va_start(args, fmt);
+	writeAsync(file, line, func, subsystem, type, tid, fmt, args);
+	va_end(args);
+}
+
+void Logger::writeAsync(const char* file,
+	int line,
+	const char* func,
+	const char* subsystem,
+	LoggerMessageType type,
+	ThreadId tid,
+	const char* fmt,
+	va_list args)
+{
+	const U32 HEADER_SIZE = sizeof(AsyncMessageHeader);
+	const U32 ALIGNMENT = alignof(AsyncMessageHeader);
+	static_assert((ASYNC_RING_BUFFER_SIZE & (ASYNC_RING_BUFFER_SIZE - 1)) == 0, "Should be power of 2");
+	static_assert(ASYNC_RING_BUFFER_SIZE % alignof(AsyncMessageHeader) == 0, "Wrong alignment");
+
+	ThreadLocal& tlocal = getThreadLocal(tid);
+
+	U32 head = tlocal.m_head.load(AtomicMemoryOrder::RELAXED);
+	const U32 tail = tlocal.m_tail.load(AtomicMemoryOrder::ACQUIRE);
+	U32 freeSpace = ASYNC_RING_BUFFER_SIZE - (head - tail);
+
+	// Try writing at the current position and if the text doesn't fit try again at the start of the buffer
+	for(U32 attempt = 0; attempt < 2; ++attempt)
+	{
+		const U32 offset = head & (ASYNC_RING_BUFFER_SIZE - 1);
+		const U32 spaceToEnd = ASYNC_RING_BUFFER_SIZE - offset;
+		if(spaceToEnd < HEADER_SIZE)
+		{
+			// Too small for a header. The consumer skips those bytes as well
+			if(freeSpace < spaceToEnd)
+			{
+				break;
+			}
+
+			head += spaceToEnd;
+			freeSpace -= spaceToEnd;
+			continue;
+		}
+
+		const U32 contiguousSpace = min(spaceToEnd, freeSpace);
+		if(contiguousSpace <= HEADER_SIZE)
+		{
+			break;
+		}
+
+		U8* const mem = &tlocal.m_buffer[offset];
+		char* const text = reinterpret_cast<char*>(mem + HEADER_SIZE);
+		const U32 maxTextSize = contiguousSpace - HEADER_SIZE;
+
+		va_list argsCopy;
+		va_copy(argsCopy, args);
+		const I len = vsnprintf(text, maxTextSize, fmt, argsCopy);
+		va_end(argsCopy);
+
+		if(len < 0)
+		{
+			break;
+		}
+
+		AsyncMessageHeader& header = *reinterpret_cast<AsyncMessageHeader*>(mem);
+		if(U32(len) < maxTextSize)
+		{
+			// It fits, publish it
+			header.m_file = file;
+			header.m_func = func;
+			header.m_subsystem = subsystem;
+			header.m_tid = tid;
+			header.m_line = line;
+			header.m_type = type;
+			header.m_size = min(getAlignedRoundUp(ALIGNMENT, HEADER_SIZE + U32(len) + 1), contiguousSpace);
+
+			// Sequentially consistent to be ordered with the check in wakeDrainThread()
+			tlocal.m_head.store(head + header.m_size, AtomicMemoryOrder::SEQ_CST);
+			wakeDrainThread();
+			return;
+		}
+
+		if(offset == 0 || spaceToEnd > freeSpace || U32(len) + 1 + HEADER_SIZE > ASYNC_RING_BUFFER_SIZE)
+		{
+			// Wrapping around won't help
+			break;
+		}
+
+		// Pad the rest of the buffer and try at the start
+		header.m_type = LoggerMessageType::COUNT;
+		header.m_size = spaceToEnd;
+		head += spaceToEnd;
+		freeSpace -= spaceToEnd;
+		tlocal.m_head.store(head, AtomicMemoryOrder::RELEASE);
+	}
+
+	// Didn't fit, drop it
+	tlocal.m_droppedCount.fetchAdd(1, AtomicMemoryOrder::SEQ_CST);
+	wakeDrainThread();
+}
+
+Logger::ThreadLocal& Logger::getThreadLocal(ThreadId tid)
+{
+	ThreadLocal* out = m_threadLocalList.m_head;
+	if(ANKI_LIKELY(out && out->m_loggerUuid == m_uuid))
+	{
+		return *out;
+	}
+
+	// Search the rest of the list. Free the ThreadLocal of the Loggers that are gone while at it
+	ThreadLocal* prev = nullptr;
+	out = m_threadLocalList.m_head;
+	while(out && out->m_loggerUuid != m_uuid)
+	{
+		ThreadLocal* next = out->m_nextInThread;
+		if(out->m_refcount.load(AtomicMemoryOrder::ACQUIRE) == 1)
+		{
+			if(prev)
+			{
+				prev->m_nextInThread = next;
+			}
+			else
+			{
+				m_threadLocalList.m_head = next;
+			}
+
+			out->release();
+		}
+		else
+		{
+			prev = out;
+		}
+
+		out = next;
+	}
+
+	if(out == nullptr)
+	{
+		void* mem = mallocAligned(sizeof(ThreadLocal), alignof(ThreadLocal));
+		out = ::new(mem) ThreadLocal();
+		out->m_loggerUuid = m_uuid;
+		out->m_tid = tid;
+		out->m_buffer = static_cast<U8*>(mallocAligned(ASYNC_RING_BUFFER_SIZE, ANKI_CACHE_LINE_SIZE));
+
+		out->m_nextInThread = m_threadLocalList.m_head;
+		m_threadLocalList.m_head = out;
+
+		// Store it to the list of the Logger without locking
+		ThreadLocal* head = m_threadLocalsHead.load();
+		do
+		{
+			out->m_next = head;
+		} while(!m_threadLocalsHead.compareExchange(head, out, AtomicMemoryOrder::SEQ_CST));
+	}
+
+	return *out;
+}
+
+void Logger::releaseThreadLocal(ThreadLocal& tlocal)
+{
+	freeAligned(tlocal.m_buffer);
+	tlocal.m_buffer = nullptr;
+	tlocal.release();
+}
+
+Logger::ThreadLocal* Logger::unlinkThreadLocal(ThreadLocal* prev, ThreadLocal& tlocal)
+{
+	if(prev == nullptr)
+	{
+		// It's the head, but other threads might push new ThreadLocal in the meantime
+		ThreadLocal* expected = &tlocal;
+		while(!m_threadLocalsHead.compareExchange(expected, tlocal.m_next, AtomicMemoryOrder::SEQ_CST))
+		{
+			if(expected != &tlocal)
+			{
+				prev = expected;
+				while(prev->m_next != &tlocal)
+				{
+					prev = prev->m_next;
+				}
+				break;
+			}
+		}
+	}
+
+	if(prev)
+	{
+		prev->m_next = tlocal.m_next;
+	}
+
+	return prev;
+}
+
+void Logger::drainAllThreadLocals()
+{
+	const U32 HEADER_SIZE = sizeof(AsyncMessageHeader);
+
+	ThreadLocal* prev = nullptr;
+	ThreadLocal* tlocal = m_threadLocalsHead.load(AtomicMemoryOrder::ACQUIRE);
+	while(tlocal)
+	{
+		// Check it before draining to get all the messages the thread wrote before exiting
+		const Bool threadExited = tlocal->m_threadExited.load(AtomicMemoryOrder::ACQUIRE);
+
+		U32 tail = tlocal->m_tail.load(AtomicMemoryOrder::RELAXED);
+		const U32 head = tlocal->m_head.load(AtomicMemoryOrder::ACQUIRE);
+
+		while(tail != head)
+		{
+			const U32 offset = tail & (ASYNC_RING_BUFFER_SIZE - 1);
+			const U32 spaceToEnd = ASYNC_RING_BUFFER_SIZE - offset;
+			if(spaceToEnd < HEADER_SIZE)
+			{
+				tail += spaceToEnd;
+				continue;
+			}
+
+			const AsyncMessageHeader& header = *reinterpret_cast<const AsyncMessageHeader*>(&tlocal->m_buffer[offset]);
+			if(header.m_type != LoggerMessageType::COUNT)
+			{
+				const char* text = reinterpret_cast<const char*>(&tlocal->m_buffer[offset + HEADER_SIZE]);
+				LoggerMessageInfo inf = {
+					header.m_file, header.m_line, header.m_func, header.m_type, text, header.m_subsystem, header.m_tid};
+				callHandlers(inf);
+			}
+
+			tail += header.m_size;
+		}
+
+		tlocal->m_tail.store(tail, AtomicMemoryOrder::RELEASE);
+
+		const U32 droppedCount = tlocal->m_droppedCount.exchange(0);
+		if(droppedCount)
+		{
+			m_droppedMessageCount.fetchAdd(droppedCount);
+
+			char msg[128];
+			snprintf(msg, sizeof(msg), "Dropped %u log messages because the ring buffer was full", droppedCount);
+			LoggerMessageInfo inf = {
+				ANKI_FILE, __LINE__, ANKI_FUNC, LoggerMessageType::WARNING, msg, "UTIL", tlocal->m_tid};
+			callHandlers(inf);
+		}
+
+		ThreadLocal* next = tlocal->m_next;
+		if(threadExited)
+		{
+			prev = unlinkThreadLocal(prev, *tlocal);
+			releaseThreadLocal(*tlocal);
+		}
+		else
+		{
+			prev = tlocal;
+		}
+
+		tlocal = next;
+	}
+}
+
+Bool Logger::hasPendingMessages() const
+{
+	const ThreadLocal* tlocal = m_threadLocalsHead.load(AtomicMemoryOrder::ACQUIRE);
+	for(; tlocal; tlocal = tlocal->m_next)
+	{
+		if(tlocal->m_head.load(AtomicMemoryOrder::SEQ_CST) != tlocal->m_tail.load()
+			|| tlocal->m_droppedCount.load(AtomicMemoryOrder::SEQ_CST) != 0 || tlocal->m_threadExited.load())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Logger::wakeDrainThread()
+{
+	// It's seldom set so the writers rarely touch the mutex
+	if(m_drainThreadSleeping.load() && m_drainThreadSleeping.exchange(false))
+	{
+		LockGuard<Mutex> lock(m_mutex);
+		m_drainCondVar.notifyOne();
+	}
+}
+
+Error Logger::drainThreadCallback(ThreadCallbackInfo& info)
+{
+	Logger& self = *static_cast<Logger*>(info.m_userData);
+
+	while(!self.m_quitDrainThread.load())
+	{
+		self.flush();
+
+		// Sleep until a writer wakes it. The flag is set before checking for messages so a writer that publishes a
+		// message after the check will see it
+		LockGuard<Mutex> lock(self.m_mutex);
+		self.m_drainThreadSleeping.store(true);
+		if(!self.hasPendingMessages() && !self.m_quitDrainThread.load())
+		{
+			self.m_drainCondVar.wait(self.m_mutex);
+		}
+		self.m_drainThreadSleeping.store(false);
+	}
+
+	return Error::NONE;
+}
+
 void Logger::defaultSystemMessageHandler(void*, const LoggerMessageInfo& info)
 {
 #if ANKI_OS_LINUX
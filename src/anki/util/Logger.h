@@ -8,6 +8,8 @@
 #include <anki/Config.h>
 #include <anki/util/Singleton.h>
 #include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
+#include <cstdarg>
 
 namespace anki
 {
@@ -51,9 +53,16 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 /// thread safe.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
+///
+/// By default the handlers are called on the thread that writes the message. In async mode (see startAsync()) every
+/// thread formats its messages into a lock-free ring buffer of its own and a background thread passes them to the
+/// handlers. The background thread sleeps when there is nothing to pass. Messages that don't fit in a ring buffer are
+/// dropped and counted. FATAL messages are always handled synchronously, after flushing the pending messages.
 class Logger
 {
 public:
+	static constexpr U32 ASYNC_RING_BUFFER_SIZE = 64 * 1024; ///< Per thread. Should be power of 2.
+
 	/// Initialize the logger and add the default message handler
 	Logger();
 
@@ -87,7 +96,30 @@ public:
 		const char* fmt,
 		...);
 
+	/// Start the async mode. It spawns the thread that drains the messages.
+	void startAsync();
+
+	/// Flush the pending messages and go back to synchronous mode.
+	void stopAsync();
+
+	/// Pass all the pending messages of the async mode to the handlers. It blocks.
+	void flush();
+
+	Bool isAsync() const
+	{
+		return m_async.load();
+	}
+
+	/// Get the number of messages that got dropped because a ring buffer was full.
+	U64 getDroppedMessageCount() const
+	{
+		return m_droppedMessageCount.load();
+	}
+
 private:
+	class ThreadLocal;
+	class ThreadLocalList;
+	class AsyncMessageHeader;
 	class Handler
 	{
 	public:
@@ -109,6 +141,61 @@ private:
 	Array<Handler, 4> m_handlers;
 	U32 m_handlersCount = 0;
 
+	/// @name Async mode
+	/// @{
+	/// The ThreadLocal of every Logger the thread wrote to. They are looked up with m_uuid.
+	static thread_local ThreadLocalList m_threadLocalList;
+	U64 m_uuid; ///< Unique for every Logger. Unlike the address of the Logger it's never re-used.
+	Atomic<ThreadLocal*> m_threadLocalsHead = {nullptr}; ///< Lock-free list of all the ThreadLocal.
+
+	Thread m_drainThread = {"AnKiLogger"};
+	ConditionVariable m_drainCondVar; ///< Wakes the drain thread. Used with m_mutex.
+	Atomic<Bool, AtomicMemoryOrder::SEQ_CST> m_drainThreadSleeping = {false};
+	Atomic<Bool> m_async = {false};
+	Atomic<Bool> m_quitDrainThread = {false};
+	Atomic<U64> m_droppedMessageCount = {0};
+	/// @}
+
+	void callHandlers(const LoggerMessageInfo& info);
+
+	void writeAsync(const char* file,
+		int line,
+		const char* func,
+		const char* subsystem,
+		LoggerMessageType type,
+		ThreadId tid,
+		const char* fmt,
+		va_list args);
+
+	void writeAsyncFormated(const char* file,
+		int line,
+		const char* func,
+		const char* subsystem,
+		LoggerMessageType type,
+		ThreadId tid,
+		const char* fmt,
+		...);
+
+	ThreadLocal& getThreadLocal(ThreadId tid);
+
+	/// Release the reference of the Logger to a ThreadLocal and free its ring buffer.
+	static void releaseThreadLocal(ThreadLocal& tlocal);
+
+	/// Drain the ring buffers and free the ThreadLocal of the threads that exited. Needs m_mutex to be locked.
+	void drainAllThreadLocals();
+
+	/// Remove a ThreadLocal from the m_threadLocalsHead list. Needs m_mutex to be locked.
+	/// @return The new previous of the ThreadLocal's next.
+	ThreadLocal* unlinkThreadLocal(ThreadLocal* prev, ThreadLocal& tlocal);
+
+	/// Check if there are messages to drain. Needs m_mutex to be locked.
+	Bool hasPendingMessages() const;
+
+	/// Wake the drain thread if it sleeps.
+	void wakeDrainThread();
+
+	static Error drainThreadCallback(ThreadCallbackInfo& info);
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
 };
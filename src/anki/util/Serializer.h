@@ -105,7 +105,7 @@ public:
 	{
 		if(!m_err)
 		{
-			m_err = doArrayComplexType(arr, size);
+			m_err = doArrayComplexType(arr, size, memberOffset);
 		}
 	}
 
@@ -160,7 +160,7 @@ private:
 	Error m_err = Error::NONE;
 
 	template<typename T>
-	ANKI_USE_RESULT Error doArrayComplexType(const T* arr, PtrSize size);
+	ANKI_USE_RESULT Error doArrayComplexType(const T* arr, PtrSize size, PtrSize memberOffset);
 
 	template<typename T>
 	ANKI_USE_RESULT Error doDynamicArrayComplexType(const T* arr, PtrSize size, PtrSize memberOffset);
@@ -191,9 +191,10 @@ public:
 	/// Serialize a class.
 	/// @param x The struct to read.
 	/// @param allocator The allocator to use to allocate the new structures.
-	/// @param file The file to read from.
-	template<typename T>
-	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file);
+	/// @param file The file to read from. It can be a File or any other class with the same read(), seek() and getSize()
+	///             interface. The serialized data should start at the beginning of the file.
+	template<typename T, typename TFile>
+	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, TFile& file);
 
 	/// Read a single value. Can't call this directly.
 	template<typename T>
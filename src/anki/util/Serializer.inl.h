@@ -89,14 +89,14 @@ Error BinarySerializer::serializeInternal(const T& x, GenericMemoryPoolAllocator
 }
 
 template<typename T>
-Error BinarySerializer::doArrayComplexType(const T* arr, PtrSize size)
+Error BinarySerializer::doArrayComplexType(const T* arr, PtrSize size, PtrSize memberOffset)
 {
 	ANKI_ASSERT(arr && size > 0);
 	check();
 	checkStruct<T>();
 
 	// Serialize pointers
-	PtrSize structFilePos = m_structureFilePos.getBack();
+	PtrSize structFilePos = m_structureFilePos.getBack() + memberOffset;
 	for(PtrSize i = 0; i < size; ++i)
 	{
 		m_structureFilePos.emplaceBack(m_alloc, structFilePos);
@@ -161,14 +161,14 @@ Error BinarySerializer::doDynamicArrayComplexType(const T* arr, PtrSize size, Pt
 	return Error::NONE;
 }
 
-template<typename T>
-Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file)
+template<typename T, typename TFile>
+Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, TFile& file)
 {
 	x = nullptr;
 
 	detail::BinarySerializerHeader header;
 	ANKI_CHECK(file.read(&header, sizeof(header)));
-	const PtrSize dataFilePos = file.tell();
+	const PtrSize dataFilePos = sizeof(header);
 
 	// Sanity checks
 	{
@@ -53,6 +53,9 @@ public:
 	/// Identify the current thread
 	static ThreadId getCurrentThreadId();
 
+	/// Give the rest of the time slice to another thread.
+	static void yield();
+
 anki_internal:
 	const char* getName() const
 	{
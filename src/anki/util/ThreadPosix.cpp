@@ -9,6 +9,7 @@
 #include <cstring>
 #include <algorithm>
 #include <pthread.h>
+#include <sched.h>
 #include <semaphore.h>
 
 namespace anki
@@ -125,6 +126,11 @@ ThreadId Thread::getCurrentThreadId()
 	return pid;
 }
 
+void Thread::yield()
+{
+	sched_yield();
+}
+
 Mutex::Mutex()
 {
 	pthread_mutex_t* mtx = static_cast<pthread_mutex_t*>(malloc(sizeof(pthread_mutex_t)));
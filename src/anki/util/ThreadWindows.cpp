@@ -118,6 +118,11 @@ ThreadId Thread::getCurrentThreadId()
 	return PtrSize(x);
 }
 
+void Thread::yield()
+{
+	SwitchToThread();
+}
+
 Mutex::Mutex()
 {
 	CRITICAL_SECTION* mtx = reinterpret_cast<CRITICAL_SECTION*>(malloc(sizeof(CRITICAL_SECTION)));
@@ -521,6 +521,70 @@ ANKI_TEST(Gr, SimpleDrawcall)
 	COMMON_END()
 }
 
+ANKI_TEST(Gr, PipelinePrewarm)
+{
+	// The GrManager stores the manifest in the cache directory of the tests. Start with an invalid one
+	const CString manifestFilename = "./vk_pipeline_manifest";
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(manifestFilename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	}
+
+	for(U32 run = 0; run < 3; ++run)
+	{
+		if(run == 2)
+		{
+			// Corrupt the last entry of the manifest. It should be ignored
+			HeapAllocator<U8> alloc(allocAligned, nullptr);
+			DynamicArrayAuto<U8> manifest(alloc);
+			{
+				File file;
+				ANKI_TEST_EXPECT_NO_ERR(file.open(manifestFilename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+				manifest.create(U32(file.getSize()));
+				ANKI_TEST_EXPECT_NO_ERR(file.read(&manifest[0], manifest.getSize()));
+			}
+
+			manifest.getBack() ^= 0xFF;
+
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(manifestFilename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&manifest[0], manifest.getSize()));
+		}
+
+		COMMON_BEGIN()
+
+		// Creating the program queues the pipelines of the manifest. The drawcall comes right after and it shouldn't
+		// wait for the queue
+		ShaderProgramPtr prog = createProgram(VERT_SRC, FRAG_SRC, *gr);
+
+		TexturePtr presentTex = gr->acquireNextPresentableTexture();
+		FramebufferPtr fb = createColorFb(*gr, presentTex);
+
+		CommandBufferInitInfo cinit;
+		cinit.m_flags = CommandBufferFlag::GRAPHICS_WORK;
+		CommandBufferPtr cmdb = gr->newCommandBuffer(cinit);
+
+		cmdb->setViewport(0, 0, WIDTH, HEIGHT);
+		cmdb->bindShaderProgram(prog);
+		presentBarrierA(cmdb, presentTex);
+		cmdb->beginRenderPass(fb, {{TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE}}, {});
+		cmdb->drawArrays(PrimitiveTopology::TRIANGLES, 3);
+		cmdb->endRenderPass();
+		presentBarrierB(cmdb, presentTex);
+		cmdb->flush();
+
+		gr->swapBuffers();
+		gr->finish();
+
+		// Either the prewarming or the drawcall created the pipeline, not both
+		const GrManagerStats stats = gr->getStats();
+		ANKI_TEST_EXPECT_EQ(stats.m_prewarmedPipelineCount, (run == 1) ? 1u : 0u);
+		ANKI_TEST_EXPECT_EQ(stats.m_createdPipelineCount, 1u);
+
+		COMMON_END()
+	}
+}
+
 ANKI_TEST(Gr, ViewportAndScissor)
 {
 #if 0
@@ -1788,6 +1852,94 @@ ANKI_TEST(Gr, RenderGraph)
 	}
 
 	rgraph->compileNewGraph(descr, alloc);
+	rgraph->reset();
+
+	// Some RTs have disjoint lifetimes and they should share textures
+	RenderGraphStatistics stats;
+	rgraph->getStatistics(stats);
+	ANKI_TEST_EXPECT_LEQ(stats.m_transientRenderTargetMemory, stats.m_transientRenderTargetMemoryWithoutAliasing);
+
+	// Same graph again, it should re-use the previous schedule
+	rgraph->compileNewGraph(descr, alloc);
+	rgraph->reset();
+
+	RenderGraphStatistics stats2;
+	rgraph->getStatistics(stats2);
+	ANKI_TEST_EXPECT_EQ(stats2.m_scheduleCacheHits, stats.m_scheduleCacheHits + 1);
+	ANKI_TEST_EXPECT_EQ(stats2.m_scheduleCacheMisses, stats.m_scheduleCacheMisses);
+
+	// Change the graph, the schedule can't be re-used
+	{
+		GraphicsRenderPassDescription& pass = descr.newGraphicsRenderPass("Final");
+		pass.newDependency({taaRt, TextureUsageBit::SAMPLED_FRAGMENT});
+	}
+
+	rgraph->compileNewGraph(descr, alloc);
+	rgraph->reset();
+
+	RenderGraphStatistics stats3;
+	rgraph->getStatistics(stats3);
+	ANKI_TEST_EXPECT_EQ(stats3.m_scheduleCacheHits, stats2.m_scheduleCacheHits);
+	ANKI_TEST_EXPECT_EQ(stats3.m_scheduleCacheMisses, stats2.m_scheduleCacheMisses + 1);
+
+	// A chain of 3 RTs. The 1st and the 3rd have disjoint lifetimes and they should share a texture
+	{
+		RenderGraphDescription chainDescr(alloc);
+		RenderTargetHandle rtA = chainDescr.newRenderTarget(newRTDescr("A"));
+		RenderTargetHandle rtB = chainDescr.newRenderTarget(newRTDescr("B"));
+		RenderTargetHandle rtC = chainDescr.newRenderTarget(newRTDescr("C"));
+		RenderTargetHandle outRt = chainDescr.importRenderTarget(dummyTex, TextureUsageBit::NONE);
+
+		GraphicsRenderPassDescription& pass0 = chainDescr.newGraphicsRenderPass("0");
+		pass0.newDependency({rtA, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+
+		GraphicsRenderPassDescription& pass1 = chainDescr.newGraphicsRenderPass("1");
+		pass1.newDependency({rtA, TextureUsageBit::SAMPLED_FRAGMENT});
+		pass1.newDependency({rtB, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+
+		GraphicsRenderPassDescription& pass2 = chainDescr.newGraphicsRenderPass("2");
+		pass2.newDependency({rtB, TextureUsageBit::SAMPLED_FRAGMENT});
+		pass2.newDependency({rtC, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+
+		GraphicsRenderPassDescription& pass3 = chainDescr.newGraphicsRenderPass("3");
+		pass3.newDependency({rtC, TextureUsageBit::SAMPLED_FRAGMENT});
+		pass3.newDependency({outRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+
+		rgraph->compileNewGraph(chainDescr, alloc);
+		rgraph->reset();
+
+		RenderGraphStatistics chainStats;
+		rgraph->getStatistics(chainStats);
+		ANKI_TEST_EXPECT_GT(chainStats.m_transientRenderTargetMemory, 0);
+		ANKI_TEST_EXPECT_EQ(chainStats.m_transientRenderTargetMemory * 3,
+			chainStats.m_transientRenderTargetMemoryWithoutAliasing * 2);
+	}
+
+	// Two RTs that live at the same time can't share
+	{
+		RenderGraphDescription overlapDescr(alloc);
+		RenderTargetHandle rtA = overlapDescr.newRenderTarget(newRTDescr("A"));
+		RenderTargetHandle rtB = overlapDescr.newRenderTarget(newRTDescr("B"));
+		RenderTargetHandle outRt = overlapDescr.importRenderTarget(dummyTex, TextureUsageBit::NONE);
+
+		GraphicsRenderPassDescription& pass0 = overlapDescr.newGraphicsRenderPass("0");
+		pass0.newDependency({rtA, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+		pass0.newDependency({rtB, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+
+		GraphicsRenderPassDescription& pass1 = overlapDescr.newGraphicsRenderPass("1");
+		pass1.newDependency({rtA, TextureUsageBit::SAMPLED_FRAGMENT});
+		pass1.newDependency({rtB, TextureUsageBit::SAMPLED_FRAGMENT});
+		pass1.newDependency({outRt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_WRITE});
+
+		rgraph->compileNewGraph(overlapDescr, alloc);
+		rgraph->reset();
+
+		RenderGraphStatistics overlapStats;
+		rgraph->getStatistics(overlapStats);
+		ANKI_TEST_EXPECT_GT(overlapStats.m_transientRenderTargetMemory, 0);
+		ANKI_TEST_EXPECT_EQ(
+			overlapStats.m_transientRenderTargetMemory, overlapStats.m_transientRenderTargetMemoryWithoutAliasing);
+	}
 	COMMON_END()
 }
 
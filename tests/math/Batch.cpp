@@ -0,0 +1,175 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/math/Batch.h>
+#include <anki/math/Axisang.h>
+#include <anki/util/HighRezTimer.h>
+#include <vector>
+
+using namespace anki;
+
+static F32 randFactor()
+{
+	return F32(rand()) / F32(RAND_MAX);
+}
+
+static Vec3 randVec3()
+{
+	return Vec3(randFactor(), randFactor(), randFactor()) * 200.0f - 100.0f;
+}
+
+static Mat3 randRotation()
+{
+	return Mat3(Quat(Axisang(randFactor() * PI, randVec3().getNormalized())));
+}
+
+static Mat3x4 randTransform()
+{
+	return Mat3x4(randVec3(), randRotation(), 0.5f + randFactor());
+}
+
+static Mat4 randMat4()
+{
+	return Mat4(Vec4(randVec3(), 1.0f), randRotation(), 0.5f + randFactor());
+}
+
+template<typename T>
+static void expectNear(const T& a, const T& b)
+{
+	for(U i = 0; i < sizeof(T) / sizeof(F32); ++i)
+	{
+		ANKI_TEST_EXPECT_NEAR(a[i], b[i], absolute(a[i]) * 1.0e-4f + 1.0e-3f);
+	}
+}
+
+/// Run a batch function with all the backends, compare the results and time them.
+template<typename TOut, typename TFunc>
+static void testAllBackends(const char* name, U32 count, TFunc func)
+{
+	const MathBatchBackend originalBackend = getMathBatchBackend();
+
+	std::vector<TOut> reference(count);
+	std::vector<TOut> out(count);
+	for(MathBatchBackend backend = MathBatchBackend::GENERIC; backend < MathBatchBackend::COUNT;
+		backend = MathBatchBackend(U(backend) + 1))
+	{
+		if(!isMathBatchBackendSupported(backend))
+		{
+			continue;
+		}
+
+		setMathBatchBackend(backend);
+
+		std::vector<TOut>& results = (backend == MathBatchBackend::GENERIC) ? reference : out;
+		const Second begin = HighRezTimer::getCurrentTime();
+		func(WeakArray<TOut>(&results[0], count));
+		const Second time = HighRezTimer::getCurrentTime() - begin;
+
+		ANKI_TEST_LOGI("%s: backend %u, %f ms for %u elements", name, U(backend), time * 1000.0, count);
+
+		if(backend != MathBatchBackend::GENERIC)
+		{
+			for(U32 i = 0; i < count; ++i)
+			{
+				expectNear(reference[i], out[i]);
+			}
+		}
+	}
+
+	setMathBatchBackend(originalBackend);
+}
+
+ANKI_TEST(Math, Batch)
+{
+	// Odd count to test the remainders
+	const U32 COUNT = 64 * 1024 + 3;
+	const Mat3x4 trf = randTransform();
+	const Mat4 mat = randMat4();
+
+	std::vector<Vec3> points(COUNT);
+	std::vector<Vec4> points4(COUNT);
+	std::vector<Vec3> mins(COUNT);
+	std::vector<Vec3> maxs(COUNT);
+	std::vector<Mat4> mats(COUNT);
+	std::vector<Mat3x4> trfs(COUNT);
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		points[i] = randVec3();
+		points4[i] = Vec4(points[i], 1.0f);
+		mins[i] = randVec3();
+		maxs[i] = mins[i] + Vec3(randFactor(), randFactor(), randFactor()) * 10.0f;
+		trfs[i] = randTransform();
+		mats[i] = randMat4();
+	}
+
+	testAllBackends<Vec3>("batchTransformPoints(Mat3x4)", COUNT, [&](WeakArray<Vec3> out) {
+		batchTransformPoints(trf, ConstWeakArray<Vec3>(&points[0], COUNT), out);
+	});
+
+	testAllBackends<Vec4>("batchTransformPoints(Mat4)", COUNT, [&](WeakArray<Vec4> out) {
+		batchTransformPoints(mat, ConstWeakArray<Vec4>(&points4[0], COUNT), out);
+	});
+
+	testAllBackends<Vec3>("batchTransformAabbs", COUNT, [&](WeakArray<Vec3> out) {
+		std::vector<Vec3> outMaxs(COUNT);
+		batchTransformAabbs(trf,
+			ConstWeakArray<Vec3>(&mins[0], COUNT),
+			ConstWeakArray<Vec3>(&maxs[0], COUNT),
+			out,
+			WeakArray<Vec3>(&outMaxs[0], COUNT));
+	});
+
+	testAllBackends<Mat4>("batchMultiplyMatrices", COUNT, [&](WeakArray<Mat4> out) {
+		batchMultiplyMatrices(mat, ConstWeakArray<Mat4>(&mats[0], COUNT), out);
+	});
+
+	testAllBackends<Mat3x4>("batchCombineTransformations", COUNT, [&](WeakArray<Mat3x4> out) {
+		batchCombineTransformations(trf, ConstWeakArray<Mat3x4>(&trfs[0], COUNT), out);
+	});
+
+	// The AABBs should contain the transformed corners
+	std::vector<Vec3> outMins(COUNT);
+	std::vector<Vec3> outMaxs(COUNT);
+	batchTransformAabbs(trf,
+		ConstWeakArray<Vec3>(&mins[0], COUNT),
+		ConstWeakArray<Vec3>(&maxs[0], COUNT),
+		WeakArray<Vec3>(&outMins[0], COUNT),
+		WeakArray<Vec3>(&outMaxs[0], COUNT));
+	for(U32 i = 0; i < COUNT; i += 97)
+	{
+		for(U corner = 0; corner < 8; ++corner)
+		{
+			const Vec3 p((corner & 1) ? maxs[i].x() : mins[i].x(),
+				(corner & 2) ? maxs[i].y() : mins[i].y(),
+				(corner & 4) ? maxs[i].z() : mins[i].z());
+			const Vec3 tp = trf * Vec4(p, 1.0f);
+			for(U c = 0; c < 3; ++c)
+			{
+				ANKI_TEST_EXPECT_GEQ(tp[c], outMins[i][c] - 1.0e-3f);
+				ANKI_TEST_EXPECT_LEQ(tp[c], outMaxs[i][c] + 1.0e-3f);
+			}
+		}
+	}
+
+	// In-place transformation should give the same results
+	std::vector<Vec3> inPlace = points;
+	batchTransformPoints(trf, ConstWeakArray<Vec3>(&inPlace[0], COUNT), WeakArray<Vec3>(&inPlace[0], COUNT));
+	for(U32 i = 0; i < COUNT; i += 13)
+	{
+		expectNear(inPlace[i], trf * Vec4(points[i], 1.0f));
+	}
+
+	// Slerp
+	const Quat q0(Axisang(0.1f, Vec3(0.0f, 1.0f, 0.0f)));
+	const Quat q1(Axisang(1.1f, Vec3(0.0f, 1.0f, 0.0f)));
+	const Array<Quat, 2> from = {{q0, q0}};
+	const Array<Quat, 2> to = {{q1, q1}};
+	const Array<F32, 2> factors = {{0.0f, 0.5f}};
+	Array<Quat, 2> slerped;
+	batchSlerpQuats(from, to, factors, slerped);
+	expectNear(slerped[0], q0);
+	expectNear(slerped[1], Quat(Axisang(0.6f, Vec3(0.0f, 1.0f, 0.0f))));
+}
@@ -0,0 +1,198 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/physics/PhysicsWorld.h>
+#include <anki/physics/PhysicsCollisionShape.h>
+#include <anki/physics/PhysicsBody.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
+
+ANKI_TEST(Physics, BatchedQueries)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive hive(getCpuCoresCount(), alloc);
+
+	PhysicsWorld* world = alloc.newInstance<PhysicsWorld>();
+	ANKI_TEST_EXPECT_NO_ERR(world->create(allocAligned, nullptr));
+
+	{
+		// A grid of boxes
+		const U GRID_SIZE = 32;
+		const F32 SPACING = 4.0f;
+		PhysicsCollisionShapePtr box = world->newInstance<PhysicsBox>(Vec3(1.0f));
+		DynamicArrayAuto<PhysicsBodyPtr> bodies(alloc);
+		bodies.create(GRID_SIZE * GRID_SIZE);
+		for(U i = 0; i < GRID_SIZE * GRID_SIZE; ++i)
+		{
+			PhysicsBodyInitInfo init;
+			init.m_shape = box;
+			init.m_transform.setOrigin(Vec4(F32(i % GRID_SIZE) * SPACING, 0.0f, F32(i / GRID_SIZE) * SPACING, 0.0f));
+			bodies[i] = world->newInstance<PhysicsBody>(init);
+		}
+
+		// Rays that go down to the center of each box
+		const U RAY_COUNT = 64 * 1024;
+		DynamicArrayAuto<PhysicsWorldQuery> queries(alloc);
+		DynamicArrayAuto<PhysicsWorldQueryResult> results(alloc);
+		queries.create(RAY_COUNT);
+		results.create(RAY_COUNT);
+		for(U i = 0; i < RAY_COUNT; ++i)
+		{
+			const U cell = i % (GRID_SIZE * GRID_SIZE);
+			const Vec3 center(F32(cell % GRID_SIZE) * SPACING, 0.0f, F32(cell / GRID_SIZE) * SPACING);
+			queries[i].m_from = center + Vec3(0.0f, 10.0f, 0.0f);
+			queries[i].m_to = center - Vec3(0.0f, 10.0f, 0.0f);
+		}
+
+		// Serial
+		Second begin = HighRezTimer::getCurrentTime();
+		world->query(ConstWeakArray<PhysicsWorldQuery>(&queries[0], RAY_COUNT),
+			WeakArray<PhysicsWorldQueryResult>(&results[0], RAY_COUNT),
+			nullptr);
+		const Second serialTime = HighRezTimer::getCurrentTime() - begin;
+
+		for(U i = 0; i < RAY_COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(results[i].m_object, bodies[i % (GRID_SIZE * GRID_SIZE)].get());
+			ANKI_TEST_EXPECT_NEAR(results[i].m_worldPosition.y(), 1.0f, 0.1f);
+		}
+
+		// Parallel
+		begin = HighRezTimer::getCurrentTime();
+		world->query(ConstWeakArray<PhysicsWorldQuery>(&queries[0], RAY_COUNT),
+			WeakArray<PhysicsWorldQueryResult>(&results[0], RAY_COUNT),
+			&hive);
+		const Second parallelTime = HighRezTimer::getCurrentTime() - begin;
+
+		for(U i = 0; i < RAY_COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(results[i].m_object, bodies[i % (GRID_SIZE * GRID_SIZE)].get());
+		}
+
+		ANKI_TEST_LOGI("Rays per ms: serial %f, parallel %f (%u threads)",
+			F64(RAY_COUNT) / (serialTime * 1000.0),
+			F64(RAY_COUNT) / (parallelTime * 1000.0),
+			hive.getThreadCount() + 1);
+
+		// Sweeps and overlaps
+		Array<PhysicsWorldQuery, 3> shapeQueries;
+		shapeQueries[0].m_type = PhysicsWorldQueryType::SPHERE_SWEEP;
+		shapeQueries[0].m_from = Vec3(0.0f, 10.0f, 0.0f);
+		shapeQueries[0].m_to = Vec3(0.0f, -10.0f, 0.0f);
+		shapeQueries[0].m_extend = Vec3(0.5f);
+		shapeQueries[1].m_type = PhysicsWorldQueryType::BOX_OVERLAP;
+		shapeQueries[1].m_from = Vec3(SPACING, 1.2f, 0.0f);
+		shapeQueries[1].m_extend = Vec3(0.5f);
+		shapeQueries[2].m_type = PhysicsWorldQueryType::SPHERE_OVERLAP;
+		shapeQueries[2].m_from = Vec3(SPACING / 2.0f, 0.0f, 0.0f);
+		shapeQueries[2].m_extend = Vec3(0.5f);
+
+		Array<PhysicsWorldQueryResult, 3> shapeResults;
+		world->query(shapeQueries, shapeResults, &hive);
+
+		ANKI_TEST_EXPECT_EQ(shapeResults[0].m_object, bodies[0].get());
+		ANKI_TEST_EXPECT_NEAR(shapeResults[0].m_worldPosition.y(), 1.0f, 0.1f);
+		ANKI_TEST_EXPECT_EQ(shapeResults[1].m_object, bodies[1].get());
+		ANKI_TEST_EXPECT_EQ(shapeResults[2].m_object, static_cast<PhysicsFilteredObject*>(nullptr));
+	}
+
+	hive.waitAllTasks();
+	alloc.deleteInstance(world);
+}
+
+ANKI_TEST(Physics, TriangleSoupBvh)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	PhysicsWorld* world = alloc.newInstance<PhysicsWorld>();
+	ANKI_TEST_EXPECT_NO_ERR(world->create(allocAligned, nullptr));
+
+	{
+		// A grid of quads on the XZ plane
+		const U32 GRID_SIZE = 16;
+		DynamicArrayAuto<Vec3> positions(alloc);
+		for(U32 z = 0; z <= GRID_SIZE; ++z)
+		{
+			for(U32 x = 0; x <= GRID_SIZE; ++x)
+			{
+				positions.emplaceBack(F32(x), 0.0f, F32(z));
+			}
+		}
+
+		DynamicArrayAuto<U32> indices(alloc);
+		for(U32 z = 0; z < GRID_SIZE; ++z)
+		{
+			for(U32 x = 0; x < GRID_SIZE; ++x)
+			{
+				const U32 i0 = z * (GRID_SIZE + 1) + x;
+				const U32 i1 = i0 + 1;
+				const U32 i2 = i0 + GRID_SIZE + 1;
+				const U32 i3 = i2 + 1;
+				const Array<U32, 6> quad = {{i0, i2, i1, i1, i2, i3}};
+				for(U32 idx : quad)
+				{
+					indices.emplaceBack(idx);
+				}
+			}
+		}
+
+		// Build and serialize
+		DynamicArrayAuto<U8> bvh(alloc);
+		{
+			PhysicsPtr<PhysicsTriangleSoup> soup = world->newInstance<PhysicsTriangleSoup>(positions, indices);
+			ANKI_TEST_EXPECT_EQ(soup->isBvhDeserialized(), false);
+			soup->serializeBvh(bvh);
+			ANKI_TEST_EXPECT_GT(bvh.getSize(), 0u);
+		}
+
+		// Reload and cast rays to the center of every quad
+		{
+			PhysicsPtr<PhysicsTriangleSoup> soup =
+				world->newInstance<PhysicsTriangleSoup>(positions, indices, false, bvh);
+			ANKI_TEST_EXPECT_EQ(soup->isBvhDeserialized(), true);
+
+			PhysicsBodyInitInfo init;
+			init.m_shape = soup;
+			PhysicsBodyPtr body = world->newInstance<PhysicsBody>(init);
+
+			DynamicArrayAuto<PhysicsWorldQuery> queries(alloc);
+			DynamicArrayAuto<PhysicsWorldQueryResult> results(alloc);
+			queries.create(GRID_SIZE * GRID_SIZE);
+			results.create(GRID_SIZE * GRID_SIZE);
+			for(U32 i = 0; i < queries.getSize(); ++i)
+			{
+				const Vec3 center(F32(i % GRID_SIZE) + 0.5f, 0.0f, F32(i / GRID_SIZE) + 0.5f);
+				queries[i].m_from = center + Vec3(0.0f, 10.0f, 0.0f);
+				queries[i].m_to = center - Vec3(0.0f, 10.0f, 0.0f);
+			}
+
+			world->query(queries, WeakArray<PhysicsWorldQueryResult>(results), nullptr);
+
+			for(U32 i = 0; i < results.getSize(); ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(results[i].m_object, body.get());
+				ANKI_TEST_EXPECT_NEAR(results[i].m_worldPosition.y(), 0.0f, 0.1f);
+			}
+		}
+
+		// A truncated BVH gets rebuilt
+		{
+			PhysicsPtr<PhysicsTriangleSoup> soup = world->newInstance<PhysicsTriangleSoup>(
+				positions, indices, false, ConstWeakArray<U8>(&bvh[0], 16));
+			ANKI_TEST_EXPECT_EQ(soup->isBvhDeserialized(), false);
+		}
+
+		// A BVH that points to triangles that don't exist gets rebuilt
+		{
+			PhysicsPtr<PhysicsTriangleSoup> soup = world->newInstance<PhysicsTriangleSoup>(
+				positions, ConstWeakArray<U32>(&indices[0], indices.getSize() / 2), false, bvh);
+			ANKI_TEST_EXPECT_EQ(soup->isBvhDeserialized(), false);
+		}
+	}
+
+	alloc.deleteInstance(world);
+}
@@ -63,6 +63,11 @@ ANKI_TEST(Renderer, TileAllocator)
 	res = talloc.allocate(crntTimestamp, lightTimestamp, lightUuid + 4, 0, dcCount + 1, 2, viewport);
 	ANKI_TEST_EXPECT_EQ(res, TileAllocatorResult::ALLOCATION_SUCCEEDED);
 
+	// Mark some uncached content
+	ANKI_TEST_EXPECT_EQ(talloc.exchangeUncachedContent(lightUuid + 3, 0, true), false);
+	ANKI_TEST_EXPECT_EQ(talloc.exchangeUncachedContent(lightUuid + 3, 0, false), true);
+	ANKI_TEST_EXPECT_EQ(talloc.exchangeUncachedContent(lightUuid + 100, 0, true), false);
+
 	// Allocate 16 small
 	for(U i = 0; i < 16; ++i)
 	{
@@ -0,0 +1,122 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/resource/MaterialResource.h>
+#include <anki/resource/ShaderProgramResource.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/resource/ResourceBinary.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/Serializer.h>
+#include <anki/util/Hash.h>
+
+namespace anki
+{
+
+static const char* MTL_FILENAME = "MaterialResourceTest.ankimtl";
+
+static const char* MTL_SRC = R"(<?xml version="1.0" encoding="UTF-8" ?>
+<material shaderProgram="shaders/ForwardShadingParticles.glslp" forwardShading="1" shadow="0">
+	<mutators>
+		<mutator name="ANIMATED_TEXTURE" value="0"/>
+		<mutator name="LIGHT" value="1"/>
+	</mutators>
+
+	<inputs>
+		<input shaderInput="mvp" builtin="MODEL_VIEW_PROJECTION_MATRIX"/>
+		<input shaderInput="cameraRotMat" builtin="CAMERA_ROTATION_MATRIX"/>
+		<input shaderInput="globalSampler" builtin="GLOBAL_SAMPLER"/>
+
+		<input shaderInput="diffuseMap" value="engine_data/GreenDecal.ankitex"/>
+		<input shaderInput="colorScale" value="1.0 1.0 1.0 1.0"/>
+		<input shaderInput="colorBias" value="0 0 0 0"/>
+	</inputs>
+</material>
+)";
+
+static void testMaterial(ResourceManager& resources)
+{
+	MaterialResourcePtr mtl;
+	ANKI_TEST_EXPECT_NO_ERR(resources.loadResource(MTL_FILENAME, mtl, false));
+
+	ANKI_TEST_EXPECT_EQ(mtl->getShaderProgramResource()->getFilename(), "shaders/ForwardShadingParticles.glslp");
+	ANKI_TEST_EXPECT_EQ(mtl->castsShadow(), false);
+	ANKI_TEST_EXPECT_EQ(mtl->isForwardShading(), true);
+	ANKI_TEST_EXPECT_EQ(mtl->getVariables().getSize(), 4);
+}
+
+/// Make the baked material look like it was baked against an older version of a program.
+static void makeBakeStale(CString bakedFilename, CString programFilename)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	MaterialBinary* bin;
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(bakedFilename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserialize(bin, alloc, file));
+	}
+
+	bin->m_programInterfaceHash += 1;
+	bin->m_shaderProgram = WeakArray<char>(const_cast<char*>(programFilename.cstr()), programFilename.getLength() + 1);
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(bakedFilename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(*bin, alloc, file));
+	}
+
+	alloc.getMemoryPool().free(bin);
+}
+
+ANKI_TEST(Resource, MaterialResource)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs);
+
+	// The material is written in the cache directory. The baked form goes there as well
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(MTL_FILENAME, FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.write(MTL_SRC, strlen(MTL_SRC)));
+	}
+
+	StringAuto bakedFilename(resources->getTempAllocator());
+	bakedFilename.sprintf("baked/%016" PRIx64 ".ankimtlbin", computeHash(MTL_SRC, strlen(MTL_SRC)));
+
+	// Parse and bake
+	testMaterial(*resources);
+	ANKI_TEST_EXPECT_EQ(fileExists(bakedFilename.toCString()), true);
+
+	// Load the baked form
+	testMaterial(*resources);
+
+	// Stale bake that points to the same program. The program is re-used when the XML is parsed again
+	makeBakeStale(bakedFilename.toCString(), "shaders/ForwardShadingParticles.glslp");
+	testMaterial(*resources);
+
+	// Stale bake that points to another program
+	makeBakeStale(bakedFilename.toCString(), "shaders/ForwardShadingFog.glslp");
+	testMaterial(*resources);
+
+	// The stale bakes were replaced
+	testMaterial(*resources);
+
+	delete resources;
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
+
+} // end namespace anki
@@ -0,0 +1,213 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/resource/MeshResource.h>
+#include <anki/resource/MeshLoader.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/collision/Functions.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/File.h>
+
+namespace anki
+{
+
+static const char* MESH_FILENAME = "MeshResourceTest.ankimesh";
+
+/// Write a mesh with two quads and one meshlet per quad. The 1st quad is at the origin and it faces +Z. The 2nd is
+/// centered at X=10 and it faces -Z.
+static void writeMesh(MeshBinaryFile::Flag flags, const Array<MeshBinaryFile::Meshlet, 2>& meshlets)
+{
+	const Array<Vec3, 8> positions = {{Vec3(-1.0f, -1.0f, 0.0f),
+		Vec3(1.0f, -1.0f, 0.0f),
+		Vec3(1.0f, 1.0f, 0.0f),
+		Vec3(-1.0f, 1.0f, 0.0f),
+		Vec3(9.0f, -1.0f, 0.0f),
+		Vec3(11.0f, -1.0f, 0.0f),
+		Vec3(11.0f, 1.0f, 0.0f),
+		Vec3(9.0f, 1.0f, 0.0f)}};
+	const Array<U16, 12> indices = {{0, 1, 2, 2, 3, 0, 4, 6, 5, 6, 4, 7}};
+	const Array<U32, 8 * 3> otherAttribs = {}; // Normal, tangent and UV
+
+	MeshBinaryFile::Header header = {};
+	memcpy(&header.m_magic[0], MeshBinaryFile::MAGIC, 8);
+	header.m_flags = flags;
+	header.m_vertexBufferCount = 2;
+	header.m_vertexBuffers[0].m_vertexStride = sizeof(Vec3);
+	header.m_vertexBuffers[1].m_vertexStride = sizeof(U32) * 3;
+	header.m_vertexAttributes[VertexAttributeLocation::POSITION] = {0, Format::R32G32B32_SFLOAT, 0, 1.0f};
+	header.m_vertexAttributes[VertexAttributeLocation::NORMAL] = {1, Format::A2B10G10R10_SNORM_PACK32, 0, 1.0f};
+	header.m_vertexAttributes[VertexAttributeLocation::TANGENT] = {1, Format::A2B10G10R10_SNORM_PACK32, 4, 1.0f};
+	header.m_vertexAttributes[VertexAttributeLocation::UV] = {1, Format::R16G16_SFLOAT, 8, 1.0f};
+	header.m_indexType = IndexType::U16;
+	header.m_totalIndexCount = indices.getSize();
+	header.m_totalVertexCount = positions.getSize();
+	header.m_subMeshCount = 1;
+	header.m_aabbMin = Vec3(-1.0f, -1.0f, -0.1f);
+	header.m_aabbMax = Vec3(11.0f, 1.0f, 0.1f);
+
+	MeshBinaryFile::SubMesh submesh;
+	submesh.m_firstIndex = 0;
+	submesh.m_indexCount = indices.getSize();
+	submesh.m_aabbMin = header.m_aabbMin;
+	submesh.m_aabbMax = header.m_aabbMax;
+
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open(MESH_FILENAME, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&header, sizeof(header)));
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&submesh, sizeof(submesh)));
+
+	const U32 meshletCount = meshlets.getSize();
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&meshletCount, sizeof(meshletCount)));
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&meshlets[0], meshlets.getSizeInBytes()));
+
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&indices[0], indices.getSizeInBytes()));
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&positions[0], positions.getSizeInBytes()));
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&otherAttribs[0], otherAttribs.getSizeInBytes()));
+}
+
+/// Return the meshlets that a camera sees.
+static void cullMeshlets(const MeshResource& mesh,
+	const Transform& worldTransform,
+	const Vec3& cameraOrigin,
+	F32 cameraRotationY,
+	F32 fov,
+	DynamicArrayAuto<U32>& visibleMeshlets)
+{
+	Mat3 cameraRotation = Mat3::getIdentity();
+	cameraRotation.setRotationY(cameraRotationY);
+	const Mat4 view = Mat4(cameraOrigin.xyz1(), cameraRotation, 1.0f).getInverse();
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(fov, fov, 0.1f, 100.0f);
+
+	Array<Plane, 6> planes;
+	extractClipPlanes(proj * view, planes);
+
+	visibleMeshlets.destroy();
+	mesh.cullMeshlets(0, worldTransform, cameraOrigin.xyz0(), planes, visibleMeshlets);
+}
+
+ANKI_TEST(Resource, MeshResourceMeshlets)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs);
+
+	// The bounds and the cones as the importer computes them. All the normals of a quad are the same so the cones are
+	// as narrow as they can get
+	Array<MeshBinaryFile::Meshlet, 2> meshlets;
+	meshlets[0].m_firstIndex = 0;
+	meshlets[0].m_indexCount = 6;
+	meshlets[0].m_sphereCenter = Vec3(0.0f);
+	meshlets[0].m_sphereRadius = sqrt(2.0f);
+	meshlets[0].m_coneAxis = Vec3(0.0f, 0.0f, 1.0f);
+	meshlets[0].m_coneCutoff = 0.0f;
+
+	meshlets[1].m_firstIndex = 6;
+	meshlets[1].m_indexCount = 6;
+	meshlets[1].m_sphereCenter = Vec3(10.0f, 0.0f, 0.0f);
+	meshlets[1].m_sphereRadius = sqrt(2.0f);
+	meshlets[1].m_coneAxis = Vec3(0.0f, 0.0f, -1.0f);
+	meshlets[1].m_coneCutoff = 0.0f;
+
+	// Load the meshlets
+	{
+		writeMesh(MeshBinaryFile::Flag::MESHLETS, meshlets);
+
+		MeshLoader loader(resources);
+		ANKI_TEST_EXPECT_NO_ERR(loader.load(MESH_FILENAME));
+		ANKI_TEST_EXPECT_EQ(loader.getMeshlets().getSize(), 2);
+		for(U32 i = 0; i < 2; ++i)
+		{
+			const MeshBinaryFile::Meshlet& m = loader.getMeshlets()[i];
+			ANKI_TEST_EXPECT_EQ(m.m_firstIndex, meshlets[i].m_firstIndex);
+			ANKI_TEST_EXPECT_EQ(m.m_indexCount, meshlets[i].m_indexCount);
+			ANKI_TEST_EXPECT_EQ(m.m_sphereCenter, meshlets[i].m_sphereCenter);
+			ANKI_TEST_EXPECT_EQ(m.m_sphereRadius, meshlets[i].m_sphereRadius);
+			ANKI_TEST_EXPECT_EQ(m.m_coneAxis, meshlets[i].m_coneAxis);
+			ANKI_TEST_EXPECT_EQ(m.m_coneCutoff, meshlets[i].m_coneCutoff);
+		}
+	}
+
+	// Broken files
+	{
+		Array<MeshBinaryFile::Meshlet, 2> broken = meshlets;
+		broken[1].m_coneCutoff = 1.5f;
+		writeMesh(MeshBinaryFile::Flag::MESHLETS, broken);
+		MeshLoader loader0(resources);
+		ANKI_TEST_EXPECT_EQ(loader0.load(MESH_FILENAME), Error::USER_DATA);
+
+		broken = meshlets;
+		broken[1].m_coneAxis = Vec3(0.0f, 0.0f, -2.0f);
+		writeMesh(MeshBinaryFile::Flag::MESHLETS, broken);
+		MeshLoader loader1(resources);
+		ANKI_TEST_EXPECT_EQ(loader1.load(MESH_FILENAME), Error::USER_DATA);
+
+		broken = meshlets;
+		broken[0].m_sphereCenter = Vec3(0.0f, 5.0f, 0.0f);
+		writeMesh(MeshBinaryFile::Flag::MESHLETS, broken);
+		MeshLoader loader2(resources);
+		ANKI_TEST_EXPECT_EQ(loader2.load(MESH_FILENAME), Error::USER_DATA);
+
+		broken = meshlets;
+		broken[0].m_indexCount = 4;
+		broken[1].m_firstIndex = 4;
+		broken[1].m_indexCount = 8;
+		writeMesh(MeshBinaryFile::Flag::MESHLETS, broken);
+		MeshLoader loader3(resources);
+		ANKI_TEST_EXPECT_EQ(loader3.load(MESH_FILENAME), Error::USER_DATA);
+
+		writeMesh(MeshBinaryFile::Flag::MESHLETS | MeshBinaryFile::Flag::QUAD, meshlets);
+		MeshLoader loader4(resources);
+		ANKI_TEST_EXPECT_EQ(loader4.load(MESH_FILENAME), Error::USER_DATA);
+	}
+
+	// Cull
+	{
+		writeMesh(MeshBinaryFile::Flag::MESHLETS, meshlets);
+
+		MeshResourcePtr mesh;
+		ANKI_TEST_EXPECT_NO_ERR(resources->loadResource(MESH_FILENAME, mesh, false));
+		ANKI_TEST_EXPECT_EQ(mesh->hasMeshlets(), true);
+		ANKI_TEST_EXPECT_EQ(mesh->getMeshlets(0).getSize(), 2);
+
+		const F32 wideFov = toRad(120.0f);
+		const F32 narrowFov = toRad(30.0f);
+		DynamicArrayAuto<U32> visible(resources->getTempAllocator());
+
+		// Looking at -Z. The 2nd quad is back-facing
+		cullMeshlets(*mesh, Transform::getIdentity(), Vec3(0.0f, 0.0f, 10.0f), 0.0f, wideFov, visible);
+		ANKI_TEST_EXPECT_EQ(visible.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(visible[0], 0);
+
+		// Looking at +Z. The 1st quad is back-facing
+		cullMeshlets(*mesh, Transform::getIdentity(), Vec3(0.0f, 0.0f, -10.0f), PI, wideFov, visible);
+		ANKI_TEST_EXPECT_EQ(visible.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(visible[0], 1);
+
+		// The 1st quad faces the camera but it's outside the frustum
+		cullMeshlets(*mesh, Transform::getIdentity(), Vec3(20.0f, 0.0f, 10.0f), 0.0f, narrowFov, visible);
+		ANKI_TEST_EXPECT_EQ(visible.getSize(), 0);
+
+		// Rotate the mesh so the 2nd quad faces the camera
+		Mat3x4 rot = Mat3x4::getIdentity();
+		rot.setRotationY(PI);
+		cullMeshlets(*mesh, Transform(Vec4(0.0f), rot, 1.0f), Vec3(0.0f, 0.0f, 10.0f), 0.0f, wideFov, visible);
+		ANKI_TEST_EXPECT_EQ(visible.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(visible[0], 1);
+	}
+
+	delete resources;
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
+
+} // end namespace anki
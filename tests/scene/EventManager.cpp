@@ -0,0 +1,232 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/events/Event.h>
+#include <anki/scene/events/EventManager.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/physics/PhysicsWorld.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/ThreadHive.h>
+
+namespace anki
+{
+
+/// Remembers the order the events started and when.
+class EventLog
+{
+public:
+	static const U32 MAX_EVENTS = 16;
+
+	Array<U32, MAX_EVENTS> m_ids;
+	Array<Second, MAX_EVENTS> m_prevUpdateTimes;
+	Array<Second, MAX_EVENTS> m_crntTimes;
+	U32 m_count = 0;
+
+	Array<U32, MAX_EVENTS> m_updateCounts = {};
+	Array<Second, MAX_EVENTS> m_lastUpdateTimes = {};
+};
+
+class TestEvent : public Event
+{
+public:
+	TestEvent(EventManager* manager)
+		: Event(manager)
+	{
+	}
+
+	ANKI_USE_RESULT Error init(Second startTime, Second duration, U32 id, EventLog* log)
+	{
+		ANKI_ASSERT(id < EventLog::MAX_EVENTS && log);
+		Event::init(startTime, duration);
+		m_id = id;
+		m_log = log;
+		return Error::NONE;
+	}
+
+	ANKI_USE_RESULT Error update(Second prevUpdateTime, Second crntTime) override
+	{
+		if(m_log->m_updateCounts[m_id] == 0)
+		{
+			m_log->m_ids[m_log->m_count] = m_id;
+			m_log->m_prevUpdateTimes[m_log->m_count] = prevUpdateTime;
+			m_log->m_crntTimes[m_log->m_count] = crntTime;
+			++m_log->m_count;
+		}
+
+		++m_log->m_updateCounts[m_id];
+		m_log->m_lastUpdateTimes[m_id] = crntTime;
+		return Error::NONE;
+	}
+
+private:
+	U32 m_id = 0;
+	EventLog* m_log = nullptr;
+};
+
+static void runFrames(EventManager& events, Second& time, Second until, Second step)
+{
+	while(time < until)
+	{
+		const Second prevTime = time;
+		time += step;
+		ANKI_TEST_EXPECT_NO_ERR(events.updateAllEvents(prevTime, time));
+		events.deleteEventsMarkedForDeletion();
+	}
+}
+
+/// Check that the event started in the first update that covered its start time.
+static void checkStartedAt(const EventLog& log, U32 id, Second startTime)
+{
+	for(U32 i = 0; i < log.m_count; ++i)
+	{
+		if(log.m_ids[i] == id)
+		{
+			ANKI_TEST_EXPECT_GT(startTime, log.m_prevUpdateTimes[i]);
+			ANKI_TEST_EXPECT_GEQ(log.m_crntTimes[i], startTime);
+			return;
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(id, MAX_U32); // Never started
+}
+
+ANKI_TEST(Scene, EventManager)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs);
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive* hive = new ThreadHive(getCpuCoresCount(), alloc);
+	Timestamp timestamp = 1;
+
+	auto newScene = [&]() {
+		SceneGraph* scene = new SceneGraph();
+		ANKI_TEST_EXPECT_NO_ERR(scene->init(allocAligned, nullptr, hive, resources, nullptr, nullptr, &timestamp, cfg));
+		return scene;
+	};
+
+	// Events on every level of the wheel and past it start at the right update
+	{
+		SceneGraph* scene = newScene();
+		EventManager& events = scene->getEventManager();
+		EventLog log;
+
+		const Array<Second, 6> startTimes = {{600000.0, 9000.0, 150.0, 2.5, 0.5, 0.01}};
+		for(U32 i = 0; i < startTimes.getSize(); ++i)
+		{
+			TestEvent* event;
+			ANKI_TEST_EXPECT_NO_ERR(events.newEvent(event, startTimes[i], 0.1, i, &log));
+		}
+
+		Second time = 0.0;
+		runFrames(events, time, 200.0, 1.0 / 60.0);
+		ANKI_TEST_EXPECT_EQ(log.m_count, 4);
+
+		runFrames(events, time, 10000.0, 1.0);
+		ANKI_TEST_EXPECT_EQ(log.m_count, 5);
+
+		runFrames(events, time, 600100.0, 100.0);
+		ANKI_TEST_EXPECT_EQ(log.m_count, 6);
+
+		for(U32 i = 0; i < startTimes.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(log.m_ids[i], startTimes.getSize() - 1 - i);
+			checkStartedAt(log, i, startTimes[i]);
+		}
+
+		delete scene;
+	}
+
+	// Events that start in the same tick are updated in the order they were created, no matter the level of the wheel
+	// they were in
+	{
+		SceneGraph* scene = newScene();
+		EventManager& events = scene->getEventManager();
+		EventLog log;
+		Second time = 0.0;
+		TestEvent* event;
+
+		runFrames(events, time, 0.1, 1.0 / 60.0);
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(event, 3.01, 1.0, 0, &log)); // Goes to level 1
+
+		runFrames(events, time, 1.5, 1.0 / 60.0);
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(event, 3.02, 1.0, 1, &log)); // Goes to level 0
+
+		runFrames(events, time, 2.9, 1.0 / 60.0);
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(event, 3.0, 1.0, 2, &log)); // Starts a bit earlier
+
+		runFrames(events, time, 3.1, 3.1 - time);
+		ANKI_TEST_EXPECT_EQ(log.m_count, 3);
+		for(U32 i = 0; i < 3; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(log.m_ids[i], i);
+		}
+
+		delete scene;
+	}
+
+	// Kill dormant events and schedule them again
+	{
+		SceneGraph* scene = newScene();
+		EventManager& events = scene->getEventManager();
+		EventLog log;
+		Second time = 0.0;
+
+		Array<TestEvent*, 6> evs;
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[0], 1.0, 0.1, 0, &log)); // Level 0
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[1], 1.0, 0.1, 1, &log)); // Same slot as the above
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[2], 10.0, 0.1, 2, &log)); // Level 1
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[3], 3.0, 0.1, 3, &log)); // Level 1 and then level 0
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[4], 600000.0, 0.1, 4, &log)); // Far
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[5], 1.0, 0.25, 5, &log)); // Dies and starts again
+		evs[5]->setReanimate(true);
+
+		runFrames(events, time, 0.5, 1.0 / 60.0);
+		evs[0]->setMarkedForDeletion();
+		evs[2]->setMarkedForDeletion();
+		evs[4]->setMarkedForDeletion();
+
+		runFrames(events, time, 2.5, 1.0 / 60.0);
+		evs[3]->setMarkedForDeletion();
+
+		// Schedule the killed ones again, later
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[0], 4.0, 0.1, 6, &log));
+		ANKI_TEST_EXPECT_NO_ERR(events.newEvent(evs[3], 5.0, 0.1, 7, &log));
+
+		runFrames(events, time, 12.0, 1.0 / 60.0);
+
+		ANKI_TEST_EXPECT_EQ(log.m_count, 4);
+		ANKI_TEST_EXPECT_EQ(log.m_updateCounts[0], 0);
+		ANKI_TEST_EXPECT_EQ(log.m_updateCounts[2], 0);
+		ANKI_TEST_EXPECT_EQ(log.m_updateCounts[3], 0);
+		ANKI_TEST_EXPECT_EQ(log.m_updateCounts[4], 0);
+		checkStartedAt(log, 1, 1.0);
+		checkStartedAt(log, 6, 4.0);
+		checkStartedAt(log, 7, 5.0);
+
+		// The reanimated one is still alive
+		checkStartedAt(log, 5, 1.0);
+		ANKI_TEST_EXPECT_EQ(log.m_lastUpdateTimes[5], time);
+
+		delete scene;
+	}
+
+	delete hive;
+	delete resources;
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
+
+} // end namespace anki
@@ -0,0 +1,234 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SceneGraph.h>
+#include <anki/scene/SceneBinaryLoader.h>
+#include <anki/scene/components/LightComponent.h>
+#include <anki/scene/components/MoveComponent.h>
+#include <anki/resource/ResourceManager.h>
+#include <anki/physics/PhysicsWorld.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/System.h>
+#include <anki/util/File.h>
+
+namespace anki
+{
+
+static const char* SCENE_FILENAME = "SceneBinaryLoaderTest.ankiscene";
+
+/// Builds scene binaries in memory.
+class SceneBinaryBuilder
+{
+public:
+	HeapAllocator<U8> m_alloc;
+	SceneBinaryFile::Header m_header;
+	DynamicArrayAuto<SceneBinaryFile::Resource> m_resources;
+	DynamicArrayAuto<SceneBinaryFile::Node> m_nodes;
+	DynamicArrayAuto<char> m_strings;
+
+	SceneBinaryBuilder(HeapAllocator<U8> alloc)
+		: m_alloc(alloc)
+		, m_resources(alloc)
+		, m_nodes(alloc)
+		, m_strings(alloc)
+	{
+		zeroMemory(m_header);
+		memcpy(&m_header.m_magic[0], SceneBinaryFile::MAGIC, sizeof(m_header.m_magic));
+	}
+
+	U32 addString(CString str)
+	{
+		const U32 offset = m_strings.getSize();
+		m_strings.resize(offset + str.getLength() + 1);
+		memcpy(&m_strings[offset], str.cstr(), str.getLength() + 1);
+		return offset;
+	}
+
+	SceneBinaryFile::Node& addNode(SceneBinaryFile::NodeType type, CString name, const Vec3& origin)
+	{
+		SceneBinaryFile::Node node;
+		zeroMemory(node);
+		node.m_type = type;
+		node.m_name = addString(name);
+		node.m_resource = SceneBinaryFile::NONE;
+		node.m_origin = {{origin.x(), origin.y(), origin.z()}};
+		node.m_rotation = {{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f}};
+		node.m_scale = 1.0f;
+
+		return *m_nodes.emplaceBack(node);
+	}
+
+	/// Write the file. The counts of the header are the sizes of the arrays unless they are set by hand.
+	/// @param truncateBy Drop that many bytes from the end of the file.
+	void write(PtrSize truncateBy = 0, Bool fixCounts = true)
+	{
+		if(fixCounts)
+		{
+			m_header.m_resourceCount = m_resources.getSize();
+			m_header.m_nodeCount = m_nodes.getSize();
+			m_header.m_stringTableSize = m_strings.getSize();
+		}
+
+		DynamicArrayAuto<U8> bytes(m_alloc);
+		auto append = [&](const void* data, PtrSize size) {
+			if(size)
+			{
+				const PtrSize offset = bytes.getSize();
+				bytes.resize(offset + size);
+				memcpy(&bytes[offset], data, size);
+			}
+		};
+
+		append(&m_header, sizeof(m_header));
+		append(m_resources.getBegin(), m_resources.getSizeInBytes());
+		append(m_nodes.getBegin(), m_nodes.getSizeInBytes());
+		append(m_strings.getBegin(), m_strings.getSizeInBytes());
+		ANKI_TEST_EXPECT_GT(bytes.getSize(), truncateBy);
+
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(SCENE_FILENAME, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_TEST_EXPECT_NO_ERR(file.write(&bytes[0], bytes.getSize() - truncateBy));
+	}
+};
+
+ANKI_TEST(Scene, SceneBinaryLoader)
+{
+	ConfigSet cfg = DefaultConfigSet::get();
+	initConfig(cfg);
+
+	NativeWindow* win = createWindow(cfg);
+	GrManager* gr = createGrManager(cfg, win);
+	PhysicsWorld* physics;
+	ResourceFilesystem* fs;
+	ResourceManager* resources = createResourceManager(cfg, gr, physics, fs);
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ThreadHive* hive = new ThreadHive(getCpuCoresCount(), alloc);
+	Timestamp timestamp = 1;
+
+	SceneGraph* scene = new SceneGraph();
+	ANKI_TEST_EXPECT_NO_ERR(scene->init(allocAligned, nullptr, hive, resources, nullptr, nullptr, &timestamp, cfg));
+
+	// A light and a camera
+	auto buildGoodScene = [&](SceneBinaryBuilder& b) {
+		SceneBinaryFile::Node& light =
+			b.addNode(SceneBinaryFile::NodeType::POINT_LIGHT, "light", Vec3(1.0f, 2.0f, 3.0f));
+		light.m_light.m_diffuseColor = {{1.0f, 0.5f, 0.25f}};
+		light.m_light.m_radius = 5.0f;
+		light.m_light.m_lensFlare = SceneBinaryFile::NONE;
+
+		SceneBinaryFile::Node& cam = b.addNode(SceneBinaryFile::NodeType::PERSPECTIVE_CAMERA, "cam", Vec3(0.0f));
+		cam.m_camera.m_near = 0.1f;
+		cam.m_camera.m_far = 100.0f;
+		cam.m_camera.m_fovY = toRad(60.0f);
+	};
+
+	// Good file
+	{
+		SceneBinaryBuilder b(alloc);
+		buildGoodScene(b);
+		b.write();
+
+		ANKI_TEST_EXPECT_NO_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f));
+
+		SceneNode* light = scene->tryFindSceneNode("light");
+		ANKI_TEST_EXPECT_NEQ(light, nullptr);
+		ANKI_TEST_EXPECT_EQ(light->getComponent<LightComponent>().getRadius(), 5.0f);
+		ANKI_TEST_EXPECT_EQ(light->getComponent<MoveComponent>().getLocalTransform().getOrigin(),
+			Vec4(1.0f, 2.0f, 3.0f, 0.0f));
+
+		ANKI_TEST_EXPECT_NEQ(scene->tryFindSceneNode("cam"), nullptr);
+		ANKI_TEST_EXPECT_EQ(&scene->getActiveCameraNode(), scene->tryFindSceneNode("cam"));
+		ANKI_TEST_EXPECT_NEQ(scene->getContentHash(), 0);
+	}
+
+	// Bad magic
+	{
+		SceneBinaryBuilder b(alloc);
+		buildGoodScene(b);
+		b.m_header.m_magic[7] = 'X';
+		b.write();
+
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+	}
+
+	// Truncated sections
+	{
+		SceneBinaryBuilder b(alloc);
+		buildGoodScene(b);
+
+		// Part of the string table is missing
+		b.write(1);
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+
+		// The header says there are more nodes than there are
+		b.m_header.m_nodeCount = b.m_nodes.getSize() + 1;
+		b.write(0, false);
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+
+		// Not even a header
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(SCENE_FILENAME, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&b.m_header, 4));
+		}
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+	}
+
+	// Out of range string index
+	{
+		SceneBinaryBuilder b(alloc);
+		buildGoodScene(b);
+		b.m_nodes[1].m_name = b.m_strings.getSize();
+		b.write();
+
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+	}
+
+	// Out of range resource filename
+	{
+		SceneBinaryBuilder b(alloc);
+		buildGoodScene(b);
+		SceneBinaryFile::Resource rsrc;
+		rsrc.m_type = SceneBinaryFile::ResourceType::MODEL;
+		rsrc.m_filename = b.m_strings.getSize() + 10;
+		b.m_resources.emplaceBack(rsrc);
+		b.write();
+
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+	}
+
+	// Out of range resource indices
+	{
+		SceneBinaryBuilder b(alloc);
+		buildGoodScene(b);
+		b.addNode(SceneBinaryFile::NodeType::MODEL, "model", Vec3(0.0f)).m_resource = 0;
+		b.write();
+
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+
+		SceneBinaryBuilder b2(alloc);
+		buildGoodScene(b2);
+		b2.m_nodes[0].m_light.m_lensFlare = 3;
+		b2.write();
+
+		ANKI_TEST_EXPECT_ERR(scene->loadBinaryScene(SCENE_FILENAME, 1.5f), Error::USER_DATA);
+	}
+
+	// The failed loads didn't create anything
+	ANKI_TEST_EXPECT_EQ(scene->tryFindSceneNode("model"), nullptr);
+
+	delete scene;
+	delete hive;
+	delete resources;
+	delete physics;
+	delete fs;
+	GrManager::deleteInstance(gr);
+	delete win;
+}
+
+} // end namespace anki
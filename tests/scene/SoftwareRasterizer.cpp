@@ -0,0 +1,89 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/SoftwareRasterizer.h>
+#include <anki/collision/Aabb.h>
+
+namespace anki
+{
+
+ANKI_TEST(Scene, SoftwareRasterizer)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 width = 16;
+	const U32 height = 16;
+	const Mat4 proj = Mat4::calculatePerspectiveProjectionMatrix(toRad(90.0f), toRad(90.0f), 0.1f, 100.0f);
+	const Mat4 view = Mat4::getIdentity();
+
+	// The previous frame's camera was a bit back and it saw a wall at Z=-10
+	Mat4 prevView = Mat4::getIdentity();
+	prevView(2, 3) = -5.0f;
+	const Mat4 prevViewProj = proj * prevView;
+
+	const Vec4 wallClip = prevViewProj * Vec4(0.0f, 0.0f, -10.0f, 1.0f);
+	DynamicArrayAuto<F32> depths(alloc, width * height, wallClip.z() / wallClip.w());
+
+	const Aabb boxInFrontOfWall(Vec4(-0.5f, -0.5f, -9.0f, 0.0f), Vec4(0.5f, 0.5f, -8.0f, 0.0f));
+	const Aabb boxBehindWall(Vec4(-0.5f, -0.5f, -13.0f, 0.0f), Vec4(0.5f, 0.5f, -12.0f, 0.0f));
+
+	SoftwareRasterizer r;
+	r.init(alloc);
+	SoftwareRasterizerSourceBit occludedBy;
+
+	// Nothing rendered. The texels are at the far plane but they don't come from any source
+	{
+		r.prepare(view, proj, width, height);
+
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxBehindWall), true);
+
+		const Aabb boxPastFarPlane(Vec4(-0.5f, -0.5f, -120.0f, 0.0f), Vec4(0.5f, 0.5f, -110.0f, 0.0f));
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxPastFarPlane, occludedBy), false);
+		ANKI_TEST_EXPECT_EQ(occludedBy, SoftwareRasterizerSourceBit::NONE);
+	}
+
+	// Reprojected depth buffer
+	{
+		r.prepare(view, proj, width, height);
+		r.reprojectDepthBuffer(ConstWeakArray<F32>(&depths[0], depths.getSize()), prevViewProj);
+
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxInFrontOfWall), true);
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxBehindWall, occludedBy), false);
+		ANKI_TEST_EXPECT_EQ(occludedBy, SoftwareRasterizerSourceBit::DEPTH_BUFFER);
+	}
+
+	// Same without reprojection, the old wall is too far to occlude
+	{
+		r.prepare(view, proj, width, height);
+		r.fillDepthBuffer(ConstWeakArray<F32>(&depths[0], depths.getSize()));
+
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxBehindWall), true);
+	}
+
+	// Occluders
+	{
+		r.prepare(view, proj, width, height);
+
+		const Array<Vec3, 6> verts = {{Vec3(-10.0f, -10.0f, -11.0f),
+			Vec3(10.0f, -10.0f, -11.0f),
+			Vec3(10.0f, 10.0f, -11.0f),
+			Vec3(10.0f, 10.0f, -11.0f),
+			Vec3(-10.0f, 10.0f, -11.0f),
+			Vec3(-10.0f, -10.0f, -11.0f)}};
+		r.draw(&verts[0][0], verts.getSize(), sizeof(Vec3), false);
+
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxInFrontOfWall), true);
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxBehindWall, occludedBy), false);
+		ANKI_TEST_EXPECT_EQ(occludedBy, SoftwareRasterizerSourceBit::OCCLUDERS);
+
+		// Outside the window, nothing occludes it
+		const Aabb boxOutside(Vec4(50.0f, -0.5f, -11.0f, 0.0f), Vec4(51.0f, 0.5f, -10.0f, 0.0f));
+		ANKI_TEST_EXPECT_EQ(r.visibilityTest(boxOutside, occludedBy), false);
+		ANKI_TEST_EXPECT_EQ(occludedBy, SoftwareRasterizerSourceBit::NONE);
+	}
+}
+
+} // end namespace anki
@@ -16,6 +16,11 @@ ANKI_TEST(Util, FileExists)
 
 	// Check
 	ANKI_TEST_EXPECT_EQ(fileExists("./tmp"), true);
+
+	// Remove
+	ANKI_TEST_EXPECT_NO_ERR(removeFile("./tmp"));
+	ANKI_TEST_EXPECT_EQ(fileExists("./tmp"), false);
+	ANKI_TEST_EXPECT_ERR(removeFile("./tmp"), Error::FUNCTION_FAILED);
 }
 
 ANKI_TEST(Util, Directory)
@@ -0,0 +1,73 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/Functions.h>
+#include <vector>
+
+using namespace anki;
+
+ANKI_TEST(Util, SplitThreadedProblemWeighted)
+{
+	const U32 THREAD_COUNT = 4;
+
+	// Uniform costs should give almost the same range sizes
+	{
+		const U32 problemSize = 103;
+		std::vector<F32> prefixSums(problemSize);
+		for(U32 i = 0; i < problemSize; ++i)
+		{
+			prefixSums[i] = F32(i + 1);
+		}
+
+		for(U32 tid = 0; tid < THREAD_COUNT; ++tid)
+		{
+			U32 start, end;
+			splitThreadedProblem(tid, THREAD_COUNT, problemSize, &prefixSums[0], start, end);
+
+			ANKI_TEST_EXPECT_GEQ(end - start, problemSize / THREAD_COUNT);
+			ANKI_TEST_EXPECT_LEQ(end - start, problemSize / THREAD_COUNT + 1);
+		}
+	}
+
+	// Random costs. Ranges should be contiguous, not empty and cover the whole problem
+	for(U32 iteration = 0; iteration < 100; ++iteration)
+	{
+		const U32 problemSize = THREAD_COUNT + U32(rand() % 200);
+		std::vector<F32> prefixSums(problemSize);
+		F32 sum = 0.0f;
+		for(U32 i = 0; i < problemSize; ++i)
+		{
+			// Some elements are way more expensive
+			sum += ((rand() % 10) == 0) ? 50.0f : 1.0f;
+			prefixSums[i] = sum;
+		}
+
+		U32 prevEnd = 0;
+		for(U32 tid = 0; tid < THREAD_COUNT; ++tid)
+		{
+			U32 start, end;
+			splitThreadedProblem(tid, THREAD_COUNT, problemSize, &prefixSums[0], start, end);
+
+			ANKI_TEST_EXPECT_EQ(start, prevEnd);
+			ANKI_TEST_EXPECT_LT(start, end);
+			prevEnd = end;
+		}
+
+		ANKI_TEST_EXPECT_EQ(prevEnd, problemSize);
+	}
+
+	// The expensive element should start a new range
+	{
+		const Array<F32, 8> prefixSums = {{1.0f, 2.0f, 102.0f, 103.0f, 104.0f, 105.0f, 106.0f, 107.0f}};
+		U32 start, end;
+		splitThreadedProblem(0, 2, prefixSums.getSize(), &prefixSums[0], start, end);
+		ANKI_TEST_EXPECT_EQ(start, 0);
+		ANKI_TEST_EXPECT_EQ(end, 2);
+		splitThreadedProblem(1, 2, prefixSums.getSize(), &prefixSums[0], start, end);
+		ANKI_TEST_EXPECT_EQ(start, 2);
+		ANKI_TEST_EXPECT_EQ(end, 8);
+	}
+}
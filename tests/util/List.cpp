@@ -195,4 +195,26 @@ ANKI_TEST(Util, List)
 		a.erase(alloc, a.getBegin());
 		a.erase(alloc, a.getBegin());
 	}
+
+	// Insert in the middle
+	{
+		List<I> a;
+
+		a.emplaceBack(alloc, 10);
+		a.emplaceBack(alloc, 30);
+		a.emplace(alloc, a.getBegin() + 1, 20);
+
+		I sum = 0;
+		I i = 10;
+		for(I x : a)
+		{
+			ANKI_TEST_EXPECT_EQ(x, i);
+			sum += x;
+			i += 10;
+		}
+		ANKI_TEST_EXPECT_EQ(sum, 60);
+		ANKI_TEST_EXPECT_EQ(20, *(a.getEnd() - 2));
+
+		a.destroy(alloc);
+	}
 }
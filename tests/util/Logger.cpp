@@ -0,0 +1,164 @@
+// Copyright (C) 2009-2019, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/Logger.h>
+#include <anki/util/Thread.h>
+#include <cstring>
+
+using namespace anki;
+
+namespace
+{
+
+class LoggerTestContext
+{
+public:
+	static const U32 THREAD_COUNT = 4;
+	static const U32 MESSAGES_PER_THREAD = 64;
+
+	Logger* m_logger = nullptr;
+	Array<I32, THREAD_COUNT> m_lastMessage;
+	Atomic<U32> m_receivedCount = {0};
+	Bool m_outOfOrder = false;
+};
+
+} // end anonymous namespace
+
+static void countingMessageHandler(void* ud, const LoggerMessageInfo& info)
+{
+	if(std::strcmp(info.m_subsystem, "TEST") != 0)
+	{
+		return;
+	}
+
+	LoggerTestContext& ctx = *static_cast<LoggerTestContext*>(ud);
+
+	U32 thread, msg;
+	sscanf(info.m_msg, "%u %u", &thread, &msg);
+	if(I32(msg) <= ctx.m_lastMessage[thread])
+	{
+		ctx.m_outOfOrder = true;
+	}
+	ctx.m_lastMessage[thread] = I32(msg);
+
+	ctx.m_receivedCount.fetchAdd(1);
+}
+
+static void writeTestMessages(Logger& logger, U32 threadIdx, U32 count)
+{
+	for(U32 i = 0; i < count; ++i)
+	{
+		logger.writeFormated(ANKI_FILE,
+			__LINE__,
+			ANKI_FUNC,
+			"TEST",
+			LoggerMessageType::NORMAL,
+			Thread::getCurrentThreadId(),
+			"%u %u",
+			threadIdx,
+			i);
+	}
+}
+
+static Error loggerTestThread(ThreadCallbackInfo& info)
+{
+	LoggerTestContext& ctx = *static_cast<LoggerTestContext*>(info.m_userData);
+	const U32 threadIdx = U32(info.m_threadName[0] - '0');
+
+	writeTestMessages(*ctx.m_logger, threadIdx, LoggerTestContext::MESSAGES_PER_THREAD);
+	return Error::NONE;
+}
+
+ANKI_TEST(Util, LoggerAsync)
+{
+	Logger logger;
+	LoggerTestContext ctx;
+	ctx.m_logger = &logger;
+	for(I32& last : ctx.m_lastMessage)
+	{
+		last = -1;
+	}
+	logger.addMessageHandler(&ctx, countingMessageHandler);
+
+	logger.startAsync();
+	ANKI_TEST_EXPECT_EQ(logger.isAsync(), true);
+
+	// The name of the thread is its index
+	Thread t0("0"), t1("1"), t2("2"), t3("3");
+	Array<Thread*, LoggerTestContext::THREAD_COUNT> threads = {{&t0, &t1, &t2, &t3}};
+	for(Thread* thread : threads)
+	{
+		thread->start(&ctx, loggerTestThread);
+	}
+
+	for(Thread* thread : threads)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(thread->join());
+	}
+
+	logger.stopAsync();
+	ANKI_TEST_EXPECT_EQ(logger.isAsync(), false);
+
+	// Every message was either handled in order or dropped
+	ANKI_TEST_EXPECT_EQ(ctx.m_outOfOrder, false);
+	ANKI_TEST_EXPECT_EQ(ctx.m_receivedCount.load() + logger.getDroppedMessageCount(),
+		LoggerTestContext::THREAD_COUNT * LoggerTestContext::MESSAGES_PER_THREAD);
+
+	logger.removeMessageHandler(&ctx, countingMessageHandler);
+}
+
+ANKI_TEST(Util, LoggerAsyncManyLoggers)
+{
+	const U32 MESSAGE_COUNT = 16;
+
+	// Two loggers written by the same thread one after the other
+	{
+		Array<Logger, 2> loggers;
+		Array<LoggerTestContext, 2> contexts;
+		for(U32 i = 0; i < 2; ++i)
+		{
+			for(I32& last : contexts[i].m_lastMessage)
+			{
+				last = -1;
+			}
+			loggers[i].addMessageHandler(&contexts[i], countingMessageHandler);
+			loggers[i].startAsync();
+		}
+
+		for(U32 i = 0; i < MESSAGE_COUNT; ++i)
+		{
+			writeTestMessages(loggers[i % 2], 0, 1);
+		}
+
+		for(U32 i = 0; i < 2; ++i)
+		{
+			loggers[i].stopAsync();
+			ANKI_TEST_EXPECT_EQ(contexts[i].m_receivedCount.load(), MESSAGE_COUNT / 2);
+		}
+	}
+
+	// A logger that is created in the memory of a deleted one shouldn't get the ring buffer of the old one
+	alignas(Logger) U8 mem[sizeof(Logger)];
+	for(U32 i = 0; i < 2; ++i)
+	{
+		Logger* logger = ::new(&mem[0]) Logger();
+
+		LoggerTestContext ctx;
+		for(I32& last : ctx.m_lastMessage)
+		{
+			last = -1;
+		}
+		logger->addMessageHandler(&ctx, countingMessageHandler);
+		logger->startAsync();
+
+		writeTestMessages(*logger, 0, MESSAGE_COUNT);
+		logger->flush();
+		ANKI_TEST_EXPECT_EQ(ctx.m_receivedCount.load(), MESSAGE_COUNT);
+		ANKI_TEST_EXPECT_EQ(ctx.m_outOfOrder, false);
+
+		logger->~Logger();
+	}
+}
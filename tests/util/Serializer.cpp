@@ -9,7 +9,7 @@
 
 ANKI_TEST(Util, BinarySerializer)
 {
-	Array<ClassB, 2> b = {};
+	Array<ClassB, 3> b = {};
 
 	b[0].m_array[0] = 2;
 	b[0].m_array[1] = 3;
@@ -23,6 +23,9 @@ ANKI_TEST(Util, BinarySerializer)
 	Array<U32, 1> bDarr2 = {{0x12345678}};
 	b[1].m_darray = bDarr2;
 
+	// Leave the dynamic array empty
+	b[2].m_array[0] = 1;
+
 	ClassA a = {};
 	a.m_array[0] = 123;
 	a.m_array[1] = 56;
@@ -57,6 +60,7 @@ ANKI_TEST(Util, BinarySerializer)
 		for(U32 i = 0; i < pa->m_darray.getSize(); ++i)
 		{
 			ANKI_TEST_EXPECT_EQ(pa->m_darray[i].m_array[1], b[i].m_array[1]);
+			ANKI_TEST_EXPECT_EQ(pa->m_darray[i].m_darray.getSize(), b[i].m_darray.getSize());
 
 			for(U32 j = 0; j < pa->m_darray[i].m_darray.getSize(); ++j)
 			{
@@ -67,3 +71,52 @@ ANKI_TEST(Util, BinarySerializer)
 		alloc.deleteInstance(pa);
 	}
 }
+
+ANKI_TEST(Util, BinarySerializerComplexArray)
+{
+	// The array of classes that point to memory is not at the beginning of the class
+	Array<U32, 2> darr0 = {{0x11223344, 0x55667788}};
+	Array<U32, 3> darr1 = {{0xAABBCCDD, 0xEEFF0011, 0x22334455}};
+
+	ClassC c = {};
+	c.m_u32 = 0xDEADBEEF;
+	c.m_array[0].m_array[0] = 10;
+	c.m_array[0].m_darray = darr0;
+	c.m_array[1].m_array[2] = 20;
+	c.m_array[1].m_darray = darr1;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(c, alloc, file));
+	}
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::READ | FileOpenFlag::BINARY));
+
+		ClassC* pc;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserialize(pc, alloc, file));
+
+		ANKI_TEST_EXPECT_EQ(pc->m_u32, c.m_u32);
+		ANKI_TEST_EXPECT_EQ(pc->m_array[0].m_array[0], 10);
+		ANKI_TEST_EXPECT_EQ(pc->m_array[1].m_array[2], 20);
+
+		ANKI_TEST_EXPECT_EQ(pc->m_array[0].m_darray.getSize(), darr0.getSize());
+		for(U32 i = 0; i < darr0.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(pc->m_array[0].m_darray[i], darr0[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(pc->m_array[1].m_darray.getSize(), darr1.getSize());
+		for(U32 i = 0; i < darr1.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(pc->m_array[1].m_darray[i], darr1[i]);
+		}
+
+		alloc.deleteInstance(pc);
+	}
+}
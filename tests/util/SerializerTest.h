@@ -70,4 +70,31 @@ public:
 	}
 };
 
+/// ClassC class.
+class ClassC
+{
+public:
+	U32 m_u32;
+	Array<ClassB, 2> m_array;
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doValue("m_u32", offsetof(ClassC, m_u32), self.m_u32);
+		s.doArray("m_array", offsetof(ClassC, m_array), &self.m_array[0], 2);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ClassC&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ClassC&>(serializer, *this);
+	}
+};
+
 } // end namespace anki